@@ -0,0 +1,189 @@
+# Copyright 2022 The DeepRec Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Benchmark of the dense variable cache on a local ps cluster.
+
+The ps and the worker run in separate processes on localhost. The worker
+trains a MLP whose variables live on the ps. For each staleness the bytes
+received by the worker from the ps per step, the step time and the loss are
+reported.
+
+  python benchmark.py --staleness=0,2,4,8 --protocol=grpc
+"""
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import argparse
+import multiprocessing
+import socket
+import time
+
+import numpy as np
+import tensorflow as tf
+from tensorflow.core.protobuf import config_pb2
+from tensorflow.python.framework import dtypes
+
+_RECV_OPS = ('_Recv', '_HostRecv', '_FuseRecv', '_HostFuseRecv')
+
+
+def _free_port():
+  s = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+  s.bind(('localhost', 0))
+  port = s.getsockname()[1]
+  s.close()
+  return port
+
+
+def _cluster(ps_port, worker_port):
+  return tf.train.ClusterSpec({
+      'ps': ['localhost:%d' % ps_port],
+      'worker': ['localhost:%d' % worker_port]
+  })
+
+
+def _run_ps(protocol, ps_port, worker_port):
+  server = tf.distribute.Server(_cluster(ps_port, worker_port),
+                                job_name='ps',
+                                task_index=0,
+                                protocol=protocol)
+  server.join()
+
+
+def _task(device):
+  return device[:device.find('/device:')] if '/device:' in device else device
+
+
+def _remote_recvs(run_metadata):
+  """Returns the (device, name) of the recvs whose sender is in another
+  task."""
+  recvs = set()
+  for graph in run_metadata.partition_graphs:
+    for node in graph.node:
+      if node.op not in _RECV_OPS:
+        continue
+      if node.op.endswith('FuseRecv'):
+        send = node.attr['send_devices'].list.s[0].decode()
+      else:
+        send = node.attr['send_device'].s.decode()
+      if _task(send) != _task(node.device):
+        recvs.add((node.device, node.name))
+  return recvs
+
+
+def _received_bytes(run_metadata, recvs):
+  """Sums the sizes of the tensors received by the remote recvs, dead
+  tensors have no output."""
+  total = 0
+  for dev_stats in run_metadata.step_stats.dev_stats:
+    for node_stats in dev_stats.node_stats:
+      if (dev_stats.device, node_stats.node_name) not in recvs:
+        continue
+      for output in node_stats.output:
+        desc = output.tensor_description
+        if not desc.shape.dim:
+          num_elements = 1
+        else:
+          num_elements = np.prod([d.size for d in desc.shape.dim])
+        total += num_elements * dtypes.as_dtype(desc.dtype).size
+  return total
+
+
+def _benchmark(args, staleness, ps_port, worker_port):
+  server = tf.distribute.Server(_cluster(ps_port, worker_port),
+                                job_name='worker',
+                                task_index=0,
+                                protocol=args.protocol)
+  graph = tf.Graph()
+  with graph.as_default():
+    with tf.device(tf.train.replica_device_setter(
+        worker_device='/job:worker/task:0', ps_tasks=1)):
+      features = tf.random.normal([args.batch_size, args.hidden_units])
+      labels = tf.cast(tf.reduce_sum(features, axis=1, keepdims=True) > 0,
+                       tf.float32)
+      net = features
+      for i in range(args.num_layers):
+        net = tf.layers.dense(net, args.hidden_units, activation=tf.nn.relu,
+                              name='hidden_%d' % i)
+      logits = tf.layers.dense(net, 1, name='logits')
+      loss = tf.reduce_mean(
+          tf.nn.sigmoid_cross_entropy_with_logits(labels=labels,
+                                                  logits=logits))
+      train_op = tf.train.AdagradOptimizer(0.01).minimize(loss)
+    init = tf.global_variables_initializer()
+
+  config = tf.ConfigProto()
+  config.graph_options.optimizer_options.dense_variable_staleness = staleness
+  with tf.Session(server.target, graph=graph, config=config) as sess:
+    sess.run(init)
+    run_metadata = config_pb2.RunMetadata()
+    sess.run(train_op,
+             options=config_pb2.RunOptions(output_partition_graphs=True),
+             run_metadata=run_metadata)
+    recvs = _remote_recvs(run_metadata)
+
+    # Averages the received bytes over a few refresh periods.
+    trace_steps = max(staleness, 1) * 4
+    total_bytes = 0
+    for _ in range(trace_steps):
+      run_metadata = config_pb2.RunMetadata()
+      sess.run(train_op,
+               options=config_pb2.RunOptions(
+                   trace_level=config_pb2.RunOptions.FULL_TRACE),
+               run_metadata=run_metadata)
+      total_bytes += _received_bytes(run_metadata, recvs)
+
+    losses = []
+    start = time.time()
+    for _ in range(args.steps):
+      losses.append(sess.run([loss, train_op])[0])
+    elapsed = time.time() - start
+  return (total_bytes / trace_steps, elapsed / args.steps,
+          sum(losses[-10:]) / len(losses[-10:]))
+
+
+def main():
+  parser = argparse.ArgumentParser()
+  parser.add_argument('--staleness', type=str, default='0,2,4,8',
+                      help='Comma separated staleness to compare, 0 '
+                      'disables the cache.')
+  parser.add_argument('--protocol', type=str, default='grpc')
+  parser.add_argument('--num_layers', type=int, default=4)
+  parser.add_argument('--hidden_units', type=int, default=1024)
+  parser.add_argument('--batch_size', type=int, default=256)
+  parser.add_argument('--steps', type=int, default=200)
+  args = parser.parse_args()
+
+  print('%-10s %14s %14s %10s' %
+        ('staleness', 'bytes/step', 'step time(ms)', 'loss'))
+  ctx = multiprocessing.get_context('spawn')
+  for staleness in [int(s) for s in args.staleness.split(',')]:
+    ps_port, worker_port = _free_port(), _free_port()
+    ps = ctx.Process(target=_run_ps,
+                     args=(args.protocol, ps_port, worker_port))
+    ps.daemon = True
+    ps.start()
+    try:
+      received, step_time, loss = _benchmark(args, staleness, ps_port,
+                                             worker_port)
+    finally:
+      ps.terminate()
+      ps.join()
+    print('%-10d %14d %14.3f %10.4f' %
+          (staleness, received, step_time * 1000, loss))
+
+
+if __name__ == '__main__':
+  main()
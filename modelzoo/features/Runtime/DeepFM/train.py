@@ -333,6 +333,10 @@ def get_arg_parser():
                         help='Use thread local executor or not.',
                         type=bool,
                         default=False)
+    parser.add_argument('--use_work_stealing_executor',
+                        help='Use work stealing executor or not.',
+                        type=bool,
+                        default=False)
     return parser
 
 
@@ -425,6 +429,8 @@ def main(tf_config=None, server=None):
         sess_config.executor_policy = tf.ExecutorPolicy.USE_COST_MODEL_EXECUTOR
     if args.use_thread_local_executor:
         sess_config.executor_policy = tf.ExecutorPolicy.USE_INLINE_EXECUTOR
+    if args.use_work_stealing_executor:
+        sess_config.executor_policy = tf.ExecutorPolicy.USE_WORK_STEALING_EXECUTOR
 
     hooks = []
 
@@ -605,6 +611,8 @@ if __name__ == "__main__":
           sess_config.executor_policy = tf.ExecutorPolicy.USE_COST_MODEL_EXECUTOR
         if args.use_thread_local_executor:
           sess_config.executor_policy = tf.ExecutorPolicy.USE_INLINE_EXECUTOR
+        if args.use_work_stealing_executor:
+          sess_config.executor_policy = tf.ExecutorPolicy.USE_WORK_STEALING_EXECUTOR
 
         server = tf.distribute.Server(cluster,
                                       job_name=task_type,
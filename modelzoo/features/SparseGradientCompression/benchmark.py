@@ -0,0 +1,173 @@
+# Copyright 2022 The DeepRec Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Benchmark of the sparse gradient compression on a local ps cluster.
+
+The ps and the workers run in separate processes on localhost. Each worker
+trains an embedding model whose variables live on the ps with Adagrad, the
+ids are skewed so that a batch has many duplicated ids like the features of
+a recommendation model. The step time and the loss are reported for each
+compression.
+
+  python benchmark.py --compressions=none,fp16,bf16 --protocol=grpc
+"""
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import argparse
+import multiprocessing
+import socket
+import time
+
+import tensorflow as tf
+from tensorflow.core.protobuf import config_pb2
+
+_COMPRESSIONS = {
+    'none': config_pb2.OptimizerOptions.NO_COMPRESSION,
+    'fp16': config_pb2.OptimizerOptions.FP16,
+    'bf16': config_pb2.OptimizerOptions.BF16,
+}
+
+
+def _free_port():
+  s = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+  s.bind(('localhost', 0))
+  port = s.getsockname()[1]
+  s.close()
+  return port
+
+
+def _cluster(ps_ports, worker_ports):
+  return tf.train.ClusterSpec({
+      'ps': ['localhost:%d' % p for p in ps_ports],
+      'worker': ['localhost:%d' % p for p in worker_ports]
+  })
+
+
+def _run_ps(args, task_index, ps_ports, worker_ports):
+  server = tf.distribute.Server(_cluster(ps_ports, worker_ports),
+                                job_name='ps',
+                                task_index=task_index,
+                                protocol=args.protocol)
+  server.join()
+
+
+def _build_model(args, task_index, num_ps):
+  with tf.device(tf.train.replica_device_setter(
+      worker_device='/job:worker/task:%d' % task_index,
+      ps_tasks=num_ps)):
+    global_step = tf.train.get_or_create_global_step()
+    embedding = tf.get_variable(
+        'embedding', [args.vocabulary_size, args.embedding_dim],
+        initializer=tf.random_normal_initializer(stddev=0.01),
+        partitioner=tf.fixed_size_partitioner(num_ps))
+    weights = tf.get_variable('weights', [args.embedding_dim, 1])
+
+    # Skewed ids, a few hot ids appear many times in a batch.
+    uniform = tf.random.uniform([args.batch_size, args.num_fields], seed=1)
+    ids = tf.cast(tf.pow(uniform, 4.0) * args.vocabulary_size, tf.int64)
+    labels = tf.cast(tf.reduce_sum(ids % 2, axis=1, keepdims=True) >
+                     args.num_fields // 2, tf.float32)
+    features = tf.reduce_sum(tf.nn.embedding_lookup(embedding, ids), axis=1)
+    logits = tf.matmul(features, weights)
+    loss = tf.reduce_mean(
+        tf.nn.sigmoid_cross_entropy_with_logits(labels=labels, logits=logits))
+    train_op = tf.train.AdagradOptimizer(0.1).minimize(
+        loss, global_step=global_step)
+  return loss, train_op
+
+
+def _run_worker(args, compression, task_index, ps_ports, worker_ports,
+                results):
+  server = tf.distribute.Server(_cluster(ps_ports, worker_ports),
+                                job_name='worker',
+                                task_index=task_index,
+                                protocol=args.protocol)
+  loss, train_op = _build_model(args, task_index, len(ps_ports))
+  config = tf.ConfigProto()
+  config.graph_options.optimizer_options.sparse_gradient_compression = (
+      _COMPRESSIONS[compression])
+  with tf.train.MonitoredTrainingSession(master=server.target,
+                                         is_chief=task_index == 0,
+                                         config=config) as sess:
+    # Warm up the connections and the executors.
+    for _ in range(10):
+      sess.run(train_op)
+    losses = []
+    start = time.time()
+    for _ in range(args.steps):
+      losses.append(sess.run([loss, train_op])[0])
+    elapsed = time.time() - start
+  results.put((task_index, elapsed / args.steps,
+               sum(losses[-10:]) / len(losses[-10:])))
+
+
+def _benchmark(args, compression):
+  ps_ports = [_free_port() for _ in range(args.num_ps)]
+  worker_ports = [_free_port() for _ in range(args.num_workers)]
+  ctx = multiprocessing.get_context('spawn')
+  ps = []
+  for i in range(args.num_ps):
+    p = ctx.Process(target=_run_ps, args=(args, i, ps_ports, worker_ports))
+    p.daemon = True
+    p.start()
+    ps.append(p)
+  results = ctx.Queue()
+  workers = []
+  for i in range(args.num_workers):
+    p = ctx.Process(target=_run_worker,
+                    args=(args, compression, i, ps_ports, worker_ports,
+                          results))
+    p.start()
+    workers.append(p)
+  try:
+    for p in workers:
+      p.join()
+    step_times, losses = [], []
+    for _ in workers:
+      _, step_time, loss = results.get()
+      step_times.append(step_time)
+      losses.append(loss)
+  finally:
+    for p in ps:
+      p.terminate()
+      p.join()
+  return sum(step_times) / len(step_times), sum(losses) / len(losses)
+
+
+def main():
+  parser = argparse.ArgumentParser()
+  parser.add_argument('--compressions', type=str, default='none,fp16,bf16',
+                      help='Comma separated compressions to compare.')
+  parser.add_argument('--protocol', type=str, default='grpc',
+                      help='Protocol of the cluster.')
+  parser.add_argument('--num_ps', type=int, default=2)
+  parser.add_argument('--num_workers', type=int, default=2)
+  parser.add_argument('--vocabulary_size', type=int, default=1000000)
+  parser.add_argument('--embedding_dim', type=int, default=64)
+  parser.add_argument('--num_fields', type=int, default=50)
+  parser.add_argument('--batch_size', type=int, default=2048)
+  parser.add_argument('--steps', type=int, default=200)
+  args = parser.parse_args()
+
+  print('%-8s %14s %10s' % ('compress', 'step time(ms)', 'loss'))
+  for compression in args.compressions.split(','):
+    step_time, loss = _benchmark(args, compression)
+    print('%-8s %14.3f %10.4f' % (compression, step_time * 1000, loss))
+
+
+if __name__ == '__main__':
+  main()
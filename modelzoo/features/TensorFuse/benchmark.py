@@ -0,0 +1,166 @@
+# Copyright 2022 The DeepRec Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Benchmark of the recv fusion on a local ps cluster.
+
+The ps and the worker run in separate processes on localhost. The worker
+trains many small dense variables and an embedding which live on the ps, so
+that a step transfers hundreds of small tensors. For each fusion mode the
+number of cross-process recvs per step, which is the number of RPCs, and the
+step time are reported.
+
+  python benchmark.py --modes=none,fuse,profile --protocol=grpc
+"""
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import argparse
+import multiprocessing
+import socket
+import time
+
+import tensorflow as tf
+from tensorflow.core.protobuf import config_pb2
+
+_RECV_OPS = ('_Recv', '_HostRecv', '_FuseRecv', '_HostFuseRecv')
+
+
+def _free_port():
+  s = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+  s.bind(('localhost', 0))
+  port = s.getsockname()[1]
+  s.close()
+  return port
+
+
+def _cluster(ps_port, worker_port):
+  return tf.train.ClusterSpec({
+      'ps': ['localhost:%d' % ps_port],
+      'worker': ['localhost:%d' % worker_port]
+  })
+
+
+def _run_ps(protocol, ps_port, worker_port):
+  server = tf.distribute.Server(_cluster(ps_port, worker_port),
+                                job_name='ps',
+                                task_index=0,
+                                protocol=protocol)
+  server.join()
+
+
+def _task(device):
+  return device[:device.find('/device:')] if '/device:' in device else device
+
+
+def _count_rpcs(run_metadata):
+  """Counts the recvs whose sender is in another task."""
+  rpcs = 0
+  for graph in run_metadata.partition_graphs:
+    for node in graph.node:
+      if node.op not in _RECV_OPS:
+        continue
+      if node.op.endswith('FuseRecv'):
+        send = node.attr['send_devices'].list.s[0].decode()
+        recv = node.attr['recv_devices'].list.s[0].decode()
+      else:
+        send = node.attr['send_device'].s.decode()
+        recv = node.attr['recv_device'].s.decode()
+      if _task(send) != _task(recv):
+        rpcs += 1
+  return rpcs
+
+
+def _config(args, mode):
+  config = tf.ConfigProto()
+  if mode != 'none':
+    config.tensor_fuse = True
+  if mode == 'profile':
+    config.tensor_fuse_profile_steps = args.profile_steps
+    config.tensor_fuse_max_bytes = args.max_bytes
+    config.tensor_fuse_max_wait_micros = args.max_wait_micros
+  return config
+
+
+def _benchmark(args, mode, ps_port, worker_port):
+  server = tf.distribute.Server(_cluster(ps_port, worker_port),
+                                job_name='worker',
+                                task_index=0,
+                                protocol=args.protocol)
+  graph = tf.Graph()
+  with graph.as_default():
+    with tf.device('/job:ps/task:0'):
+      dense = [tf.get_variable('dense_%d' % i, [args.dense_size])
+               for i in range(args.num_dense)]
+      embedding = tf.get_variable('embedding', [100000, 16])
+    with tf.device('/job:worker/task:0'):
+      ids = tf.random.uniform([1024], maxval=100000, dtype=tf.int64)
+      loss = tf.reduce_sum(tf.nn.embedding_lookup(embedding, ids))
+      for var in dense:
+        loss += tf.reduce_sum(tf.square(var))
+      train_op = tf.train.GradientDescentOptimizer(1e-6).minimize(loss)
+    init = tf.global_variables_initializer()
+
+  with tf.Session(server.target, graph=graph,
+                  config=_config(args, mode)) as sess:
+    sess.run(init)
+    # The profiling steps are part of the warm up.
+    for _ in range(args.profile_steps + 5):
+      sess.run(train_op)
+    run_metadata = config_pb2.RunMetadata()
+    sess.run(train_op,
+             options=config_pb2.RunOptions(output_partition_graphs=True),
+             run_metadata=run_metadata)
+    start = time.time()
+    for _ in range(args.steps):
+      sess.run(train_op)
+    elapsed = time.time() - start
+  return _count_rpcs(run_metadata), elapsed / args.steps
+
+
+def main():
+  parser = argparse.ArgumentParser()
+  parser.add_argument('--modes', type=str, default='none,fuse,profile',
+                      help='Comma separated fusion modes to compare: none '
+                      'disables the fusion, fuse fuses the recvs of the '
+                      'tensors ready in the same round, profile fuses them '
+                      'by the sizes and ready times of the profiled steps.')
+  parser.add_argument('--protocol', type=str, default='grpc')
+  parser.add_argument('--num_dense', type=int, default=200)
+  parser.add_argument('--dense_size', type=int, default=64)
+  parser.add_argument('--profile_steps', type=int, default=5)
+  parser.add_argument('--max_bytes', type=int, default=1 << 20)
+  parser.add_argument('--max_wait_micros', type=int, default=1000)
+  parser.add_argument('--steps', type=int, default=100)
+  args = parser.parse_args()
+
+  print('%-8s %10s %14s' % ('mode', 'rpcs/step', 'step time(ms)'))
+  ctx = multiprocessing.get_context('spawn')
+  for mode in args.modes.split(','):
+    ps_port, worker_port = _free_port(), _free_port()
+    ps = ctx.Process(target=_run_ps,
+                     args=(args.protocol, ps_port, worker_port))
+    ps.daemon = True
+    ps.start()
+    try:
+      rpcs, step_time = _benchmark(args, mode, ps_port, worker_port)
+    finally:
+      ps.terminate()
+      ps.join()
+    print('%-8s %10d %14.3f' % (mode, rpcs, step_time * 1000))
+
+
+if __name__ == '__main__':
+  main()
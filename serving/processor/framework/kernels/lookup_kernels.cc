@@ -21,6 +21,7 @@ limitations under the License.
 #include "tensorflow/core/util/tensor_bundle/tensor_bundle.h"
 #include "serving/processor/storage/redis_feature_store.h"
 #include "serving/processor/storage/feature_store_mgr.h"
+#include "serving/processor/serving/serving_stats.h"
 
 namespace tensorflow {
 namespace processor {
@@ -34,9 +35,10 @@ BatchGetCallback make_lookup_callback(
     int64 N, // indices count
     Tensor allocated_out_tensor_const,
     Tensor default_values,
+    uint64 start_micros,
     AsyncOpKernel::DoneCallback done) {
   return [ctx, N, allocated_out_tensor_const, default_values,
-          done = std::move(done)](const Status& s) {
+          start_micros, done = std::move(done)](const Status& s) {
 /*
     Tensor allocated_out_tensor = allocated_out_tensor_const;
     auto out_flat = allocated_out_tensor.shaped<TValue, 2>(
@@ -51,6 +53,8 @@ BatchGetCallback make_lookup_callback(
 
 */
     ctx->SetStatus(s);
+    ServingStats::Get()->Record(ServingStage::kFeatureStoreLookup,
+        Env::Default()->NowMicros() - start_micros);
 
     done();
   };
@@ -113,7 +117,7 @@ class KvLookupOp : public AsyncOpKernel {
         (const char*)default_values.data(),
         make_lookup_callback<TValue>(
             ctx, N, *out, default_values,
-            std::move(done)));
+            Env::Default()->NowMicros(), std::move(done)));
 
     if (!s.ok()) {
       ctx->SetStatus(s);
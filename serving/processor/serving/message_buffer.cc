@@ -0,0 +1,90 @@
+#include "serving/processor/serving/message_buffer.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/lib/core/bits.h"
+#include "tensorflow/core/platform/mem.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace tensorflow {
+namespace processor {
+
+MessageBufferPool* MessageBufferPool::Get() {
+  static MessageBufferPool pool;
+  return &pool;
+}
+
+void* MessageBufferPool::Allocate(size_t size, size_t* capacity) {
+  int shift = std::max(Log2Ceiling64(std::max<size_t>(size, 1)), kMinShift);
+  if (shift > kMaxShift) {
+    *capacity = size;
+    return port::AlignedMalloc(size, EIGEN_MAX_ALIGN_BYTES);
+  }
+
+  *capacity = 1ull << shift;
+  {
+    mutex_lock lock(mu_);
+    auto& blocks = free_blocks_[shift - kMinShift];
+    if (!blocks.empty()) {
+      void* ptr = blocks.back();
+      blocks.pop_back();
+      cached_bytes_ -= *capacity;
+      return ptr;
+    }
+  }
+  return port::AlignedMalloc(*capacity, EIGEN_MAX_ALIGN_BYTES);
+}
+
+void MessageBufferPool::Deallocate(void* ptr, size_t capacity) {
+  if (ptr == nullptr) return;
+  int shift = Log2Ceiling64(capacity);
+  if (shift >= kMinShift && shift <= kMaxShift &&
+      (1ull << shift) == capacity) {
+    mutex_lock lock(mu_);
+    auto& blocks = free_blocks_[shift - kMinShift];
+    if (blocks.size() < kMaxCachedPerClass &&
+        cached_bytes_ + capacity <= kMaxCachedBytes) {
+      blocks.push_back(ptr);
+      cached_bytes_ += capacity;
+      return;
+    }
+  }
+  port::AlignedFree(ptr);
+}
+
+PooledBlock::PooledBlock(size_t size) {
+  data_ = static_cast<char*>(
+      MessageBufferPool::Get()->Allocate(size, &capacity_));
+}
+
+PooledBlock::~PooledBlock() {
+  MessageBufferPool::Get()->Deallocate(data_, capacity_);
+}
+
+void RequestTensorBuffer::FillAllocationDescription(
+    AllocationDescription* proto) const {
+  proto->set_requested_bytes(size_);
+  proto->set_allocated_bytes(size_);
+  proto->set_allocator_name("RequestTensorBuffer");
+}
+
+Tensor MakeRequestTensor(DataType dtype, const TensorShape& shape,
+                         const std::shared_ptr<void>& owner,
+                         const void* data, size_t size) {
+  if (owner == nullptr || size == 0 ||
+      reinterpret_cast<intptr_t>(data) % EIGEN_MAX_ALIGN_BYTES != 0) {
+    Tensor tensor(dtype, shape);
+    if (size > 0) {
+      memcpy(const_cast<char*>(tensor.tensor_data().data()), data, size);
+    }
+    return tensor;
+  }
+
+  RequestTensorBuffer* buf =
+      new RequestTensorBuffer(owner, const_cast<void*>(data), size);
+  core::ScopedUnref unref(buf);
+  return Tensor(dtype, shape, buf);
+}
+
+} // processor
+} // tensorflow
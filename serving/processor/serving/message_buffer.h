@@ -0,0 +1,124 @@
+#ifndef SERVING_PROCESSOR_SERVING_MESSAGE_BUFFER_H
+#define SERVING_PROCESSOR_SERVING_MESSAGE_BUFFER_H
+
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/protobuf.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace processor {
+
+// Process wide pool of EIGEN_MAX_ALIGN_BYTES aligned memory blocks,
+// bucketed by power-of-two size classes. Request/response buffers are
+// borrowed from here, so steady state serving doesn't hit the system
+// allocator for every call.
+class MessageBufferPool {
+ public:
+  static MessageBufferPool* Get();
+
+  // Returns a block of at least `size` bytes, the real size of
+  // the block is stored in `capacity`.
+  void* Allocate(size_t size, size_t* capacity);
+  void Deallocate(void* ptr, size_t capacity);
+
+ private:
+  MessageBufferPool() = default;
+
+  // Size classes from 4KB to 16MB, larger blocks aren't cached.
+  static constexpr int kMinShift = 12;
+  static constexpr int kMaxShift = 24;
+  static constexpr int kNumClasses = kMaxShift - kMinShift + 1;
+  static constexpr int kMaxCachedPerClass = 64;
+  // Budget of all the cached blocks, blocks released beyond it are freed.
+  static constexpr size_t kMaxCachedBytes = 256ull << 20;
+
+  mutex mu_;
+  std::vector<void*> free_blocks_[kNumClasses] GUARDED_BY(mu_);
+  size_t cached_bytes_ GUARDED_BY(mu_) = 0;
+};
+
+// A block borrowed from MessageBufferPool, returned to the pool
+// when destructed.
+class PooledBlock {
+ public:
+  explicit PooledBlock(size_t size);
+  ~PooledBlock();
+
+  PooledBlock(const PooledBlock&) = delete;
+  PooledBlock& operator=(const PooledBlock&) = delete;
+
+  char* data() const { return data_; }
+  size_t capacity() const { return capacity_; }
+
+ private:
+  char* data_ = nullptr;
+  size_t capacity_ = 0;
+};
+
+// A protobuf message allocated on an arena whose first block is
+// borrowed from MessageBufferPool.
+template <typename MessageType>
+class ArenaMessage {
+ public:
+  static constexpr size_t kDefaultBlockSize = 64 * 1024;
+
+  explicit ArenaMessage(size_t block_size = kDefaultBlockSize)
+      : block_(block_size),
+        arena_(ArenaOptionsFor(block_)),
+        message_(protobuf::Arena::CreateMessage<MessageType>(&arena_)) {}
+
+  ArenaMessage(const ArenaMessage&) = delete;
+  ArenaMessage& operator=(const ArenaMessage&) = delete;
+
+  MessageType* get() const { return message_; }
+  MessageType* operator->() const { return message_; }
+
+ private:
+  static protobuf::ArenaOptions ArenaOptionsFor(const PooledBlock& block) {
+    protobuf::ArenaOptions options;
+    options.initial_block = block.data();
+    options.initial_block_size = block.capacity();
+    return options;
+  }
+
+  // NOTE: block_ must outlive arena_.
+  PooledBlock block_;
+  protobuf::Arena arena_;
+  MessageType* message_;
+};
+
+// TensorBuffer aliasing memory of a decoded request. `owner` is the
+// object the memory belongs to, it's kept alive until the last tensor
+// referring to the buffer is released.
+class RequestTensorBuffer : public TensorBuffer {
+ public:
+  RequestTensorBuffer(std::shared_ptr<void> owner, void* data, size_t size)
+      : TensorBuffer(data), owner_(std::move(owner)), size_(size) {}
+
+  size_t size() const override { return size_; }
+
+  TensorBuffer* root_buffer() override { return this; }
+
+  void FillAllocationDescription(AllocationDescription* proto) const override;
+
+  bool OwnsMemory() const override { return false; }
+
+ private:
+  std::shared_ptr<void> owner_;
+  size_t size_;
+};
+
+// Returns a tensor which aliases the `size` bytes at `data` when the
+// memory is EIGEN aligned, otherwise falls back to a copy.
+Tensor MakeRequestTensor(DataType dtype, const TensorShape& shape,
+                         const std::shared_ptr<void>& owner,
+                         const void* data, size_t size);
+
+} // processor
+} // tensorflow
+
+#endif // SERVING_PROCESSOR_SERVING_MESSAGE_BUFFER_H
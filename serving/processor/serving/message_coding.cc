@@ -1,8 +1,198 @@
 #include "serving/processor/serving/message_coding.h"
+#include "serving/processor/serving/message_buffer.h"
+#include "serving/processor/serving/predict_generated.h"
 #include "serving/processor/serving/util.h"
+#include "tensorflow/core/framework/tensor_shape.h"
+#include "tensorflow/core/lib/core/errors.h"
 
 namespace tensorflow {
 namespace processor {
+namespace {
+
+// Numeric contents are aligned to this in flatbuffer messages,
+// so they can be aliased as tensors directly.
+constexpr size_t kFlatContentAlignment = 64;
+
+char* CopyToOutputBuf(const void* data, int size) {
+  char* buf = new char[size];
+  memcpy(buf, data, size);
+  return buf;
+}
+
+Status FlatTypeToDataType(int type, DataType* dtype) {
+  switch (type) {
+    case eas::DT_FLOAT:
+    case eas::DT_DOUBLE:
+    case eas::DT_INT32:
+    case eas::DT_UINT8:
+    case eas::DT_INT16:
+    case eas::DT_INT8:
+    case eas::DT_STRING:
+    case eas::DT_COMPLEX64:
+    case eas::DT_INT64:
+    case eas::DT_BOOL:
+    case eas::DT_BFLOAT16:
+    case eas::DT_UINT16:
+    case eas::DT_COMPLEX128:
+    case eas::DT_HALF:
+      // eas::ArrayDataType shares the values of tensorflow::DataType.
+      *dtype = static_cast<DataType>(type);
+      return Status::OK();
+    default:
+      return errors::InvalidArgument(
+          "Input Tensor Not Support this DataType: ", type);
+  }
+}
+
+Status FlatBuffer2Request(const eas::fb::PredictRequest* request,
+    const std::shared_ptr<void>& owner, Request& req) {
+  if (request->feed_names() == nullptr) {
+    return Status::OK();
+  }
+  int feed_num = request->feed_names()->size();
+  if (request->types() == nullptr || request->shapes() == nullptr ||
+      request->types()->size() != feed_num ||
+      request->shapes()->size() != feed_num) {
+    return errors::InvalidArgument(
+        "Invalid flatbuffer request, feeds mismatch types or shapes.");
+  }
+
+  req.inputs.reserve(feed_num);
+  int content_idx = 0;
+  int string_idx = 0;
+  int string_len_idx = 0;
+  for (int i = 0; i < feed_num; ++i) {
+    DataType dtype;
+    TF_RETURN_IF_ERROR(FlatTypeToDataType(request->types()->Get(i), &dtype));
+
+    // The dims come from the client, AddDim would CHECK-fail on a bad one.
+    std::vector<int64> dim_sizes;
+    auto dims = request->shapes()->Get(i)->dim();
+    if (dims != nullptr) {
+      dim_sizes.assign(dims->begin(), dims->end());
+    }
+    TensorShape shape;
+    Status s = TensorShapeUtils::MakeShape(dim_sizes, &shape);
+    if (!s.ok()) {
+      return errors::InvalidArgument(
+          "Invalid flatbuffer request, bad shape: ", s.error_message());
+    }
+
+    if (dtype == DT_STRING) {
+      if (request->string_content() == nullptr ||
+          string_idx >= request->string_content()->size()) {
+        return errors::InvalidArgument(
+            "Invalid flatbuffer request, missing string content.");
+      }
+      auto lens = request->string_content_len();
+      int64 num = shape.num_elements();
+      if (lens == nullptr || string_len_idx + num > lens->size()) {
+        return errors::InvalidArgument(
+            "Invalid flatbuffer request, missing string lengths.");
+      }
+      auto content = request->string_content()->Get(string_idx++);
+      Tensor tensor(DT_STRING, shape);
+      auto flat = tensor.flat<std::string>();
+      size_t offset = 0;
+      for (int64 j = 0; j < num; ++j) {
+        const int64 len = lens->Get(string_len_idx++);
+        if (len < 0 || static_cast<uint64>(len) > content->size() - offset) {
+          return errors::InvalidArgument(
+              "Invalid flatbuffer request, bad string length ", len, ".");
+        }
+        flat(j).assign(content->c_str() + offset, static_cast<size_t>(len));
+        offset += static_cast<size_t>(len);
+      }
+      req.inputs.emplace_back(request->feed_names()->Get(i)->str(),
+                              std::move(tensor));
+    } else {
+      if (request->content() == nullptr ||
+          content_idx >= request->content()->size()) {
+        return errors::InvalidArgument(
+            "Invalid flatbuffer request, missing content.");
+      }
+      auto content = request->content()->Get(content_idx++)->content();
+      size_t bytes = shape.num_elements() * DataTypeSize(dtype);
+      if (content == nullptr || content->size() != bytes) {
+        return errors::InvalidArgument(
+            "Invalid flatbuffer request, content size mismatch shape.");
+      }
+      req.inputs.emplace_back(request->feed_names()->Get(i)->str(),
+          MakeRequestTensor(dtype, shape, owner, content->Data(), bytes));
+    }
+  }
+
+  if (request->fetch_names() != nullptr) {
+    for (auto name : *request->fetch_names()) {
+      req.output_tensor_names.emplace_back(name->str());
+    }
+  }
+  return Status::OK();
+}
+
+// Builders are reused by the serving threads, the underlying
+// buffer is kept across calls so encoding doesn't reallocate.
+flatbuffers::FlatBufferBuilder* GetThreadLocalBuilder() {
+  thread_local flatbuffers::FlatBufferBuilder builder(64 * 1024);
+  builder.Clear();
+  return &builder;
+}
+
+Status Response2FlatBuffer(const Request& req, const Response& resp,
+    flatbuffers::FlatBufferBuilder* builder) {
+  const auto& outputs = resp.outputs;
+  std::vector<flatbuffers::Offset<flatbuffers::String>> names;
+  std::vector<int> types;
+  std::vector<flatbuffers::Offset<eas::fb::ShapeType>> shapes;
+  std::vector<flatbuffers::Offset<eas::fb::ContentType>> contents;
+  std::vector<int> string_lens;
+  std::vector<flatbuffers::Offset<flatbuffers::String>> string_contents;
+  std::string string_buf;
+
+  for (size_t i = 0; i < outputs.size(); ++i) {
+    const Tensor& t = outputs[i];
+    names.emplace_back(builder->CreateString(req.output_tensor_names[i]));
+    types.emplace_back(static_cast<int>(t.dtype()));
+    std::vector<int64_t> dims;
+    dims.reserve(t.dims());
+    for (int j = 0; j < t.dims(); ++j) {
+      dims.emplace_back(t.dim_size(j));
+    }
+    shapes.emplace_back(
+        eas::fb::CreateShapeType(*builder, builder->CreateVector(dims)));
+
+    if (t.dtype() == DT_STRING) {
+      auto flat = t.flat<std::string>();
+      string_buf.clear();
+      for (int64 j = 0; j < flat.size(); ++j) {
+        string_lens.emplace_back(flat(j).size());
+        string_buf.append(flat(j));
+      }
+      string_contents.emplace_back(builder->CreateString(string_buf));
+    } else {
+      DataType dtype;
+      TF_RETURN_IF_ERROR(FlatTypeToDataType(t.dtype(), &dtype));
+      auto data = t.tensor_data();
+      builder->ForceVectorAlignment(data.size(), sizeof(uint8_t),
+                                    kFlatContentAlignment);
+      auto content = builder->CreateVector(
+          reinterpret_cast<const uint8_t*>(data.data()), data.size());
+      contents.emplace_back(eas::fb::CreateContentType(*builder, content));
+    }
+  }
+
+  builder->Finish(eas::fb::CreatePredictResponse(*builder,
+      builder->CreateVector(names),
+      builder->CreateVector(types),
+      builder->CreateVector(shapes),
+      builder->CreateVector(contents),
+      builder->CreateVector(string_lens),
+      builder->CreateVector(string_contents)));
+  return Status::OK();
+}
+
+} // namespace
+
 ProtoBufParser::ProtoBufParser(int thread_num) {
   thread_pool_.reset(new thread::ThreadPool(Env::Default(), "",
       thread_num));
@@ -10,27 +200,32 @@ ProtoBufParser::ProtoBufParser(int thread_num) {
 
 Status ProtoBufParser::ParseRequestFromBuf(const void* input_data,
     int input_size, Call& call) {
-  eas::PredictRequest request;
-  request.ParseFromArray(input_data, input_size);
+  ArenaMessage<eas::PredictRequest> request(input_size);
+  if (!request->ParseFromArray(input_data, input_size)) {
+    return errors::InvalidArgument("Invalid protobuf request.");
+  }
 
-  for (auto& input : request.inputs()) {
-    call.request.inputs.emplace_back(input.first, util::Proto2Tensor(input.second));
+  call.request.inputs.reserve(request->inputs_size());
+  for (auto& input : *request->mutable_inputs()) {
+    Tensor tensor;
+    TF_RETURN_IF_ERROR(util::Proto2Tensor(&input.second, &tensor));
+    call.request.inputs.emplace_back(input.first, std::move(tensor));
   }
 
   call.request.output_tensor_names =
-      std::vector<std::string>(request.output_filter().begin(),
-                               request.output_filter().end());
+      std::vector<std::string>(request->output_filter().begin(),
+                               request->output_filter().end());
 
   return Status::OK();
 }
 
 Status ProtoBufParser::ParseResponseToBuf(const Call& call,
     void** output_data, int* output_size) {
-  eas::PredictResponse response = util::Tensor2Response(call.request,
-      call.response);
-  *output_size = response.ByteSize();
+  ArenaMessage<eas::PredictResponse> response;
+  util::Tensor2Response(call.request, call.response, response.get());
+  *output_size = response->ByteSize();
   *output_data = new char[*output_size];
-  response.SerializeToArray(*output_data, *output_size);
+  response->SerializeToArray(*output_data, *output_size);
   return Status::OK();
 }
 
@@ -65,11 +260,12 @@ Status ProtoBufParser::ParseBatchResponseToBuf(
   call.SplitResponse();
   auto do_work = [&call, output_data, output_size](size_t begin, size_t end) {
     for (size_t i = begin; i < end; ++i) {
-      eas::PredictResponse response = util::Tensor2Response(call.request[i],
-          call.response[i]);
-      output_size[i] = response.ByteSize();
-      output_data[i] = new char[*output_size];
-      response.SerializeToArray(output_data[i], output_size[i]); 
+      ArenaMessage<eas::PredictResponse> response;
+      util::Tensor2Response(call.request[i], call.response[i],
+                            response.get());
+      output_size[i] = response->ByteSize();
+      output_data[i] = new char[output_size[i]];
+      response->SerializeToArray(output_data[i], output_size[i]);
     }
   };
   thread_pool_->ParallelFor(call.call_num, 10000, do_work);
@@ -92,5 +288,44 @@ FlatBufferParser::FlatBufferParser(int thread_num) {
       thread_num));
 }
 
+Status FlatBufferParser::ParseRequestFromBuf(const void* input_data,
+    int input_size, Call& call) {
+  // input_data is only valid during the current call, keep one aligned
+  // copy of the whole request which is shared by all the input tensors,
+  // instead of allocating and copying tensor by tensor.
+  auto block = std::make_shared<PooledBlock>(input_size);
+  memcpy(block->data(), input_data, input_size);
+
+  flatbuffers::Verifier verifier(
+      reinterpret_cast<const uint8_t*>(block->data()), input_size);
+  if (!verifier.VerifyBuffer<eas::fb::PredictRequest>(nullptr)) {
+    return errors::InvalidArgument("Invalid flatbuffer request.");
+  }
+
+  auto request = flatbuffers::GetRoot<eas::fb::PredictRequest>(block->data());
+  return FlatBuffer2Request(request, block, call.request);
+}
+
+Status FlatBufferParser::ParseResponseToBuf(const Call& call,
+    void** output_data, int* output_size) {
+  auto builder = GetThreadLocalBuilder();
+  TF_RETURN_IF_ERROR(Response2FlatBuffer(call.request, call.response,
+                                         builder));
+  *output_size = builder->GetSize();
+  *output_data = CopyToOutputBuf(builder->GetBufferPointer(), *output_size);
+  return Status::OK();
+}
+
+Status FlatBufferParser::ParseServingModelInfoToBuf(
+    ServingModelInfo& model_info, void* output_data[],
+    int* output_size) {
+  auto builder = GetThreadLocalBuilder();
+  builder->Finish(eas::fb::CreateServingModelInfo(*builder,
+      builder->CreateString(model_info.model_path)));
+  *output_size = builder->GetSize();
+  *output_data = CopyToOutputBuf(builder->GetBufferPointer(), *output_size);
+  return Status::OK();
+}
+
 } // processor
 } // tensorflow
@@ -66,17 +66,13 @@ class FlatBufferParser : public IParser {
  public:
   explicit FlatBufferParser(int thread_num);
 
+  // Numeric inputs alias the request buffer instead of being copied
+  // into freshly allocated tensors.
   Status ParseRequestFromBuf(const void* input_data,
-      int input_size, Call& call) override {
-    // TO be implemented
-    return Status::OK();
-  }
+      int input_size, Call& call) override;
 
   Status ParseResponseToBuf(const Call& call,
-      void** output_data, int* output_size) override {
-    // TO be implemented
-    return Status::OK();
-  }
+      void** output_data, int* output_size) override;
   
   Status ParseBatchRequestFromBuf(const void* input_data[],
       int* input_size, BatchCall& call) override {
@@ -92,10 +88,7 @@ class FlatBufferParser : public IParser {
 
   Status ParseServingModelInfoToBuf(
       ServingModelInfo& model_info, void* output_data[],
-      int* output_size) override {
-    // TO be implemented
-    return Status::OK();
-  }
+      int* output_size) override;
 
  private:
   std::unique_ptr<thread::ThreadPool> thread_pool_;
@@ -0,0 +1,269 @@
+#include "gtest/gtest.h"
+#include "serving/processor/serving/message_buffer.h"
+#include "serving/processor/serving/message_coding.h"
+#include "serving/processor/serving/model_message.h"
+#include "serving/processor/serving/predict.pb.h"
+#include "serving/processor/serving/predict_generated.h"
+#include "tensorflow/core/framework/tensor_description.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+
+namespace tensorflow {
+namespace processor {
+namespace {
+
+struct FlatInput {
+  std::string name;
+  int type;
+  std::vector<int64_t> dims;
+  std::string content;
+  std::vector<int> string_lens;
+};
+
+std::string BuildFlatRequest(const std::vector<FlatInput>& inputs) {
+  flatbuffers::FlatBufferBuilder builder;
+  std::vector<flatbuffers::Offset<flatbuffers::String>> names;
+  std::vector<int> types;
+  std::vector<flatbuffers::Offset<eas::fb::ShapeType>> shapes;
+  std::vector<flatbuffers::Offset<eas::fb::ContentType>> contents;
+  std::vector<int> string_lens;
+  std::vector<flatbuffers::Offset<flatbuffers::String>> string_contents;
+  for (const auto& input : inputs) {
+    names.emplace_back(builder.CreateString(input.name));
+    types.emplace_back(input.type);
+    shapes.emplace_back(eas::fb::CreateShapeType(builder,
+        builder.CreateVector(input.dims)));
+    if (input.type == eas::DT_STRING) {
+      string_lens.insert(string_lens.end(), input.string_lens.begin(),
+                         input.string_lens.end());
+      string_contents.emplace_back(builder.CreateString(input.content));
+    } else {
+      builder.ForceVectorAlignment(input.content.size(), sizeof(uint8_t), 64);
+      auto content = builder.CreateVector(
+          reinterpret_cast<const uint8_t*>(input.content.data()),
+          input.content.size());
+      contents.emplace_back(eas::fb::CreateContentType(builder, content));
+    }
+  }
+  std::vector<flatbuffers::Offset<flatbuffers::String>> fetches{
+      builder.CreateString("output")};
+  builder.Finish(eas::fb::CreatePredictRequest(builder,
+      builder.CreateString("serving_default"),
+      builder.CreateVector(names),
+      builder.CreateVector(types),
+      builder.CreateVector(shapes),
+      builder.CreateVector(contents),
+      builder.CreateVector(string_lens),
+      builder.CreateVector(string_contents),
+      builder.CreateVector(fetches)));
+  return std::string(reinterpret_cast<const char*>(builder.GetBufferPointer()),
+                     builder.GetSize());
+}
+
+FlatInput FloatInput(const std::vector<float>& values) {
+  FlatInput input;
+  input.name = "dense";
+  input.type = eas::DT_FLOAT;
+  input.dims = {1, static_cast<int64_t>(values.size())};
+  input.content.assign(reinterpret_cast<const char*>(values.data()),
+                       values.size() * sizeof(float));
+  return input;
+}
+
+FlatInput StringInput(const std::vector<std::string>& values) {
+  FlatInput input;
+  input.name = "ids";
+  input.type = eas::DT_STRING;
+  input.dims = {static_cast<int64_t>(values.size())};
+  for (const auto& v : values) {
+    input.content.append(v);
+    input.string_lens.emplace_back(v.size());
+  }
+  return input;
+}
+
+bool AliasesRequest(const Tensor& tensor) {
+  TensorDescription desc;
+  tensor.FillDescription(&desc);
+  return desc.allocation_description().allocator_name() ==
+         "RequestTensorBuffer";
+}
+
+Status ParseFlat(const std::string& buf, Call* call) {
+  FlatBufferParser parser(1);
+  return parser.ParseRequestFromBuf(buf.data(), buf.size(), *call);
+}
+
+} // namespace
+
+class MessageCodingTest : public ::testing::Test {
+};
+
+TEST_F(MessageCodingTest, ProtoBufRoundTrip) {
+  eas::PredictRequest request;
+  auto& dense = (*request.mutable_inputs())["dense"];
+  dense.set_dtype(eas::DT_FLOAT);
+  dense.mutable_array_shape()->add_dim(1);
+  dense.mutable_array_shape()->add_dim(2);
+  dense.add_float_val(1.0f);
+  dense.add_float_val(2.0f);
+  auto& ids = (*request.mutable_inputs())["ids"];
+  ids.set_dtype(eas::DT_STRING);
+  ids.mutable_array_shape()->add_dim(2);
+  ids.add_string_val("a");
+  ids.add_string_val("bc");
+  request.add_output_filter("output");
+  std::string buf = request.SerializeAsString();
+
+  ProtoBufParser parser(1);
+  Call call;
+  TF_ASSERT_OK(parser.ParseRequestFromBuf(buf.data(), buf.size(), call));
+  ASSERT_EQ(2, call.request.inputs.size());
+  for (const auto& input : call.request.inputs) {
+    if (input.first == "dense") {
+      test::ExpectTensorEqual<float>(
+          test::AsTensor<float>({1.0f, 2.0f}, {1, 2}), input.second);
+    } else {
+      EXPECT_EQ("ids", input.first);
+      test::ExpectTensorEqual<std::string>(
+          test::AsTensor<std::string>({"a", "bc"}, {2}), input.second);
+    }
+  }
+  ASSERT_EQ(1, call.request.output_tensor_names.size());
+
+  call.response.outputs.emplace_back(
+      test::AsTensor<float>({3.0f, 4.0f}, {2, 1}));
+  void* output = nullptr;
+  int output_size = 0;
+  TF_ASSERT_OK(parser.ParseResponseToBuf(call, &output, &output_size));
+  eas::PredictResponse response;
+  EXPECT_TRUE(response.ParseFromArray(output, output_size));
+  delete [] static_cast<char*>(output);
+  const auto& out = response.outputs().at("output");
+  EXPECT_EQ(eas::DT_FLOAT, out.dtype());
+  ASSERT_EQ(2, out.float_val_size());
+  EXPECT_EQ(3.0f, out.float_val(0));
+  EXPECT_EQ(4.0f, out.float_val(1));
+}
+
+TEST_F(MessageCodingTest, ProtoBufStringCountMismatch) {
+  eas::PredictRequest request;
+  auto& ids = (*request.mutable_inputs())["ids"];
+  ids.set_dtype(eas::DT_STRING);
+  ids.mutable_array_shape()->add_dim(3);
+  ids.add_string_val("a");
+  std::string buf = request.SerializeAsString();
+
+  ProtoBufParser parser(1);
+  Call call;
+  Status s = parser.ParseRequestFromBuf(buf.data(), buf.size(), call);
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+}
+
+TEST_F(MessageCodingTest, FlatBufferRoundTrip) {
+  std::string buf = BuildFlatRequest(
+      {FloatInput({1.0f, 2.0f, 3.0f}), StringInput({"a", "", "bc"})});
+  Call call;
+  TF_ASSERT_OK(ParseFlat(buf, &call));
+  ASSERT_EQ(2, call.request.inputs.size());
+  EXPECT_EQ("dense", call.request.inputs[0].first);
+  test::ExpectTensorEqual<float>(
+      test::AsTensor<float>({1.0f, 2.0f, 3.0f}, {1, 3}),
+      call.request.inputs[0].second);
+  EXPECT_EQ("ids", call.request.inputs[1].first);
+  test::ExpectTensorEqual<std::string>(
+      test::AsTensor<std::string>({"a", "", "bc"}, {3}),
+      call.request.inputs[1].second);
+  ASSERT_EQ(1, call.request.output_tensor_names.size());
+  EXPECT_EQ("output", call.request.output_tensor_names[0]);
+
+  call.response.outputs.emplace_back(
+      test::AsTensor<float>({5.0f, 6.0f}, {2}));
+  FlatBufferParser parser(1);
+  void* output = nullptr;
+  int output_size = 0;
+  TF_ASSERT_OK(parser.ParseResponseToBuf(call, &output, &output_size));
+  auto response = flatbuffers::GetRoot<eas::fb::PredictResponse>(output);
+  ASSERT_EQ(1, response->output_names()->size());
+  EXPECT_EQ("output", response->output_names()->Get(0)->str());
+  EXPECT_EQ(eas::DT_FLOAT, response->types()->Get(0));
+  EXPECT_EQ(2, response->shapes()->Get(0)->dim()->Get(0));
+  auto content = response->content()->Get(0)->content();
+  ASSERT_EQ(2 * sizeof(float), content->size());
+  const float* values = reinterpret_cast<const float*>(content->Data());
+  EXPECT_EQ(5.0f, values[0]);
+  EXPECT_EQ(6.0f, values[1]);
+  delete [] static_cast<char*>(output);
+}
+
+TEST_F(MessageCodingTest, FlatBufferInputsAliasRequest) {
+  std::string buf = BuildFlatRequest({FloatInput({1.0f, 2.0f})});
+  Call call;
+  TF_ASSERT_OK(ParseFlat(buf, &call));
+  ASSERT_EQ(1, call.request.inputs.size());
+  const Tensor& dense = call.request.inputs[0].second;
+  EXPECT_TRUE(AliasesRequest(dense));
+  // The request is copied once into a pooled block, not left pointing
+  // at the caller's buffer.
+  const char* data = dense.tensor_data().data();
+  EXPECT_FALSE(data >= buf.data() && data < buf.data() + buf.size());
+}
+
+TEST_F(MessageCodingTest, FlatBufferPooledBlockReused) {
+  std::string buf = BuildFlatRequest({FloatInput({1.0f, 2.0f})});
+  const char* first = nullptr;
+  {
+    Call call;
+    TF_ASSERT_OK(ParseFlat(buf, &call));
+    first = call.request.inputs[0].second.tensor_data().data();
+  }
+  // The block went back to the pool with the last tensor referring to it,
+  // the same request lands in the same block again.
+  Call call;
+  TF_ASSERT_OK(ParseFlat(buf, &call));
+  EXPECT_EQ(first, call.request.inputs[0].second.tensor_data().data());
+
+  size_t capacity = 0;
+  void* block = MessageBufferPool::Get()->Allocate(5000, &capacity);
+  MessageBufferPool::Get()->Deallocate(block, capacity);
+  size_t reused_capacity = 0;
+  void* reused = MessageBufferPool::Get()->Allocate(5000, &reused_capacity);
+  EXPECT_EQ(block, reused);
+  EXPECT_EQ(capacity, reused_capacity);
+  MessageBufferPool::Get()->Deallocate(reused, reused_capacity);
+}
+
+TEST_F(MessageCodingTest, FlatBufferNegativeStringLength) {
+  FlatInput ids = StringInput({"ab", "cd"});
+  ids.string_lens = {-1, 2};
+  Call call;
+  Status s = ParseFlat(BuildFlatRequest({ids}), &call);
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+}
+
+TEST_F(MessageCodingTest, FlatBufferStringLengthPastEnd) {
+  FlatInput ids = StringInput({"ab", "cd"});
+  ids.string_lens = {2, 3};
+  Call call;
+  Status s = ParseFlat(BuildFlatRequest({ids}), &call);
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+}
+
+TEST_F(MessageCodingTest, FlatBufferNegativeDim) {
+  FlatInput dense = FloatInput({1.0f, 2.0f});
+  dense.dims = {-1, 2};
+  Call call;
+  Status s = ParseFlat(BuildFlatRequest({dense}), &call);
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+}
+
+TEST_F(MessageCodingTest, FlatBufferStringCountMismatch) {
+  FlatInput ids = StringInput({"a", "b"});
+  ids.dims = {3};
+  Call call;
+  Status s = ParseFlat(BuildFlatRequest({ids}), &call);
+  EXPECT_TRUE(errors::IsInvalidArgument(s)) << s;
+}
+
+} // processor
+} // tensorflow
@@ -1,6 +1,7 @@
 #include <stdlib.h>
 
 #include "serving/processor/serving/model_config.h"
+#include "serving/processor/serving/serving_stats.h"
 #include "serving/processor/serving/tracer.h"
 #include "include/json/json.h"
 #include "tensorflow/core/util/env_var.h"
@@ -301,6 +302,68 @@ Status ModelConfigFactory::Create(const char* model_config, ModelConfig** config
         json_config["use_per_session_threads"].asBool();
   }
 
+  (*config)->double_buffer_delta_update = false;
+  if (!json_config["double_buffer_delta_update"].isNull()) {
+    (*config)->double_buffer_delta_update =
+        json_config["double_buffer_delta_update"].asBool();
+  }
+  if ((*config)->double_buffer_delta_update &&
+      (*config)->feature_store_type != "memory") {
+    return Status(error::Code::INVALID_ARGUMENT,
+        "[TensorFlow] double_buffer_delta_update require "
+        "feature_store_type must be 'memory' mode.");
+  }
+
+  (*config)->model_update_nice = 10;
+  if (!json_config["model_update_nice"].isNull()) {
+    (*config)->model_update_nice =
+        json_config["model_update_nice"].asInt();
+  }
+
+  (*config)->warmup_sample_num = 0;
+  if (!json_config["warmup_sample_num"].isNull()) {
+    (*config)->warmup_sample_num =
+        json_config["warmup_sample_num"].asInt();
+  }
+  if ((*config)->warmup_sample_num > 0 &&
+      (*config)->feature_store_type != "memory") {
+    return Status(error::Code::INVALID_ARGUMENT,
+        "[TensorFlow] warmup_sample_num require "
+        "feature_store_type must be 'memory' mode.");
+  }
+
+  (*config)->warmup_sample_interval = 100;
+  if (!json_config["warmup_sample_interval"].isNull()) {
+    (*config)->warmup_sample_interval =
+        json_config["warmup_sample_interval"].asInt();
+  }
+
+  (*config)->warmup_thread_num = 4;
+  if (!json_config["warmup_thread_num"].isNull()) {
+    (*config)->warmup_thread_num =
+        json_config["warmup_thread_num"].asInt();
+  }
+
+  (*config)->warmup_max_rounds = 10;
+  if (!json_config["warmup_max_rounds"].isNull()) {
+    (*config)->warmup_max_rounds =
+        json_config["warmup_max_rounds"].asInt();
+  }
+
+  (*config)->warmup_latency_threshold_us = 0;
+  if (!json_config["warmup_latency_threshold_us"].isNull()) {
+    (*config)->warmup_latency_threshold_us =
+        json_config["warmup_latency_threshold_us"].asInt();
+  }
+
+  if ((*config)->warmup_sample_num > 0 &&
+      ((*config)->warmup_sample_interval <= 0 ||
+       (*config)->warmup_thread_num <= 0)) {
+    return Status(error::Code::INVALID_ARGUMENT,
+        "[TensorFlow] warmup_sample_interval and warmup_thread_num "
+        "must be positive.");
+  }
+
   (*config)->shard_embedding = false;
   bool shard_embedding = false;
   if (!json_config["shard_embedding"].isNull()) {
@@ -338,6 +401,13 @@ Status ModelConfigFactory::Create(const char* model_config, ModelConfig** config
     (*config)->shard_embedding_names.push_back(embedding_names);
   }
 
+  // collect step stats of one of every stats_sample_interval
+  // requests for per op type latency, 0 disables it.
+  if (!json_config["stats_sample_interval"].isNull()) {
+    ServingStats::Get()->SetStepStatsSampleInterval(
+        json_config["stats_sample_interval"].asInt());
+  }
+
   // enable trace timeline
   if (!json_config["timeline_start_step"].isNull() &&
       !json_config["timeline_interval_step"].isNull() &&
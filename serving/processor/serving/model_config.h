@@ -54,6 +54,26 @@ struct ModelConfig {
 
   // session use self-owned thread pool
   bool use_per_session_threads = false;
+
+  // Model Update Info
+  // Local mode only. Keep a shadow session in memory, delta models are
+  // restored into the shadow session which is then swapped in, instead
+  // of being restored into the serving session.
+  bool double_buffer_delta_update = false;
+  // Nice value of the model update thread, restore ops run inline in
+  // this thread, larger value means lower priority.
+  int model_update_nice = 10;
+
+  // Traffic warmup, local mode only. Sample one of every
+  // warmup_sample_interval live requests and keep the latest
+  // warmup_sample_num ones, they're replayed in parallel against a newly
+  // loaded model before it serves, until p99 latency of a round is under
+  // warmup_latency_threshold_us and stable. 0 sample num disables it.
+  int warmup_sample_num = 0;
+  int warmup_sample_interval = 100;
+  int warmup_thread_num = 4;
+  int warmup_max_rounds = 10;
+  int warmup_latency_threshold_us = 0;
 };
 
 class ModelConfigFactory {
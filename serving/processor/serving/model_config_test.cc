@@ -216,6 +216,88 @@ const std::string oss_and_redis_config = " \
   EXPECT_EQ("test_key", config->oss_access_key);
 }
 
+TEST_F(ModelConfigTest, ShouldFailedWhenDoubleBufferUpdateAndRedis) {
+const std::string config_str = " \
+  { \
+    \"serialize_protocol\": \"protobuf\", \
+    \"signature_name\": \"tensorflow_serving\", \
+    \"checkpoint_dir\" : \"/test_ckpt/1\", \
+    \"savedmodel_dir\" : \"/test_savedmodel/1\", \
+    \"feature_store_type\" : \"cluster_redis\", \
+    \"redis_url\" :\"test_url\",  \
+    \"redis_password\" :\"test_password\", \
+    \"double_buffer_delta_update\" : true, \
+    \"model_store_type\": \"local\" \
+  }";
+
+  ModelConfig* config = nullptr;
+  EXPECT_FALSE(
+      ModelConfigFactory::Create(config_str.c_str(), &config).ok());
+}
+
+TEST_F(ModelConfigTest, ShouldSuccessWhenDoubleBufferUpdateAndMemory) {
+const std::string config_str = " \
+  { \
+    \"serialize_protocol\": \"protobuf\", \
+    \"signature_name\": \"tensorflow_serving\", \
+    \"checkpoint_dir\" : \"/test_ckpt/1\", \
+    \"savedmodel_dir\" : \"/test_savedmodel/1\", \
+    \"feature_store_type\" : \"memory\", \
+    \"double_buffer_delta_update\" : true, \
+    \"model_update_nice\" : 5, \
+    \"model_store_type\": \"local\" \
+  }";
+
+  ModelConfig* config = nullptr;
+  EXPECT_TRUE(
+      ModelConfigFactory::Create(config_str.c_str(), &config).ok());
+  EXPECT_TRUE(config->double_buffer_delta_update);
+  EXPECT_EQ(5, config->model_update_nice);
+}
+
+TEST_F(ModelConfigTest, ShouldSuccessWhenTrafficWarmupAndMemory) {
+const std::string config_str = " \
+  { \
+    \"serialize_protocol\": \"protobuf\", \
+    \"signature_name\": \"tensorflow_serving\", \
+    \"checkpoint_dir\" : \"/test_ckpt/1\", \
+    \"savedmodel_dir\" : \"/test_savedmodel/1\", \
+    \"feature_store_type\" : \"memory\", \
+    \"warmup_sample_num\" : 500, \
+    \"warmup_sample_interval\" : 10, \
+    \"warmup_latency_threshold_us\" : 2000, \
+    \"model_store_type\": \"local\" \
+  }";
+
+  ModelConfig* config = nullptr;
+  EXPECT_TRUE(
+      ModelConfigFactory::Create(config_str.c_str(), &config).ok());
+  EXPECT_EQ(500, config->warmup_sample_num);
+  EXPECT_EQ(10, config->warmup_sample_interval);
+  EXPECT_EQ(4, config->warmup_thread_num);
+  EXPECT_EQ(10, config->warmup_max_rounds);
+  EXPECT_EQ(2000, config->warmup_latency_threshold_us);
+}
+
+TEST_F(ModelConfigTest, ShouldFailedWhenTrafficWarmupAndRedis) {
+const std::string config_str = " \
+  { \
+    \"serialize_protocol\": \"protobuf\", \
+    \"signature_name\": \"tensorflow_serving\", \
+    \"checkpoint_dir\" : \"/test_ckpt/1\", \
+    \"savedmodel_dir\" : \"/test_savedmodel/1\", \
+    \"feature_store_type\" : \"cluster_redis\", \
+    \"redis_url\" :\"test_url\",  \
+    \"redis_password\" :\"test_password\", \
+    \"warmup_sample_num\" : 500, \
+    \"model_store_type\": \"local\" \
+  }";
+
+  ModelConfig* config = nullptr;
+  EXPECT_FALSE(
+      ModelConfigFactory::Create(config_str.c_str(), &config).ok());
+}
+
 } // processor
 } // tensorflow
 
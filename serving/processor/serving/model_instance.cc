@@ -1,4 +1,9 @@
 #include <fstream>
+#if defined(__linux__)
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 #include "serving/processor/serving/model_instance.h"
 #include "serving/processor/serving/model_partition.h"
 #include "serving/processor/serving/model_session.h"
@@ -233,6 +238,15 @@ Status LocalSessionInstance::Init(ModelConfig* config,
         {kSavedModelTagServe}, &meta_graph_def_));
 
   warmup_file_name_ = config->warmup_file_name;
+  if (config->warmup_sample_num > 0) {
+    request_recorder_.reset(new RequestRecorder(
+        config->warmup_sample_num, config->warmup_sample_interval));
+    warmup_thread_pool_.reset(new thread::ThreadPool(Env::Default(),
+        "traffic_warmup", config->warmup_thread_num));
+    warmup_options_.max_rounds = config->warmup_max_rounds;
+    warmup_options_.latency_threshold_us =
+        config->warmup_latency_threshold_us;
+  }
 
   GraphOptimizerOption option;
   option.native_tf_mode = true;
@@ -260,13 +274,17 @@ Status LocalSessionInstance::Init(ModelConfig* config,
         /*is_incr_ckpt*/false, config));
 
   // Load delta model if existed
-  if (version_.delta_ckpt_name.empty()) {
-    return Status::OK();
+  if (!version_.delta_ckpt_name.empty()) {
+    TF_RETURN_IF_ERROR(session_mgr_->CreateModelSession(version_,
+        version_.full_ckpt_name.c_str(),
+        version_.delta_ckpt_name.c_str(),
+        /*is_incr_ckpt*/true, config));
   }
-  return session_mgr_->CreateModelSession(version_,
-      version_.full_ckpt_name.c_str(),
-      version_.delta_ckpt_name.c_str(),
-      /*is_incr_ckpt*/true, config);
+
+  if (config->double_buffer_delta_update) {
+    return session_mgr_->CreateShadowSession(version_, config);
+  }
+  return Status::OK();
 }
 
 Status LocalSessionInstance::ReadModelSignature(ModelConfig* model_config) {
@@ -284,7 +302,11 @@ Status LocalSessionInstance::ReadModelSignature(ModelConfig* model_config) {
 }
 
 Status LocalSessionInstance::Predict(Request& req, Response& resp) {
-  return session_mgr_->LocalPredict(req, resp);
+  Status status = session_mgr_->LocalPredict(req, resp);
+  if (request_recorder_ && status.ok()) {
+    request_recorder_->Record(req);
+  }
+  return status;
 }
 
 Status LocalSessionInstance::GetServingModelInfo(
@@ -296,7 +318,8 @@ Status LocalSessionInstance::Warmup(
     ModelSession* warmup_session) {
   if (warmup_file_name_.empty() &&
       !ShouldWarmup(model_signature_.second)) {
-    return Status::OK();
+    // Recorded requests are real, string inputs are fine.
+    return warmup_session ? TrafficWarmup(warmup_session) : Status::OK();
   }
 
   Call call;
@@ -308,14 +331,35 @@ Status LocalSessionInstance::Warmup(
   }
 
   if (warmup_session) {
-    return warmup_session->LocalPredict(
-        call.request, call.response);
+    TF_RETURN_IF_ERROR(warmup_session->LocalPredict(
+        call.request, call.response));
+    return TrafficWarmup(warmup_session);
   }
 
   return session_mgr_->LocalPredict(
       call.request, call.response);
 }
 
+Status LocalSessionInstance::TrafficWarmup(
+    ModelSession* warmup_session) {
+  if (request_recorder_ == nullptr) {
+    return Status::OK();
+  }
+
+  std::vector<Request> requests = request_recorder_->Samples();
+  if (requests.empty()) {
+    return Status::OK();
+  }
+
+  LOG(INFO) << "[Model Instance] Warmup new model with "
+            << requests.size() << " recorded requests.";
+  return processor::TrafficWarmup(requests, warmup_options_,
+      warmup_thread_pool_.get(),
+      [warmup_session](Request& req, Response& resp) {
+        return warmup_session->LocalPredict(req, resp);
+      });
+}
+
 std::string LocalSessionInstance::DebugString() {
   return model_json_signature_;
 }
@@ -332,11 +376,24 @@ Status LocalSessionInstance::FullModelUpdate(
           &new_model_session));
 
   // warmup model
-  Warmup(new_model_session);
+  Status warmup_status = Warmup(new_model_session);
+  if (!warmup_status.ok()) {
+    LOG(WARNING) << "[Model Instance] Warmup new model failed: "
+                 << warmup_status.error_message();
+  }
 
   session_mgr_->ResetServingSession(new_model_session);
   UpdateVersion(new_model_session->GetVersion());
 
+  if (model_config->double_buffer_delta_update) {
+    // Shadow session holds the same full model as serving session,
+    // delta model will be applied by DeltaModelUpdate.
+    Version full_version(version);
+    full_version.delta_ckpt_name = "";
+    TF_RETURN_IF_ERROR(session_mgr_->CreateShadowSession(
+        full_version, model_config));
+  }
+
   return Status::OK();
 }
 
@@ -348,8 +405,9 @@ Status LocalSessionInstance::DeltaModelUpdate(
           version.delta_ckpt_name.c_str(),
           /*is_incr_ckpt*/true, model_config));
 
-  // Delta model update: No need to warmup model and
-  // reset serving session, we don't create a new session.
+  // Delta model update: No need to warmup model, the delta model
+  // is restored into the serving session, or into the shadow session
+  // which is swapped in when double_buffer_delta_update is enabled.
 
   UpdateVersion(version);
 
@@ -730,17 +788,42 @@ Status ModelUpdater::ModelUpdate(const Version& version,
     ModelConfig* model_config, bool new_full_ckpt_generated) {
   // Load new full model vesion
   if (version.IsFullModel()) {
-    return FullModelUpdate(version, model_config);
+    TF_RETURN_IF_ERROR(FullModelUpdate(version, model_config));
   } else {
     // Load new full model vesion before incremental model be loaded.
     if (new_full_ckpt_generated) {
       TF_RETURN_IF_ERROR(FullModelUpdate(version, model_config));
     }
-    return DeltaModelUpdate(version, model_config);
+    TF_RETURN_IF_ERROR(DeltaModelUpdate(version, model_config));
   }
+
+  LogUpdateToServeLag(version);
+  return Status::OK();
+}
+
+void ModelUpdater::LogUpdateToServeLag(const Version& version) {
+  const std::string& ckpt_name = version.IsFullModel() ?
+      version.full_ckpt_name : version.delta_ckpt_name;
+  FileStatistics stat;
+  Status s = Env::Default()->Stat(MetaFilename(ckpt_name), &stat);
+  if (!s.ok()) return;
+
+  int64 lag_ms = (Env::Default()->NowNanos() - stat.mtime_nsec) / 1000000;
+  LOG(INFO) << "[Processor] Model version "
+            << version.full_ckpt_version << "/"
+            << version.delta_ckpt_version
+            << " is serving, update-to-serve lag: " << lag_ms << " ms.";
 }
 
 void ModelUpdater::WorkLoop() {
+#if defined(__linux__)
+  // Lower priority of the update thread, restore ops of delta model
+  // run inline in this thread.
+  if (setpriority(PRIO_PROCESS, syscall(SYS_gettid),
+                  model_config_->model_update_nice) != 0) {
+    LOG(WARNING) << "[Processor] Set model update thread priority failed.";
+  }
+#endif
   while(!is_stop_) {
     Version version;
     auto status = model_store_->GetLatestVersion(version);
@@ -6,9 +6,11 @@
 #include "serving/processor/framework/model_version.h"
 #include "serving/processor/serving/model_message.h"
 #include "serving/processor/serving/model_config.h"
+#include "serving/processor/serving/traffic_warmup.h"
 #include "serving/processor/storage/feature_store.h"
 #include <thread>
 #include <atomic>
+#include <memory>
 
 namespace tensorflow {
 class SessionOptions;
@@ -46,6 +48,9 @@ class LocalSessionInstance {
  private:
   Status ReadModelSignature(ModelConfig* model_config);
 
+  // Replay recorded live requests against `warmup_session`.
+  Status TrafficWarmup(ModelSession* warmup_session);
+
  private: 
   MetaGraphDef meta_graph_def_;
   std::pair<std::string, SignatureDef> model_signature_;
@@ -56,6 +61,11 @@ class LocalSessionInstance {
   SessionOptions* session_options_ = nullptr;
   RunOptions* run_options_ = nullptr;
   SavedModelOptimizer* optimizer_ = nullptr;
+
+  // Set when warmup_sample_num > 0.
+  std::unique_ptr<RequestRecorder> request_recorder_;
+  std::unique_ptr<thread::ThreadPool> warmup_thread_pool_;
+  TrafficWarmupOptions warmup_options_;
   
   Version version_;
 };
@@ -136,6 +146,10 @@ class ModelUpdater {
                      ModelConfig* model_config,
                      bool new_full_model_generated);
 
+  // Log the lag between the checkpoint of `version` was written
+  // and it's served.
+  void LogUpdateToServeLag(const Version& version);
+
  protected:
   ModelStore* model_store_ = nullptr;
   ModelConfig* model_config_ = nullptr; // not owned
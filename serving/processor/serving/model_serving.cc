@@ -3,7 +3,9 @@
 #include "serving/processor/serving/model_config.h"
 #include "serving/processor/serving/model_message.h"
 #include "serving/processor/serving/message_coding.h"
+#include "serving/processor/serving/serving_stats.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/errors.h"
 
 namespace tensorflow {
 namespace processor {
@@ -38,25 +40,33 @@ Status Model::Init(const char* model_config) {
 Status Model::Predict(const void* input_data, int input_size,
     void** output_data, int* output_size) {
   Call call;
-  parser_->ParseRequestFromBuf(input_data, input_size, call);
+  {
+    ScopedStageTimer timer(ServingStage::kParse);
+    TF_RETURN_IF_ERROR(parser_->ParseRequestFromBuf(input_data,
+        input_size, call));
+  }
   auto status = Predict(call.request, call.response);
   if (!status.ok()) {
     return status;
   }
 
-  parser_->ParseResponseToBuf(call, output_data, output_size);
-  return Status::OK();
+  ScopedStageTimer timer(ServingStage::kSerialize);
+  return parser_->ParseResponseToBuf(call, output_data, output_size);
 }
 
 Status Model::BatchPredict(const void* input_data[], int* input_size,
     void* output_data[], int* output_size) {
   BatchCall call;
-  parser_->ParseBatchRequestFromBuf(input_data, input_size, call);
+  {
+    ScopedStageTimer timer(ServingStage::kParse);
+    parser_->ParseBatchRequestFromBuf(input_data, input_size, call);
+  }
   auto status = Predict(call.batched_request, call.batched_response);
   if (!status.ok()) {
     return status;
   }
 
+  ScopedStageTimer timer(ServingStage::kSerialize);
   parser_->ParseBatchResponseToBuf(call, output_data, output_size);
   return Status::OK();
 }
@@ -76,6 +86,10 @@ Status Model::GetServingModelInfo(void* output_data[],
   return Status::OK();
 }
 
+std::string Model::GetServingStats() {
+  return ServingStats::Get()->ToJson();
+}
+
 Status Model::Rollback() {
   return impl_->Rollback();
 }
@@ -28,6 +28,9 @@ class Model {
 
   Status GetServingModelInfo(void* output_data[], int* output_size);
 
+  // Json of per stage latency histograms and per op type aggregates.
+  std::string GetServingStats();
+
   Status Rollback();
 
   std::string DebugString();
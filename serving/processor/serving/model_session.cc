@@ -1,6 +1,7 @@
 #include <random>
 #include "serving/processor/serving/model_session.h"
 #include "serving/processor/serving/model_message.h"
+#include "serving/processor/serving/serving_stats.h"
 #include "serving/processor/serving/tracer.h"
 #include "serving/processor/serving/util.h"
 #include "serving/processor/storage/model_store.h"
@@ -132,6 +133,7 @@ ModelSessionMgr::~ModelSessionMgr() {
   is_stop_ = true;
   clear_session_thread_->join();
   delete clear_session_thread_;
+  delete shadow_session_;
 }
 
 Status ModelSessionMgr::CreateSession(Session** session) {
@@ -269,23 +271,7 @@ Status ModelSession::Predict(Request& req, Response& resp) {
 
   req.inputs.emplace_back(sparse_storage_name_, sparse_storage_tensor_);
   req.inputs.emplace_back(model_version_name_, model_version_tensor_);
-  ++counter_;
-  Status status;
-  if (Tracer::GetTracer()->NeedTracing()) {
-    tensorflow::RunOptions run_options;
-    run_options.set_trace_level(tensorflow::RunOptions::FULL_TRACE);
-    tensorflow::RunMetadata run_metadata;
-    // TODO: which session selected to run on, add some policy here
-    status = session_group_->Run(run_options, req.inputs,
-        req.output_tensor_names, {}, &resp.outputs,
-        &run_metadata, GetServingSessionId());
-    Tracer::GetTracer()->GenTimeline(run_metadata);
-  } else {
-    status = session_group_->Run(req.inputs, req.output_tensor_names,
-        {}, &resp.outputs, GetServingSessionId());
-  }
-  --counter_;
-  return status;
+  return Run(req, resp);
 }
 
 Status ModelSession::LocalPredict(Request& req, Response& resp) {
@@ -293,31 +279,95 @@ Status ModelSession::LocalPredict(Request& req, Response& resp) {
     return Status(error::Code::INTERNAL,
         "Remote sparse storage, please use Predict.");
   }
+  return Run(req, resp);
+}
+
+Status ModelSession::Run(Request& req, Response& resp) {
   ++counter_;
   Status status;
-  if (Tracer::GetTracer()->NeedTracing()) {
+  bool need_tracing = Tracer::GetTracer()->NeedTracing();
+  bool need_stats = ServingStats::Get()->NeedSampleStepStats();
+  uint64 start = Env::Default()->NowMicros();
+  if (need_tracing || need_stats) {
     tensorflow::RunOptions run_options;
-    run_options.set_trace_level(tensorflow::RunOptions::FULL_TRACE);
+    run_options.set_trace_level(need_tracing ?
+        tensorflow::RunOptions::FULL_TRACE :
+        tensorflow::RunOptions::SOFTWARE_TRACE);
     tensorflow::RunMetadata run_metadata;
     // TODO: which session selected to run on, add some policy here
     status = session_group_->Run(run_options, req.inputs,
         req.output_tensor_names, {}, &resp.outputs,
         &run_metadata, GetServingSessionId());
-    Tracer::GetTracer()->GenTimeline(run_metadata); 
+    if (need_tracing) {
+      Tracer::GetTracer()->GenTimeline(run_metadata);
+    }
+    ServingStats::Get()->RecordStepStats(run_metadata.step_stats(), start);
   } else {
     status = session_group_->Run(req.inputs, req.output_tensor_names,
         {}, &resp.outputs, GetServingSessionId());
   }
+  ServingStats::Get()->Record(ServingStage::kSessionRun,
+      Env::Default()->NowMicros() - start);
   --counter_;
   return status;
 }
 
 Status ModelSessionMgr::Predict(Request& req, Response& resp) {
-  return serving_session_->Predict(req, resp);
+  uint64 start = updating_.load(std::memory_order_relaxed) ?
+      Env::Default()->NowMicros() : 0;
+  Status status;
+  {
+    ServingEpoch::ReadLock lock(&serving_epoch_);
+    status = serving_session_.load()->Predict(req, resp);
+  }
+  if (start > 0) {
+    RecordUpdateLatency(Env::Default()->NowMicros() - start);
+  }
+  return status;
 }
 
 Status ModelSessionMgr::LocalPredict(Request& req, Response& resp) {
-  return serving_session_->LocalPredict(req, resp);
+  uint64 start = updating_.load(std::memory_order_relaxed) ?
+      Env::Default()->NowMicros() : 0;
+  Status status;
+  {
+    ServingEpoch::ReadLock lock(&serving_epoch_);
+    status = serving_session_.load()->LocalPredict(req, resp);
+  }
+  if (start > 0) {
+    RecordUpdateLatency(Env::Default()->NowMicros() - start);
+  }
+  return status;
+}
+
+void ModelSessionMgr::RecordUpdateLatency(int64 micros) {
+  ++update_request_count_;
+  update_latency_total_ += micros;
+  int64 prev_max = update_latency_max_.load();
+  while (micros > prev_max &&
+         !update_latency_max_.compare_exchange_weak(prev_max, micros)) {
+  }
+}
+
+void ModelSessionMgr::BeginUpdate() {
+  update_request_count_ = 0;
+  update_latency_total_ = 0;
+  update_latency_max_ = 0;
+  update_start_micros_ = Env::Default()->NowMicros();
+  updating_ = true;
+}
+
+void ModelSessionMgr::EndUpdate(const Version& version, bool is_incr_ckpt) {
+  updating_ = false;
+  int64 count = update_request_count_;
+  LOG(INFO) << "[Model Session] " << (is_incr_ckpt ? "Delta" : "Full")
+            << " model update finished in "
+            << (Env::Default()->NowMicros() - update_start_micros_) / 1000
+            << " ms, version: " << version.full_ckpt_version << "/"
+            << version.delta_ckpt_version << ", requests served during "
+            << "update: " << count << ", avg latency: "
+            << (count > 0 ? update_latency_total_ / count : 0)
+            << " us, max latency: " << update_latency_max_ << " us.";
 }
 
 Status ModelSessionMgr::CreateModelSession(
@@ -440,53 +490,158 @@ Status ModelSessionMgr::CreateModelSession(
     const Version& version, const char* full_ckpt_name,
     const char* incr_ckpt_name, bool is_incr_ckpt,
     ModelConfig* config, ModelSession** new_model_session) {
+  if (is_incr_ckpt && shadow_session_ != nullptr) {
+    return DoubleBufferDeltaUpdate(version, full_ckpt_name,
+                                   incr_ckpt_name, config);
+  }
+
+  SessionGroup* session_group = nullptr;
+  Session* session = nullptr;
+  if (is_incr_ckpt) {
+    // Use serving session to update delta model
+    session = serving_session_.load()->GetSession();
+  } else {
+    TF_RETURN_IF_ERROR(CreateSessionGroup(&session_group, config));
+    session = session_group->GetLeaderSession();
+  }
+
+  BeginUpdate();
+  Status s = RestoreCheckpoint(version, full_ckpt_name, incr_ckpt_name,
+                               is_incr_ckpt, session);
+  EndUpdate(version, is_incr_ckpt);
+  if (!s.ok()) {
+    delete session_group;
+    return s;
+  }
+
+  if (!is_incr_ckpt) {
+    // ResetServingSession(session, version);
+    *new_model_session = new ModelSession(
+      session_group, config->select_session_policy, version);
+  } else {
+    serving_session_.load()->UpdateVersion(version);
+  }
+
+  return Status::OK();
+}
+
+Status ModelSessionMgr::RestoreCheckpoint(const Version& version,
+    const char* full_ckpt_name, const char* incr_ckpt_name,
+    bool is_incr_ckpt, Session* session) {
   std::string restore_op_name =
       meta_graph_def_.saver_def().restore_op_name();
   std::string filename_tensor_name =
       meta_graph_def_.saver_def().filename_tensor_name();
   std::string incr_filename_tensor_name =
       meta_graph_def_.incr_saver_def().filename_tensor_name();
-  SessionGroup* session_group = nullptr;
-  Session* session = nullptr;
   if (is_incr_ckpt) {
-    // Use serving session to update delta model
-    session = serving_session_->GetSession();
     restore_op_name =
         meta_graph_def_.incr_saver_def().restore_op_name();
-  } else {
-    TF_RETURN_IF_ERROR(CreateSessionGroup(&session_group, config));
-    session = session_group->GetLeaderSession();
+  }
+
+  RunOptions run_options(*run_options_);
+  if (is_incr_ckpt) {
+    // Run delta restore ops in the caller thread, so they don't
+    // compete with serving requests for inter-op threads.
+    run_options.set_inter_op_thread_pool(-1);
   }
 
   TF_RETURN_IF_ERROR(util::RunRestoreCheckpoint(
-      is_incr_ckpt, *run_options_, full_ckpt_name,
+      is_incr_ckpt, run_options, full_ckpt_name,
       incr_ckpt_name, version.savedmodel_dir.c_str(),
       restore_op_name, filename_tensor_name,
       incr_filename_tensor_name, asset_file_defs_, session));
 
   if (util::HasMainOp(meta_graph_def_)) {
-    TF_RETURN_IF_ERROR(util::RunMainOp(*run_options_,
+    return util::RunMainOp(run_options,
         version.savedmodel_dir.c_str(),
         meta_graph_def_, asset_file_defs_,
-        session, kSavedModelMainOpKey));
+        session, kSavedModelMainOpKey);
   } else {
-    TF_RETURN_IF_ERROR(util::RunMainOp(
-        *run_options_, version.savedmodel_dir.c_str(),
+    return util::RunMainOp(
+        run_options, version.savedmodel_dir.c_str(),
         meta_graph_def_, asset_file_defs_, session,
-        kSavedModelLegacyInitOpKey));
+        kSavedModelLegacyInitOpKey);
   }
+}
 
-  if (!is_incr_ckpt) {
-    // ResetServingSession(session, version);
-    *new_model_session = new ModelSession(
-      session_group, config->select_session_policy, version);
-  } else {
-    serving_session_->UpdateVersion(version);
+Status ModelSessionMgr::CreateShadowSession(const Version& version,
+    ModelConfig* config) {
+  // The previous shadow session holds an older model, drop it first so
+  // that a failed rebuild leaves no stale shadow to apply delta model
+  // to. Delta models are updated in place until a rebuild succeeds.
+  DropShadowSession();
+
+  ModelSession* shadow_session = nullptr;
+  TF_RETURN_IF_ERROR(CreateModelSession(version,
+      version.full_ckpt_name.c_str(), version.delta_ckpt_name.c_str(),
+      /*is_incr_ckpt*/false, config, &shadow_session));
+
+  if (!version.delta_ckpt_name.empty()) {
+    Status s = RestoreCheckpoint(version, version.full_ckpt_name.c_str(),
+        version.delta_ckpt_name.c_str(), /*is_incr_ckpt*/true,
+        shadow_session->GetSession());
+    if (!s.ok()) {
+      delete shadow_session;
+      return s;
+    }
   }
 
+  shadow_session_ = shadow_session;
   return Status::OK();
 }
 
+void ModelSessionMgr::DropShadowSession() {
+  delete shadow_session_;
+  shadow_session_ = nullptr;
+}
+
+Status ModelSessionMgr::DoubleBufferDeltaUpdate(const Version& version,
+    const char* full_ckpt_name, const char* incr_ckpt_name,
+    ModelConfig* config) {
+  BeginUpdate();
+  // 1) Restore delta model into shadow session, serving session
+  // isn't touched.
+  Status s = RestoreCheckpoint(version, full_ckpt_name, incr_ckpt_name,
+                               /*is_incr_ckpt*/true,
+                               shadow_session_->GetSession());
+  if (!s.ok()) {
+    EndUpdate(version, /*is_incr_ckpt*/true);
+    // The shadow session may be partly restored, never publish it.
+    DropShadowSession();
+    return s;
+  }
+  shadow_session_->UpdateVersion(version);
+
+  // 2) Publish the shadow session, and wait until the requests
+  // on previous serving session are finished.
+  ModelSession* prev_serving_session =
+      serving_session_.exchange(shadow_session_);
+  serving_epoch_.Synchronize();
+  EndUpdate(version, /*is_incr_ckpt*/true);
+
+  // 3) Catch up the previous serving session as new shadow session,
+  // rebuild it from checkpoint once it's failed.
+  shadow_session_ = prev_serving_session;
+  s = RestoreCheckpoint(version, full_ckpt_name, incr_ckpt_name,
+                        /*is_incr_ckpt*/true,
+                        shadow_session_->GetSession());
+  if (s.ok()) {
+    shadow_session_->UpdateVersion(version);
+    return Status::OK();
+  }
+
+  LOG(WARNING) << "[Model Session] Catch up shadow session failed, "
+               << "rebuild it. " << s.error_message();
+  s = CreateShadowSession(version, config);
+  if (!s.ok()) {
+    LOG(WARNING) << "[Model Session] Rebuild shadow session failed, "
+                 << "fall back to in-place delta update. "
+                 << s.error_message();
+  }
+  return s;
+}
+
 Status ModelSessionMgr::CleanupModelSession() {
   mutex_lock lock(mu_);
   sessions_.erase(
@@ -504,11 +659,12 @@ Status ModelSessionMgr::CleanupModelSession() {
 }
 
 void ModelSessionMgr::ResetServingSession(ModelSession* model_session) {
-  auto tmp = serving_session_;
-  serving_session_ = model_session;
-
+  auto tmp = serving_session_.exchange(model_session);
   if (tmp == nullptr) return;
 
+  // Wait for the requests which may hold the previous session.
+  serving_epoch_.Synchronize();
+
   if (tmp->counter_ > 0) {
     // TODO: free it in active object.
     mutex_lock lock(mu_);
@@ -520,8 +676,9 @@ void ModelSessionMgr::ResetServingSession(ModelSession* model_session) {
 
 Status ModelSessionMgr::GetServingModelInfo(
     tensorflow::processor::ServingModelInfo& model_info) {
+  ServingEpoch::ReadLock lock(&serving_epoch_);
   model_info.model_path =
-      serving_session_->GetVersion().full_ckpt_name;
+      serving_session_.load()->GetVersion().full_ckpt_name;
   return Status::OK();
 }
 
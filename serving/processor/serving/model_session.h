@@ -4,6 +4,7 @@
 #include "serving/processor/framework/model_version.h"
 #include "serving/processor/serving/model_config.h"
 #include "serving/processor/serving/model_message.h"
+#include "serving/processor/serving/serving_epoch.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/protobuf/meta_graph.pb.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -54,6 +55,7 @@ struct ModelSession {
 
  private:
   int GetServingSessionId();
+  Status Run(Request& req, Response& resp);
 };
 
 class ModelSessionMgr {
@@ -88,14 +90,41 @@ class ModelSessionMgr {
       const char* incr_ckpt_name, bool is_incr_ckpt,
       ModelConfig* config, ModelSession** new_model_session);
 
+  // Create the shadow session used by double buffered delta update,
+  // restored to the same full and delta model of `version`. Delta
+  // model is updated in place while there is no shadow session.
+  Status CreateShadowSession(const Version& version, ModelConfig* config);
+
   Status CleanupModelSession();
 
+  // Publish `model_session` to serving threads, the previous serving
+  // session is reclaimed once no request refers to it.
   void ResetServingSession(ModelSession* model_session);
 
   Status GetServingModelInfo(
       tensorflow::processor::ServingModelInfo& model_info);
 
  private:
+  // Restore checkpoint into `session`, restore ops run inline in the
+  // caller thread to stay off the serving inter-op threadpool.
+  Status RestoreCheckpoint(const Version& version,
+      const char* full_ckpt_name, const char* incr_ckpt_name,
+      bool is_incr_ckpt, Session* session);
+
+  // Restore delta model into the shadow session, publish it and
+  // then catch up the previous serving session as new shadow.
+  Status DoubleBufferDeltaUpdate(const Version& version,
+      const char* full_ckpt_name, const char* incr_ckpt_name,
+      ModelConfig* config);
+
+  void DropShadowSession();
+
+  // Record latency of requests served while a model update is
+  // in progress, see BeginUpdate/EndUpdate.
+  void BeginUpdate();
+  void EndUpdate(const Version& version, bool is_incr_ckpt);
+  void RecordUpdateLatency(int64 micros);
+
   virtual Status CreateSession(Session** sess);
   virtual Status CreateSessionGroup(
       SessionGroup** session_group, ModelConfig* config);
@@ -110,7 +139,16 @@ class ModelSessionMgr {
   void ClearLoop();
 
  protected:
-  ModelSession* serving_session_ = nullptr;
+  std::atomic<ModelSession*> serving_session_{nullptr};
+  // Only accessed by the model update thread.
+  ModelSession* shadow_session_ = nullptr;
+  ServingEpoch serving_epoch_;
+
+  std::atomic<bool> updating_{false};
+  uint64 update_start_micros_ = 0;
+  std::atomic<int64> update_request_count_{0};
+  std::atomic<int64> update_latency_total_{0};
+  std::atomic<int64> update_latency_max_{0};
 
   MetaGraphDef meta_graph_def_;
   SessionOptions* session_options_;
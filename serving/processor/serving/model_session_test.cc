@@ -3,6 +3,7 @@
 #include "serving/processor/serving/model_session.h"
 #include "serving/processor/serving/model_config.h"
 #include "serving/processor/serving/model_message.h"
+#include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/public/session.h"
 
 namespace tensorflow {
@@ -39,6 +40,12 @@ class ModelSessionMgrTest : public ::testing::Test {
 
 class FakeSession : public Session {
  public:
+  FakeSession() = default;
+  // Checkpoints are restored by RunCallable, let the next `*run_passes`
+  // calls pass and then fail the next `*run_failures` calls.
+  FakeSession(int* run_passes, int* run_failures)
+    : run_passes_(run_passes), run_failures_(run_failures) {}
+
   Status Create(const GraphDef& graph) override {
     return Status::OK();
   }
@@ -104,12 +111,22 @@ class FakeSession : public Session {
                      const std::vector<Tensor>& feed_tensors,
                      std::vector<Tensor>* fetch_tensors,
                      RunMetadata* run_metadata) override {
+    if (run_passes_ != nullptr && *run_passes_ > 0) {
+      --(*run_passes_);
+    } else if (run_failures_ != nullptr && *run_failures_ > 0) {
+      --(*run_failures_);
+      return errors::Internal("Restore failed");
+    }
     return Status::OK();
   }
 
   Status ReleaseCallable(CallableHandle handle) override {
     return Status::OK();
   }
+
+ private:
+  int* run_passes_ = nullptr;
+  int* run_failures_ = nullptr;
 };
 
 class FakeFeatureStoreMgr : public IFeatureStoreMgr {
@@ -188,9 +205,11 @@ class TestableModelSessionMgr : public ModelSessionMgr {
     int session_num = config->session_num;
     *sess_group = new SessionGroup();
     if (session_num > 0) {
-      (*sess_group)->CreateLeaderSession(new FakeSession());
+      (*sess_group)->CreateLeaderSession(
+          new FakeSession(&run_passes_, &run_failures_));
       for (int i = 1; i < session_num; ++i) {
-        (*sess_group)->CreateFollowerSession(new FakeSession());
+        (*sess_group)->CreateFollowerSession(
+            new FakeSession(&run_passes_, &run_failures_));
       }
     }
     return Status::OK();
@@ -212,7 +231,17 @@ class TestableModelSessionMgr : public ModelSessionMgr {
   }
 
   void* GetServingSession() {
-    return serving_session_->GetSession();
+    return serving_session_.load()->GetSession();
+  }
+
+  void* GetShadowSession() {
+    return shadow_session_ == nullptr ?
+        nullptr : shadow_session_->GetSession();
+  }
+
+  void FailRestores(int passes, int failures) {
+    run_passes_ = passes;
+    run_failures_ = failures;
   }
 
   Status RunRestoreOps(
@@ -222,6 +251,10 @@ class TestableModelSessionMgr : public ModelSessionMgr {
       bool update_sparse, int64_t latest_version) override {
     return Status::OK();
   }
+
+ private:
+  int run_passes_ = 0;
+  int run_failures_ = 0;
 };
 
 TEST_F(ModelSessionMgrTest, CreateModelSessionReturnStatusOK) {
@@ -290,5 +323,115 @@ TEST_F(ModelSessionMgrTest, CleanupModelSessionWhenNoRequest) {
   EXPECT_EQ(1, mgr.GetModelSessionSize());
 }
 
+Status CreateDoubleBufferedSessions(TestableModelSessionMgr* mgr,
+    const Version& version, ModelConfig* config) {
+  TF_RETURN_IF_ERROR(mgr->CreateModelSession(version,
+      version.full_ckpt_name.c_str(), version.delta_ckpt_name.c_str(),
+      /*is_incr_ckpt*/false, config));
+  return mgr->CreateShadowSession(version, config);
+}
+
+Status ApplyDeltaModel(TestableModelSessionMgr* mgr,
+    const Version& version, ModelConfig* config) {
+  return mgr->CreateModelSession(version,
+      version.full_ckpt_name.c_str(), version.delta_ckpt_name.c_str(),
+      /*is_incr_ckpt*/true, config);
+}
+
+TEST_F(ModelSessionMgrTest, DoubleBufferDeltaUpdatePublishShadowSession) {
+  MetaGraphDef test_graph_def;
+  SessionOptions sess_options;
+  RunOptions run_options;
+  TestableModelSessionMgr mgr(test_graph_def, &sess_options, &run_options);
+  ModelConfig config = CreateValidModelConfig();
+
+  Version version;
+  version.full_ckpt_name = "full";
+  EXPECT_TRUE(CreateDoubleBufferedSessions(&mgr, version, &config).ok());
+  void* serving_session = mgr.GetServingSession();
+  void* shadow_session = mgr.GetShadowSession();
+  EXPECT_TRUE(shadow_session != nullptr);
+
+  version.delta_ckpt_name = "delta_1";
+  EXPECT_TRUE(ApplyDeltaModel(&mgr, version, &config).ok());
+  // Sessions are swapped and the previous serving session is caught up
+  // as new shadow.
+  EXPECT_EQ(shadow_session, mgr.GetServingSession());
+  EXPECT_EQ(serving_session, mgr.GetShadowSession());
+}
+
+TEST_F(ModelSessionMgrTest, DoubleBufferDeltaUpdateFailedRestore) {
+  MetaGraphDef test_graph_def;
+  SessionOptions sess_options;
+  RunOptions run_options;
+  TestableModelSessionMgr mgr(test_graph_def, &sess_options, &run_options);
+  ModelConfig config = CreateValidModelConfig();
+
+  Version version;
+  version.full_ckpt_name = "full";
+  EXPECT_TRUE(CreateDoubleBufferedSessions(&mgr, version, &config).ok());
+  void* serving_session = mgr.GetServingSession();
+
+  // A partly restored shadow session is dropped rather than published.
+  version.delta_ckpt_name = "delta_1";
+  mgr.FailRestores(0, 1);
+  EXPECT_FALSE(ApplyDeltaModel(&mgr, version, &config).ok());
+  EXPECT_EQ(serving_session, mgr.GetServingSession());
+  EXPECT_EQ(nullptr, mgr.GetShadowSession());
+
+  // Then delta model is updated in place.
+  EXPECT_TRUE(ApplyDeltaModel(&mgr, version, &config).ok());
+  EXPECT_EQ(serving_session, mgr.GetServingSession());
+  EXPECT_EQ(nullptr, mgr.GetShadowSession());
+}
+
+TEST_F(ModelSessionMgrTest, DoubleBufferDeltaUpdateFailedCatchUp) {
+  MetaGraphDef test_graph_def;
+  SessionOptions sess_options;
+  RunOptions run_options;
+  TestableModelSessionMgr mgr(test_graph_def, &sess_options, &run_options);
+  ModelConfig config = CreateValidModelConfig();
+
+  Version version;
+  version.full_ckpt_name = "full";
+  EXPECT_TRUE(CreateDoubleBufferedSessions(&mgr, version, &config).ok());
+  void* shadow_session = mgr.GetShadowSession();
+
+  // Catch up fails, the shadow session is rebuilt from checkpoint.
+  version.delta_ckpt_name = "delta_1";
+  mgr.FailRestores(1, 1);
+  EXPECT_TRUE(ApplyDeltaModel(&mgr, version, &config).ok());
+  EXPECT_EQ(shadow_session, mgr.GetServingSession());
+  EXPECT_TRUE(mgr.GetShadowSession() != nullptr);
+  EXPECT_NE(mgr.GetServingSession(), mgr.GetShadowSession());
+}
+
+TEST_F(ModelSessionMgrTest, DoubleBufferDeltaUpdateFailedRebuild) {
+  MetaGraphDef test_graph_def;
+  SessionOptions sess_options;
+  RunOptions run_options;
+  TestableModelSessionMgr mgr(test_graph_def, &sess_options, &run_options);
+  ModelConfig config = CreateValidModelConfig();
+
+  Version version;
+  version.full_ckpt_name = "full";
+  EXPECT_TRUE(CreateDoubleBufferedSessions(&mgr, version, &config).ok());
+  void* shadow_session = mgr.GetShadowSession();
+
+  // Both catch up and rebuild fail, no stale shadow session is kept.
+  version.delta_ckpt_name = "delta_1";
+  mgr.FailRestores(1, 2);
+  EXPECT_FALSE(ApplyDeltaModel(&mgr, version, &config).ok());
+  EXPECT_EQ(shadow_session, mgr.GetServingSession());
+  EXPECT_EQ(nullptr, mgr.GetShadowSession());
+
+  // Next delta model is updated in place, until a rebuild succeeds.
+  version.delta_ckpt_name = "delta_2";
+  EXPECT_TRUE(ApplyDeltaModel(&mgr, version, &config).ok());
+  EXPECT_EQ(shadow_session, mgr.GetServingSession());
+  EXPECT_TRUE(mgr.CreateShadowSession(version, &config).ok());
+  EXPECT_TRUE(mgr.GetShadowSession() != nullptr);
+}
+
 } // processor
 } // tensorflow
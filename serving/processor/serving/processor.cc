@@ -99,4 +99,13 @@ int get_serving_model_info(
   return 200;
 }
 
+int get_serving_stats(
+    void* model_buf, void** output_data, int* output_size) {
+  auto model = static_cast<tensorflow::processor::Model*>(model_buf);
+  auto stats = model->GetServingStats();
+  *output_data = strndup(stats.c_str(), stats.length());
+  *output_size = stats.length();
+  return 200;
+}
+
 } // extern "C"
@@ -0,0 +1,98 @@
+#ifndef SERVING_PROCESSOR_SERVING_SERVING_EPOCH_H
+#define SERVING_PROCESSOR_SERVING_SERVING_EPOCH_H
+
+#include <atomic>
+#include "tensorflow/core/platform/env.h"
+
+namespace tensorflow {
+namespace processor {
+
+// Read-copy-update style epochs for objects published to the serving
+// threads, e.g. the serving ModelSession. Readers never block, writers
+// publish a new object with an atomic swap and call Synchronize()
+// before reclaiming the old one.
+//
+// Reader counters are striped over cache lines and split by epoch
+// parity. Synchronize() flips the parity twice and waits for the old
+// parity counters to drain each time, so any reader which may hold an
+// object published before the call has exited when it returns.
+class ServingEpoch {
+ public:
+  ServingEpoch() : epoch_(0) {
+    for (int i = 0; i < kNumStripes; ++i) {
+      stripes_[i].readers[0] = 0;
+      stripes_[i].readers[1] = 0;
+    }
+  }
+
+  ServingEpoch(const ServingEpoch&) = delete;
+  ServingEpoch& operator=(const ServingEpoch&) = delete;
+
+  // Returns a token which must be passed to Exit().
+  int Enter() {
+    int stripe = ThreadStripe();
+    int parity = epoch_.load() & 1;
+    stripes_[stripe].readers[parity].fetch_add(1);
+    return (stripe << 1) | parity;
+  }
+
+  void Exit(int token) {
+    stripes_[token >> 1].readers[token & 1].fetch_sub(1);
+  }
+
+  // Blocks until all the readers entered before this call exit.
+  // Only one writer is expected to call this at a time.
+  void Synchronize() {
+    for (int i = 0; i < 2; ++i) {
+      int parity = epoch_.fetch_add(1) & 1;
+      WaitForReaders(parity);
+    }
+  }
+
+  class ReadLock {
+   public:
+    explicit ReadLock(ServingEpoch* epoch)
+        : epoch_(epoch), token_(epoch->Enter()) {}
+    ~ReadLock() { epoch_->Exit(token_); }
+
+    ReadLock(const ReadLock&) = delete;
+    ReadLock& operator=(const ReadLock&) = delete;
+
+   private:
+    ServingEpoch* epoch_;
+    int token_;
+  };
+
+ private:
+  static constexpr int kNumStripes = 64;
+  static constexpr int kWaitMicros = 100;
+
+  struct alignas(64) Stripe {
+    std::atomic<int64> readers[2];
+  };
+
+  static int ThreadStripe() {
+    static std::atomic<int> counter{0};
+    static thread_local int stripe = -1;
+    if (stripe == -1) {
+      stripe = counter.fetch_add(1) % kNumStripes;
+    }
+    return stripe;
+  }
+
+  void WaitForReaders(int parity) {
+    for (int i = 0; i < kNumStripes; ++i) {
+      while (stripes_[i].readers[parity].load() > 0) {
+        Env::Default()->SleepForMicroseconds(kWaitMicros);
+      }
+    }
+  }
+
+  std::atomic<int64> epoch_;
+  Stripe stripes_[kNumStripes];
+};
+
+} // processor
+} // tensorflow
+
+#endif // SERVING_PROCESSOR_SERVING_SERVING_EPOCH_H
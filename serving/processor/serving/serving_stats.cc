@@ -0,0 +1,159 @@
+#include "serving/processor/serving/serving_stats.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+
+#include <algorithm>
+#include <limits>
+#include <vector>
+
+namespace tensorflow {
+namespace processor {
+namespace {
+
+const char* kStageNames[] = {
+  "parse",
+  "feature_store_lookup",
+  "session_queue",
+  "session_run",
+  "serialize",
+};
+
+// Timeline label of a node is "node_name = OpType(inputs...)".
+std::string OpType(const NodeExecStats& node_stats) {
+  const std::string& label = node_stats.timeline_label();
+  auto begin = label.find(" = ");
+  if (begin == std::string::npos) {
+    return node_stats.node_name();
+  }
+  begin += 3;
+  auto end = label.find('(', begin);
+  return label.substr(begin, end == std::string::npos ?
+                             std::string::npos : end - begin);
+}
+
+} // namespace
+
+LatencyHistogram::LatencyHistogram() : count_(0), sum_(0), max_(0) {
+  for (int i = 0; i < kNumBuckets; ++i) {
+    buckets_[i] = 0;
+  }
+}
+
+int LatencyHistogram::BucketIndex(int64 micros) {
+  if (micros < kSubBuckets) {
+    return std::max<int64>(micros, 0);
+  }
+  int msb = 63 - __builtin_clzll(micros);
+  int sub = (micros >> (msb - kSubBucketBits)) & (kSubBuckets - 1);
+  int index = (msb - kSubBucketBits + 1) * kSubBuckets + sub;
+  return std::min(index, kNumBuckets - 1);
+}
+
+int64 LatencyHistogram::BucketUpperBound(int index) {
+  if (index == kNumBuckets - 1) {
+    return std::numeric_limits<int64>::max();
+  }
+  int next = index + 1;
+  if (next < kSubBuckets) {
+    return next - 1;
+  }
+  int msb = next / kSubBuckets + kSubBucketBits - 1;
+  int sub = next % kSubBuckets;
+  return (static_cast<int64>(kSubBuckets + sub) <<
+          (msb - kSubBucketBits)) - 1;
+}
+
+void LatencyHistogram::Record(int64 micros) {
+  buckets_[BucketIndex(micros)].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+  sum_.fetch_add(micros, std::memory_order_relaxed);
+  int64 prev_max = max_.load(std::memory_order_relaxed);
+  while (micros > prev_max &&
+         !max_.compare_exchange_weak(prev_max, micros,
+                                     std::memory_order_relaxed)) {
+  }
+}
+
+int64 LatencyHistogram::Percentile(double p) const {
+  int64 total = Count();
+  if (total == 0) return 0;
+  int64 rank = std::max<int64>(1, static_cast<int64>(total * p + 0.5));
+  int64 seen = 0;
+  for (int i = 0; i < kNumBuckets; ++i) {
+    seen += buckets_[i].load(std::memory_order_relaxed);
+    if (seen >= rank) {
+      return std::min(BucketUpperBound(i), Max());
+    }
+  }
+  return Max();
+}
+
+std::string LatencyHistogram::ToJson() const {
+  int64 count = Count();
+  return strings::StrCat(
+      "{\"count\":", count,
+      ",\"avg_us\":", count > 0 ? Sum() / count : 0,
+      ",\"p50_us\":", Percentile(0.5),
+      ",\"p90_us\":", Percentile(0.9),
+      ",\"p99_us\":", Percentile(0.99),
+      ",\"max_us\":", Max(), "}");
+}
+
+ServingStats* ServingStats::Get() {
+  static ServingStats stats;
+  return &stats;
+}
+
+void ServingStats::RecordStepStats(const StepStats& step_stats,
+                                   int64 run_start_micros) {
+  int64 first_start = std::numeric_limits<int64>::max();
+  mutex_lock lock(mu_);
+  for (auto& dev_stats : step_stats.dev_stats()) {
+    for (auto& node_stats : dev_stats.node_stats()) {
+      first_start = std::min(first_start, node_stats.all_start_micros());
+      auto& op = op_stats_[OpType(node_stats)];
+      int64 micros = node_stats.all_end_rel_micros();
+      ++op.count;
+      op.total_micros += micros;
+      op.max_micros = std::max(op.max_micros, micros);
+    }
+  }
+  if (first_start != std::numeric_limits<int64>::max() &&
+      first_start >= run_start_micros) {
+    Record(ServingStage::kSessionQueue, first_start - run_start_micros);
+  }
+}
+
+std::string ServingStats::ToJson() {
+  std::string json = "{\"stages\":{";
+  for (int i = 0; i < static_cast<int>(ServingStage::kNumStages); ++i) {
+    if (i > 0) json += ",";
+    strings::StrAppend(&json, "\"", kStageNames[i], "\":",
+                       stages_[i].ToJson());
+  }
+  json += "},\"ops\":[";
+
+  std::vector<std::pair<std::string, OpStats>> ops;
+  {
+    mutex_lock lock(mu_);
+    ops.assign(op_stats_.begin(), op_stats_.end());
+  }
+  std::sort(ops.begin(), ops.end(),
+            [](const std::pair<std::string, OpStats>& a,
+               const std::pair<std::string, OpStats>& b) {
+              return a.second.total_micros > b.second.total_micros;
+            });
+  for (size_t i = 0; i < ops.size(); ++i) {
+    if (i > 0) json += ",";
+    const OpStats& op = ops[i].second;
+    strings::StrAppend(&json, "{\"op\":\"", ops[i].first,
+        "\",\"count\":", op.count,
+        ",\"avg_us\":", op.total_micros / op.count,
+        ",\"max_us\":", op.max_micros,
+        ",\"total_us\":", op.total_micros, "}");
+  }
+  json += "]}";
+  return json;
+}
+
+} // processor
+} // tensorflow
@@ -0,0 +1,129 @@
+#ifndef SERVING_PROCESSOR_SERVING_SERVING_STATS_H
+#define SERVING_PROCESSOR_SERVING_SERVING_STATS_H
+
+#include <atomic>
+#include <string>
+#include <unordered_map>
+
+#include "tensorflow/core/framework/step_stats.pb.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace processor {
+
+// Lock-free latency histogram in microseconds. Each power of two range
+// is split into 4 buckets, so the relative error of percentiles is
+// under 25%.
+class LatencyHistogram {
+ public:
+  LatencyHistogram();
+
+  LatencyHistogram(const LatencyHistogram&) = delete;
+  LatencyHistogram& operator=(const LatencyHistogram&) = delete;
+
+  void Record(int64 micros);
+
+  int64 Count() const { return count_.load(std::memory_order_relaxed); }
+  int64 Sum() const { return sum_.load(std::memory_order_relaxed); }
+  int64 Max() const { return max_.load(std::memory_order_relaxed); }
+  // Returns the upper bound of the bucket the p-th (0 < p <= 1)
+  // sample falls into.
+  int64 Percentile(double p) const;
+
+  // {"count":..,"avg_us":..,"p50_us":..,"p90_us":..,"p99_us":..,"max_us":..}
+  std::string ToJson() const;
+
+ private:
+  static constexpr int kSubBucketBits = 2;
+  static constexpr int kSubBuckets = 1 << kSubBucketBits;
+  static constexpr int kNumBuckets = 160;
+
+  static int BucketIndex(int64 micros);
+  static int64 BucketUpperBound(int index);
+
+  std::atomic<int64> buckets_[kNumBuckets];
+  std::atomic<int64> count_;
+  std::atomic<int64> sum_;
+  std::atomic<int64> max_;
+};
+
+enum class ServingStage {
+  kParse = 0,
+  kFeatureStoreLookup,
+  kSessionQueue,
+  kSessionRun,
+  kSerialize,
+  kNumStages
+};
+
+// Process wide serving statistics: latency histograms of each stage of
+// a request, and per op type aggregates from sampled step stats.
+class ServingStats {
+ public:
+  static ServingStats* Get();
+
+  void Record(ServingStage stage, int64 micros) {
+    stages_[static_cast<int>(stage)].Record(micros);
+  }
+
+  // Collect step stats of one of every `interval` session runs,
+  // 0 disables it.
+  void SetStepStatsSampleInterval(int64 interval) {
+    sample_interval_ = interval;
+  }
+  bool NeedSampleStepStats() {
+    int64 interval = sample_interval_.load(std::memory_order_relaxed);
+    return interval > 0 &&
+           sample_counter_.fetch_add(1, std::memory_order_relaxed) %
+               interval == 0;
+  }
+
+  // `run_start_micros` is the time the session run was issued, the
+  // delay until the first node starts is recorded as session queueing.
+  void RecordStepStats(const StepStats& step_stats, int64 run_start_micros);
+
+  // Json of all the stage histograms and the op type aggregates, ops
+  // are sorted by total time.
+  std::string ToJson();
+
+ private:
+  ServingStats() : sample_interval_(0), sample_counter_(0) {}
+
+  struct OpStats {
+    int64 count = 0;
+    int64 total_micros = 0;
+    int64 max_micros = 0;
+  };
+
+  LatencyHistogram stages_[static_cast<int>(ServingStage::kNumStages)];
+  std::atomic<int64> sample_interval_;
+  std::atomic<int64> sample_counter_;
+
+  mutex mu_;
+  std::unordered_map<std::string, OpStats> op_stats_ GUARDED_BY(mu_);
+};
+
+// Records the time from construction to destruction into `stage`.
+class ScopedStageTimer {
+ public:
+  explicit ScopedStageTimer(ServingStage stage)
+      : stage_(stage), start_(Env::Default()->NowMicros()) {}
+  ~ScopedStageTimer() {
+    ServingStats::Get()->Record(stage_,
+        Env::Default()->NowMicros() - start_);
+  }
+
+  ScopedStageTimer(const ScopedStageTimer&) = delete;
+  ScopedStageTimer& operator=(const ScopedStageTimer&) = delete;
+
+ private:
+  ServingStage stage_;
+  uint64 start_;
+};
+
+} // processor
+} // tensorflow
+
+#endif // SERVING_PROCESSOR_SERVING_SERVING_STATS_H
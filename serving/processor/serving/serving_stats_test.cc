@@ -0,0 +1,83 @@
+#include "gtest/gtest.h"
+#include "serving/processor/serving/serving_stats.h"
+#include <thread>
+#include <vector>
+
+namespace tensorflow {
+namespace processor {
+
+class ServingStatsTest : public ::testing::Test {
+};
+
+TEST_F(ServingStatsTest, HistogramPercentileWithinBucketError) {
+  LatencyHistogram histogram;
+  for (int64 i = 1; i <= 1000; ++i) {
+    histogram.Record(i);
+  }
+
+  EXPECT_EQ(1000, histogram.Count());
+  EXPECT_EQ(500500, histogram.Sum());
+  EXPECT_EQ(1000, histogram.Max());
+  int64 p50 = histogram.Percentile(0.5);
+  EXPECT_GE(p50, 500);
+  EXPECT_LE(p50, 625);
+  int64 p99 = histogram.Percentile(0.99);
+  EXPECT_GE(p99, 990);
+  EXPECT_LE(p99, 1000);
+}
+
+TEST_F(ServingStatsTest, HistogramConcurrentRecord) {
+  LatencyHistogram histogram;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < 8; ++i) {
+    threads.emplace_back([&histogram]() {
+      for (int64 j = 0; j < 10000; ++j) {
+        histogram.Record(j % 100);
+      }
+    });
+  }
+  for (auto& t : threads) t.join();
+
+  EXPECT_EQ(80000, histogram.Count());
+  EXPECT_EQ(99, histogram.Max());
+}
+
+TEST_F(ServingStatsTest, AggregateStepStatsByOpType) {
+  StepStats step_stats;
+  auto dev_stats = step_stats.add_dev_stats();
+  auto node = dev_stats->add_node_stats();
+  node->set_node_name("dense/MatMul");
+  node->set_timeline_label("dense/MatMul = MatMul(input, dense/kernel)");
+  node->set_all_start_micros(110);
+  node->set_all_end_rel_micros(30);
+  node = dev_stats->add_node_stats();
+  node->set_node_name("dense_1/MatMul");
+  node->set_timeline_label("dense_1/MatMul = MatMul(dense/Relu, kernel)");
+  node->set_all_start_micros(150);
+  node->set_all_end_rel_micros(10);
+
+  ServingStats::Get()->RecordStepStats(step_stats, 100);
+  auto json = ServingStats::Get()->ToJson();
+  EXPECT_NE(std::string::npos, json.find(
+      "{\"op\":\"MatMul\",\"count\":2,\"avg_us\":20,"
+      "\"max_us\":30,\"total_us\":40}"));
+  EXPECT_NE(std::string::npos, json.find("\"session_queue\":{\"count\":1,"));
+}
+
+TEST_F(ServingStatsTest, StepStatsSampling) {
+  // Off unless stats_sample_interval is configured.
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_FALSE(ServingStats::Get()->NeedSampleStepStats());
+  }
+
+  ServingStats::Get()->SetStepStatsSampleInterval(3);
+  int sampled = 0;
+  for (int i = 0; i < 9; ++i) {
+    if (ServingStats::Get()->NeedSampleStepStats()) ++sampled;
+  }
+  EXPECT_EQ(3, sampled);
+  ServingStats::Get()->SetStepStatsSampleInterval(0);
+}
+
+} // processor
+} // tensorflow
@@ -0,0 +1,130 @@
+#include "serving/processor/serving/traffic_warmup.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_util.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/logging.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace tensorflow {
+namespace processor {
+namespace {
+
+Request CopyRequest(const Request& req) {
+  Request copy;
+  copy.inputs.reserve(req.inputs.size());
+  for (auto& input : req.inputs) {
+    copy.inputs.emplace_back(input.first, tensor::DeepCopy(input.second));
+  }
+  copy.output_tensor_names = req.output_tensor_names;
+  return copy;
+}
+
+int64 Percentile(std::vector<int64>* latencies, double p) {
+  if (latencies->empty()) return 0;
+  size_t idx = std::min(latencies->size() - 1,
+      static_cast<size_t>(latencies->size() * p));
+  std::nth_element(latencies->begin(), latencies->begin() + idx,
+                   latencies->end());
+  return (*latencies)[idx];
+}
+
+} // namespace
+
+RequestRecorder::RequestRecorder(int capacity, int sample_interval)
+    : capacity_(std::max(capacity, 1)),
+      sample_interval_(std::max(sample_interval, 1)),
+      counter_(0) {
+}
+
+void RequestRecorder::Record(const Request& req) {
+  if (counter_.fetch_add(1, std::memory_order_relaxed) %
+      sample_interval_ != 0) {
+    return;
+  }
+
+  // Copy outside of the lock, serving threads only contend on the slot.
+  Request copy = CopyRequest(req);
+  mutex_lock lock(mu_);
+  if (samples_.size() < capacity_) {
+    samples_.emplace_back(std::move(copy));
+  } else {
+    samples_[next_] = std::move(copy);
+  }
+  next_ = (next_ + 1) % capacity_;
+}
+
+std::vector<Request> RequestRecorder::Samples() {
+  mutex_lock lock(mu_);
+  return samples_;
+}
+
+Status TrafficWarmup(const std::vector<Request>& requests,
+                     const TrafficWarmupOptions& options,
+                     thread::ThreadPool* pool,
+                     const std::function<Status(Request&, Response&)>& predict) {
+  int64 prev_p99 = 0;
+  for (int round = 0; round < options.max_rounds; ++round) {
+    std::vector<int64> latencies(requests.size(), 0);
+    std::vector<Status> status(requests.size());
+    BlockingCounter counter(requests.size());
+    for (size_t i = 0; i < requests.size(); ++i) {
+      pool->Schedule([&requests, &latencies, &status, &counter,
+                      &predict, i]() {
+        // Request may be modified by predict, e.g. remote predict
+        // appends storage inputs.
+        Call call;
+        call.request = requests[i];
+        uint64 start = Env::Default()->NowMicros();
+        status[i] = predict(call.request, call.response);
+        latencies[i] = Env::Default()->NowMicros() - start;
+        counter.DecrementCount();
+      });
+    }
+    counter.Wait();
+
+    size_t failed = 0;
+    std::vector<int64> succeeded;
+    succeeded.reserve(requests.size());
+    for (size_t i = 0; i < requests.size(); ++i) {
+      if (status[i].ok()) {
+        succeeded.emplace_back(latencies[i]);
+      } else {
+        ++failed;
+      }
+    }
+    if (succeeded.empty()) {
+      if (round == 0) {
+        return Status(error::Code::INTERNAL,
+            "[TensorFlow] All recorded warmup requests failed, last error: " +
+            status.back().error_message());
+      }
+      break;
+    }
+
+    int64 p50 = Percentile(&succeeded, 0.5);
+    int64 p99 = Percentile(&succeeded, 0.99);
+    LOG(INFO) << "[Model Instance] Traffic warmup round " << round
+              << ", requests: " << requests.size()
+              << ", failed: " << failed
+              << ", p50: " << p50 << "us, p99: " << p99 << "us";
+
+    bool under_threshold = options.latency_threshold_us <= 0 ||
+                           p99 <= options.latency_threshold_us;
+    bool stable = round > 0 &&
+        std::abs(p99 - prev_p99) <= prev_p99 * options.stable_ratio;
+    if (under_threshold && stable) {
+      return Status::OK();
+    }
+    prev_p99 = p99;
+  }
+
+  LOG(WARNING) << "[Model Instance] Traffic warmup latency didn't stabilize "
+               << "in " << options.max_rounds << " rounds.";
+  return Status::OK();
+}
+
+} // processor
+} // tensorflow
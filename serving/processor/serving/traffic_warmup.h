@@ -0,0 +1,67 @@
+#ifndef SERVING_PROCESSOR_SERVING_TRAFFIC_WARMUP_H
+#define SERVING_PROCESSOR_SERVING_TRAFFIC_WARMUP_H
+
+#include <atomic>
+#include <functional>
+#include <vector>
+
+#include "serving/processor/serving/model_message.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+
+namespace tensorflow {
+namespace processor {
+
+// Keeps a sample of recent live requests in a ring buffer, they're
+// replayed against a newly loaded model before it serves. Sampled
+// requests are deep copied, so they don't pin the decoding buffers.
+class RequestRecorder {
+ public:
+  // Records one of every `sample_interval` requests, the latest
+  // `capacity` sampled requests are kept.
+  RequestRecorder(int capacity, int sample_interval);
+
+  RequestRecorder(const RequestRecorder&) = delete;
+  RequestRecorder& operator=(const RequestRecorder&) = delete;
+
+  void Record(const Request& req);
+
+  // Returns a copy of the kept requests.
+  std::vector<Request> Samples();
+
+ private:
+  const size_t capacity_;
+  const int64 sample_interval_;
+  std::atomic<int64> counter_;
+
+  mutex mu_;
+  std::vector<Request> samples_ GUARDED_BY(mu_);
+  size_t next_ GUARDED_BY(mu_) = 0;
+};
+
+struct TrafficWarmupOptions {
+  // Max rounds of replaying all the sampled requests.
+  int max_rounds = 10;
+  // Warmup is done when p99 latency of a round is under this,
+  // 0 means no limit.
+  int64 latency_threshold_us = 0;
+  // and differs from p99 latency of the previous round less than
+  // this ratio.
+  double stable_ratio = 0.1;
+};
+
+// Replays `requests` in parallel on `pool` with `predict` round by round,
+// until the latency of a round is stable under the threshold or
+// max_rounds is reached. Returns error only when all requests of the
+// first round failed, e.g. the new model rejects the recorded traffic.
+Status TrafficWarmup(const std::vector<Request>& requests,
+                     const TrafficWarmupOptions& options,
+                     thread::ThreadPool* pool,
+                     const std::function<Status(Request&, Response&)>& predict);
+
+} // processor
+} // tensorflow
+
+#endif // SERVING_PROCESSOR_SERVING_TRAFFIC_WARMUP_H
@@ -0,0 +1,86 @@
+#include "gtest/gtest.h"
+#include "serving/processor/serving/traffic_warmup.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/env.h"
+#include <algorithm>
+
+namespace tensorflow {
+namespace processor {
+
+class TrafficWarmupTest : public ::testing::Test {
+ protected:
+  Request CreateRequest(int64 value) {
+    Request req;
+    Tensor t(DT_INT64, TensorShape({1}));
+    t.flat<int64>()(0) = value;
+    req.inputs.emplace_back("input", t);
+    req.output_tensor_names.emplace_back("output");
+    return req;
+  }
+};
+
+TEST_F(TrafficWarmupTest, RecorderKeepLatestSampledRequests) {
+  RequestRecorder recorder(/*capacity*/3, /*sample_interval*/2);
+  for (int64 i = 0; i < 10; ++i) {
+    recorder.Record(CreateRequest(i));
+  }
+
+  // 0, 2, 4, 6, 8 are sampled, the latest 3 are kept.
+  auto samples = recorder.Samples();
+  ASSERT_EQ(3, samples.size());
+  std::vector<int64> values;
+  for (auto& req : samples) {
+    values.emplace_back(req.inputs[0].second.flat<int64>()(0));
+  }
+  std::sort(values.begin(), values.end());
+  EXPECT_EQ(std::vector<int64>({4, 6, 8}), values);
+}
+
+TEST_F(TrafficWarmupTest, RecorderDeepCopyRequest) {
+  RequestRecorder recorder(1, 1);
+  Request req = CreateRequest(1);
+  recorder.Record(req);
+  req.inputs[0].second.flat<int64>()(0) = 2;
+
+  auto samples = recorder.Samples();
+  ASSERT_EQ(1, samples.size());
+  EXPECT_EQ(1, samples[0].inputs[0].second.flat<int64>()(0));
+}
+
+TEST_F(TrafficWarmupTest, ReplayUntilLatencyStable) {
+  std::vector<Request> requests;
+  for (int64 i = 0; i < 8; ++i) {
+    requests.emplace_back(CreateRequest(i));
+  }
+
+  thread::ThreadPool pool(Env::Default(), "test", 4);
+  std::atomic<int> calls(0);
+  TrafficWarmupOptions options;
+  options.max_rounds = 10;
+  options.stable_ratio = 1.0;
+  EXPECT_TRUE(TrafficWarmup(requests, options, &pool,
+      [&calls](Request& req, Response& resp) {
+        ++calls;
+        Env::Default()->SleepForMicroseconds(1000);
+        return Status::OK();
+      }).ok());
+
+  // Latency is stable from the second round.
+  EXPECT_EQ(2 * 8, calls.load());
+}
+
+TEST_F(TrafficWarmupTest, ShouldFailedWhenAllRequestsFailed) {
+  std::vector<Request> requests;
+  requests.emplace_back(CreateRequest(0));
+
+  thread::ThreadPool pool(Env::Default(), "test", 2);
+  TrafficWarmupOptions options;
+  EXPECT_FALSE(TrafficWarmup(requests, options, &pool,
+      [](Request& req, Response& resp) {
+        return errors::InvalidArgument("invalid input");
+      }).ok());
+}
+
+} // processor
+} // tensorflow
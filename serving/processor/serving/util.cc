@@ -501,14 +501,48 @@ Tensor Proto2Tensor(const eas::ArrayProto& input) {
   return Tensor();
 }
 
+Status Proto2Tensor(eas::ArrayProto* input, Tensor* tensor) {
+  if (input->dtype() != tensorflow::eas::DT_STRING) {
+    *tensor = Proto2Tensor(*input);
+    return Status::OK();
+  }
+
+  TensorShape tensor_shape;
+  int64 total_size = 1;
+  for (int i = 0; i < input->array_shape().dim_size(); ++i) {
+    tensor_shape.AddDim(input->array_shape().dim(i));
+    total_size *= input->array_shape().dim(i);
+  }
+  if (total_size != input->string_val_size()) {
+    return errors::InvalidArgument("Invalid input, shape ",
+        tensor_shape.DebugString(), " but ", input->string_val_size(),
+        " strings.");
+  }
+  *tensor = Tensor(tensorflow::DT_STRING, tensor_shape);
+  auto flat = tensor->flat<std::string>();
+  auto string_val = input->mutable_string_val();
+  for (int i = 0; i < input->string_val_size(); i++) {
+    flat(i).swap(*string_val->Mutable(i));
+  }
+  return Status::OK();
+}
+
 eas::PredictResponse Tensor2Response(const processor::Request& req,
     const processor::Response& resp) {
   eas::PredictResponse response;
+  Tensor2Response(req, resp, &response);
+  return response;
+}
+
+void Tensor2Response(const processor::Request& req,
+                     const processor::Response& resp,
+                     eas::PredictResponse* response) {
   const auto& output_tensor_names = req.output_tensor_names;
   const auto & outputs = resp.outputs;
 
   for (size_t i = 0; i < outputs.size(); ++i) {
-    eas::ArrayProto output;
+    eas::ArrayProto& output =
+        (*response->mutable_outputs())[output_tensor_names[i]];
     int64 total_dim_size = 1;
     for (int j = 0; j < outputs[i].dims(); ++j) {
       int64 dim_size = outputs[i].dim_size(j);
@@ -520,25 +554,28 @@ eas::PredictResponse Tensor2Response(const processor::Request& req,
       case DT_FLOAT: {
         output.set_dtype(eas::DT_FLOAT);
         auto flat = outputs[i].flat<float>();
-        for (int64 j = 0; j < total_dim_size; ++j) {
-          output.add_float_val(flat(j));
-        }
+        auto val = output.mutable_float_val();
+        val->Resize(total_dim_size, 0);
+        memcpy(val->mutable_data(), flat.data(),
+            total_dim_size * sizeof(float));
         break;
       }
       case DT_DOUBLE: {
         output.set_dtype(eas::DT_DOUBLE);
         auto flat = outputs[i].flat<double>();
-        for (int64 j = 0; j < total_dim_size; ++j) {
-          output.add_double_val(flat(j));
-        }
+        auto val = output.mutable_double_val();
+        val->Resize(total_dim_size, 0);
+        memcpy(val->mutable_data(), flat.data(),
+            total_dim_size * sizeof(double));
         break;
       }
       case DT_INT32: {
         output.set_dtype(eas::DT_INT32);
         auto flat = outputs[i].flat<int>();
-        for (int64 j = 0; j < total_dim_size; ++j) {
-          output.add_int_val(flat(j));
-        }
+        auto val = output.mutable_int_val();
+        val->Resize(total_dim_size, 0);
+        memcpy(val->mutable_data(), flat.data(),
+            total_dim_size * sizeof(int));
         break;
       }
       case DT_UINT8: {
@@ -616,9 +653,10 @@ eas::PredictResponse Tensor2Response(const processor::Request& req,
       case DT_INT64: {
         output.set_dtype(eas::DT_INT64);
         auto flat = outputs[i].flat<int64>();
-        for (int64 j = 0; j < total_dim_size; ++j) {
-          output.add_int64_val(flat(j));
-        }
+        auto val = output.mutable_int64_val();
+        val->Resize(total_dim_size, 0);
+        memcpy(val->mutable_data(), flat.data(),
+            total_dim_size * sizeof(int64));
         break;
       }
       case DT_BOOL: {
@@ -684,9 +722,7 @@ eas::PredictResponse Tensor2Response(const processor::Request& req,
         LOG(ERROR) << "Output Tensor Not Support this DataType";
         break;
     }
-    (*response.mutable_outputs())[output_tensor_names[i]] = output;
   }
-  return response;
 }
 
 } // namespace util
@@ -74,9 +74,20 @@ Status RunRestore(const RunOptions& run_options,
 
 Tensor Proto2Tensor(const eas::ArrayProto& input);
 
+// Same as above, but string elements are moved out of `input`
+// instead of being copied. Returns InvalidArgument when the number
+// of strings doesn't match the shape.
+Status Proto2Tensor(eas::ArrayProto* input, Tensor* tensor);
+
 eas::PredictResponse Tensor2Response(
     const processor::Request& req,
     const processor::Response& resp);
+
+// Fill outputs into `response` in place, `response` may be
+// allocated on an arena.
+void Tensor2Response(const processor::Request& req,
+                     const processor::Response& resp,
+                     eas::PredictResponse* response);
  
 } // namespace util
 } // namespace processor
@@ -0,0 +1,166 @@
+"""Generates a WDL or DeepFM SavedModel with EmbeddingVariables for
+serving_benchmark.
+
+Inputs of the serving signature are `C1`..`C{num_sparse}` int64 ids of
+shape [batch] and `dense` float of shape [batch, num_dense], the output is
+`prob`. The model is trained a few steps on zipf distributed ids, so the
+EmbeddingVariables hold a realistic skewed set of keys.
+"""
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import argparse
+import os
+import sys
+
+import numpy as np
+import tensorflow as tf
+
+FLAGS = None
+
+
+def _sparse_names():
+  return ['C{}'.format(i + 1) for i in range(FLAGS.num_sparse)]
+
+
+_ZIPF_CDF = None
+
+
+def _zipf_ids(size):
+  # Same distribution as serving_benchmark: id r in [0, vocab) is drawn
+  # with probability proportional to 1 / (r + 1)^zipf.
+  global _ZIPF_CDF
+  if _ZIPF_CDF is None:
+    pdf = 1.0 / np.power(np.arange(1, FLAGS.vocab + 1), FLAGS.zipf)
+    _ZIPF_CDF = np.cumsum(pdf) / np.sum(pdf)
+  return np.minimum(np.searchsorted(_ZIPF_CDF, np.random.rand(size)),
+                    FLAGS.vocab - 1).astype(np.int64)
+
+
+def _mlp(net, hidden_units, name):
+  with tf.variable_scope(name):
+    for i, units in enumerate(hidden_units):
+      net = tf.layers.dense(net, units, activation=tf.nn.relu,
+                            name='layer{}'.format(i))
+  return net
+
+
+def _build_model(inputs):
+  embeddings = []
+  weights = []
+  for name in _sparse_names():
+    ids = inputs[name]
+    ev = tf.get_embedding_variable(
+        '{}_embedding'.format(name),
+        embedding_dim=FLAGS.embedding_dim,
+        key_dtype=tf.int64,
+        initializer=tf.truncated_normal_initializer(stddev=0.01))
+    embeddings.append(tf.nn.embedding_lookup(ev, ids))
+    w = tf.get_embedding_variable(
+        '{}_weight'.format(name),
+        embedding_dim=1,
+        key_dtype=tf.int64,
+        initializer=tf.zeros_initializer())
+    weights.append(tf.nn.embedding_lookup(w, ids))
+
+  dense = inputs['dense']
+  # [batch, num_sparse, embedding_dim]
+  stacked = tf.stack(embeddings, axis=1)
+  linear = tf.add_n(weights) + tf.layers.dense(dense, 1, name='dense_linear')
+
+  deep_input = tf.concat(
+      [tf.reshape(stacked, [-1, FLAGS.num_sparse * FLAGS.embedding_dim]),
+       dense], axis=1)
+  deep = tf.layers.dense(_mlp(deep_input, [256, 128, 64], 'dnn'), 1,
+                         name='dnn_logit')
+
+  if FLAGS.model == 'wdl':
+    logit = linear + deep
+  else:
+    # FM second order term: 0.5 * ((sum v)^2 - sum v^2)
+    sum_square = tf.square(tf.reduce_sum(stacked, axis=1))
+    square_sum = tf.reduce_sum(tf.square(stacked), axis=1)
+    fm = 0.5 * tf.reduce_sum(sum_square - square_sum, axis=1, keepdims=True)
+    logit = linear + fm + deep
+  return logit
+
+
+def _feed_dict(inputs, label):
+  feed = {inputs['dense']: np.random.rand(
+      FLAGS.batch_size, FLAGS.num_dense).astype(np.float32)}
+  for name in _sparse_names():
+    feed[inputs[name]] = _zipf_ids(FLAGS.batch_size)
+  feed[label] = np.random.randint(0, 2, (FLAGS.batch_size, 1)).astype(
+      np.float32)
+  return feed
+
+
+def main(_):
+  with tf.Session(graph=tf.Graph()) as sess:
+    inputs = {
+        name: tf.placeholder(tf.int64, [None], name=name)
+        for name in _sparse_names()
+    }
+    inputs['dense'] = tf.placeholder(tf.float32, [None, FLAGS.num_dense],
+                                     name='dense')
+    label = tf.placeholder(tf.float32, [None, 1], name='label')
+
+    logit = _build_model(inputs)
+    prob = tf.sigmoid(logit, name='prob')
+    loss = tf.reduce_mean(
+        tf.nn.sigmoid_cross_entropy_with_logits(labels=label, logits=logit))
+    global_step = tf.train.get_or_create_global_step()
+    train_op = tf.train.AdagradOptimizer(0.01).minimize(
+        loss, global_step=global_step)
+
+    sess.run(tf.global_variables_initializer())
+    for step in range(FLAGS.train_steps):
+      _, l = sess.run([train_op, loss], feed_dict=_feed_dict(inputs, label))
+      if step % 100 == 0:
+        print('step {}, loss {}'.format(step, l))
+
+    checkpoint_dir = os.path.join(FLAGS.checkpoint_dir, '1')
+    # ModelStore expects the delta model dir to exist.
+    tf.gfile.MakeDirs(os.path.join(checkpoint_dir, '.incremental_checkpoint'))
+    saver = tf.train.Saver(sharded=True)
+    saver.save(sess, os.path.join(checkpoint_dir, 'model.ckpt'),
+               global_step=global_step)
+
+    signature = tf.saved_model.signature_def_utils.predict_signature_def(
+        inputs=inputs, outputs={'prob': prob})
+    builder = tf.saved_model.builder.SavedModelBuilder(FLAGS.saved_model_dir)
+    builder.add_meta_graph_and_variables(
+        sess, [tf.saved_model.tag_constants.SERVING],
+        signature_def_map={
+            tf.saved_model.signature_constants
+            .DEFAULT_SERVING_SIGNATURE_DEF_KEY: signature
+        },
+        saver=saver)
+    builder.save()
+
+  print('SavedModel generated at: {}, checkpoint at: {}'.format(
+      FLAGS.saved_model_dir, checkpoint_dir))
+
+
+if __name__ == '__main__':
+  parser = argparse.ArgumentParser()
+  parser.add_argument('--model', type=str, default='deepfm',
+                      choices=['wdl', 'deepfm'])
+  parser.add_argument('--saved_model_dir', type=str,
+                      default='/tmp/benchmark/saved_model')
+  parser.add_argument('--checkpoint_dir', type=str,
+                      default='/tmp/benchmark/checkpoint',
+                      help='Parent checkpoint dir, the checkpoint is saved '
+                           'into checkpoint_dir/1.')
+  parser.add_argument('--num_sparse', type=int, default=26)
+  parser.add_argument('--num_dense', type=int, default=13)
+  parser.add_argument('--embedding_dim', type=int, default=16)
+  parser.add_argument('--vocab', type=int, default=1000000)
+  parser.add_argument('--zipf', type=float, default=1.2,
+                      help='Zipf exponent of the ids.')
+  parser.add_argument('--batch_size', type=int, default=512)
+  parser.add_argument('--train_steps', type=int, default=500)
+  FLAGS, unparsed = parser.parse_known_args()
+  tf.app.run(main=main, argv=[sys.argv[0]] + unparsed)
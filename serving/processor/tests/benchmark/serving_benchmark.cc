@@ -0,0 +1,516 @@
+// Load generator for the serving processor. It loads a model through
+// initialize() and drives process() or batch_process() with synthetic
+// requests of skewed ids, in closed-loop mode (a fixed number of clients
+// each sending the next request once the previous one returns) and
+// open-loop mode (requests arrive at a target rate with exponential
+// inter-arrival times, latency includes the time queued before being
+// sent). QPS and latency percentiles are reported for each concurrency
+// level or target rate, followed by the processor's get_serving_stats().
+//
+// See README for generating the model and running the benchmark.
+#include <stdlib.h>
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "serving/processor/serving/predict.pb.h"
+#include "serving/processor/serving/predict_generated.h"
+#include "serving/processor/serving/processor.h"
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/init_main.h"
+#include "tensorflow/core/util/command_line_flags.h"
+
+namespace tensorflow {
+namespace processor {
+namespace {
+
+struct BenchmarkFlags {
+  // Model
+  std::string model_config_file = "";
+  std::string savedmodel_dir = "/tmp/benchmark/saved_model";
+  std::string checkpoint_dir = "/tmp/benchmark/checkpoint";
+  std::string protocol = "protobuf";
+  int32 inter_threads = 8;
+  int32 intra_threads = 8;
+  int32 session_num = 1;
+
+  // Requests, must match generate_model.py
+  int32 num_sparse = 26;
+  int32 num_dense = 13;
+  int64 vocab = 1000000;
+  float zipf = 1.2;
+  int32 batch_size = 64;
+  int32 num_requests = 1000;
+
+  // Load
+  std::string mode = "closed";
+  std::string concurrency = "1,4,16,64";
+  std::string qps = "100,500,1000";
+  int32 open_loop_threads = 64;
+  int32 batch_process_size = 0;
+  int32 duration_secs = 10;
+  int32 warmup_secs = 5;
+};
+
+std::vector<int> ParseIntList(const std::string& list) {
+  std::vector<int> values;
+  for (auto& s : str_util::Split(list, ',', str_util::SkipEmpty())) {
+    int32 v;
+    if (strings::safe_strto32(s, &v) && v > 0) {
+      values.emplace_back(v);
+    } else {
+      LOG(FATAL) << "Invalid positive integer list: " << list;
+    }
+  }
+  return values;
+}
+
+std::string ModelConfigJson(const BenchmarkFlags& flags) {
+  if (!flags.model_config_file.empty()) {
+    std::string config;
+    TF_CHECK_OK(ReadFileToString(Env::Default(),
+        flags.model_config_file, &config));
+    return config;
+  }
+
+  return strings::StrCat("{",
+      "\"feature_store_type\": \"memory\",",
+      "\"serialize_protocol\": \"", flags.protocol, "\",",
+      "\"inter_op_parallelism_threads\": ", flags.inter_threads, ",",
+      "\"intra_op_parallelism_threads\": ", flags.intra_threads, ",",
+      "\"session_num\": ", flags.session_num, ",",
+      "\"init_timeout_minutes\": 10,",
+      "\"signature_name\": \"serving_default\",",
+      "\"model_store_type\": \"local\",",
+      "\"checkpoint_dir\": \"", flags.checkpoint_dir, "/\",",
+      "\"savedmodel_dir\": \"", flags.savedmodel_dir, "/\"",
+      "}");
+}
+
+// Id r in [0, vocab) is drawn with probability proportional to
+// 1 / (r + 1)^s, by binary searching the cdf.
+class ZipfGenerator {
+ public:
+  ZipfGenerator(int64 vocab, double s) : cdf_(vocab) {
+    double sum = 0;
+    for (int64 i = 0; i < vocab; ++i) {
+      sum += 1.0 / std::pow(static_cast<double>(i + 1), s);
+      cdf_[i] = sum;
+    }
+    for (auto& c : cdf_) c /= sum;
+  }
+
+  int64 Next(std::mt19937_64* rng) {
+    double u = uniform_(*rng);
+    auto it = std::lower_bound(cdf_.begin(), cdf_.end(), u);
+    return std::min<int64>(it - cdf_.begin(), cdf_.size() - 1);
+  }
+
+ private:
+  std::vector<double> cdf_;
+  std::uniform_real_distribution<double> uniform_{0.0, 1.0};
+};
+
+struct RequestData {
+  std::vector<std::vector<int64>> ids;  // [num_sparse][batch_size]
+  std::vector<float> dense;             // [batch_size * num_dense]
+};
+
+RequestData GenerateRequestData(const BenchmarkFlags& flags,
+                                ZipfGenerator* zipf,
+                                std::mt19937_64* rng) {
+  RequestData data;
+  data.ids.resize(flags.num_sparse);
+  for (auto& ids : data.ids) {
+    ids.resize(flags.batch_size);
+    for (auto& id : ids) id = zipf->Next(rng);
+  }
+  std::uniform_real_distribution<float> uniform(0.0, 1.0);
+  data.dense.resize(flags.batch_size * flags.num_dense);
+  for (auto& v : data.dense) v = uniform(*rng);
+  return data;
+}
+
+std::string EncodeProtobuf(const BenchmarkFlags& flags,
+                           const RequestData& data) {
+  eas::PredictRequest request;
+  request.set_signature_name("serving_default");
+  request.add_output_filter("prob:0");
+  for (int i = 0; i < flags.num_sparse; ++i) {
+    eas::ArrayProto input;
+    input.set_dtype(eas::DT_INT64);
+    input.mutable_array_shape()->add_dim(flags.batch_size);
+    input.mutable_int64_val()->Reserve(flags.batch_size);
+    for (auto id : data.ids[i]) input.add_int64_val(id);
+    (*request.mutable_inputs())[strings::StrCat("C", i + 1, ":0")] =
+        std::move(input);
+  }
+  eas::ArrayProto dense;
+  dense.set_dtype(eas::DT_FLOAT);
+  dense.mutable_array_shape()->add_dim(flags.batch_size);
+  dense.mutable_array_shape()->add_dim(flags.num_dense);
+  dense.mutable_float_val()->Reserve(data.dense.size());
+  for (auto v : data.dense) dense.add_float_val(v);
+  (*request.mutable_inputs())["dense:0"] = std::move(dense);
+
+  std::string buf;
+  request.SerializeToString(&buf);
+  return buf;
+}
+
+std::string EncodeFlatBuffer(const BenchmarkFlags& flags,
+                             const RequestData& data) {
+  flatbuffers::FlatBufferBuilder builder;
+  std::vector<flatbuffers::Offset<flatbuffers::String>> names;
+  std::vector<int> types;
+  std::vector<flatbuffers::Offset<eas::fb::ShapeType>> shapes;
+  std::vector<flatbuffers::Offset<eas::fb::ContentType>> contents;
+
+  auto add_input = [&](const std::string& name, int type,
+                       const std::vector<int64_t>& dims,
+                       const void* content, size_t size) {
+    names.emplace_back(builder.CreateString(name));
+    types.emplace_back(type);
+    shapes.emplace_back(
+        eas::fb::CreateShapeType(builder, builder.CreateVector(dims)));
+    // Aligned so that the processor aliases it, see predict.fbs.
+    builder.ForceVectorAlignment(size, sizeof(uint8_t), 64);
+    contents.emplace_back(eas::fb::CreateContentType(builder,
+        builder.CreateVector(static_cast<const uint8_t*>(content), size)));
+  };
+
+  for (int i = 0; i < flags.num_sparse; ++i) {
+    add_input(strings::StrCat("C", i + 1, ":0"), eas::DT_INT64,
+              {flags.batch_size}, data.ids[i].data(),
+              data.ids[i].size() * sizeof(int64));
+  }
+  add_input("dense:0", eas::DT_FLOAT, {flags.batch_size, flags.num_dense},
+            data.dense.data(), data.dense.size() * sizeof(float));
+
+  std::vector<flatbuffers::Offset<flatbuffers::String>> fetches = {
+      builder.CreateString("prob:0")};
+  builder.Finish(eas::fb::CreatePredictRequest(builder,
+      builder.CreateString("serving_default"),
+      builder.CreateVector(names),
+      builder.CreateVector(types),
+      builder.CreateVector(shapes),
+      builder.CreateVector(contents),
+      /*string_content_len*/0, /*string_content*/0,
+      builder.CreateVector(fetches)));
+  return std::string(reinterpret_cast<const char*>(
+      builder.GetBufferPointer()), builder.GetSize());
+}
+
+// Output buffers are allocated by new[] on success, by strndup otherwise.
+void FreeOutput(int state, void* output) {
+  if (state == 200) {
+    delete[] static_cast<char*>(output);
+  } else {
+    free(output);
+  }
+}
+
+class Client {
+ public:
+  Client(void* model, const std::vector<std::string>* requests,
+         int batch_process_size)
+      : model_(model), requests_(requests),
+        batch_process_size_(batch_process_size) {}
+
+  // Sends the idx-th request, or batch_process_size requests from it.
+  bool Call(size_t idx) {
+    if (batch_process_size_ <= 0) {
+      const std::string& req = (*requests_)[idx % requests_->size()];
+      void* output = nullptr;
+      int output_size = 0;
+      int state = process(model_, req.data(), req.size(),
+                          &output, &output_size);
+      FreeOutput(state, output);
+      return state == 200;
+    }
+
+    std::vector<const void*> input_data(batch_process_size_);
+    std::vector<int> input_size(batch_process_size_);
+    for (int i = 0; i < batch_process_size_; ++i) {
+      const std::string& req = (*requests_)[(idx + i) % requests_->size()];
+      input_data[i] = req.data();
+      input_size[i] = req.size();
+    }
+    std::vector<void*> output_data(batch_process_size_, nullptr);
+    std::vector<int> output_size(batch_process_size_, 0);
+    int state = batch_process(model_, input_data.data(), input_size.data(),
+                              output_data.data(), output_size.data());
+    for (auto output : output_data) FreeOutput(state, output);
+    return state == 200;
+  }
+
+ private:
+  void* model_;
+  const std::vector<std::string>* requests_;
+  int batch_process_size_;
+};
+
+struct LoadResult {
+  std::string label;
+  double seconds = 0;
+  int64 errors = 0;
+  std::vector<int64> latencies;  // micros
+};
+
+LoadResult RunClosedLoop(Client* client, int concurrency, int duration_secs) {
+  LoadResult result;
+  result.label = strings::StrCat("closed c=", concurrency);
+  std::vector<std::vector<int64>> latencies(concurrency);
+  std::atomic<int64> errors(0);
+  uint64 start = Env::Default()->NowMicros();
+  uint64 deadline = start + duration_secs * 1000000ull;
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < concurrency; ++t) {
+    threads.emplace_back([&, t]() {
+      size_t idx = t * 7919;
+      while (true) {
+        uint64 begin = Env::Default()->NowMicros();
+        if (begin >= deadline) break;
+        if (!client->Call(idx++)) ++errors;
+        latencies[t].emplace_back(Env::Default()->NowMicros() - begin);
+      }
+    });
+  }
+  for (auto& t : threads) t.join();
+
+  result.seconds = (Env::Default()->NowMicros() - start) / 1e6;
+  result.errors = errors;
+  for (auto& l : latencies) {
+    result.latencies.insert(result.latencies.end(), l.begin(), l.end());
+  }
+  return result;
+}
+
+LoadResult RunOpenLoop(Client* client, int qps, int num_threads,
+                       int duration_secs) {
+  LoadResult result;
+  result.label = strings::StrCat("open qps=", qps);
+  std::mutex mu;
+  std::condition_variable cv;
+  std::deque<uint64> arrivals;
+  bool done = false;
+  std::vector<std::vector<int64>> latencies(num_threads);
+  std::atomic<int64> errors(0);
+
+  std::vector<std::thread> workers;
+  for (int t = 0; t < num_threads; ++t) {
+    workers.emplace_back([&, t]() {
+      size_t idx = t * 7919;
+      while (true) {
+        uint64 arrival;
+        {
+          std::unique_lock<std::mutex> lock(mu);
+          cv.wait(lock, [&]() { return done || !arrivals.empty(); });
+          if (arrivals.empty()) break;
+          arrival = arrivals.front();
+          arrivals.pop_front();
+        }
+        if (!client->Call(idx++)) ++errors;
+        // Measured from the arrival, so a saturated server shows up as
+        // growing latency instead of a slower sending rate.
+        latencies[t].emplace_back(Env::Default()->NowMicros() - arrival);
+      }
+    });
+  }
+
+  std::mt19937_64 rng(qps);
+  std::exponential_distribution<double> interval(qps / 1e6);
+  uint64 start = Env::Default()->NowMicros();
+  uint64 deadline = start + duration_secs * 1000000ull;
+  double next = start;
+  while (next < deadline) {
+    uint64 now = Env::Default()->NowMicros();
+    if (now < next) {
+      uint64 wait = static_cast<uint64>(next) - now;
+      if (wait > 100) {
+        Env::Default()->SleepForMicroseconds(wait - 50);
+      } else {
+        std::this_thread::yield();
+      }
+      continue;
+    }
+    {
+      std::lock_guard<std::mutex> lock(mu);
+      arrivals.emplace_back(static_cast<uint64>(next));
+    }
+    cv.notify_one();
+    next += interval(rng);
+  }
+  {
+    std::lock_guard<std::mutex> lock(mu);
+    done = true;
+  }
+  cv.notify_all();
+  for (auto& t : workers) t.join();
+
+  result.seconds = (Env::Default()->NowMicros() - start) / 1e6;
+  result.errors = errors;
+  for (auto& l : latencies) {
+    result.latencies.insert(result.latencies.end(), l.begin(), l.end());
+  }
+  return result;
+}
+
+double PercentileMillis(const std::vector<int64>& sorted, double p) {
+  if (sorted.empty()) return 0;
+  size_t idx = std::min(sorted.size() - 1,
+                        static_cast<size_t>(sorted.size() * p));
+  return sorted[idx] / 1000.0;
+}
+
+void PrintHeader() {
+  printf("%-16s %10s %8s %10s %9s %9s %9s %9s %9s %9s\n", "load",
+         "requests", "errors", "qps", "avg(ms)", "p50(ms)", "p90(ms)",
+         "p99(ms)", "p999(ms)", "max(ms)");
+}
+
+void PrintResult(LoadResult* result) {
+  auto& l = result->latencies;
+  std::sort(l.begin(), l.end());
+  double avg = 0;
+  for (auto v : l) avg += v;
+  avg = l.empty() ? 0 : avg / l.size() / 1000.0;
+  printf("%-16s %10zu %8lld %10.1f %9.3f %9.3f %9.3f %9.3f %9.3f %9.3f\n",
+         result->label.c_str(), l.size(),
+         static_cast<long long>(result->errors), l.size() / result->seconds,
+         avg, PercentileMillis(l, 0.5), PercentileMillis(l, 0.9),
+         PercentileMillis(l, 0.99), PercentileMillis(l, 0.999),
+         l.empty() ? 0 : l.back() / 1000.0);
+  fflush(stdout);
+}
+
+int Run(const BenchmarkFlags& flags) {
+  if (flags.protocol != "protobuf" && flags.protocol != "flatbuffer") {
+    LOG(ERROR) << "Unknown protocol: " << flags.protocol;
+    return -1;
+  }
+  // batch_process() only parses protobuf requests.
+  if (flags.protocol == "flatbuffer" && flags.batch_process_size > 0) {
+    LOG(ERROR) << "--batch_process_size requires --protocol=protobuf.";
+    return -1;
+  }
+
+  int state = 0;
+  void* model = initialize("", ModelConfigJson(flags).c_str(), &state);
+  if (state != 0) {
+    LOG(ERROR) << "Initialize processor failed.";
+    return -1;
+  }
+
+  LOG(INFO) << "Generating " << flags.num_requests << " requests.";
+  ZipfGenerator zipf(flags.vocab, flags.zipf);
+  std::mt19937_64 rng(0);
+  std::vector<std::string> requests;
+  requests.reserve(flags.num_requests);
+  for (int i = 0; i < flags.num_requests; ++i) {
+    auto data = GenerateRequestData(flags, &zipf, &rng);
+    requests.emplace_back(flags.protocol == "protobuf" ?
+        EncodeProtobuf(flags, data) : EncodeFlatBuffer(flags, data));
+  }
+
+  Client client(model, &requests, flags.batch_process_size);
+  auto concurrency = ParseIntList(flags.concurrency);
+  if (flags.warmup_secs > 0) {
+    LOG(INFO) << "Warmup " << flags.warmup_secs << "s.";
+    RunClosedLoop(&client, *std::max_element(concurrency.begin(),
+                                             concurrency.end()),
+                  flags.warmup_secs);
+  }
+
+  PrintHeader();
+  if (flags.mode == "closed" || flags.mode == "both") {
+    for (int c : concurrency) {
+      auto result = RunClosedLoop(&client, c, flags.duration_secs);
+      PrintResult(&result);
+    }
+  }
+  if (flags.mode == "open" || flags.mode == "both") {
+    for (int q : ParseIntList(flags.qps)) {
+      auto result = RunOpenLoop(&client, q, flags.open_loop_threads,
+                                flags.duration_secs);
+      PrintResult(&result);
+    }
+  }
+
+  void* stats = nullptr;
+  int stats_size = 0;
+  if (get_serving_stats(model, &stats, &stats_size) == 200) {
+    std::cout << "serving stats: "
+              << std::string(static_cast<char*>(stats), stats_size)
+              << std::endl;
+    free(stats);
+  }
+  return 0;
+}
+
+} // namespace
+} // processor
+} // tensorflow
+
+int main(int argc, char** argv) {
+  tensorflow::processor::BenchmarkFlags flags;
+  std::vector<tensorflow::Flag> flag_list = {
+      tensorflow::Flag("model_config_file", &flags.model_config_file,
+          "json model config, overrides the model flags below"),
+      tensorflow::Flag("savedmodel_dir", &flags.savedmodel_dir,
+          "SavedModel dir of generate_model.py"),
+      tensorflow::Flag("checkpoint_dir", &flags.checkpoint_dir,
+          "parent checkpoint dir of generate_model.py"),
+      tensorflow::Flag("protocol", &flags.protocol,
+          "protobuf or flatbuffer"),
+      tensorflow::Flag("inter_threads", &flags.inter_threads,
+          "inter op threads"),
+      tensorflow::Flag("intra_threads", &flags.intra_threads,
+          "intra op threads"),
+      tensorflow::Flag("session_num", &flags.session_num,
+          "session num of the session group"),
+      tensorflow::Flag("num_sparse", &flags.num_sparse,
+          "number of sparse features"),
+      tensorflow::Flag("num_dense", &flags.num_dense,
+          "number of dense features"),
+      tensorflow::Flag("vocab", &flags.vocab, "id range of each feature"),
+      tensorflow::Flag("zipf", &flags.zipf, "zipf exponent of the ids"),
+      tensorflow::Flag("batch_size", &flags.batch_size,
+          "samples per request"),
+      tensorflow::Flag("num_requests", &flags.num_requests,
+          "distinct requests generated before the run"),
+      tensorflow::Flag("mode", &flags.mode, "closed, open or both"),
+      tensorflow::Flag("concurrency", &flags.concurrency,
+          "closed loop client counts, comma separated"),
+      tensorflow::Flag("qps", &flags.qps,
+          "open loop target rates, comma separated"),
+      tensorflow::Flag("open_loop_threads", &flags.open_loop_threads,
+          "max in-flight requests of open loop"),
+      tensorflow::Flag("batch_process_size", &flags.batch_process_size,
+          "requests per batch_process call, 0 uses process"),
+      tensorflow::Flag("duration_secs", &flags.duration_secs,
+          "seconds of each load level"),
+      tensorflow::Flag("warmup_secs", &flags.warmup_secs,
+          "seconds of warmup before measuring"),
+  };
+  std::string usage = tensorflow::Flags::Usage(argv[0], flag_list);
+  if (!tensorflow::Flags::Parse(&argc, argv, flag_list)) {
+    std::cerr << usage;
+    return -1;
+  }
+  tensorflow::port::InitMain(argv[0], &argc, &argv);
+  return tensorflow::processor::Run(flags);
+}
@@ -4,6 +4,7 @@
 #include <vector>
 #include <string>
 #include "serving/processor/tests/request_generated.h"
+#include "serving/processor/serving/message_buffer.h"
 #include "serving/processor/serving/predict.pb.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -17,6 +18,12 @@ using std::default_random_engine;
 #define DEBUG 0
 #define CONTENT_STRING_TYPE 0
 #define FLAT_COPY_INPUT 1
+// Alias aligned flatbuffer contents as tensors instead of memcpy,
+// see FlatBufferParser::ParseRequestFromBuf.
+#define FLAT_ZERO_COPY 1
+// Parse protobuf requests on a pooled arena and move strings out,
+// see ProtoBufParser::ParseRequestFromBuf.
+#define PB_ARENA 1
 
 static const int DIM_0 = 2;
 static const int DIM_1 = 10000;
@@ -196,6 +203,9 @@ void EncodeByFlatBuffer(flatbuffers::FlatBufferBuilder& fbb,
     size_t len = 1;
     for (size_t j = 0; j < shapes[i].size(); ++j) len *= shapes[i][j];
     len *= sizeof(VType);
+  #if FLAT_ZERO_COPY
+    fbb.ForceVectorAlignment(len, sizeof(int8_t), 64);
+  #endif
     auto vec_content = fbb.CreateVector(
         reinterpret_cast<const int8_t*>(contents[i]), len);
     tmp_content_vecs.push_back(vec_content);
@@ -350,12 +360,30 @@ tensorflow::Tensor Proto2Tensor(const tensorflow::eas::ArrayProto& input) {
   return tensorflow::Tensor();
 }
 
+tensorflow::Tensor Proto2Tensor(tensorflow::eas::ArrayProto* input) {
+  if (input->dtype() != tensorflow::eas::DT_STRING) {
+    return Proto2Tensor(*input);
+  }
+  tensorflow::TensorShape tensor_shape;
+  for (int i = 0; i < input->array_shape().dim_size(); ++i) {
+    tensor_shape.AddDim(input->array_shape().dim(i));
+  }
+  tensorflow::Tensor tensor(tensorflow::DT_STRING, tensor_shape);
+  auto flat = tensor.flat<std::string>();
+  for (int i = 0; i < input->string_val_size(); i++) {
+    flat(i).swap(*input->mutable_string_val(i));
+  }
+  return tensor;
+}
+
  
 int main() {
 
   std::cout << "DIM_0: " << DIM_0
             << ", DIM_1: " << DIM_1
-            << ", COUNT: " << COUNT << "\n";
+            << ", COUNT: " << COUNT
+            << ", FLAT_ZERO_COPY: " << FLAT_ZERO_COPY
+            << ", PB_ARENA: " << PB_ARENA << "\n";
 
 #if DEBUG
   // if print debug log, only tesing once.
@@ -483,8 +511,16 @@ int main() {
     std::string wrapper_data((char*)fbb.GetBufferPointer(), fbb.GetSize());
 
     // 2) decode - flatbuffer
+  #if FLAT_ZERO_COPY
+    auto flat_block = std::make_shared<tensorflow::processor::PooledBlock>(
+        wrapper_data.size());
+    memcpy(flat_block->data(), wrapper_data.data(), wrapper_data.size());
+    const tensorflow::eas::test::PredictRequest* flat_recv_req =
+        flatbuffers::GetRoot<tensorflow::eas::test::PredictRequest>((void*)(flat_block->data()));
+  #else
     const tensorflow::eas::test::PredictRequest* flat_recv_req =
         flatbuffers::GetRoot<tensorflow::eas::test::PredictRequest>((void*)(wrapper_data.data()));
+  #endif
 
     #if USE_STRING_TYPE
     auto& string_content_len_arr = (*(flat_recv_req->string_content_len()));
@@ -529,6 +565,17 @@ int main() {
       tensorflow::TensorBuffer tbuffer((void*)((*(flat_recv_req->content()))[i]->c_str()));
       tensorflow::Tensor t(tensorflow::DT_FLOAT, tensor_shape, &tbuffer);
       */
+    #if FLAT_ZERO_COPY && !CONTENT_STRING_TYPE
+      {
+        auto content = (*(flat_recv_req->content()))[i]->content();
+        tensorflow::DataType dtype =
+            typeid(TensorType).name() == typeid(float).name() ?
+            tensorflow::DT_FLOAT : tensorflow::DT_INT64;
+        tensorflow::Tensor t = tensorflow::processor::MakeRequestTensor(
+            dtype, tensor_shape, flat_block, content->Data(), content->size());
+        //std::cout << t.DebugString() << "\n";
+      }
+    #else
       if (typeid(TensorType).name() == typeid(float).name()) {
         tensorflow::Tensor t(tensorflow::DT_FLOAT, tensor_shape);
         auto flat = t.flat<float>();
@@ -554,6 +601,7 @@ int main() {
 
         //std::cout << t.DebugString() << "\n";
       }
+    #endif
       
 #endif
     }
@@ -633,10 +681,20 @@ int main() {
     pb_req.SerializeToString(&pb_req_str);
 
     // 2) decode - protobufbuffer
+  #if PB_ARENA
+    tensorflow::processor::ArenaMessage<tensorflow::eas::PredictRequest>
+        pb_arena_req(pb_req_str.size());
+    tensorflow::eas::PredictRequest& pb_recv_req = *pb_arena_req.get();
+  #else
     tensorflow::eas::PredictRequest pb_recv_req;
+  #endif
     pb_recv_req.ParseFromArray(pb_req_str.c_str(), pb_req_str.size());
-    for (auto& input : pb_recv_req.inputs()) {
+    for (auto& input : *pb_recv_req.mutable_inputs()) {
+    #if PB_ARENA
+      tensorflow::Tensor t = Proto2Tensor(&input.second);
+    #else
       tensorflow::Tensor t = Proto2Tensor(input.second);
+    #endif
     }
 
   #if DEBUG
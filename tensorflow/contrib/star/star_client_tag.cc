@@ -132,6 +132,11 @@ void InitStarClientTag(protobuf::Message* request,
         tag->resp_tensor_bufs_[idx].len_ = sm.tensor_bytes_;
         tag->resp_tensor_bufs_[idx].data_ =
             new char[tag->resp_tensor_bufs_[idx].len_]();
+        if (sm.data_type_ == DT_STRING) {
+          // Strings always sit on host.
+          response->SetTensor(Tensor(cpu_allocator(), DT_STRING,
+                                     sm.tensor_shape_));
+        }
       }
 
       return Status();
@@ -181,6 +186,13 @@ void InitStarClientTag(protobuf::Message* request,
                       done(s);
                       delete tag;
                     }
+                  } else if (response->GetDataType() == DT_STRING) {
+                    Tensor val = response->GetTensor();
+                    Status status = StarMessage::DeserializeStringTensor(
+                        tag->resp_tensor_bufs_[0].data_,
+                        tag->resp_tensor_bufs_[0].len_, &val);
+                    done(status);
+                    delete tag;
                   } else {
                     // could not memcoy
                     // LOG(INFO) << "wrapper_done, could not memcpy, recv bytes: "
@@ -266,6 +278,10 @@ void InitStarClientTag(protobuf::Message* request,
       } else {
         tag->resp_tensor_bufs_[idx].len_ = sm.tensor_bytes_;
         tag->resp_tensor_bufs_[idx].data_ = new char[tag->resp_tensor_bufs_[idx].len_]();
+        if (sm.data_type_ == DT_STRING) {
+          response->SetTensorByIndex(
+              idx, Tensor(cpu_allocator(), DT_STRING, sm.tensor_shape_));
+        }
       }
 
       return Status();
@@ -323,6 +339,17 @@ void InitStarClientTag(protobuf::Message* request,
                           delete tag;
                         }
                       }
+                    } else if (response->GetDataTypeByIndex(idx) == DT_STRING) {
+                      Tensor val = response->GetTensorByIndex(idx);
+                      Status status = StarMessage::DeserializeStringTensor(
+                          tag->resp_tensor_bufs_[idx].data_,
+                          tag->resp_tensor_bufs_[idx].len_, &val);
+                      CHECK(status.ok()) << "Make string tensor from message.";
+                      if (__sync_sub_and_fetch(resp_tensor_counter, 1) == 0) {
+                        delete resp_tensor_counter;
+                        done(status);
+                        delete tag;
+                      }
                     } else {
                       // Could not memory copy.
                       ParseProtoUnlimited(&response->GetTensorProtoByIndex(idx),
@@ -372,7 +399,7 @@ void InitStarClientTag(StarRunGraphRequest* request,
   uint64_t payload_size = meta_size;
   for (int i = 0; i < tag->req_tensor_count_; ++i) {
     TensorProto tensor_proto;
-    if (!DataTypeCanUseMemcpy(request->feed_tensors_[i].dtype())) {
+    if (StarMessage::UseTensorProto(request->feed_tensors_[i].dtype())) {
       request->feed_tensors_[i].AsProtoTensorContent(&tensor_proto);
     }
     payload_size
@@ -413,7 +440,13 @@ void InitStarClientTag(StarRunGraphRequest* request,
     bool can_memcpy = DataTypeCanUseMemcpy(sm.data_type_);
     if (can_memcpy) {
       // TODO(jiankeng.pt): Implement GPU device here.
-      Tensor val(cpu_allocator(), sm.data_type_, sm.tensor_shape_);
+      // The tensor is received in place in the memory of the fetching device.
+      Allocator* alloc = cpu_allocator();
+      if (response->device_ != nullptr &&
+          response->device_->tensorflow_gpu_device_info() == nullptr) {
+        alloc = response->device_->GetAllocator(AllocatorAttributes());
+      }
+      Tensor val(alloc, sm.data_type_, sm.tensor_shape_);
       tag->resp_tensor_bufs_[idx].data_ = reinterpret_cast<char*>(DMAHelper::base(&val));
       tag->resp_tensor_bufs_[idx].len_ =  sm.tensor_bytes_;
       tag->resp_tensor_bufs_[idx].owned_ = false;
@@ -422,6 +455,10 @@ void InitStarClientTag(StarRunGraphRequest* request,
     } else {
       tag->resp_tensor_bufs_[idx].len_ = sm.tensor_bytes_;
       tag->resp_tensor_bufs_[idx].data_ = new char[tag->resp_tensor_bufs_[idx].len_]();
+      if (sm.data_type_ == DT_STRING) {
+        response->fetch_tensors_[idx] =
+            Tensor(cpu_allocator(), DT_STRING, sm.tensor_shape_);
+      }
     }
 
     return Status();
@@ -438,6 +475,17 @@ void InitStarClientTag(StarRunGraphRequest* request,
         bool can_memcpy = DataTypeCanUseMemcpy(response->data_type_[i]);
         if (can_memcpy) {
           // TODO: impl GPU device here
+        } else if (response->data_type_[i] == DT_STRING) {
+          Status status = StarMessage::DeserializeStringTensor(
+              tag->resp_tensor_bufs_[i].data_, tag->resp_tensor_bufs_[i].len_,
+              &response->fetch_tensors_[i]);
+          if (!status.ok()) {
+            LOG(ERROR) << "Failed to make string tensor, err msg: "
+                       << status.error_message().c_str();
+            done(status);
+            delete tag;
+            return;
+          }
         } else {
           TensorProto tensor_proto;
           ParseProtoUnlimited(&tensor_proto,
@@ -1,4 +1,5 @@
 #include "tensorflow/contrib/star/star_message.h"
+#include "tensorflow/core/lib/core/errors.h"
 
 
 namespace tensorflow {
@@ -43,6 +44,8 @@ uint64_t StarMessage::SerializeTensorMessage(
     tensor_buf->len_ = sm.tensor_bytes_;
     tensor_buf->data_ = const_cast<char*>(in.tensor_data().data());
     tensor_buf->owned_ = false;
+  } else if (sm.data_type_ == DT_STRING) {
+    sm.tensor_bytes_ = SerializeStringTensor(in, tensor_buf);
   } else {
     sm.tensor_bytes_ = inp.ByteSize();
 
@@ -58,4 +61,51 @@ uint64_t StarMessage::SerializeTensorMessage(
   return StarMessage::kMessageTotalBytes + sm.tensor_bytes_;
 }
 
+uint64_t StarMessage::SerializeStringTensor(const Tensor& in,
+                                            StarBuf* tensor_buf) {
+  // |len_0|...|len_n-1|bytes_0|...|bytes_n-1|
+  // | 8B  |...|  8B   |  ...
+  auto strings = in.flat<tstring>();
+  const int64 num_elements = strings.size();
+  uint64_t len = num_elements * sizeof(uint64_t);
+  for (int64 i = 0; i < num_elements; ++i) {
+    len += strings(i).size();
+  }
+
+  tensor_buf->len_ = len;
+  tensor_buf->data_ = new char[len];
+  tensor_buf->owned_ = true;
+  char* lens = tensor_buf->data_;
+  char* bytes = lens + num_elements * sizeof(uint64_t);
+  for (int64 i = 0; i < num_elements; ++i) {
+    uint64_t size = strings(i).size();
+    memcpy(lens + i * sizeof(uint64_t), &size, sizeof(uint64_t));
+    memcpy(bytes, strings(i).data(), size);
+    bytes += size;
+  }
+  return len;
+}
+
+Status StarMessage::DeserializeStringTensor(const char* data, uint64_t len,
+                                            Tensor* out) {
+  auto strings = out->flat<tstring>();
+  const int64 num_elements = strings.size();
+  uint64_t offset = num_elements * sizeof(uint64_t);
+  if (offset > len) {
+    return errors::Internal("Invalid string tensor message of ", len,
+                            " bytes for ", num_elements, " strings.");
+  }
+  for (int64 i = 0; i < num_elements; ++i) {
+    uint64_t size;
+    memcpy(&size, data + i * sizeof(uint64_t), sizeof(uint64_t));
+    if (size > len - offset) {
+      return errors::Internal("Invalid string tensor message of ", len,
+                              " bytes for ", num_elements, " strings.");
+    }
+    strings(i).assign(data + offset, size);
+    offset += size;
+  }
+  return Status::OK();
+}
+
 } // namespace tensorflow
@@ -36,10 +36,22 @@ struct StarMessage {
   static const size_t kStarMessageBufferSize = kMessageTotalBytes;
   static void SerializeMessage(const StarMessage& rm, char* data);
   static void DeserializeMessage(StarMessage* rm, const char* data);
+  // The buffer of a memcpy-able tensor is sent as is. `inp` is only
+  // serialized for the types UseTensorProto() returns true for.
   static uint64_t SerializeTensorMessage(
       const Tensor& in, const TensorProto& inp,
       bool is_dead, StarBuf* message_buf,
       StarBuf* tensor_buf);
+
+  // String tensors are sent as the lengths of their strings followed by the
+  // bytes, which saves building and parsing a TensorProto on both sides.
+  static bool UseTensorProto(DataType data_type) {
+    return !DataTypeCanUseMemcpy(data_type) && data_type != DT_STRING;
+  }
+  static uint64_t SerializeStringTensor(const Tensor& in, StarBuf* tensor_buf);
+  // `out` is allocated with the shape of the message.
+  static Status DeserializeStringTensor(const char* data, uint64_t len,
+                                        Tensor* out);
 };
 
 } // namespace tensorflow
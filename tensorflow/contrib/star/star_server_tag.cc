@@ -9,6 +9,24 @@
 
 namespace tensorflow {
 
+namespace {
+
+// Returns the local device of a feed of a run graph request, or null.
+Device* LookupFeedDevice(const DeviceMgr* device_mgr,
+                         const string& feed_name) {
+  Rendezvous::ParsedKey parsed_key;
+  if (!Rendezvous::ParseKey(feed_name, &parsed_key).ok()) {
+    return nullptr;
+  }
+  Device* device = nullptr;
+  if (!device_mgr->LookupDevice(parsed_key.dst_device, &device).ok()) {
+    device_mgr->LookupDevice(parsed_key.src_device, &device).IgnoreError();
+  }
+  return device;
+}
+
+}  // namespace
+
 void InitStarServerTag(protobuf::Message* request,
                        protobuf::Message* response,
                        StarServerTag* tag) {
@@ -170,7 +188,16 @@ void InitStarServerTag(StarServerTag* tag) {
     bool can_memcpy = DataTypeCanUseMemcpy(sm.data_type_);
     if (can_memcpy) {
       //TODO: Implement GPU device here
-      Tensor val(cpu_allocator(), sm.data_type_, sm.tensor_shape_);
+      // The tensor is received in place in the memory of the device it is
+      // fed to.
+      Allocator* alloc = cpu_allocator();
+      Device* device = LookupFeedDevice(
+          tag->star_worker_service_->GetWorker()->env()->device_mgr,
+          tag->star_graph_request_.feed_names_[idx]);
+      if (device != nullptr && device->tensorflow_gpu_device_info() == nullptr) {
+        alloc = device->GetAllocator(AllocatorAttributes());
+      }
+      Tensor val(alloc, sm.data_type_, sm.tensor_shape_);
       tag->req_tensor_bufs_[idx].data_ = reinterpret_cast<char*>(DMAHelper::base(&val));
       tag->req_tensor_bufs_[idx].len_ =  sm.tensor_bytes_;
       tag->req_tensor_bufs_[idx].owned_ = false;
@@ -178,6 +205,10 @@ void InitStarServerTag(StarServerTag* tag) {
     } else {
       tag->req_tensor_bufs_[idx].len_ = sm.tensor_bytes_;
       tag->req_tensor_bufs_[idx].data_ = new char[tag->req_tensor_bufs_[idx].len_]();
+      if (sm.data_type_ == DT_STRING) {
+        tag->star_graph_request_.feed_tensors_[idx] =
+            Tensor(cpu_allocator(), DT_STRING, sm.tensor_shape_);
+      }
     }
     return Status();
   };
@@ -190,6 +221,14 @@ void InitStarServerTag(StarServerTag* tag) {
       bool can_memcpy = DataTypeCanUseMemcpy(tag->star_graph_request_.data_type_[i]);
       if (can_memcpy) {
         //TODO: Implement GPU device here
+      } else if (tag->star_graph_request_.data_type_[i] == DT_STRING) {
+        Status s = StarMessage::DeserializeStringTensor(
+            tag->req_tensor_bufs_[i].data_, tag->req_tensor_bufs_[i].len_,
+            &tag->star_graph_request_.feed_tensors_[i]);
+        if (!s.ok()) {
+          LOG(FATAL) << "Failed to make string tensor, feed name is : "
+                     << tag->star_graph_request_.feed_names_[i] << ", " << s;
+        }
       } else {
         TensorProto tensor_proto;
         ParseProtoUnlimited(&tensor_proto,
@@ -272,7 +311,8 @@ void StarServerTag::FillRespBody() {
   uint64_t payload_len = meta_len;
   for (uint64_t i = 0; i < fetch_count; ++i) {
     TensorProto tensor_proto;
-    if (!DataTypeCanUseMemcpy(star_graph_response_.fetch_tensors_[i].dtype())) {
+    if (StarMessage::UseTensorProto(
+            star_graph_response_.fetch_tensors_[i].dtype())) {
       star_graph_response_.fetch_tensors_[i].AsProtoTensorContent(&tensor_proto);
     }
     payload_len
@@ -0,0 +1,142 @@
+# Copyright 2022 The DeepRec Authors. All Rights Reserved.
+#
+# Licensed under the Apache License, Version 2.0 (the "License");
+# you may not use this file except in compliance with the License.
+# You may obtain a copy of the License at
+#
+#     http://www.apache.org/licenses/LICENSE-2.0
+#
+# Unless required by applicable law or agreed to in writing, software
+# distributed under the License is distributed on an "AS IS" BASIS,
+# WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+# See the License for the specific language governing permissions and
+# limitations under the License.
+# ==============================================================================
+"""Loopback benchmark of the tensor transfer of the distributed protocols.
+
+A ps and a worker run in separate processes on localhost. The worker pulls a
+float tensor from the ps and pushes one back, for tensor sizes from 1KB to
+64MB, and reports the throughput of each protocol.
+
+  python star_transport_benchmark.py --protocols=grpc,grpc++,star_server
+"""
+
+from __future__ import absolute_import
+from __future__ import division
+from __future__ import print_function
+
+import argparse
+import multiprocessing
+import socket
+import time
+
+import tensorflow as tf
+
+_KB = 1024
+_MB = 1024 * 1024
+
+
+def _free_port():
+  s = socket.socket(socket.AF_INET, socket.SOCK_STREAM)
+  s.bind(('localhost', 0))
+  port = s.getsockname()[1]
+  s.close()
+  return port
+
+
+def _cluster(ps_port, worker_port):
+  return tf.train.ClusterSpec({
+      'ps': ['localhost:%d' % ps_port],
+      'worker': ['localhost:%d' % worker_port]
+  })
+
+
+def _run_ps(protocol, ps_port, worker_port):
+  server = tf.distribute.Server(_cluster(ps_port, worker_port),
+                                job_name='ps',
+                                task_index=0,
+                                protocol=protocol)
+  server.join()
+
+
+def _benchmark(protocol, sizes, iters, ps_port, worker_port):
+  server = tf.distribute.Server(_cluster(ps_port, worker_port),
+                                job_name='worker',
+                                task_index=0,
+                                protocol=protocol)
+  results = []
+  for size in sizes:
+    num_elements = size // 4
+    graph = tf.Graph()
+    with graph.as_default():
+      with tf.device('/job:ps/task:0'):
+        var = tf.Variable(tf.zeros([num_elements]), name='var_%d' % size)
+      with tf.device('/job:worker/task:0'):
+        grad = tf.Variable(tf.ones([num_elements]), name='grad_%d' % size)
+        # Reading the variable on the worker pulls it from the ps.
+        pull = tf.reduce_sum(var.read_value()[:1])
+      with tf.device('/job:ps/task:0'):
+        # Applying the worker tensor on the ps pushes it.
+        push = var.assign_add(grad.read_value()).op
+      init = tf.global_variables_initializer()
+
+    with tf.Session(server.target, graph=graph) as sess:
+      sess.run(init)
+      for name, op in [('pull', pull), ('push', push)]:
+        # Warm up the connection and the executors.
+        for _ in range(3):
+          sess.run(op)
+        start = time.time()
+        for _ in range(iters):
+          sess.run(op)
+        elapsed = time.time() - start
+        results.append((name, size, elapsed / iters,
+                        size * iters / elapsed / _MB))
+  return results
+
+
+def _format_size(size):
+  if size >= _MB:
+    return '%dMB' % (size // _MB)
+  return '%dKB' % (size // _KB)
+
+
+def main():
+  parser = argparse.ArgumentParser()
+  parser.add_argument('--protocols', type=str,
+                      default='grpc,grpc++,star_server',
+                      help='Comma separated protocols to compare.')
+  parser.add_argument('--min_size', type=int, default=_KB,
+                      help='Smallest tensor size in bytes.')
+  parser.add_argument('--max_size', type=int, default=64 * _MB,
+                      help='Largest tensor size in bytes.')
+  parser.add_argument('--iters', type=int, default=20,
+                      help='Number of steps per tensor size.')
+  args = parser.parse_args()
+
+  sizes = []
+  size = args.min_size
+  while size <= args.max_size:
+    sizes.append(size)
+    size *= 4
+
+  print('%-12s %-5s %8s %12s %12s' %
+        ('protocol', 'op', 'size', 'latency(ms)', 'MB/s'))
+  ctx = multiprocessing.get_context('spawn')
+  for protocol in args.protocols.split(','):
+    ps_port, worker_port = _free_port(), _free_port()
+    ps = ctx.Process(target=_run_ps, args=(protocol, ps_port, worker_port))
+    ps.daemon = True
+    ps.start()
+    try:
+      results = _benchmark(protocol, sizes, args.iters, ps_port, worker_port)
+    finally:
+      ps.terminate()
+      ps.join()
+    for name, size, latency, throughput in results:
+      print('%-12s %-5s %8s %12.3f %12.1f' %
+            (protocol, name, _format_size(size), latency * 1000, throughput))
+
+
+if __name__ == '__main__':
+  main()
@@ -1,4 +1,5 @@
 #include "tensorflow/contrib/star/star_worker_service.h"
+#include "tensorflow/contrib/star/star_message.h"
 #include "tensorflow/contrib/star/star_server_tag.h"
 #include "tensorflow/contrib/star/star_tensor_coding.h"
 #include "tensorflow/contrib/verbs/verbs_util.h"
@@ -486,7 +487,7 @@ void StarWorker::RecvTensorAsync(CallOptions* opts,
           } else {
             // tensor is in CPU memory.
             response->SetTensor(val);
-            if (!can_memcpy) {
+            if (StarMessage::UseTensorProto(val.dtype())) {
               val.AsProtoTensorContent(&response->GetTensorProto());
             }
             done(Status());
@@ -599,7 +600,7 @@ void StarWorker::FuseRecvTensorAsync(CallOptions* opts,
             } else {
               // tensor is in CPU memory.
               response->SetTensorByIndex(idx, vals[idx]);
-              if (!can_memcpy) {
+              if (StarMessage::UseTensorProto(vals[idx].dtype())) {
                 vals[idx].AsProtoTensorContent(&response->GetTensorProtoByIndex(idx));
               }
               if (__sync_sub_and_fetch(fuse_counter, 1) == 0) {
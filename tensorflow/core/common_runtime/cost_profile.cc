@@ -0,0 +1,128 @@
+#include "tensorflow/core/common_runtime/cost_profile.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/lib/strings/numbers.h"
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/fingerprint.h"
+
+namespace tensorflow {
+namespace ExecutorInternal {
+
+const char* const kCostProfileDirEnvName = "EXECUTOR_COST_PROFILE_DIR";
+
+namespace {
+
+// First line of a profile: "<magic> <graph fingerprint>", followed by
+// one "<cost ns>\t<node name>" line per node.
+const char* const kCostProfileMagic = "executor_cost_profile_v1";
+
+}  // namespace
+
+uint64 GraphCostFingerprint(const Graph& g) {
+  // Node ids depend on the construction order of the graph, fingerprint
+  // the nodes by name.
+  std::vector<string> nodes;
+  nodes.reserve(g.num_nodes());
+  for (const Node* n : g.nodes()) {
+    string node = strings::StrCat(n->name(), ":", n->type_string());
+    std::vector<string> inputs;
+    for (const Edge* e : n->in_edges()) {
+      inputs.push_back(strings::StrCat(e->src()->name(), ":", e->src_output(),
+                                       ":", e->dst_input()));
+    }
+    std::sort(inputs.begin(), inputs.end());
+    for (const string& input : inputs) {
+      strings::StrAppend(&node, ",", input);
+    }
+    nodes.push_back(std::move(node));
+  }
+  std::sort(nodes.begin(), nodes.end());
+
+  uint64 fingerprint = 0;
+  for (const string& node : nodes) {
+    fingerprint = FingerprintCat64(fingerprint, Fingerprint64(node));
+  }
+  return fingerprint;
+}
+
+string CostProfilePath(const string& dir, const Graph& g) {
+  return io::JoinPath(dir, strings::StrCat(strings::Hex(
+                               GraphCostFingerprint(g), strings::kZeroPad16),
+                           ".cost_profile"));
+}
+
+Status SaveCostProfile(Env* env, const string& path, const Graph& g,
+                       const std::vector<int64>& costs) {
+  string content = strings::StrCat(kCostProfileMagic, " ",
+                                   GraphCostFingerprint(g), "\n");
+  for (const Node* n : g.nodes()) {
+    if (static_cast<size_t>(n->id()) >= costs.size()) {
+      continue;
+    }
+    strings::StrAppend(&content, costs[n->id()], "\t", n->name(), "\n");
+  }
+  // Write to a temporary file first, so that concurrent processes never
+  // read a partial profile.
+  string tmp_path = strings::StrCat(path, ".tmp", env->NowMicros());
+  TF_RETURN_IF_ERROR(WriteStringToFile(env, tmp_path, content));
+  return env->RenameFile(tmp_path, path);
+}
+
+Status LoadCostProfile(Env* env, const string& path, const Graph& g,
+                       std::vector<int64>* costs) {
+  if (!env->FileExists(path).ok()) {
+    return errors::NotFound("No cost profile at ", path);
+  }
+  string content;
+  TF_RETURN_IF_ERROR(ReadFileToString(env, path, &content));
+
+  std::vector<string> lines = str_util::Split(content, '\n',
+                                              str_util::SkipEmpty());
+  uint64 fingerprint = 0;
+  std::vector<string> header = str_util::Split(lines.empty() ? "" : lines[0],
+                                               ' ');
+  if (header.size() != 2 || header[0] != kCostProfileMagic ||
+      !strings::safe_strtou64(header[1], &fingerprint)) {
+    return errors::DataLoss("Invalid cost profile header in ", path);
+  }
+  if (fingerprint != GraphCostFingerprint(g)) {
+    return errors::FailedPrecondition("Cost profile ", path,
+                                      " was recorded for another graph");
+  }
+
+  std::unordered_map<string, int64> node_costs;
+  for (size_t i = 1; i < lines.size(); ++i) {
+    auto pos = lines[i].find('\t');
+    int64 cost = 0;
+    if (pos == string::npos ||
+        !strings::safe_strto64(lines[i].substr(0, pos), &cost)) {
+      return errors::DataLoss("Invalid cost profile line ", i, " in ", path);
+    }
+    node_costs[lines[i].substr(pos + 1)] = cost;
+  }
+
+  costs->assign(g.num_node_ids(), 0);
+  for (const Node* n : g.nodes()) {
+    auto it = node_costs.find(n->name());
+    if (it != node_costs.end()) {
+      (*costs)[n->id()] = it->second;
+    }
+  }
+  return Status::OK();
+}
+
+bool IsOffCriticalPathNode(const Node& node) {
+  const string& op = node.type_string();
+  return str_util::EndsWith(op, "Summary") || op == "SummaryWriter" ||
+         op == "WriteSummary" || op == "ImportEvent" ||
+         op == "FlushSummaryWriter" || op == "Save" || op == "SaveSlices" ||
+         op == "SaveV2" || op == "MergeV2Checkpoints";
+}
+
+}  // end namespace ExecutorInternal
+}  // end namespace tensorflow
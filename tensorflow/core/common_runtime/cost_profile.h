@@ -0,0 +1,46 @@
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_COST_PROFILE_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_COST_PROFILE_H_
+
+#include <string>
+#include <vector>
+
+#include "tensorflow/core/graph/graph.h"
+#include "tensorflow/core/lib/core/status.h"
+#include "tensorflow/core/platform/env.h"
+
+namespace tensorflow {
+namespace ExecutorInternal {
+
+// Node execution costs collected by KernelStats can be persisted, so that
+// later processes running the same graph schedule by the critical path from
+// the first step on. Profiles are kept in the directory given by the
+// environment variable below, one file per graph named by its fingerprint.
+extern const char* const kCostProfileDirEnvName;
+
+// Fingerprint of the names, ops and edges of the nodes of `g`. It is stable
+// across processes building the same graph.
+uint64 GraphCostFingerprint(const Graph& g);
+
+// Path of the profile of `g` in `dir`.
+string CostProfilePath(const string& dir, const Graph& g);
+
+// Writes `costs`, the average execution time in nanoseconds of each node of
+// `g` indexed by node id, to `path`.
+Status SaveCostProfile(Env* env, const string& path, const Graph& g,
+                       const std::vector<int64>& costs);
+
+// Reads a profile written by SaveCostProfile into `costs`, indexed by node
+// id of `g`. Nodes missing in the profile get cost 0. Returns NotFound if
+// there is no profile.
+Status LoadCostProfile(Env* env, const string& path, const Graph& g,
+                       std::vector<int64>* costs);
+
+// Returns true for nodes whose results nothing else of the step waits on,
+// e.g. summaries and checkpoint savers. They are excluded from the critical
+// path, so the cost model executor runs them after the other ready nodes.
+bool IsOffCriticalPathNode(const Node& node);
+
+}  // end namespace ExecutorInternal
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_COST_PROFILE_H_
@@ -0,0 +1,94 @@
+#include "tensorflow/core/common_runtime/cost_profile.h"
+
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/graph/testlib.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/io/path.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace ExecutorInternal {
+namespace {
+
+class CostProfileTest : public ::testing::Test {
+ protected:
+  // c0 + c1 -> add, tag + add -> summary
+  void BuildGraph(Graph* g) {
+    Node* c0 = test::graph::Constant(g, test::AsScalar<float>(1.0), "c0");
+    Node* c1 = test::graph::Constant(g, test::AsScalar<float>(2.0), "c1");
+    add_ = test::graph::Add(g, c0, c1);
+    Node* tag = test::graph::Constant(g, test::AsScalar<string>("loss"),
+                                      "tag");
+    TF_CHECK_OK(NodeBuilder("summary", "ScalarSummary")
+                    .Input(tag)
+                    .Input(add_)
+                    .Finalize(g, &summary_));
+  }
+
+  string ProfileDir() {
+    return io::JoinPath(testing::TmpDir(), "cost_profile_test");
+  }
+
+  Node* add_ = nullptr;
+  Node* summary_ = nullptr;
+};
+
+TEST_F(CostProfileTest, FingerprintStableAcrossGraphs) {
+  Graph g0(OpRegistry::Global());
+  BuildGraph(&g0);
+  Graph g1(OpRegistry::Global());
+  BuildGraph(&g1);
+  EXPECT_EQ(GraphCostFingerprint(g0), GraphCostFingerprint(g1));
+  EXPECT_EQ(CostProfilePath(ProfileDir(), g0),
+            CostProfilePath(ProfileDir(), g1));
+
+  test::graph::Identity(&g1, add_);
+  EXPECT_NE(GraphCostFingerprint(g0), GraphCostFingerprint(g1));
+}
+
+TEST_F(CostProfileTest, SaveAndLoad) {
+  Env* env = Env::Default();
+  TF_ASSERT_OK(env->RecursivelyCreateDir(ProfileDir()));
+
+  Graph g0(OpRegistry::Global());
+  BuildGraph(&g0);
+  std::vector<int64> costs(g0.num_node_ids(), 0);
+  costs[add_->id()] = 1000;
+  costs[summary_->id()] = 50;
+  const string path = CostProfilePath(ProfileDir(), g0);
+  TF_ASSERT_OK(SaveCostProfile(env, path, g0, costs));
+
+  // Another process builds the same graph.
+  Graph g1(OpRegistry::Global());
+  BuildGraph(&g1);
+  std::vector<int64> loaded;
+  TF_ASSERT_OK(LoadCostProfile(env, path, g1, &loaded));
+  ASSERT_EQ(g1.num_node_ids(), loaded.size());
+  EXPECT_EQ(1000, loaded[add_->id()]);
+  EXPECT_EQ(50, loaded[summary_->id()]);
+
+  // The profile does not apply to a different graph.
+  test::graph::Identity(&g1, add_);
+  EXPECT_TRUE(errors::IsFailedPrecondition(
+      LoadCostProfile(env, path, g1, &loaded)));
+}
+
+TEST_F(CostProfileTest, LoadMissingProfile) {
+  Graph g(OpRegistry::Global());
+  BuildGraph(&g);
+  std::vector<int64> costs;
+  EXPECT_TRUE(errors::IsNotFound(LoadCostProfile(
+      Env::Default(), io::JoinPath(ProfileDir(), "missing"), g, &costs)));
+}
+
+TEST_F(CostProfileTest, OffCriticalPathNodes) {
+  Graph g(OpRegistry::Global());
+  BuildGraph(&g);
+  EXPECT_TRUE(IsOffCriticalPathNode(*summary_));
+  EXPECT_FALSE(IsOffCriticalPathNode(*add_));
+}
+
+}  // namespace
+}  // namespace ExecutorInternal
+}  // namespace tensorflow
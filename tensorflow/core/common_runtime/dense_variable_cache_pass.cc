@@ -0,0 +1,211 @@
+/* Copyright 2022 The DeepRec Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <map>
+#include <utility>
+
+#include "tensorflow/core/common_runtime/optimization_registry.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/control_flow.h"
+#include "tensorflow/core/graph/graph_node_util.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/util/device_name_utils.h"
+
+namespace tensorflow {
+namespace {
+
+// Returns the variable read by `n`, or nullptr if `n` is not a read of a
+// dense variable.
+const Node* ReadVariable(const Node* n) {
+  const Edge* e;
+  if (n->num_inputs() != 1 || !n->input_edge(0, &e).ok()) {
+    return nullptr;
+  }
+  if (n->type_string() == "Identity" && IsRefType(n->input_type(0)) &&
+      e->src()->IsVariable()) {
+    return e->src();
+  }
+  if (n->type_string() == "ReadVariableOp" &&
+      e->src()->type_string() == "VarHandleOp") {
+    return e->src();
+  }
+  return nullptr;
+}
+
+// Keeps replicas of the dense variables on the ps in the workers which read
+// them. For a read on the ps consumed by a worker, the worker sends a
+// refresh flag every step, which is true every `staleness` steps. The ps
+// sends the variable only when it is true, the worker updates its cache then
+// and reads the cache otherwise:
+//
+//   ps:     Switch(read, refresh):1 --.
+//   worker:                           `-> Update --.
+//           Switch(refresh, refresh):0 -> Lookup --+-> Merge -> consumers
+//
+// The worker sees values at most `staleness` - 1 steps old, the pushes of
+// the gradients are not changed. Reads in while loops are left as is.
+class DenseVariableCachePass : public GraphOptimizationPass {
+ public:
+  Status Run(const GraphOptimizationPassOptions& options) override {
+    if (options.graph == nullptr || options.session_options == nullptr) {
+      return Status::OK();
+    }
+    const OptimizerOptions& opts =
+        options.session_options->config.graph_options().optimizer_options();
+    if (opts.dense_variable_staleness() <= 1 &&
+        opts.dense_variable_staleness_overrides().empty()) {
+      return Status::OK();
+    }
+
+    Graph* graph = options.graph->get();
+    std::vector<ControlFlowInfo> cf_info;
+    std::vector<string> unreachable_nodes;
+    TF_RETURN_IF_ERROR(
+        BuildControlFlowInfo(graph, &cf_info, &unreachable_nodes));
+
+    // Reads and their consumer edges by destination device.
+    std::vector<std::pair<Node*, std::map<string, std::vector<const Edge*>>>>
+        reads;
+    for (Node* n : graph->op_nodes()) {
+      if (ReadVariable(n) == nullptr || !InRootFrame(cf_info, n)) continue;
+      const string& src_device = n->assigned_device_name();
+      std::map<string, std::vector<const Edge*>> edges;
+      for (const Edge* e : n->out_edges()) {
+        if (e->IsControlEdge() || !InRootFrame(cf_info, e->dst())) continue;
+        const string& dst_device = e->dst()->assigned_device_name();
+        if (DeviceNameUtils::IsSameAddressSpace(src_device, dst_device) ||
+            !IsCPUDevice(dst_device)) {
+          continue;
+        }
+        edges[dst_device].push_back(e);
+      }
+      if (!edges.empty()) {
+        reads.emplace_back(n, std::move(edges));
+      }
+    }
+
+    RefreshNodesMap refresh_nodes;
+    for (auto& read : reads) {
+      const string& var_name = ReadVariable(read.first)->name();
+      int staleness = opts.dense_variable_staleness();
+      auto it = opts.dense_variable_staleness_overrides().find(var_name);
+      if (it != opts.dense_variable_staleness_overrides().end()) {
+        staleness = it->second;
+      }
+      if (staleness <= 1) continue;
+      for (auto& dst : read.second) {
+        TF_RETURN_IF_ERROR(Rewrite(graph, read.first, var_name, dst.first,
+                                   staleness, dst.second, &refresh_nodes));
+      }
+    }
+    return Status::OK();
+  }
+
+ private:
+  struct RefreshNodes {
+    Node* refresh;
+    Node* pivot;
+  };
+  typedef std::map<std::pair<string, int>, RefreshNodes> RefreshNodesMap;
+
+  static bool InRootFrame(const std::vector<ControlFlowInfo>& cf_info,
+                          const Node* n) {
+    return n->id() < static_cast<int>(cf_info.size()) &&
+           cf_info[n->id()].frame_name.empty();
+  }
+
+  // Returns the refresh flag and its switch on `device`, shared by the
+  // variables with the same staleness.
+  static Status GetRefreshNodes(Graph* graph, const string& device,
+                                int staleness, RefreshNodesMap* refresh_nodes,
+                                RefreshNodes* nodes) {
+    auto key = std::make_pair(device, staleness);
+    auto it = refresh_nodes->find(key);
+    if (it != refresh_nodes->end()) {
+      *nodes = it->second;
+      return Status::OK();
+    }
+    const string prefix =
+        strings::StrCat("DenseVariableCache/staleness_", staleness);
+    TF_RETURN_IF_ERROR(NodeBuilder(graph->NewName(prefix + "/Refresh"),
+                                   "_DenseVariableCacheRefresh")
+                           .Attr("staleness", staleness)
+                           .Finalize(graph, &nodes->refresh));
+    nodes->refresh->set_assigned_device_name(device);
+    TF_RETURN_IF_ERROR(NodeBuilder(graph->NewName(prefix + "/Pivot"), "Switch")
+                           .Input(nodes->refresh, 0)
+                           .Input(nodes->refresh, 0)
+                           .Finalize(graph, &nodes->pivot));
+    nodes->pivot->set_assigned_device_name(device);
+    refresh_nodes->emplace(key, *nodes);
+    return Status::OK();
+  }
+
+  static Status Rewrite(Graph* graph, Node* read, const string& var_name,
+                        const string& dst_device, int staleness,
+                        const std::vector<const Edge*>& edges,
+                        RefreshNodesMap* refresh_nodes) {
+    RefreshNodes refresh;
+    TF_RETURN_IF_ERROR(GetRefreshNodes(graph, dst_device, staleness,
+                                       refresh_nodes, &refresh));
+    const string prefix = read->name() + "/DenseVariableCache";
+    const DataType dtype = read->output_type(0);
+
+    Node* fetch;
+    TF_RETURN_IF_ERROR(NodeBuilder(graph->NewName(prefix + "/Switch"), "Switch")
+                           .Input(read, 0)
+                           .Input(refresh.refresh, 0)
+                           .Finalize(graph, &fetch));
+    fetch->set_assigned_device_name(read->assigned_device_name());
+
+    Node* update;
+    TF_RETURN_IF_ERROR(NodeBuilder(graph->NewName(prefix + "/Update"),
+                                   "_DenseVariableCacheUpdate")
+                           .Input(fetch, 1)
+                           .Attr("shared_name", var_name)
+                           .Finalize(graph, &update));
+    update->set_assigned_device_name(dst_device);
+
+    Node* lookup;
+    TF_RETURN_IF_ERROR(NodeBuilder(graph->NewName(prefix + "/Lookup"),
+                                   "_DenseVariableCacheLookup")
+                           .Input(refresh.pivot, 0)
+                           .Attr("dtype", dtype)
+                           .Attr("shared_name", var_name)
+                           .Finalize(graph, &lookup));
+    lookup->set_assigned_device_name(dst_device);
+
+    Node* merge;
+    TF_RETURN_IF_ERROR(
+        NodeBuilder(graph->NewName(prefix + "/Merge"), "Merge")
+            .Input(std::vector<NodeBuilder::NodeOut>{{lookup, 0}, {update, 0}})
+            .Finalize(graph, &merge));
+    merge->set_assigned_device_name(dst_device);
+
+    for (const Edge* e : edges) {
+      TF_RETURN_IF_ERROR(graph->UpdateEdge(merge, 0, e->dst(), e->dst_input()));
+    }
+    VLOG(1) << "Cache " << var_name << " read by " << read->name() << " in "
+            << dst_device << " with staleness " << staleness;
+    return Status::OK();
+  }
+};
+
+REGISTER_OPTIMIZATION(OptimizationPassRegistry::POST_PLACEMENT, 0,
+                      DenseVariableCachePass);
+
+}  // namespace
+}  // namespace tensorflow
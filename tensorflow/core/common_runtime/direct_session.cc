@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/direct_session.h"
 
+#include <algorithm>
 #include <atomic>
 #include <string>
 #include <vector>
@@ -57,6 +58,7 @@ limitations under the License.
 #include "tensorflow/core/graph/graph_partition.h"
 #include "tensorflow/core/graph/subgraph.h"
 #include "tensorflow/core/graph/tensor_id.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/refcount.h"
@@ -564,6 +566,7 @@ DirectSession::DirectSession(const SessionOptions& options,
 
   bool use_cost_model_executor = false;
   bool use_inline_executor = false;
+  bool use_work_stealing_executor = false;
   bool pin_threadpool_to_cpu_core = false;
   Status s =
       ReadBoolFromEnvVar("USE_COST_MODEL_EXECUTOR", false, &use_cost_model_executor);
@@ -574,6 +577,11 @@ DirectSession::DirectSession(const SessionOptions& options,
   if (!s.ok()) {
     LOG(FATAL) << s.error_message();
   }
+  s = ReadBoolFromEnvVar("USE_WORK_STEALING_EXECUTOR", false,
+                         &use_work_stealing_executor);
+  if (!s.ok()) {
+    LOG(FATAL) << s.error_message();
+  }
   s = ReadBoolFromEnvVar("SET_SESSION_THREAD_POOL_AFFINITY", false,
                          &pin_threadpool_to_cpu_core);
   if (!s.ok()) {
@@ -587,6 +595,10 @@ DirectSession::DirectSession(const SessionOptions& options,
   } else if (options_.config.executor_policy() ==
              ExecutorPolicy::USE_INLINE_EXECUTOR || use_inline_executor) {
     run_in_caller_thread_ = true;
+  } else if (options_.config.executor_policy() ==
+                 ExecutorPolicy::USE_WORK_STEALING_EXECUTOR ||
+             use_work_stealing_executor) {
+    run_work_stealing_executor_ = true;
   }
 
   // The default value of sync_on_finish will be flipped soon and this
@@ -718,6 +730,16 @@ Status DirectSession::ExtendLocked(GraphDef graph) {
     TF_RETURN_IF_ERROR(execution_state_->Extend(graph, &state));
     execution_state_.swap(state);
   }
+  if (!execution_state_->auto_smart_stages().empty()) {
+    if (smart_stage_runner_ == nullptr) {
+      smart_stage_runner_ = SmartStageRunner::Create(this);
+    }
+    smart_stage_runner_->AddStages(execution_state_->auto_smart_stages());
+  }
+  for (const MicroBatchAccumulatorNodes& nodes :
+       execution_state_->micro_batch_accumulators()) {
+    micro_batch_accumulators_[nodes.take_node] = nodes;
+  }
   return Status::OK();
 }
 
@@ -855,6 +877,8 @@ Status DirectSession::RunInternal(
     args.executor_policy = ExecutorPolicy::USE_INLINE_EXECUTOR;
   } else if (run_cost_model_executor_) {
     args.executor_policy = ExecutorPolicy::USE_COST_MODEL_EXECUTOR;
+  } else if (run_work_stealing_executor_) {
+    args.executor_policy = ExecutorPolicy::USE_WORK_STEALING_EXECUTOR;
   } else {
     args.executor_policy = ExecutorPolicy::USE_NORMAL_EXECUTOR;
   }
@@ -1063,6 +1087,83 @@ Status DirectSession::RunInternal(
   return Status::OK();
 }
 
+Status DirectSession::RunMicroBatchPipeline(
+    ExecutorsAndKeys* executors_and_keys, const NamedTensorList& inputs,
+    const std::function<Status()>& run_step) {
+  if (executors_and_keys->micro_batch_accumulates.empty()) {
+    return run_step();
+  }
+  const int num_micro_batches =
+      options_.config.graph_options().optimizer_options().micro_batch_num();
+
+  thread::ThreadPool* pool;
+  std::vector<mutex*> accumulator_mus;
+  {
+    mutex_lock l(micro_batch_mu_);
+    if (micro_batch_pool_ == nullptr) {
+      micro_batch_pool_.reset(new thread::ThreadPool(
+          options_.env, "micro_batch", num_micro_batches - 1));
+    }
+    pool = micro_batch_pool_.get();
+    std::vector<string> accumulates =
+        executors_and_keys->micro_batch_accumulates;
+    std::sort(accumulates.begin(), accumulates.end());
+    for (const string& accumulate : accumulates) {
+      std::unique_ptr<mutex>& mu = micro_batch_accumulator_mus_[accumulate];
+      if (mu == nullptr) {
+        mu.reset(new mutex);
+      }
+      accumulator_mus.push_back(mu.get());
+    }
+  }
+  // Only the steps sharing accumulators are serialized, the micro-batches
+  // of concurrent steps would be mixed otherwise. They are locked by name
+  // so that steps sharing some of them don't deadlock.
+  for (mutex* mu : accumulator_mus) {
+    mu->lock();
+  }
+
+  // The other micro-batches only run up to the accumulation of their
+  // gradients, concurrently with the step, which applies the accumulated
+  // gradients once.
+  mutex mu;
+  Status micro_batch_status;
+  BlockingCounter counter(num_micro_batches - 1);
+  for (int i = 1; i < num_micro_batches; ++i) {
+    pool->Schedule([this, executors_and_keys, &inputs, &mu,
+                                 &micro_batch_status, &counter]() {
+      Status s = Run(inputs, {}, executors_and_keys->micro_batch_accumulates,
+                     nullptr);
+      if (!s.ok()) {
+        {
+          mutex_lock l(mu);
+          micro_batch_status.Update(s);
+        }
+        // Unblocks the step waiting for the gradients of this micro-batch.
+        Run({}, {}, executors_and_keys->micro_batch_aborts, nullptr)
+            .IgnoreError();
+      }
+      counter.DecrementCount();
+    });
+  }
+  Status s = run_step();
+  counter.Wait();
+
+  if (!s.ok() || !micro_batch_status.ok()) {
+    // Drops the gradients accumulated by the failed step.
+    Status reset =
+        Run({}, {}, executors_and_keys->micro_batch_resets, nullptr);
+    if (!reset.ok()) {
+      LOG(WARNING) << "Failed to reset the micro-batch accumulators: "
+                   << reset;
+    }
+  }
+  for (mutex* mu : accumulator_mus) {
+    mu->unlock();
+  }
+  return micro_batch_status.ok() ? s : micro_batch_status;
+}
+
 bool DirectSession::EnableTensorPoolTracking(ExecutorsAndKeys* executors_and_keys) {
   static std::unordered_map<ExecutorsAndKeys*, bool> has_training_graph;
   if (has_training_graph.find(executors_and_keys) == has_training_graph.end()) {
@@ -1110,6 +1211,9 @@ Status DirectSession::Run(const RunOptions& run_options,
   TF_RETURN_IF_ERROR(GetOrCreateExecutors(input_tensor_names, output_names,
                                           target_nodes, &executors_and_keys,
                                           &run_state_args));
+  for (const string& take : executors_and_keys->auto_smart_stage_takes) {
+    smart_stage_runner_->MaybeStart(take);
+  }
   {
     mutex_lock l(collective_graph_key_lock_);
     collective_graph_key_ = executors_and_keys->collective_graph_key;
@@ -1147,9 +1251,12 @@ Status DirectSession::Run(const RunOptions& run_options,
     LogMemory::RecordStep(step_id, run_state_args.handle);
   }
 
-  TF_RETURN_IF_ERROR(RunInternal(step_id, run_options, &call_frame,
-                                 executors_and_keys, run_metadata,
-                                 thread::ThreadPoolOptions()));
+  TF_RETURN_IF_ERROR(RunMicroBatchPipeline(
+      executors_and_keys, inputs, [&]() {
+        return RunInternal(step_id, run_options, &call_frame,
+                           executors_and_keys, run_metadata,
+                           thread::ThreadPoolOptions());
+      }));
 
   // Receive outputs.
   if (outputs) {
@@ -1223,6 +1330,8 @@ Status DirectSession::PRunSetup(const std::vector<string>& input_names,
     args.executor_policy = ExecutorPolicy::USE_INLINE_EXECUTOR;
   } else if (run_cost_model_executor_) {
     args.executor_policy = ExecutorPolicy::USE_COST_MODEL_EXECUTOR;
+  } else if (run_work_stealing_executor_) {
+    args.executor_policy = ExecutorPolicy::USE_WORK_STEALING_EXECUTOR;
   } else {
     args.executor_policy = ExecutorPolicy::USE_NORMAL_EXECUTOR;
   }
@@ -1681,6 +1790,33 @@ Status DirectSession::CreateExecutors(
     TF_RETURN_IF_ERROR(EnsureMemoryTypes(DeviceType(device->device_type()),
                                          device->name(),
                                          partition_graph.get()));
+    if (smart_stage_runner_ != nullptr) {
+      for (const Node* n : partition_graph->op_nodes()) {
+        if (n->IsUnstage() && smart_stage_runner_->HasStage(n->name())) {
+          ek->auto_smart_stage_takes.push_back(n->name());
+        }
+      }
+    }
+    std::vector<string> micro_batch_takes;
+    for (const Node* n : partition_graph->op_nodes()) {
+      if (n->type_string() == "_MicroBatchTake" ||
+          n->type_string() == "_MicroBatchSparseTake") {
+        micro_batch_takes.push_back(n->name());
+      }
+    }
+    if (!micro_batch_takes.empty()) {
+      mutex_lock l(graph_state_lock_);
+      for (const string& take : micro_batch_takes) {
+        auto it = micro_batch_accumulators_.find(take);
+        if (it == micro_batch_accumulators_.end()) {
+          continue;
+        }
+        ek->micro_batch_accumulates.push_back(it->second.accumulate_node);
+        ek->micro_batch_aborts.push_back(it->second.abort_node);
+        ek->micro_batch_resets.push_back(it->second.reset_node);
+      }
+    }
+
     // NewLocalExecutor takes ownership of partition_graph.
     item->graph = partition_graph.get();
     item->executor = nullptr;
@@ -2014,7 +2150,15 @@ Status DirectSession::CreateGraphs(
 }
 
 ::tensorflow::Status DirectSession::Close() {
+  // The prefetch runs the buffer cancel ops in this session, so it must be
+  // cancelled before the session.
+  if (smart_stage_runner_ != nullptr) {
+    smart_stage_runner_->Cancel();
+  }
   cancellation_manager_->StartCancel();
+  if (smart_stage_runner_ != nullptr) {
+    smart_stage_runner_->Join();
+  }
   {
     mutex_lock l(closed_lock_);
     if (closed_) return ::tensorflow::Status::OK();
@@ -2198,6 +2342,9 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
     return errors::InvalidArgument(
         "Attempted to run callable after handle was released: ", handle);
   }
+  for (const string& take : executors_and_keys->auto_smart_stage_takes) {
+    smart_stage_runner_->MaybeStart(take);
+  }
 
   // NOTE(mrry): Debug options are not currently supported in the
   // callable interface.
@@ -2235,9 +2382,21 @@ class DirectSession::RunCallableCallFrame : public CallFrameInterface {
     LogMemory::RecordStep(step_id, run_state_args.handle);
   }
 
-  TF_RETURN_IF_ERROR(RunInternal(
-      step_id, executors_and_keys->callable_options.run_options(), &call_frame,
-      executors_and_keys.get(), run_metadata, threadpool_options));
+  NamedTensorList inputs;
+  if (!executors_and_keys->micro_batch_accumulates.empty()) {
+    const CallableOptions& callable_options =
+        executors_and_keys->callable_options;
+    for (int i = 0; i < callable_options.feed_size(); ++i) {
+      inputs.emplace_back(callable_options.feed(i), feed_tensors[i]);
+    }
+  }
+  TF_RETURN_IF_ERROR(RunMicroBatchPipeline(
+      executors_and_keys.get(), inputs, [&]() {
+        return RunInternal(
+            step_id, executors_and_keys->callable_options.run_options(),
+            &call_frame, executors_and_keys.get(), run_metadata,
+            threadpool_options);
+      }));
 
   if (fetch_tensors != nullptr) {
     size_t output_size = 0;
@@ -33,6 +33,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/process_function_library_runtime.h"
 #include "tensorflow/core/common_runtime/rendezvous_mgr.h"
 #include "tensorflow/core/common_runtime/session_factory.h"
+#include "tensorflow/core/common_runtime/smart_stage_runner.h"
 #include "tensorflow/core/framework/cancellation.h"
 #include "tensorflow/core/framework/collective.h"
 #include "tensorflow/core/framework/graph.pb.h"
@@ -174,6 +175,15 @@ class DirectSession : public Session {
     CallableOptions callable_options;
 
     int64 collective_graph_key = BuildGraphOptions::kNoCollectiveGraphKey;
+
+    // TensorBufferTake nodes of the auto SmartStage run by the executors.
+    std::vector<string> auto_smart_stage_takes;
+
+    // Nodes of the micro-batch gradient accumulators whose gradient is
+    // taken by the executors, see RunMicroBatchPipeline().
+    std::vector<string> micro_batch_accumulates;
+    std::vector<string> micro_batch_aborts;
+    std::vector<string> micro_batch_resets;
   };
 
   // A FunctionInfo object is created for every unique set of feeds/fetches.
@@ -261,6 +271,13 @@ class DirectSession : public Session {
       RunMetadata* run_metadata,
       const thread::ThreadPoolOptions& threadpool_options);
 
+  // Runs `run_step` along with the other micro-batches of the step when
+  // `executors_and_keys` takes accumulated gradients, otherwise only runs
+  // `run_step`. The other micro-batches are fed `inputs`.
+  ::tensorflow::Status RunMicroBatchPipeline(
+      ExecutorsAndKeys* executors_and_keys, const NamedTensorList& inputs,
+      const std::function<::tensorflow::Status()>& run_step);
+
   // Returns whether enable tracking of tensorpool allocator
   bool EnableTensorPoolTracking(ExecutorsAndKeys* executors_and_keys);
 
@@ -398,6 +415,23 @@ class DirectSession : public Session {
   // library; it copies and modifies the function library.
   std::unique_ptr<FunctionLibraryDefinition> flib_def_;
 
+  // Prefetches the stages inserted by the auto SmartStage, created when the
+  // graph has such stages.
+  std::unique_ptr<SmartStageRunner> smart_stage_runner_;
+
+  // Gradient accumulators of the micro-batch pipeline by take node.
+  std::unordered_map<string, MicroBatchAccumulatorNodes>
+      micro_batch_accumulators_ GUARDED_BY(graph_state_lock_);
+  // Guards the state of the micro-batch pipeline below.
+  mutex micro_batch_mu_;
+  // Runs the micro-batches of a step but the last one.
+  std::unique_ptr<thread::ThreadPool> micro_batch_pool_
+      GUARDED_BY(micro_batch_mu_);
+  // Held by a pipelined step for each of its accumulators, by accumulate
+  // node.
+  std::unordered_map<string, std::unique_ptr<mutex>>
+      micro_batch_accumulator_mus_ GUARDED_BY(micro_batch_mu_);
+
   // true if the Session has been Closed.
   mutex closed_lock_;
   bool closed_ GUARDED_BY(closed_lock_) = false;
@@ -434,6 +468,9 @@ class DirectSession : public Session {
   // If true, will use cost_model_executor to run the graph.
   bool run_cost_model_executor_ = false;
 
+  // If true, will use work_stealing_executor to run the graph.
+  bool run_work_stealing_executor_ = false;
+
   TF_DISALLOW_COPY_AND_ASSIGN(DirectSession);
 
   // EXPERIMENTAL: debugger (tfdbg) related
@@ -1708,6 +1708,174 @@ TEST(DirectSessionTest, TimeoutSession) {
   }
 }
 
+TEST(DirectSessionTest, AutoSmartStagePrefetchesQueue) {
+  Graph g(OpRegistry::Global());
+  Node* queue;
+  TF_ASSERT_OK(NodeBuilder("queue", "FIFOQueueV2")
+                   .Attr("component_types", DataTypeVector{DT_FLOAT})
+                   .Attr("capacity", 10)
+                   .Finalize(&g, &queue));
+  Node* one = test::graph::Constant(&g, test::AsScalar<float>(1.0));
+  Node* enqueue;
+  TF_ASSERT_OK(NodeBuilder("enqueue", "QueueEnqueueV2")
+                   .Input(queue)
+                   .Input({NodeBuilder::NodeOut(one)})
+                   .Finalize(&g, &enqueue));
+  Node* close;
+  TF_ASSERT_OK(
+      NodeBuilder("close", "QueueCloseV2").Input(queue).Finalize(&g, &close));
+  Node* dequeue;
+  TF_ASSERT_OK(NodeBuilder("dequeue", "QueueDequeueV2")
+                   .Input(queue)
+                   .Attr("component_types", DataTypeVector{DT_FLOAT})
+                   .Finalize(&g, &dequeue));
+  Node* var = test::graph::Var(&g, DT_FLOAT, TensorShape({}));
+  Node* init = test::graph::Assign(
+      &g, var, test::graph::Constant(&g, test::AsScalar<float>(10.0)));
+  // The dequeue runs in the prefetch, the add reading the variable runs in
+  // the step.
+  Node* add = test::graph::Add(&g, test::graph::Unary(&g, "Neg", dequeue),
+                               var);
+  GraphDef def;
+  g.ToGraphDef(&def);
+
+  SessionOptions options = DefaultSessionOptions();
+  options.config.mutable_graph_options()
+      ->mutable_optimizer_options()
+      ->set_do_auto_smart_stage(true);
+  std::unique_ptr<Session> session(NewSession(options));
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def));
+  TF_ASSERT_OK(session->Run({}, {}, {init->name()}, nullptr));
+  for (int i = 0; i < 3; ++i) {
+    TF_ASSERT_OK(session->Run({}, {}, {enqueue->name()}, nullptr));
+  }
+  TF_ASSERT_OK(session->Run({}, {}, {close->name()}, nullptr));
+
+  std::vector<Tensor> outputs;
+  for (int i = 0; i < 3; ++i) {
+    TF_ASSERT_OK(session->Run({}, {add->name()}, {}, &outputs));
+    ASSERT_EQ(1, outputs.size());
+    EXPECT_EQ(9.0, outputs[0].scalar<float>()());
+  }
+  // The prefetch closes the buffer at the end of the queue.
+  EXPECT_TRUE(
+      errors::IsOutOfRange(session->Run({}, {add->name()}, {}, &outputs)));
+  TF_ASSERT_OK(session->Close());
+}
+
+TEST(DirectSessionTest, AutoSmartStageKeepsControlDependencies) {
+  Graph g(OpRegistry::Global());
+  Node* queue;
+  TF_ASSERT_OK(NodeBuilder("queue", "FIFOQueueV2")
+                   .Attr("component_types", DataTypeVector{DT_FLOAT})
+                   .Attr("capacity", 10)
+                   .Finalize(&g, &queue));
+  Node* one = test::graph::Constant(&g, test::AsScalar<float>(1.0));
+  Node* enqueue;
+  TF_ASSERT_OK(NodeBuilder("enqueue", "QueueEnqueueV2")
+                   .Input(queue)
+                   .Input({NodeBuilder::NodeOut(one)})
+                   .Finalize(&g, &enqueue));
+  Node* close;
+  TF_ASSERT_OK(
+      NodeBuilder("close", "QueueCloseV2").Input(queue).Finalize(&g, &close));
+  Node* dequeue;
+  TF_ASSERT_OK(NodeBuilder("dequeue", "QueueDequeueV2")
+                   .Input(queue)
+                   .Attr("component_types", DataTypeVector{DT_FLOAT})
+                   .Finalize(&g, &dequeue));
+  test::graph::Unary(&g, "Neg", dequeue);
+  // Only a control dependent of the dequeue is run, it must still consume a
+  // record per step.
+  Node* noop = test::graph::NoOp(&g, {dequeue});
+  GraphDef def;
+  g.ToGraphDef(&def);
+
+  SessionOptions options = DefaultSessionOptions();
+  options.config.mutable_graph_options()
+      ->mutable_optimizer_options()
+      ->set_do_auto_smart_stage(true);
+  std::unique_ptr<Session> session(NewSession(options));
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def));
+  for (int i = 0; i < 2; ++i) {
+    TF_ASSERT_OK(session->Run({}, {}, {enqueue->name()}, nullptr));
+  }
+  TF_ASSERT_OK(session->Run({}, {}, {close->name()}, nullptr));
+
+  for (int i = 0; i < 2; ++i) {
+    TF_ASSERT_OK(session->Run({}, {}, {noop->name()}, nullptr));
+  }
+  EXPECT_TRUE(
+      errors::IsOutOfRange(session->Run({}, {}, {noop->name()}, nullptr)));
+  TF_ASSERT_OK(session->Close());
+}
+
+TEST(DirectSessionTest, MicroBatchPipelineAccumulatesGradients) {
+  Graph g(OpRegistry::Global());
+  Node* queue;
+  TF_ASSERT_OK(NodeBuilder("queue", "FIFOQueueV2")
+                   .Attr("component_types", DataTypeVector{DT_FLOAT})
+                   .Attr("capacity", 10)
+                   .Finalize(&g, &queue));
+  Node* value;
+  TF_ASSERT_OK(NodeBuilder("value", "Placeholder")
+                   .Attr("dtype", DT_FLOAT)
+                   .Finalize(&g, &value));
+  Node* enqueue;
+  TF_ASSERT_OK(NodeBuilder("enqueue", "QueueEnqueueV2")
+                   .Input(queue)
+                   .Input({NodeBuilder::NodeOut(value)})
+                   .Finalize(&g, &enqueue));
+  Node* grad;
+  TF_ASSERT_OK(NodeBuilder("grad", "QueueDequeueV2")
+                   .Input(queue)
+                   .Attr("component_types", DataTypeVector{DT_FLOAT})
+                   .Finalize(&g, &grad));
+  Node* var = test::graph::Var(&g, DT_FLOAT, TensorShape({}));
+  Node* accum = test::graph::Var(&g, DT_FLOAT, TensorShape({}));
+  Node* zero = test::graph::Constant(&g, test::AsScalar<float>(0.0));
+  Node* init_var = test::graph::Assign(&g, var, zero);
+  Node* init_accum = test::graph::Assign(&g, accum, zero);
+  Node* lr = test::graph::Constant(&g, test::AsScalar<float>(1.0));
+  Node* apply;
+  TF_ASSERT_OK(NodeBuilder("apply", "ApplyAdagrad")
+                   .Input(var)
+                   .Input(accum)
+                   .Input(lr)
+                   .Input(grad)
+                   .Finalize(&g, &apply));
+  GraphDef def;
+  g.ToGraphDef(&def);
+
+  SessionOptions options = DefaultSessionOptions();
+  OptimizerOptions* optimizer_options =
+      options.config.mutable_graph_options()->mutable_optimizer_options();
+  optimizer_options->set_micro_batch_num(3);
+  optimizer_options->set_micro_batch_pipeline(true);
+  std::unique_ptr<Session> session(NewSession(options));
+  ASSERT_TRUE(session != nullptr);
+  TF_ASSERT_OK(session->Create(def));
+  TF_ASSERT_OK(
+      session->Run({}, {}, {init_var->name(), init_accum->name()}, nullptr));
+  for (float v : {1.0f, 2.0f, 3.0f}) {
+    TF_ASSERT_OK(session->Run({{value->name(), test::AsScalar<float>(v)}}, {},
+                              {enqueue->name()}, nullptr));
+  }
+
+  // A single step dequeues the 3 micro-batches and applies the sum of
+  // their gradients once.
+  TF_ASSERT_OK(session->Run({}, {}, {apply->name()}, nullptr));
+  std::vector<Tensor> outputs;
+  TF_ASSERT_OK(
+      session->Run({}, {var->name(), accum->name()}, {}, &outputs));
+  ASSERT_EQ(2, outputs.size());
+  EXPECT_EQ(36.0, outputs[1].scalar<float>()());
+  EXPECT_EQ(-1.0, outputs[0].scalar<float>()());
+  TF_ASSERT_OK(session->Close());
+}
+
 // Accesses the cancellation manager for the step after the step has been
 // cancelled.
 class CancellationMgrPollingOp : public OpKernel {
@@ -16,8 +16,10 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/executor.h"
 
 #include <atomic>
+#include <deque>
 #include <memory>
 #include <queue>
+#include <tuple>
 #include <vector>
 
 #include "absl/memory/memory.h"
@@ -34,6 +36,7 @@ limitations under the License.
 #include "tensorflow/core/common_runtime/propagator_state.h"
 #include "tensorflow/core/common_runtime/renamed_device.h"
 #include "tensorflow/core/common_runtime/simple_propagator_state.h"
+#include "tensorflow/core/common_runtime/static_memory_planner.h"
 #include "tensorflow/core/common_runtime/step_stats_collector.h"
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/framework/cancellation.h"
@@ -59,6 +62,7 @@ limitations under the License.
 #include "tensorflow/core/lib/gtl/manual_constructor.h"
 #include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/platform/context.h"
+#include "tensorflow/core/platform/cpu_info.h"
 #include "tensorflow/core/platform/env.h"
 #include "tensorflow/core/platform/errors.h"
 #include "tensorflow/core/platform/logging.h"
@@ -174,6 +178,8 @@ class ExecutorImpl : public Executor {
     TF_RETURN_IF_ERROR(immutable_state_.Initialize());
     kernel_stats_.Initialize(immutable_state_.graph_view(),
                              immutable_state_.graph());
+    static_memory_planner_ =
+        StaticMemoryPlanner::MaybeCreate(immutable_state_.params().device);
     return Status::OK();
   }
 
@@ -189,6 +195,10 @@ class ExecutorImpl : public Executor {
     return &kernel_stats_;
   }
 
+  StaticMemoryPlanner* GetStaticMemoryPlanner() {
+    return static_memory_planner_.get();
+  }
+
  private:
   template <class PropagatorStateType>
   friend class ExecutorState;
@@ -200,6 +210,9 @@ class ExecutorImpl : public Executor {
   std::atomic<int> build_cost_model_counter_{0};
   ExecutorInternal::ExecuteCostModel* cost_model_ = nullptr;
 
+  // Null unless ENABLE_STATIC_MEMORY_PLAN is set.
+  std::unique_ptr<StaticMemoryPlanner> static_memory_planner_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(ExecutorImpl);
 };
 
@@ -271,6 +284,9 @@ class ExecutorState {
     return kernel_stats_;
   }
 
+  // Takes ownership of a reference on `plan`, which can be nullptr.
+  void SetStepMemoryPlan(StepMemoryPlan* plan) { step_memory_plan_ = plan; }
+
  protected:
   // Use `TaggedNode` types defined by `PropagatorStateType`.
   typedef typename PropagatorStateType::TaggedNode TaggedNode;
@@ -366,6 +382,7 @@ class ExecutorState {
   // QUESTION: Make it a checkpoint::TensorSliceReaderCacheWrapper
   // instead of a pointer?  (avoids having to delete).
   checkpoint::TensorSliceReaderCacheWrapper* slice_reader_cache_;
+  StepMemoryPlan* step_memory_plan_ = nullptr;
   CallFrameInterface* call_frame_;
   const ImmutableExecutorState& immutable_state_;
   ExecutorInternal::KernelStats* const kernel_stats_;
@@ -451,6 +468,166 @@ class CostExecutorState : public ExecutorState<PropagatorStateType> {
   }
 };
 
+// Ready nodes of one step, split into one deque per worker. A worker pops
+// the newest node of its own deque and steals the oldest node of the other
+// deques when its own deque is empty. The queues are shared with the worker
+// closures, since the ExecutorState is deleted as soon as its last node is
+// done while workers may still be checking the queues.
+template <class TaggedNode>
+class WorkStealingQueues {
+ public:
+  WorkStealingQueues(int num_queues, Executor::Args::Runner runner)
+      : queues_(num_queues), runner_(std::move(runner)) {}
+
+  int num_queues() const { return queues_.size(); }
+
+  // Deque a non worker thread pushes its ready nodes into.
+  int NextQueue() {
+    return next_queue_.fetch_add(1, std::memory_order_relaxed) % num_queues();
+  }
+
+  void Push(int index, const TaggedNode& node, int64_t scheduled_nsec) {
+    Queue& queue = queues_[index];
+    {
+      mutex_lock l(queue.mu);
+      queue.nodes.emplace_back(node, scheduled_nsec);
+    }
+    num_nodes_.fetch_add(1);
+  }
+
+  // Pops the newest node of deque `index`, or steals the oldest node of
+  // another deque.
+  bool Pop(int index, TaggedNode* node, int64_t* scheduled_nsec) {
+    if (num_nodes_.load() == 0) return false;
+    for (int i = 0; i < num_queues(); ++i) {
+      Queue& queue = queues_[(index + i) % num_queues()];
+      mutex_lock l(queue.mu);
+      if (queue.nodes.empty()) continue;
+      if (i == 0) {
+        std::tie(*node, *scheduled_nsec) = queue.nodes.back();
+        queue.nodes.pop_back();
+      } else {
+        std::tie(*node, *scheduled_nsec) = queue.nodes.front();
+        queue.nodes.pop_front();
+      }
+      num_nodes_.fetch_sub(1);
+      return true;
+    }
+    return false;
+  }
+
+  bool HasWork() const { return num_nodes_.load() > 0; }
+
+  // Returns true if the caller should start one more worker, at most one
+  // worker per deque is active.
+  bool TryActivateWorker() {
+    int active = num_active_workers_.load();
+    while (active < num_queues()) {
+      if (num_active_workers_.compare_exchange_weak(active, active + 1)) {
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // Takes a worker slot even if all of them are in use.
+  void ActivateWorker() { num_active_workers_.fetch_add(1); }
+
+  void DeactivateWorker() { num_active_workers_.fetch_sub(1); }
+
+  // Deque index of a new worker.
+  int NextWorkerIndex() {
+    return next_worker_.fetch_add(1, std::memory_order_relaxed) %
+           num_queues();
+  }
+
+  const Executor::Args::Runner& runner() const { return runner_; }
+
+ private:
+  struct Queue {
+    mutex mu;
+    std::deque<std::pair<TaggedNode, int64_t>> nodes TF_GUARDED_BY(mu);
+    // Keeps the locks of neighbouring deques on different cache lines.
+    char padding[64];
+  };
+
+  std::vector<Queue> queues_;
+  const Executor::Args::Runner runner_;
+  std::atomic<int> next_queue_{0};
+  std::atomic<int> next_worker_{0};
+  // Both are accessed with sequentially consistent ordering: a thread that
+  // pushes a node and then finds no free worker slot is guaranteed that
+  // the last exiting worker sees the node.
+  std::atomic<int64> num_nodes_{0};
+  std::atomic<int> num_active_workers_{0};
+};
+
+// The queues and the deque index of the work stealing worker running on
+// the current thread, nullptr if the thread is not a worker.
+struct WorkStealingWorker {
+  const void* queues = nullptr;
+  int index = 0;
+};
+static thread_local WorkStealingWorker work_stealing_worker;
+
+int64 WorkStealingExecutorWorkers() {
+  static int64 num_workers = []() {
+    int64 workers = 0;
+    Status s = ReadInt64FromEnvVar("WORK_STEALING_EXECUTOR_WORKERS",
+                                   port::MaxParallelism(), &workers);
+    if (!s.ok()) {
+      LOG(WARNING) << "Read WORK_STEALING_EXECUTOR_WORKERS envrionment error. "
+                   << s.error_message();
+      workers = port::MaxParallelism();
+    }
+    return std::max<int64>(workers, 1);
+  }();
+  return num_workers;
+}
+
+// Schedules ready nodes on per-worker deques with work stealing. The first
+// expensive ready node runs next on the current thread (continuation
+// passing), cheap and dead nodes are inlined, and the rest go to the deque
+// of the current worker, where idle workers steal them from. Workers are
+// started through `runner_` on demand, at most `WORK_STEALING_EXECUTOR_WORKERS`
+// of them per step.
+template <class PropagatorStateType>
+class WorkStealingExecutorState : public ExecutorState<PropagatorStateType> {
+ public:
+  WorkStealingExecutorState(const Executor::Args& args,
+                            const ImmutableExecutorState& immutable_state_,
+                            ExecutorInternal::KernelStats* kernel_stats_)
+      : ExecutorState<PropagatorStateType>(
+            args, immutable_state_, kernel_stats_),
+        queues_(std::make_shared<Queues>(WorkStealingExecutorWorkers(),
+                                         args.runner)) {}
+  ~WorkStealingExecutorState() {}
+
+ protected:
+  // Use `TaggedNode` types defined by `PropagatorStateType`.
+  typedef typename PropagatorStateType::TaggedNode TaggedNode;
+  typedef
+      typename PropagatorStateType::TaggedNodeReadyQueue TaggedNodeReadyQueue;
+  typedef typename PropagatorStateType::TaggedNodeSeq TaggedNodeSeq;
+
+  void ScheduleReady(TaggedNodeSeq* ready, TaggedNodeReadyQueue* inline_ready);
+
+ private:
+  typedef WorkStealingQueues<TaggedNode> Queues;
+
+  // Starts a worker if there is a free worker slot.
+  static void MaybeStartWorker(WorkStealingExecutorState* state,
+                               const std::shared_ptr<Queues>& queues);
+  // Runs `first_node` if not null, then pops or steals ready nodes until
+  // the deques are empty.
+  static void WorkerLoop(WorkStealingExecutorState* state,
+                         const std::shared_ptr<Queues>& queues,
+                         const TaggedNode* first_node,
+                         int64_t first_scheduled_nsec);
+
+  std::shared_ptr<Queues> queues_;
+};
+
 class ExecutorStateFactory {
  public:
   template <class PropagatorStateType>
@@ -459,22 +636,33 @@ class ExecutorStateFactory {
     ImmutableExecutorState& immutable_state = impl->GetImmutableState();
     ExecutorInternal::KernelStats* kernel_stats = impl->GetKernelStat();
 
+    ExecutorState<PropagatorStateType>* state = nullptr;
     // InlineExecuteState
     if (args.executor_policy == ExecutorPolicy::USE_INLINE_EXECUTOR) {
-      return new InlineExecutorState<PropagatorStateType>(
+      state = new InlineExecutorState<PropagatorStateType>(
+          args, immutable_state, kernel_stats);
+    } else if (args.executor_policy ==
+               ExecutorPolicy::USE_WORK_STEALING_EXECUTOR) {
+      state = new WorkStealingExecutorState<PropagatorStateType>(
           args, immutable_state, kernel_stats);
     } else if (args.cost_runner &&
                args.executor_policy == ExecutorPolicy::USE_COST_MODEL_EXECUTOR) {
       // TODO: FIXME consider function lib executor, set cost_runner for it?
       // Schedule by cost model
       ExecutorInternal::ExecuteCostModel* cm = impl->TryToBuildCostModel();
-      return new CostExecutorState<PropagatorStateType>(
+      state = new CostExecutorState<PropagatorStateType>(
           args, immutable_state, kernel_stats, cm);
     } else {
       // normal schedule
-      return new ExecutorState<PropagatorStateType>(
+      state = new ExecutorState<PropagatorStateType>(
           args, immutable_state, kernel_stats);
     }
+
+    StaticMemoryPlanner* planner = impl->GetStaticMemoryPlanner();
+    if (planner != nullptr) {
+      state->SetStepMemoryPlan(planner->StartStep());
+    }
+    return state;
   }
 };
 
@@ -553,6 +741,10 @@ ExecutorState<PropagatorStateType>::~ExecutorState() {
     device_context_->Unref();
   }
   delete slice_reader_cache_;
+  if (step_memory_plan_) {
+    step_memory_plan_->StepDone();
+    step_memory_plan_->Unref();
+  }
 }
 
 template <class PropagatorStateType>
@@ -848,6 +1040,7 @@ void ExecutorState<PropagatorStateType>::BatchProcess(std::vector<TaggedNode> no
   params.resource_manager = device->resource_manager();
   params.step_container = step_container_;
   params.slice_reader_cache = slice_reader_cache_;
+  params.step_memory_plan = step_memory_plan_;
   params.inputs = &inputs;
   params.input_alloc_attrs = &input_alloc_attrs;
   params.runner = &runner_;
@@ -1650,6 +1843,100 @@ void CostExecutorState<PropagatorStateType>::CostScheduleReady(
   ready->clear();
 }
 
+template <class PropagatorStateType>
+void WorkStealingExecutorState<PropagatorStateType>::ScheduleReady(
+    TaggedNodeSeq* ready, TaggedNodeReadyQueue* inline_ready) {
+  DCHECK(!ready->empty());
+
+  int64_t scheduled_nsec = 0;
+  if (this->stats_collector_) {
+    scheduled_nsec = nodestats::NowInNsec();
+  }
+
+  if (inline_ready == nullptr) {
+    // Like the normal executor, the last ready node is handed to a new
+    // worker directly: the step can not be done before, so `this` is valid
+    // until that node is dispatched.
+    const TaggedNode last = ready->back();
+    ready->pop_back();
+    for (auto& tagged_node : *ready) {
+      queues_->Push(queues_->NextQueue(), tagged_node, scheduled_nsec);
+      MaybeStartWorker(this, queues_);
+    }
+    ready->clear();
+    queues_->ActivateWorker();
+    std::shared_ptr<Queues> queues = queues_;
+    queues->runner()([this, queues, last, scheduled_nsec]() {
+      WorkerLoop(this, queues, &last, scheduled_nsec);
+    });
+    return;
+  }
+
+  const bool is_worker = work_stealing_worker.queues == queues_.get();
+  const int index =
+      is_worker ? work_stealing_worker.index : queues_->NextQueue();
+  bool has_continuation = false;
+  int num_pushed = 0;
+  for (auto& tagged_node : *ready) {
+    const NodeItem& item = *tagged_node.node_item;
+    if (tagged_node.get_is_dead() || !this->kernel_stats_->IsExpensive(item)) {
+      // Inline this inexpensive node.
+      inline_ready->push_back(tagged_node);
+    } else if (!has_continuation) {
+      // The first expensive consumer runs next on this thread, its inputs
+      // are most likely still in cache.
+      inline_ready->push_back(tagged_node);
+      has_continuation = true;
+    } else {
+      queues_->Push(index, tagged_node, scheduled_nsec);
+      ++num_pushed;
+    }
+  }
+  ready->clear();
+  // The nodes in `inline_ready` keep `this` alive here.
+  for (int i = 0; i < num_pushed; ++i) {
+    MaybeStartWorker(this, queues_);
+  }
+}
+
+template <class PropagatorStateType>
+void WorkStealingExecutorState<PropagatorStateType>::MaybeStartWorker(
+    WorkStealingExecutorState* state, const std::shared_ptr<Queues>& queues) {
+  if (!queues->TryActivateWorker()) return;
+  queues->runner()([state, queues]() {
+    WorkerLoop(state, queues, nullptr, 0);
+  });
+}
+
+template <class PropagatorStateType>
+void WorkStealingExecutorState<PropagatorStateType>::WorkerLoop(
+    WorkStealingExecutorState* state, const std::shared_ptr<Queues>& queues,
+    const TaggedNode* first_node, int64_t first_scheduled_nsec) {
+  WorkStealingWorker saved = work_stealing_worker;
+  work_stealing_worker.queues = queues.get();
+  work_stealing_worker.index = queues->NextWorkerIndex();
+
+  if (first_node != nullptr) {
+    state->Process(*first_node, first_scheduled_nsec);
+  }
+
+  TaggedNode tagged_node;
+  int64_t scheduled_nsec = 0;
+  while (true) {
+    // `state` is alive as long as a popped node is not done.
+    while (queues->Pop(work_stealing_worker.index, &tagged_node,
+                       &scheduled_nsec)) {
+      state->Process(tagged_node, scheduled_nsec);
+    }
+    queues->DeactivateWorker();
+    // Recheck after giving up the slot, a node may have been pushed by a
+    // thread which saw no free slot.
+    if (!queues->HasWork() || !queues->TryActivateWorker()) break;
+  }
+
+  work_stealing_worker = saved;
+}
+
 ExecutorInternal::ExecuteCostModel* ExecutorImpl::TryToBuildCostModel() {
   if (cost_model_) return cost_model_;
 
@@ -83,12 +83,14 @@ class ExecutorTest : public ::testing::Test {
         { thread_pool_->CostSchedule(fn, cost); };
   }
 
-  Status Run(Rendezvous* rendez) {
+  Status Run(Rendezvous* rendez, ExecutorPolicy executor_policy =
+                                      ExecutorPolicy::USE_NORMAL_EXECUTOR) {
     Executor::Args args;
     args.rendezvous = rendez;
     args.stats_collector = &step_stats_collector_;
     args.runner = runner_;
     args.cost_runner = cost_runner_;
+    args.executor_policy = executor_policy;
     return exec_->Run(args);
   }
 
@@ -254,6 +256,21 @@ TEST_F(ExecutorTest, RandomTree) {
   EXPECT_EQ(4096.0, V(out));
 }
 
+TEST_F(ExecutorTest, RandomTreeWorkStealing) {
+  auto g = absl::make_unique<Graph>(OpRegistry::Global());
+  BuildTree(4096, g.get());
+  Create(std::move(g));
+  Rendezvous::Args args;
+  TF_ASSERT_OK(
+      rendez_->Send(Key(ALICE, kIncarnation, BOB, "a"), args, V(1.0), false));
+  TF_ASSERT_OK(Run(rendez_, ExecutorPolicy::USE_WORK_STEALING_EXECUTOR));
+  Tensor out = V(-1);
+  bool is_dead = false;
+  TF_ASSERT_OK(
+      rendez_->Recv(Key(BOB, kIncarnation, ALICE, "b"), args, &out, &is_dead));
+  EXPECT_EQ(4096.0, V(out));
+}
+
 void BuildConcurrentAddAssign(Graph* g) {
   auto one = test::graph::Constant(g, V(1.0));
   // A variable holds one float.
@@ -289,6 +306,23 @@ TEST_F(ExecutorTest, ConcurrentAddAssign) {
     rendez->Unref();
   }
 }
+
+TEST_F(ExecutorTest, ConcurrentAddAssignWorkStealing) {
+  auto g = absl::make_unique<Graph>(OpRegistry::Global());
+  BuildConcurrentAddAssign(g.get());
+  Create(std::move(g));
+  for (int iters = 0; iters < 16; ++iters) {
+    Rendezvous* rendez = NewLocalRendezvous();
+    TF_ASSERT_OK(Run(rendez, ExecutorPolicy::USE_WORK_STEALING_EXECUTOR));
+    Rendezvous::Args args;
+    Tensor out;
+    bool is_dead;
+    TF_ASSERT_OK(rendez->Recv(Key(ALICE, kIncarnation, BOB, "out"), args, &out,
+                              &is_dead));
+    EXPECT_LE(V(out), 1025.0);
+    rendez->Unref();
+  }
+}
 #endif
 
 TEST_F(ExecutorTest, SimpleSwitchLive) {
@@ -424,11 +458,8 @@ TEST_F(ExecutorTest, RecvInvalidRefDtype) {
 // Create a graph that is 'depth' deep. At each level, fan-in and fan-out a
 // maximum of 'width' nodes. All nodes are no-ops and all dependencies are
 // control dependencies.
-static void BM_executor(int iters, int width, int depth) {
-#ifdef PLATFORM_GOOGLE
-  BenchmarkUseRealTime();
-#endif  // PLATFORM_GOOGLE
-  Graph* g = new Graph(OpRegistry::Global());
+static void BuildRandomNoOpGraph(Graph* g, int width, int depth,
+                                 uint64* num_nodes) {
   random::PhiloxRandom philox(1729, 17);
   random::SimplePhilox rand(&philox);
   uint64 cur = 0;
@@ -456,6 +487,16 @@ static void BM_executor(int iters, int width, int depth) {
       ++cur;
     }
   }
+  *num_nodes = cur;
+}
+
+static void BM_executor(int iters, int width, int depth) {
+#ifdef PLATFORM_GOOGLE
+  BenchmarkUseRealTime();
+#endif  // PLATFORM_GOOGLE
+  Graph* g = new Graph(OpRegistry::Global());
+  uint64 cur = 0;
+  BuildRandomNoOpGraph(g, width, depth, &cur);
 #ifdef PLATFORM_GOOGLE
   SetBenchmarkLabel(strings::StrCat("Nodes = ", cur));
   SetBenchmarkItemsProcessed(cur * static_cast<int64>(iters));
@@ -463,6 +504,24 @@ static void BM_executor(int iters, int width, int depth) {
   test::Benchmark("cpu", g).Run(iters);
 }
 
+// Same graphs as BM_executor, scheduled by the work stealing executor.
+static void BM_executor_work_stealing(int iters, int width, int depth) {
+#ifdef PLATFORM_GOOGLE
+  BenchmarkUseRealTime();
+#endif  // PLATFORM_GOOGLE
+  Graph* g = new Graph(OpRegistry::Global());
+  uint64 cur = 0;
+  BuildRandomNoOpGraph(g, width, depth, &cur);
+#ifdef PLATFORM_GOOGLE
+  SetBenchmarkLabel(strings::StrCat("Nodes = ", cur));
+  SetBenchmarkItemsProcessed(cur * static_cast<int64>(iters));
+#endif  // PLATFORM_GOOGLE
+  SessionOptions options;
+  options.config.set_executor_policy(
+      ExecutorPolicy::USE_WORK_STEALING_EXECUTOR);
+  test::Benchmark("cpu", g, &options).Run(iters);
+}
+
 // Tall skinny graphs
 BENCHMARK(BM_executor)->ArgPair(16, 1024);
 BENCHMARK(BM_executor)->ArgPair(32, 8192);
@@ -474,6 +533,12 @@ BENCHMARK(BM_executor)->ArgPair(8192, 32);
 // Tall fat graph
 BENCHMARK(BM_executor)->ArgPair(1024, 1024);
 
+BENCHMARK(BM_executor_work_stealing)->ArgPair(16, 1024);
+BENCHMARK(BM_executor_work_stealing)->ArgPair(32, 8192);
+BENCHMARK(BM_executor_work_stealing)->ArgPair(1024, 16);
+BENCHMARK(BM_executor_work_stealing)->ArgPair(8192, 32);
+BENCHMARK(BM_executor_work_stealing)->ArgPair(1024, 1024);
+
 static void BM_FeedInputFetchOutput(int iters) {
   Graph* g = new Graph(OpRegistry::Global());
   // z = x + y: x and y are provided as benchmark inputs.  z is the
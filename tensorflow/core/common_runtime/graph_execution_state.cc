@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/common_runtime/graph_execution_state.h"
 
+#include <algorithm>
+#include <map>
 #include <memory>
 #include <set>
 #include <string>
@@ -42,6 +44,8 @@ limitations under the License.
 #include "tensorflow/core/graph/collective_order.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/graph/graph_constructor.h"
+#include "tensorflow/core/graph/graph_node_util.h"
+#include "tensorflow/core/graph/node_builder.h"
 #include "tensorflow/core/graph/subgraph.h"
 #include "tensorflow/core/graph/tensor_id.h"
 #include "tensorflow/core/graph/validate.h"
@@ -645,6 +649,231 @@ Status GraphExecutionState::PipelineGraph(std::unique_ptr<Graph>* g,
   return Status::OK();
 }
 
+Status GraphExecutionState::MicroBatchPipelineGraph(
+    std::unique_ptr<Graph>* g, int32 micro_batch_num) {
+  Graph* graph = g->get();
+  std::vector<Node*> apply_nodes;
+  for (Node* n : graph->op_nodes()) {
+    if (n->IsApplyAdagradOps() || n->IsSparseApplyAdagradOps() ||
+        n->IsApplyFtrlOps() || n->IsSparseApplyFtrlOps() ||
+        n->IsApplyAdamOps() || n->IsApplySparseAdamOps()) {
+      if (!IsCPUDevice(n->assigned_device_name()) ||
+          InputIndex(n, "grad") < 0) {
+        VLOG(1) << "Micro-batch pipeline doesn't support " << n->name()
+                << " on " << n->assigned_device_name()
+                << ", duplicate the graph instead.";
+        return PipelineGraph(g, micro_batch_num);
+      }
+      apply_nodes.push_back(n);
+    }
+  }
+
+  for (Node* n : apply_nodes) {
+    const int grad_index = InputIndex(n, "grad");
+    const int indices_index = InputIndex(n, "indices");
+    const Edge* grad_edge;
+    TF_RETURN_IF_ERROR(n->input_edge(grad_index, &grad_edge));
+    const Edge* indices_edge = nullptr;
+    if (indices_index >= 0) {
+      TF_RETURN_IF_ERROR(n->input_edge(indices_index, &indices_edge));
+    }
+
+    const string prefix = strings::StrCat(n->name(), "/MicroBatch");
+    const DataType dtype = n->input_type(grad_index);
+    auto accumulator_op = [&](const string& name, const string& op) {
+      NodeBuilder builder(strings::StrCat(prefix, "/", name), op);
+      builder.Attr("shared_name", prefix);
+      if (op != "_MicroBatchAbort") {
+        builder.Attr("T", dtype)
+            .Attr("num_micro_batches", micro_batch_num);
+      }
+      if (indices_edge != nullptr && op != "_MicroBatchAbort") {
+        builder.Attr("Tindices", n->input_type(indices_index));
+      }
+      return builder;
+    };
+
+    // Every micro-batch runs the accumulate node. The step applying the
+    // gradient also runs the take node, which waits for the gradients of
+    // the other micro-batches.
+    Node* accumulate;
+    Node* take;
+    if (indices_edge == nullptr) {
+      TF_RETURN_IF_ERROR(
+          accumulator_op("Accumulate", "_MicroBatchAccumulate")
+              .Input(grad_edge->src(), grad_edge->src_output())
+              .Finalize(graph, &accumulate));
+      TF_RETURN_IF_ERROR(accumulator_op("Take", "_MicroBatchTake")
+                             .ControlInput(accumulate)
+                             .Finalize(graph, &take));
+    } else {
+      TF_RETURN_IF_ERROR(
+          accumulator_op("Accumulate", "_MicroBatchSparseAccumulate")
+              .Input(grad_edge->src(), grad_edge->src_output())
+              .Input(indices_edge->src(), indices_edge->src_output())
+              .Finalize(graph, &accumulate));
+      TF_RETURN_IF_ERROR(accumulator_op("Take", "_MicroBatchSparseTake")
+                             .ControlInput(accumulate)
+                             .Finalize(graph, &take));
+    }
+    Node* abort;
+    TF_RETURN_IF_ERROR(accumulator_op("Abort", "_MicroBatchAbort")
+                           .Attr("reset", false)
+                           .Finalize(graph, &abort));
+    Node* reset;
+    TF_RETURN_IF_ERROR(accumulator_op("Reset", "_MicroBatchAbort")
+                           .Attr("reset", true)
+                           .Finalize(graph, &reset));
+    for (Node* node : {accumulate, take, abort, reset}) {
+      node->set_assigned_device_name(n->assigned_device_name());
+    }
+
+    TF_RETURN_IF_ERROR(graph->UpdateEdge(take, 0, n, grad_index));
+    if (indices_edge != nullptr) {
+      TF_RETURN_IF_ERROR(graph->UpdateEdge(take, 1, n, indices_index));
+    }
+
+    MicroBatchAccumulatorNodes nodes;
+    nodes.accumulate_node = accumulate->name();
+    nodes.take_node = take->name();
+    nodes.abort_node = abort->name();
+    nodes.reset_node = reset->name();
+    micro_batch_accumulators_.push_back(nodes);
+    VLOG(1) << "Micro-batch pipeline accumulates the gradient of "
+            << n->name();
+  }
+  return Status::OK();
+}
+
+namespace {
+
+// Ops producing the input samples of a step. The auto SmartStage stages
+// their outputs, SmartStageGraph then moves the stage down to the first
+// nodes reading variables, e.g. KvResourceGather, so that parsing, string
+// and hash ops of the input run in the prefetch.
+bool IsAutoSmartStageSource(const Node* n) {
+  const string& op = n->type_string();
+  return op == "IteratorGetNext" || op == "IteratorGetNextSync" ||
+         op == "QueueDequeueV2" || op == "QueueDequeueManyV2" ||
+         op == "QueueDequeueUpToV2";
+}
+
+}  // namespace
+
+Status GraphExecutionState::AutoSmartStageGraph(Graph* graph) {
+  std::vector<Node*> sources;
+  for (Node* n : graph->op_nodes()) {
+    if (n->IsStage() || n->IsUnstage()) {
+      VLOG(1) << "Graph has user-placed stages, skip auto SmartStage.";
+      return Status::OK();
+    }
+    if (IsAutoSmartStageSource(n)) {
+      sources.push_back(n);
+    }
+  }
+
+  int64 capacity = 2;
+  Status s = ReadInt64FromEnvVar("SMART_STAGE_CAPACITY", 2, &capacity);
+  if (!s.ok()) {
+    LOG(ERROR) << "Read SMART_STAGE_CAPACITY envrionment error. "
+               << s.error_message();
+  }
+  int64 max_capacity = 16;
+  s = ReadInt64FromEnvVar("SMART_STAGE_MAX_CAPACITY", 16, &max_capacity);
+  if (!s.ok()) {
+    LOG(ERROR) << "Read SMART_STAGE_MAX_CAPACITY envrionment error. "
+               << s.error_message();
+  }
+  capacity = std::max(capacity, int64{1});
+
+  for (Node* src : sources) {
+    std::vector<const Edge*> control_edges;
+    std::map<int, std::vector<const Edge*>> edges_by_output;
+    for (const Edge* e : src->out_edges()) {
+      if (e->IsControlEdge()) {
+        control_edges.push_back(e);
+      } else {
+        edges_by_output[e->src_output()].push_back(e);
+      }
+    }
+    if (edges_by_output.empty()) {
+      continue;
+    }
+
+    const string prefix = strings::StrCat(src->name(), "/AutoSmartStage");
+    std::vector<NodeBuilder::NodeOut> record;
+    DataTypeVector dtypes;
+    for (const auto& it : edges_by_output) {
+      record.emplace_back(src, it.first);
+      dtypes.push_back(src->output_type(it.first));
+    }
+
+    // Nodes of the buffer ops are named after their shared buffer, like the
+    // ones created by prefetch.staged().
+    auto buffer_op = [&](const string& op) {
+      return NodeBuilder(strings::StrCat(prefix, "/", op), op)
+          .Attr("shared_name", prefix)
+          .Attr("shared_capacity", capacity)
+          .Attr("shared_max_capacity", max_capacity);
+    };
+    Node* put;
+    TF_RETURN_IF_ERROR(buffer_op("TensorBufferPut")
+                           .Input(record)
+                           .Attr("timeout_millis", 300000)
+                           .Finalize(graph, &put));
+    Node* take;
+    TF_RETURN_IF_ERROR(buffer_op("TensorBufferTake")
+                           .Attr("dtypes", dtypes)
+                           .Finalize(graph, &take));
+    Node* cancel;
+    TF_RETURN_IF_ERROR(buffer_op("TensorBufferCancel").Finalize(graph, &cancel));
+    Node* close;
+    TF_RETURN_IF_ERROR(buffer_op("TensorBufferClose").Finalize(graph, &close));
+    Node* size;
+    TF_RETURN_IF_ERROR(buffer_op("TensorBufferSize").Finalize(graph, &size));
+    for (Node* n : {put, take, cancel, close, size}) {
+      n->set_assigned_device_name(src->assigned_device_name());
+    }
+
+    // Consumers read the record through an Identity, which SmartStageGraph
+    // moves into the prefetch. A consumer reading variables directly, e.g.
+    // a KvResourceGather of the ids, is thus left in the step.
+    int index = 0;
+    for (const auto& it : edges_by_output) {
+      Node* identity;
+      TF_RETURN_IF_ERROR(
+          NodeBuilder(strings::StrCat(prefix, "/Identity_", it.first),
+                      "Identity")
+              .Input(take, index++)
+              .Finalize(graph, &identity));
+      identity->set_assigned_device_name(src->assigned_device_name());
+      for (const Edge* e : it.second) {
+        TF_RETURN_IF_ERROR(
+            graph->UpdateEdge(identity, 0, e->dst(), e->dst_input()));
+      }
+    }
+    // The step must not run the source anymore, its control dependents wait
+    // for the take of the record instead.
+    for (const Edge* e : control_edges) {
+      VLOG(1) << "Auto SmartStage moves control edge " << src->name()
+              << " -> " << e->dst()->name() << " to " << take->name();
+      Node* dst = e->dst();
+      graph->RemoveEdge(e);
+      graph->AddControlEdge(take, dst);
+    }
+
+    AutoSmartStageNodes nodes;
+    nodes.put_node = put->name();
+    nodes.take_node = take->name();
+    nodes.cancel_node = cancel->name();
+    nodes.close_node = close->name();
+    nodes.size_node = size->name();
+    auto_smart_stages_.push_back(nodes);
+    VLOG(1) << "Auto SmartStage stages " << src->name();
+  }
+  return Status::OK();
+}
+
 Status GraphExecutionState::SmartStageGraph(std::unique_ptr<Graph>* g,
                                             const std::vector<std::string>& target_nodes,
                                             const bool do_smart_stage_gpu) {
@@ -757,11 +986,21 @@ Status GraphExecutionState::InitBaseGraph(std::unique_ptr<Graph>&& new_graph) {
   int32 micro_batch_num = session_optimizer_options.micro_batch_num();
   if (micro_batch_num > 1) {
     VLOG(2) << "RUN Graph Optimization: Runtime Pipeline";
-    PipelineGraph(&new_graph, micro_batch_num);
+    if (session_optimizer_options.micro_batch_pipeline()) {
+      TF_RETURN_IF_ERROR(MicroBatchPipelineGraph(&new_graph, micro_batch_num));
+    } else {
+      PipelineGraph(&new_graph, micro_batch_num);
+    }
+  }
+
+  if (session_optimizer_options.do_auto_smart_stage()) {
+    VLOG(2) << "RUN Graph Optimization: Auto SmartStage";
+    TF_RETURN_IF_ERROR(AutoSmartStageGraph(new_graph.get()));
   }
 
   if (session_optimizer_options.do_smart_stage() ||
-      session_optimizer_options.do_smart_stage_gpu()) {
+      session_optimizer_options.do_smart_stage_gpu() ||
+      session_optimizer_options.do_auto_smart_stage()) {
     VLOG(2) << "RUN Graph Optimization: SmartStage";
     std::string tn;
     ReadStringFromEnvVar("TARGET_NODES_NAME", "", &tn);
@@ -93,6 +93,24 @@ struct ClientGraph {
 //
 // GraphExecutionState is thread-safe.
 
+// Names of the buffer nodes of a stage inserted by the auto SmartStage.
+struct AutoSmartStageNodes {
+  string put_node;
+  string take_node;
+  string cancel_node;
+  string close_node;
+  string size_node;
+};
+
+// Names of the nodes accumulating the gradient of an apply op over the
+// micro-batches of a step.
+struct MicroBatchAccumulatorNodes {
+  string accumulate_node;
+  string take_node;
+  string abort_node;
+  string reset_node;
+};
+
 class GraphExecutionState {
  public:
   virtual ~GraphExecutionState();
@@ -152,6 +170,19 @@ class GraphExecutionState {
     }
   }
 
+  // Stages inserted by the auto SmartStage, see
+  // OptimizerOptions.do_auto_smart_stage.
+  const std::vector<AutoSmartStageNodes>& auto_smart_stages() const {
+    return auto_smart_stages_;
+  }
+
+  // Gradient accumulators inserted by the micro-batch pipeline, see
+  // OptimizerOptions.micro_batch_pipeline.
+  const std::vector<MicroBatchAccumulatorNodes>& micro_batch_accumulators()
+      const {
+    return micro_batch_accumulators_;
+  }
+
   // Returns the map of stateful placements as a map of
   // node name to placement string.
   std::unordered_map<string, string> GetStatefulPlacements() const {
@@ -180,6 +211,13 @@ class GraphExecutionState {
                     subgraph::RewriteGraphMetadata* out_rewrite_metadata);
 
   Status PipelineGraph(std::unique_ptr<Graph>* graph, int32 micro_batch_num);
+  // Accumulates the gradients of the apply ops of `graph` over
+  // `micro_batch_num` steps, falls back to PipelineGraph when an apply op
+  // is not placed on CPU.
+  Status MicroBatchPipelineGraph(std::unique_ptr<Graph>* graph,
+                                 int32 micro_batch_num);
+  // Stages the outputs of the input ops of `graph`.
+  Status AutoSmartStageGraph(Graph* graph);
   // SmartStage Graph for Runtime
   Status SmartStageGraph(std::unique_ptr<Graph>* graph,
                          const std::vector<std::string>& target_nodes,
@@ -216,6 +254,9 @@ class GraphExecutionState {
   // The dataflow graph owned by this object.
   Graph* graph_;
 
+  std::vector<AutoSmartStageNodes> auto_smart_stages_;
+  std::vector<MicroBatchAccumulatorNodes> micro_batch_accumulators_;
+
   TF_DISALLOW_COPY_AND_ASSIGN(GraphExecutionState);
 };
 
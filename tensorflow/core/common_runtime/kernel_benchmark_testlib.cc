@@ -49,6 +49,7 @@ Benchmark::Benchmark(const string& device, Graph* g,
   if (!options) {
     options = &default_options;
   }
+  executor_policy_ = options->config.executor_policy();
 
   testing::StopTiming();
   string t = absl::AsciiStrToUpper(device);
@@ -161,6 +162,7 @@ void Benchmark::RunWithArgs(
   args.cost_runner = [this](std::function<void()> closure, int64 cost) {
     pool_->CostSchedule(closure, cost);
   };
+  args.executor_policy = executor_policy_;
   static const int kWarmupRuns = 3;
   for (int i = 0; i < kWarmupRuns; ++i) {
     for (const auto& p : in) {
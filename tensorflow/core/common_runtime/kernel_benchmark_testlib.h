@@ -58,6 +58,8 @@ class Benchmark {
   std::unique_ptr<Device> device_ = nullptr;
   Rendezvous* rendez_ = nullptr;
   std::unique_ptr<Executor> exec_;
+  // Taken from `options`, used by every run of the graph.
+  ExecutorPolicy executor_policy_ = ExecutorPolicy::USE_NORMAL_EXECUTOR;
 
   TF_DISALLOW_COPY_AND_ASSIGN(Benchmark);
 };
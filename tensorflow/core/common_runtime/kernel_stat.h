@@ -24,6 +24,7 @@ limitations under the License.
 #include "absl/memory/memory.h"
 #include "absl/time/time.h"
 #include "absl/types/optional.h"
+#include "tensorflow/core/common_runtime/cost_profile.h"
 #include "tensorflow/core/common_runtime/graph_view.h"
 #include "tensorflow/core/graph/graph.h"
 #include "tensorflow/core/lib/core/errors.h"
@@ -74,6 +75,11 @@ class KernelStats {
       VLOG(1) << "User collect node stats, start_step is " << start_step_
               << ", stop_step is " << stop_step_;
     }    
+    s = ReadStringFromEnvVar(kCostProfileDirEnvName, "", &cost_profile_dir_);
+    if (!s.ok()) {
+      LOG(WARNING) << "Read " << kCostProfileDirEnvName
+                   << " envrionment error. " << s.error_message();
+    }
   }    
 
   void Initialize(const GraphView& gview,
@@ -98,6 +104,50 @@ class KernelStats {
         node_stats_count_[i] = 0;
       }
     }
+    MaybeLoadCostProfile();
+  }
+
+  // Uses the node costs persisted by an earlier process for the same graph,
+  // so the critical path is known before the first step and no stats are
+  // collected in this process.
+  void MaybeLoadCostProfile() {
+    if (cost_profile_dir_.empty()) return;
+    const string path = CostProfilePath(cost_profile_dir_, *g_);
+    std::vector<int64> costs;
+    Status s = LoadCostProfile(Env::Default(), path, *g_, &costs);
+    if (!s.ok()) {
+      if (!errors::IsNotFound(s)) {
+        LOG(WARNING) << "Ignore cost profile " << path << ": "
+                     << s.error_message();
+      }
+      return;
+    }
+    for (size_t i = 0; i < nodes_count_ && i < costs.size(); ++i) {
+      immutable_avg_cost_[i] = costs[i];
+    }
+    CalculateAccumulativeCost();
+    cost_profile_loaded_ = true;
+    collect_stats_done_ = true;
+    LOG(INFO) << "Load execute cost profile " << path;
+  }
+
+  void MaybeSaveCostProfile() {
+    if (cost_profile_dir_.empty() || cost_profile_loaded_) return;
+    const string path = CostProfilePath(cost_profile_dir_, *g_);
+    std::vector<int64> costs(nodes_count_);
+    for (size_t i = 0; i < nodes_count_; ++i) {
+      costs[i] = immutable_avg_cost_[i];
+    }
+    Status s = Env::Default()->RecursivelyCreateDir(cost_profile_dir_);
+    if (s.ok() || errors::IsAlreadyExists(s)) {
+      s = SaveCostProfile(Env::Default(), path, *g_, costs);
+    }
+    if (!s.ok()) {
+      LOG(WARNING) << "Save execute cost profile to " << path
+                   << " failed: " << s.error_message();
+      return;
+    }
+    LOG(INFO) << "Save execute cost profile " << path;
   }
 
   // Returns true iff the given node is considered "expensive". The
@@ -145,6 +195,17 @@ class KernelStats {
     while (!q.empty()) {
       Node* curr = q.front();
       q.pop();
+      if (IsOffCriticalPathNode(*curr)) {
+        // Summaries and savers neither lengthen the path of their inputs nor
+        // get any priority themselves.
+        immutable_accumulative_cost_[curr->id()] = 0;
+        for (auto edge : curr->in_edges()) {
+          if (--pending_childs[edge->src()] == 0) {
+            q.push(edge->src());
+          }
+        }
+        continue;
+      }
       immutable_accumulative_cost_[curr->id()] =
           immutable_avg_cost_[curr->id()];
       for (auto edge : curr->out_edges()) {
@@ -181,6 +242,9 @@ class KernelStats {
     // 3. calculate other metrics here
 
     collect_stats_done_ = true;
+
+    // 4. persist the costs for later processes
+    MaybeSaveCostProfile();
   }
 
   // Trace node info, for example execute time etc.
@@ -302,6 +366,11 @@ class KernelStats {
   // the max total execute time of A is MAX(1+1+1+0, 1+3+0) = 4
   std::vector<int64> immutable_accumulative_cost_;
 
+  // Directory of persisted node costs, see cost_profile.h. User can set
+  // envrionment 'EXECUTOR_COST_PROFILE_DIR' to enable it.
+  string cost_profile_dir_;
+  bool cost_profile_loaded_ = false;
+
   GraphView* gv_ = nullptr; // not owned
   Graph* g_ = nullptr; // not owned
 };
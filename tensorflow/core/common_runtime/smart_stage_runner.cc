@@ -0,0 +1,255 @@
+#include "tensorflow/core/common_runtime/smart_stage_runner.h"
+
+#include <algorithm>
+#include <chrono>
+
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/public/session.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Number of buffer size samples a tuning decision is made on.
+const int kSampleWindow = 10;
+
+}  // namespace
+
+SmartStageRunner::SmartStageRunner(Session* session, int max_threads,
+                                   int64 sample_interval_micros)
+    : session_(session),
+      max_threads_(std::max(max_threads, 1)),
+      sample_interval_micros_(sample_interval_micros) {}
+
+SmartStageRunner::~SmartStageRunner() {
+  Cancel();
+  Join();
+}
+
+std::unique_ptr<SmartStageRunner> SmartStageRunner::Create(Session* session) {
+  int64 max_threads = 4;
+  Status s = ReadInt64FromEnvVar("SMART_STAGE_MAX_THREADS", 4, &max_threads);
+  if (!s.ok()) {
+    LOG(ERROR) << "Read SMART_STAGE_MAX_THREADS envrionment error. "
+               << s.error_message();
+  }
+  return std::unique_ptr<SmartStageRunner>(new SmartStageRunner(
+      session, static_cast<int>(max_threads), 100000 /* 100ms */));
+}
+
+void SmartStageRunner::AddStages(
+    const std::vector<AutoSmartStageNodes>& stages) {
+  mutex_lock l(mu_);
+  for (const AutoSmartStageNodes& nodes : stages) {
+    auto& stage = stages_[nodes.take_node];
+    if (stage == nullptr) {
+      stage.reset(new Stage);
+      stage->nodes = nodes;
+    }
+  }
+}
+
+bool SmartStageRunner::HasStage(const string& take_node) {
+  mutex_lock l(mu_);
+  return stages_.count(take_node) > 0;
+}
+
+void SmartStageRunner::MaybeStart(const string& take_node) {
+  mutex_lock l(mu_);
+  auto it = stages_.find(take_node);
+  if (cancelled_ || it == stages_.end() || it->second->started) {
+    return;
+  }
+  Stage* stage = it->second.get();
+  stage->started = true;
+  stage->num_threads = 1;
+  StartThreadLocked(stage);
+  if (tuner_thread_ == nullptr) {
+    tuner_thread_.reset(Env::Default()->StartThread(
+        ThreadOptions(), "smart_stage_tuner", [this]() { TunerLoop(); }));
+  }
+  VLOG(1) << "SmartStage starts prefetching " << take_node;
+}
+
+void SmartStageRunner::Cancel() {
+  std::vector<string> cancel_nodes;
+  {
+    mutex_lock l(mu_);
+    if (cancelled_) {
+      return;
+    }
+    cancelled_ = true;
+    for (auto& it : stages_) {
+      if (it.second->started) {
+        cancel_nodes.push_back(it.second->nodes.cancel_node);
+      }
+    }
+  }
+  cond_.notify_all();
+  tuner_cond_.notify_all();
+  // Unblocks the producers waiting for room in the buffers, and the
+  // consumers waiting for records.
+  for (const string& node : cancel_nodes) {
+    Status s = RunTarget(node);
+    if (!s.ok()) {
+      LOG(WARNING) << "Failed to cancel SmartStage " << node << ": " << s;
+    }
+  }
+}
+
+void SmartStageRunner::Join() {
+  std::vector<std::unique_ptr<Thread>> threads;
+  {
+    mutex_lock l(mu_);
+    for (auto& it : stages_) {
+      for (auto& thread : it.second->threads) {
+        threads.push_back(std::move(thread));
+      }
+      it.second->threads.clear();
+    }
+    if (tuner_thread_ != nullptr) {
+      threads.push_back(std::move(tuner_thread_));
+    }
+  }
+  // Deleting a thread joins it.
+  threads.clear();
+}
+
+int SmartStageRunner::NumThreads(const string& take_node) {
+  mutex_lock l(mu_);
+  auto it = stages_.find(take_node);
+  return it == stages_.end() ? 0 : it->second->num_threads;
+}
+
+void SmartStageRunner::StartThreadLocked(Stage* stage) {
+  const int index = stage->threads.size();
+  stage->threads.emplace_back(Env::Default()->StartThread(
+      ThreadOptions(), strings::StrCat("smart_stage_producer_", index),
+      [this, stage, index]() { ProducerLoop(stage, index); }));
+}
+
+void SmartStageRunner::ProducerLoop(Stage* stage, int index) {
+  while (true) {
+    {
+      mutex_lock l(mu_);
+      while (!cancelled_ && !stage->done && index >= stage->num_threads) {
+        cond_.wait(l);
+      }
+      if (cancelled_ || stage->done) {
+        return;
+      }
+      ++stage->num_busy;
+    }
+
+    Status s = RunTarget(stage->nodes.put_node);
+
+    bool close = false;
+    bool cancel = false;
+    {
+      mutex_lock l(mu_);
+      --stage->num_busy;
+      if (!s.ok() && !cancelled_ && !stage->done) {
+        if (errors::IsOutOfRange(s)) {
+          VLOG(1) << "SmartStage " << stage->nodes.take_node
+                  << " reaches the end of data.";
+          stage->end_of_data = true;
+        } else {
+          LOG(ERROR) << "SmartStage " << stage->nodes.take_node
+                     << " stops prefetching: " << s;
+          cancel = true;
+        }
+        stage->done = true;
+        cond_.notify_all();
+      }
+      // Close the buffer once the last put in flight is done, so that the
+      // consumer takes every record before the end of data.
+      if (stage->end_of_data && stage->num_busy == 0 && !stage->closed) {
+        stage->closed = true;
+        close = true;
+      }
+    }
+    if (close) {
+      RunTarget(stage->nodes.close_node).IgnoreError();
+    }
+    if (cancel) {
+      RunTarget(stage->nodes.cancel_node).IgnoreError();
+    }
+  }
+}
+
+void SmartStageRunner::TunerLoop() {
+  while (true) {
+    std::vector<Stage*> stages;
+    {
+      mutex_lock l(mu_);
+      if (!cancelled_) {
+        tuner_cond_.wait_for(
+            l, std::chrono::microseconds(sample_interval_micros_));
+      }
+      if (cancelled_) {
+        return;
+      }
+      for (auto& it : stages_) {
+        if (it.second->started && !it.second->done) {
+          stages.push_back(it.second.get());
+        }
+      }
+    }
+
+    for (Stage* stage : stages) {
+      std::vector<Tensor> outputs;
+      Status s = session_->Run(
+          {}, {strings::StrCat(stage->nodes.size_node, ":0")}, {}, &outputs);
+      if (!s.ok()) {
+        VLOG(1) << "Failed to sample SmartStage " << stage->nodes.take_node
+                << ": " << s;
+        continue;
+      }
+      mutex_lock l(mu_);
+      Tune(stage, outputs[0].scalar<int32>()());
+    }
+  }
+}
+
+void SmartStageRunner::Tune(Stage* stage, int32 size) {
+  if (stage->num_samples == 0 || size < stage->min_size) {
+    stage->min_size = size;
+  }
+  ++stage->num_samples;
+  if (size == 0) {
+    ++stage->num_empty_samples;
+  }
+  if (stage->num_samples < kSampleWindow) {
+    return;
+  }
+
+  if (2 * stage->num_empty_samples >= stage->num_samples) {
+    // The consumer is starved half of the time.
+    if (stage->num_threads < max_threads_) {
+      ++stage->num_threads;
+      if (stage->num_threads > static_cast<int>(stage->threads.size())) {
+        StartThreadLocked(stage);
+      }
+      cond_.notify_all();
+      VLOG(1) << "SmartStage " << stage->nodes.take_node << " grows to "
+              << stage->num_threads << " producers.";
+    }
+  } else if (stage->min_size >= 2 && stage->num_threads > 1) {
+    // The producers are always ahead, pause one of them.
+    --stage->num_threads;
+    VLOG(1) << "SmartStage " << stage->nodes.take_node << " shrinks to "
+            << stage->num_threads << " producers.";
+  }
+  stage->num_samples = 0;
+  stage->num_empty_samples = 0;
+}
+
+Status SmartStageRunner::RunTarget(const string& node) {
+  return session_->Run({}, {}, {node}, nullptr);
+}
+
+}  // end namespace tensorflow
@@ -0,0 +1,98 @@
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_SMART_STAGE_RUNNER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_SMART_STAGE_RUNNER_H_
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/core/common_runtime/graph_execution_state.h"
+#include "tensorflow/core/platform/env.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+class Session;
+
+// Runs the prefetch of the stages inserted by the auto SmartStage.
+//
+// Each stage is fed by producer threads running its TensorBufferPut in the
+// session, like PrefetchRunner does for stages placed in Python. The size
+// of the buffers is sampled periodically: a producer is added when the
+// consumer often finds its buffer empty, and one is paused when the buffer
+// never drops below two records. The capacity of the buffer itself is tuned
+// by TensorBuf.
+class SmartStageRunner {
+ public:
+  // `session` must outlive the runner.
+  SmartStageRunner(Session* session, int max_threads,
+                   int64 sample_interval_micros);
+  ~SmartStageRunner();
+
+  // Returns a runner with SMART_STAGE_MAX_THREADS producers at most per
+  // stage.
+  static std::unique_ptr<SmartStageRunner> Create(Session* session);
+
+  // Registers the stages of a graph. Known stages are ignored.
+  void AddStages(const std::vector<AutoSmartStageNodes>& stages);
+
+  // Returns true if `take_node` is the TensorBufferTake of a stage.
+  bool HasStage(const string& take_node);
+
+  // Starts the producers of the stage of `take_node` if not started yet.
+  void MaybeStart(const string& take_node);
+
+  // Stops the producers and cancels the buffers, so that the steps blocked
+  // on them return. Must be called before the session is closed.
+  void Cancel();
+
+  // Waits for the threads of the runner to exit, called after Cancel().
+  void Join();
+
+  // Number of active producers of the stage of `take_node`.
+  int NumThreads(const string& take_node);
+
+ private:
+  struct Stage {
+    AutoSmartStageNodes nodes;
+    bool started = false;
+    // Set when the producers stop, on end of data or on error.
+    bool done = false;
+    bool end_of_data = false;
+    bool closed = false;
+    // Producers with an index >= num_threads are paused.
+    int num_threads = 0;
+    // Producers running a put.
+    int num_busy = 0;
+    std::vector<std::unique_ptr<Thread>> threads;
+
+    // Samples of the buffer size in the current window.
+    int num_samples = 0;
+    int num_empty_samples = 0;
+    int32 min_size = 0;
+  };
+
+  void StartThreadLocked(Stage* stage) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  void ProducerLoop(Stage* stage, int index);
+  void TunerLoop();
+  void Tune(Stage* stage, int32 size) EXCLUSIVE_LOCKS_REQUIRED(mu_);
+  Status RunTarget(const string& node);
+
+  Session* const session_;  // Not owned.
+  const int max_threads_;
+  const int64 sample_interval_micros_;
+
+  mutex mu_;
+  // Wakes up paused producers.
+  condition_variable cond_;
+  condition_variable tuner_cond_;
+  bool cancelled_ GUARDED_BY(mu_) = false;
+  std::unordered_map<string, std::unique_ptr<Stage>> stages_ GUARDED_BY(mu_);
+  std::unique_ptr<Thread> tuner_thread_ GUARDED_BY(mu_);
+
+  TF_DISALLOW_COPY_AND_ASSIGN(SmartStageRunner);
+};
+
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_SMART_STAGE_RUNNER_H_
@@ -0,0 +1,139 @@
+/* Copyright 2022 The DeepRec Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "absl/strings/match.h"
+#include "tensorflow/core/common_runtime/optimization_registry.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/graph_node_util.h"
+#include "tensorflow/core/graph/node_builder.h"
+#include "tensorflow/core/public/session_options.h"
+#include "tensorflow/core/util/device_name_utils.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+namespace {
+
+// Compresses the sparse gradients sent from a worker to the optimizer on a
+// ps. _SparseGradientEncode on the worker sums the rows of the same index,
+// delta varint encodes the sorted indices and quantizes the rows with error
+// feedback, _SparseGradientDecode on the ps restores a float gradient with
+// unique indices before the optimizer. Gradients which don't cross address
+// spaces are left as is, so the pass is a no-op for a local session.
+class SparseGradientCompressionPass : public GraphOptimizationPass {
+ public:
+  Status Run(const GraphOptimizationPassOptions& options) override {
+    if (options.graph == nullptr || options.session_options == nullptr) {
+      return Status::OK();
+    }
+    const OptimizerOptions& opts =
+        options.session_options->config.graph_options().optimizer_options();
+    DataType values_type;
+    switch (opts.sparse_gradient_compression()) {
+      case OptimizerOptions::FP16:
+        values_type = DT_HALF;
+        break;
+      case OptimizerOptions::BF16:
+        values_type = DT_BFLOAT16;
+        break;
+      default:
+        return Status::OK();
+    }
+
+    // Each compressed gradient keeps the quantization error of at most
+    // this many indices on the worker.
+    int64 max_residual_rows;
+    TF_RETURN_IF_ERROR(ReadInt64FromEnvVar(
+        "SPARSE_GRADIENT_MAX_RESIDUAL_ROWS", 1 << 20, &max_residual_rows));
+    if (max_residual_rows < 1) {
+      return errors::InvalidArgument(
+          "SPARSE_GRADIENT_MAX_RESIDUAL_ROWS must be positive, got ",
+          max_residual_rows);
+    }
+
+    Graph* graph = options.graph->get();
+    std::vector<Node*> apply_nodes;
+    for (Node* n : graph->op_nodes()) {
+      if (absl::StrContains(n->type_string(), "SparseApply")) {
+        apply_nodes.push_back(n);
+      }
+    }
+    for (Node* n : apply_nodes) {
+      TF_RETURN_IF_ERROR(Rewrite(graph, n, values_type, max_residual_rows));
+    }
+    return Status::OK();
+  }
+
+ private:
+  Status Rewrite(Graph* graph, Node* n, DataType values_type,
+                 int64 max_residual_rows) {
+    const int grad_index = InputIndex(n, "grad");
+    const int indices_index = InputIndex(n, "indices");
+    if (grad_index < 0 || indices_index < 0 ||
+        n->input_type(grad_index) != DT_FLOAT) {
+      return Status::OK();
+    }
+    const DataType indices_type = n->input_type(indices_index);
+    if (indices_type != DT_INT32 && indices_type != DT_INT64) {
+      return Status::OK();
+    }
+    const Edge* grad_edge;
+    TF_RETURN_IF_ERROR(n->input_edge(grad_index, &grad_edge));
+    const Edge* indices_edge;
+    TF_RETURN_IF_ERROR(n->input_edge(indices_index, &indices_edge));
+
+    const string src_device = grad_edge->src()->assigned_device_name();
+    const string dst_device = n->assigned_device_name();
+    if (!DeviceNameUtils::IsSameAddressSpace(
+            src_device, indices_edge->src()->assigned_device_name()) ||
+        DeviceNameUtils::IsSameAddressSpace(src_device, dst_device) ||
+        !IsCPUDevice(src_device) || !IsCPUDevice(dst_device)) {
+      return Status::OK();
+    }
+
+    Node* encode;
+    TF_RETURN_IF_ERROR(
+        NodeBuilder(graph->NewName(n->name() + "/SparseGradientEncode"),
+                    "_SparseGradientEncode")
+            .Input(grad_edge->src(), grad_edge->src_output())
+            .Input(indices_edge->src(), indices_edge->src_output())
+            .Attr("Tvalues", values_type)
+            .Attr("shared_name", n->name() + "/SparseGradientEncode")
+            .Attr("max_residual_rows", max_residual_rows)
+            .Finalize(graph, &encode));
+    encode->set_assigned_device_name(src_device);
+
+    Node* decode;
+    TF_RETURN_IF_ERROR(
+        NodeBuilder(graph->NewName(n->name() + "/SparseGradientDecode"),
+                    "_SparseGradientDecode")
+            .Input(encode, 0)
+            .Input(encode, 1)
+            .Attr("Tindices", indices_type)
+            .Finalize(graph, &decode));
+    decode->set_assigned_device_name(dst_device);
+
+    TF_RETURN_IF_ERROR(graph->UpdateEdge(decode, 0, n, grad_index));
+    TF_RETURN_IF_ERROR(graph->UpdateEdge(decode, 1, n, indices_index));
+    VLOG(1) << "Compress sparse gradient of " << n->name() << " from "
+            << src_device << " to " << dst_device;
+    return Status::OK();
+  }
+};
+
+REGISTER_OPTIMIZATION(OptimizationPassRegistry::POST_PLACEMENT, 0,
+                      SparseGradientCompressionPass);
+
+}  // namespace
+}  // namespace tensorflow
@@ -0,0 +1,453 @@
+#include "tensorflow/core/common_runtime/static_memory_planner.h"
+
+#include <algorithm>
+#include <unordered_set>
+
+#include "tensorflow/core/common_runtime/device.h"
+#include "tensorflow/core/framework/allocation_description.pb.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mem.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+
+namespace {
+constexpr int64 DEFAULT_STATIC_MEMORY_PLAN_START_STEP = 10;
+constexpr int64 DEFAULT_STATIC_MEMORY_PLAN_RECORD_STEPS = 5;
+
+inline size_t AlignedSize(size_t num_bytes) {
+  return (num_bytes + Allocator::kAllocatorAlignment - 1) /
+         Allocator::kAllocatorAlignment * Allocator::kAllocatorAlignment;
+}
+}  // namespace
+
+// Allocates from the device allocator and records the lifetime of each
+// tensor in the logical clock of the step.
+class StaticMemoryPlanner::RecordingStep : public StepMemoryPlan {
+ public:
+  explicit RecordingStep(StaticMemoryPlanner* planner) : planner_(planner) {}
+
+  TensorBuffer* AllocateBuffer(const OpKernel* kernel, int index,
+                               size_t num_bytes,
+                               Allocator* allocator) override {
+    void* data =
+        allocator->AllocateRaw(Allocator::kAllocatorAlignment, num_bytes);
+    if (data == nullptr) {
+      return nullptr;
+    }
+    int id = 0;
+    {
+      mutex_lock l(mu_);
+      id = lifetimes_.size();
+      lifetimes_.push_back(
+          {std::make_pair(kernel, index), num_bytes, clock_++, -1});
+    }
+    return new Buffer(this, id, allocator, data, num_bytes);
+  }
+
+  void StepDone() override {
+    std::vector<TensorLifetime> lifetimes;
+    {
+      mutex_lock l(mu_);
+      done_ = true;
+      lifetimes.swap(lifetimes_);
+    }
+    // Tensors alive at this point escape the step.
+    planner_->RecordStep(std::move(lifetimes));
+  }
+
+ private:
+  class Buffer : public TensorBuffer {
+   public:
+    Buffer(RecordingStep* step, int id, Allocator* allocator, void* data,
+           size_t num_bytes)
+        : TensorBuffer(data),
+          step_(step),
+          id_(id),
+          allocator_(allocator),
+          num_bytes_(num_bytes) {
+      step_->Ref();
+    }
+
+    ~Buffer() override {
+      allocator_->DeallocateRaw(data());
+      step_->Release(id_);
+      step_->Unref();
+    }
+
+    size_t size() const override { return num_bytes_; }
+    TensorBuffer* root_buffer() override { return this; }
+    void FillAllocationDescription(
+        AllocationDescription* proto) const override {
+      proto->set_requested_bytes(num_bytes_);
+      proto->set_allocator_name(allocator_->Name());
+      proto->set_ptr(reinterpret_cast<uintptr_t>(data()));
+    }
+
+   private:
+    RecordingStep* const step_;
+    const int id_;
+    Allocator* const allocator_;
+    const size_t num_bytes_;
+  };
+
+  void Release(int id) {
+    mutex_lock l(mu_);
+    if (!done_) {
+      lifetimes_[id].end = clock_++;
+    }
+  }
+
+  StaticMemoryPlanner* const planner_;
+  mutex mu_;
+  std::vector<TensorLifetime> lifetimes_ GUARDED_BY(mu_);
+  int64 clock_ GUARDED_BY(mu_) = 0;
+  bool done_ GUARDED_BY(mu_) = false;
+};
+
+// Arenas of a plan. An arena is returned to the pool when its step is done
+// and all tensors placed in it are freed. The pool outlives the planner
+// while arenas are in use.
+class StaticMemoryPlanner::ArenaPool : public core::RefCounted {
+ public:
+  class Arena {
+   public:
+    Arena(ArenaPool* pool, const Plan& plan)
+        : pool_(pool),
+          data_(static_cast<char*>(port::AlignedMalloc(
+              plan.arena_size, Allocator::kAllocatorAlignment))),
+          live_(new std::atomic<bool>[plan.slots.size()]),
+          refs_(0) {
+      for (size_t i = 0; i < plan.slots.size(); ++i) {
+        live_[i] = false;
+      }
+    }
+
+    ~Arena() { port::AlignedFree(data_); }
+
+    void Ref() { refs_.fetch_add(1, std::memory_order_relaxed); }
+    void Unref() {
+      if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        pool_->Release(this);
+      }
+    }
+
+    char* data() const { return data_; }
+    // Whether the tensor of a slot is alive.
+    std::atomic<bool>& live(int slot) { return live_[slot]; }
+
+   private:
+    ArenaPool* const pool_;
+    char* const data_;
+    std::unique_ptr<std::atomic<bool>[]> live_;
+    std::atomic<int> refs_;
+  };
+
+  explicit ArenaPool(std::unique_ptr<Plan> plan) : plan_(std::move(plan)) {}
+
+  ~ArenaPool() override {
+    for (Arena* arena : free_arenas_) {
+      delete arena;
+    }
+  }
+
+  const Plan& plan() const { return *plan_; }
+
+  Arena* Acquire() {
+    Ref();
+    {
+      mutex_lock l(mu_);
+      if (!free_arenas_.empty()) {
+        Arena* arena = free_arenas_.back();
+        free_arenas_.pop_back();
+        return arena;
+      }
+    }
+    return new Arena(this, *plan_);
+  }
+
+ private:
+  void Release(Arena* arena) {
+    {
+      mutex_lock l(mu_);
+      free_arenas_.push_back(arena);
+    }
+    Unref();
+  }
+
+  const std::unique_ptr<Plan> plan_;
+  mutex mu_;
+  std::vector<Arena*> free_arenas_ GUARDED_BY(mu_);
+};
+
+// Places the planned tensors of a step in one arena.
+class StaticMemoryPlanner::ArenaStep : public StepMemoryPlan {
+ public:
+  explicit ArenaStep(ArenaPool* pool)
+      : plan_(pool->plan()), arena_(pool->Acquire()) {
+    arena_->Ref();
+  }
+
+  ~ArenaStep() override { arena_->Unref(); }
+
+  TensorBuffer* AllocateBuffer(const OpKernel* kernel, int index,
+                               size_t num_bytes,
+                               Allocator* allocator) override {
+    auto it = plan_.slots_by_key.find(std::make_pair(kernel, index));
+    if (it == plan_.slots_by_key.end()) {
+      return nullptr;
+    }
+    const int slot = it->second;
+    const Slot& s = plan_.slots[slot];
+    if (num_bytes > s.num_bytes) {
+      return nullptr;
+    }
+    // The same tensor allocated again in the step, e.g. in a loop.
+    if (arena_->live(slot).exchange(true)) {
+      return nullptr;
+    }
+    // Every thread marks its slot before checking the others, so of two
+    // overlapping slots allocated at the same time at least one falls back.
+    for (int other : s.shared_with) {
+      if (arena_->live(other).load()) {
+        arena_->live(slot).store(false);
+        return nullptr;
+      }
+    }
+    return new Buffer(arena_, slot, arena_->data() + s.offset, num_bytes);
+  }
+
+ private:
+  class Buffer : public TensorBuffer {
+   public:
+    Buffer(ArenaPool::Arena* arena, int slot, void* data, size_t num_bytes)
+        : TensorBuffer(data), arena_(arena), slot_(slot),
+          num_bytes_(num_bytes) {
+      arena_->Ref();
+    }
+
+    ~Buffer() override {
+      arena_->live(slot_).store(false);
+      arena_->Unref();
+    }
+
+    size_t size() const override { return num_bytes_; }
+    TensorBuffer* root_buffer() override { return this; }
+    void FillAllocationDescription(
+        AllocationDescription* proto) const override {
+      proto->set_requested_bytes(num_bytes_);
+      proto->set_allocator_name("static_memory_plan");
+      proto->set_ptr(reinterpret_cast<uintptr_t>(data()));
+    }
+
+   private:
+    ArenaPool::Arena* const arena_;
+    const int slot_;
+    const size_t num_bytes_;
+  };
+
+  const Plan& plan_;
+  ArenaPool::Arena* const arena_;
+};
+
+StaticMemoryPlanner::StaticMemoryPlanner(int64 start_step, int64 record_steps)
+    : start_step_(start_step),
+      record_steps_(std::max<int64>(record_steps, 1)),
+      step_counter_(0),
+      state_(kRecording) {}
+
+StaticMemoryPlanner::~StaticMemoryPlanner() {
+  if (arena_pool_ != nullptr) {
+    arena_pool_->Unref();
+  }
+}
+
+std::unique_ptr<StaticMemoryPlanner> StaticMemoryPlanner::MaybeCreate(
+    const Device* device) {
+  bool enable = false;
+  Status s = ReadBoolFromEnvVar("ENABLE_STATIC_MEMORY_PLAN", false, &enable);
+  if (!s.ok()) {
+    LOG(WARNING) << "Read ENABLE_STATIC_MEMORY_PLAN envrionment error. "
+                 << s.error_message();
+  }
+  if (!enable || device == nullptr || device->device_type() != DEVICE_CPU) {
+    return nullptr;
+  }
+
+  int64 start_step = DEFAULT_STATIC_MEMORY_PLAN_START_STEP;
+  s = ReadInt64FromEnvVar("STATIC_MEMORY_PLAN_START_STEP",
+                          DEFAULT_STATIC_MEMORY_PLAN_START_STEP, &start_step);
+  if (!s.ok()) {
+    LOG(WARNING) << "Read STATIC_MEMORY_PLAN_START_STEP envrionment error. "
+                 << s.error_message();
+  }
+  int64 record_steps = DEFAULT_STATIC_MEMORY_PLAN_RECORD_STEPS;
+  s = ReadInt64FromEnvVar("STATIC_MEMORY_PLAN_RECORD_STEPS",
+                          DEFAULT_STATIC_MEMORY_PLAN_RECORD_STEPS,
+                          &record_steps);
+  if (!s.ok()) {
+    LOG(WARNING) << "Read STATIC_MEMORY_PLAN_RECORD_STEPS envrionment error. "
+                 << s.error_message();
+  }
+  return std::unique_ptr<StaticMemoryPlanner>(
+      new StaticMemoryPlanner(start_step, record_steps));
+}
+
+StepMemoryPlan* StaticMemoryPlanner::StartStep() {
+  if (step_counter_.fetch_add(1, std::memory_order_relaxed) < start_step_) {
+    return nullptr;
+  }
+  const int state = state_.load(std::memory_order_acquire);
+  if (state == kPlanned) {
+    return new ArenaStep(arena_pool_);
+  } else if (state == kDisabled) {
+    return nullptr;
+  }
+
+  mutex_lock l(mu_);
+  if (state_ != kRecording || started_recordings_ >= record_steps_) {
+    return nullptr;
+  }
+  ++started_recordings_;
+  return new RecordingStep(this);
+}
+
+size_t StaticMemoryPlanner::ArenaSize() const {
+  return Planned() ? arena_pool_->plan().arena_size : 0;
+}
+
+size_t StaticMemoryPlanner::NumPlannedTensors() const {
+  return Planned() ? arena_pool_->plan().slots.size() : 0;
+}
+
+void StaticMemoryPlanner::RecordStep(std::vector<TensorLifetime> lifetimes) {
+  mutex_lock l(mu_);
+  if (state_ != kRecording) {
+    return;
+  }
+  recorded_steps_.push_back(std::move(lifetimes));
+  if (static_cast<int64>(recorded_steps_.size()) == record_steps_) {
+    BuildPlan();
+    recorded_steps_.clear();
+  }
+}
+
+void StaticMemoryPlanner::BuildPlan() {
+  // Tensors allocated twice in a step, escaping a step or changing size
+  // between steps are not planned.
+  std::unordered_map<TensorKey, size_t, TensorKeyHash> sizes;
+  std::unordered_set<TensorKey, TensorKeyHash> unplanned;
+  for (const auto& step : recorded_steps_) {
+    std::unordered_set<TensorKey, TensorKeyHash> seen;
+    for (const TensorLifetime& t : step) {
+      auto it = sizes.emplace(t.key, t.num_bytes).first;
+      if (!seen.insert(t.key).second || t.end < 0 ||
+          it->second != t.num_bytes) {
+        unplanned.insert(t.key);
+      }
+    }
+  }
+
+  std::unique_ptr<Plan> plan(new Plan);
+  for (const auto& it : sizes) {
+    if (unplanned.count(it.first) == 0) {
+      const int slot = plan->slots.size();
+      plan->slots_by_key.emplace(it.first, slot);
+      plan->slots.push_back({0, it.second, {}});
+    }
+  }
+  const int num_slots = plan->slots.size();
+  if (num_slots == 0) {
+    LOG(INFO) << "No tensor can be placed by the static memory plan.";
+    state_ = kDisabled;
+    return;
+  }
+
+  // Two tensors conflict if their lifetimes overlap in any recorded step.
+  std::vector<std::unordered_set<int>> conflicts(num_slots);
+  for (const auto& step : recorded_steps_) {
+    std::vector<std::pair<int64, int64>> intervals;  // (begin, slot)
+    std::vector<int64> ends(num_slots, -1);
+    for (const TensorLifetime& t : step) {
+      auto it = plan->slots_by_key.find(t.key);
+      if (it != plan->slots_by_key.end()) {
+        intervals.emplace_back(t.begin, it->second);
+        ends[it->second] = t.end;
+      }
+    }
+    std::sort(intervals.begin(), intervals.end());
+    std::vector<int> alive;
+    for (const auto& interval : intervals) {
+      const int64 begin = interval.first;
+      const int slot = interval.second;
+      alive.erase(std::remove_if(alive.begin(), alive.end(),
+                                 [&ends, begin](int other) {
+                                   return ends[other] < begin;
+                                 }),
+                  alive.end());
+      for (int other : alive) {
+        conflicts[slot].insert(other);
+        conflicts[other].insert(slot);
+      }
+      alive.push_back(slot);
+    }
+  }
+
+  // Greedy by size: place the largest tensors first, each at the lowest
+  // offset not overlapping the conflicting tensors placed before.
+  std::vector<int> order(num_slots);
+  for (int i = 0; i < num_slots; ++i) {
+    order[i] = i;
+  }
+  std::sort(order.begin(), order.end(), [&plan](int a, int b) {
+    return plan->slots[a].num_bytes > plan->slots[b].num_bytes;
+  });
+  std::vector<bool> placed(num_slots, false);
+  size_t total_bytes = 0;
+  for (int slot : order) {
+    std::vector<std::pair<size_t, size_t>> ranges;
+    for (int other : conflicts[slot]) {
+      if (placed[other]) {
+        const Slot& s = plan->slots[other];
+        ranges.emplace_back(s.offset, s.offset + AlignedSize(s.num_bytes));
+      }
+    }
+    std::sort(ranges.begin(), ranges.end());
+    const size_t size = AlignedSize(plan->slots[slot].num_bytes);
+    size_t offset = 0;
+    for (const auto& range : ranges) {
+      if (offset + size <= range.first) {
+        break;
+      }
+      offset = std::max(offset, range.second);
+    }
+    plan->slots[slot].offset = offset;
+    plan->arena_size = std::max(plan->arena_size, offset + size);
+    placed[slot] = true;
+    total_bytes += size;
+  }
+
+  // Slots sharing memory, checked at runtime in case the execution order of
+  // a later step differs from the recorded ones.
+  std::sort(order.begin(), order.end(), [&plan](int a, int b) {
+    return plan->slots[a].offset < plan->slots[b].offset;
+  });
+  for (int i = 0; i < num_slots; ++i) {
+    Slot& a = plan->slots[order[i]];
+    const size_t end = a.offset + AlignedSize(a.num_bytes);
+    for (int j = i + 1;
+         j < num_slots && plan->slots[order[j]].offset < end; ++j) {
+      a.shared_with.push_back(order[j]);
+      plan->slots[order[j]].shared_with.push_back(order[i]);
+    }
+  }
+
+  LOG(INFO) << "Static memory plan: " << num_slots << " tensors in an arena of "
+            << plan->arena_size << " bytes, " << total_bytes
+            << " bytes without sharing.";
+  arena_pool_ = new ArenaPool(std::move(plan));
+  state_.store(kPlanned, std::memory_order_release);
+}
+
+}  // end namespace tensorflow
@@ -0,0 +1,119 @@
+#ifndef TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_MEMORY_PLANNER_H_
+#define TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_MEMORY_PLANNER_H_
+
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/lib/core/refcount.h"
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+class Device;
+
+// Plan of the tensors allocated in one step, see StaticMemoryPlanner.
+class StepMemoryPlan : public StepMemoryPlanInterface,
+                       public core::RefCounted {
+ public:
+  // Called by the executor when all nodes of the step are done.
+  virtual void StepDone() {}
+};
+
+// Whole-graph static memory plan of an executor.
+//
+// The planner records the lifetimes of the tensors allocated in a few steps,
+// then places every tensor which is freed in the step at a fixed offset of
+// an arena, such that tensors alive at the same time never share memory.
+// Later steps carve their tensors out of a pre-allocated arena without any
+// allocator call. Arenas are pooled, so concurrent steps each get their own.
+//
+// Tensors whose size or lifetime is not stable (dynamic shapes, loops,
+// tensors escaping the step) are not planned and use the device allocator.
+// A planned tensor also falls back to the device allocator if a tensor
+// sharing its memory is still alive, which keeps the plan safe when the
+// execution order of the nodes changes between steps.
+class StaticMemoryPlanner {
+ public:
+  // The first `start_step` steps are skipped, the following `record_steps`
+  // steps are recorded.
+  StaticMemoryPlanner(int64 start_step, int64 record_steps);
+  ~StaticMemoryPlanner();
+
+  // Returns a planner if ENABLE_STATIC_MEMORY_PLAN is set and `device` is a
+  // CPU device, otherwise nullptr.
+  static std::unique_ptr<StaticMemoryPlanner> MaybeCreate(
+      const Device* device);
+
+  // Returns the plan for a new step, or nullptr if the step runs without a
+  // plan. The caller owns a reference and must call StepDone() on it.
+  StepMemoryPlan* StartStep();
+
+  bool Planned() const { return state_ == kPlanned; }
+  // Size in bytes of the arena of a step, once planned.
+  size_t ArenaSize() const;
+  // Number of tensors placed in the arena, once planned.
+  size_t NumPlannedTensors() const;
+
+ private:
+  class RecordingStep;
+  class ArenaPool;
+  class ArenaStep;
+
+  // A tensor is identified by the kernel allocating it and the order of the
+  // allocation in the kernel invocation.
+  typedef std::pair<const OpKernel*, int> TensorKey;
+  struct TensorKeyHash {
+    size_t operator()(const TensorKey& key) const {
+      return std::hash<const OpKernel*>()(key.first) * 31 + key.second;
+    }
+  };
+
+  struct TensorLifetime {
+    TensorKey key;
+    size_t num_bytes;
+    int64 begin;
+    // -1 if the tensor was still alive at the end of the step.
+    int64 end;
+  };
+
+  struct Slot {
+    size_t offset;
+    size_t num_bytes;
+    // Slots whose memory overlaps with this slot.
+    std::vector<int> shared_with;
+  };
+
+  struct Plan {
+    std::unordered_map<TensorKey, int, TensorKeyHash> slots_by_key;
+    std::vector<Slot> slots;
+    size_t arena_size = 0;
+  };
+
+  enum State { kRecording, kPlanned, kDisabled };
+
+  void RecordStep(std::vector<TensorLifetime> lifetimes);
+  void BuildPlan() EXCLUSIVE_LOCKS_REQUIRED(mu_);
+
+  const int64 start_step_;
+  const int64 record_steps_;
+  std::atomic<int64> step_counter_;
+  std::atomic<int> state_;
+
+  mutex mu_;
+  int64 started_recordings_ GUARDED_BY(mu_) = 0;
+  std::vector<std::vector<TensorLifetime>> recorded_steps_ GUARDED_BY(mu_);
+
+  // Set once when the plan is built.
+  ArenaPool* arena_pool_ = nullptr;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StaticMemoryPlanner);
+};
+
+}  // end namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_COMMON_RUNTIME_STATIC_MEMORY_PLANNER_H_
@@ -0,0 +1,154 @@
+#include "tensorflow/core/common_runtime/static_memory_planner.h"
+
+#include "tensorflow/core/framework/allocator.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class CountingAllocator : public Allocator {
+ public:
+  string Name() override { return "counting"; }
+  void* AllocateRaw(size_t alignment, size_t num_bytes) override {
+    ++num_allocations;
+    return cpu_allocator()->AllocateRaw(alignment, num_bytes);
+  }
+  void DeallocateRaw(void* ptr) override {
+    cpu_allocator()->DeallocateRaw(ptr);
+  }
+
+  int num_allocations = 0;
+};
+
+// Tensors are only identified by the kernel pointer, which is never
+// dereferenced.
+const OpKernel* Kernel(int i) {
+  return reinterpret_cast<const OpKernel*>(static_cast<uintptr_t>(i + 1) * 64);
+}
+
+class StaticMemoryPlannerTest : public ::testing::Test {
+ protected:
+  // Runs a -> b -> c with 1KB tensors, a is freed once b is allocated.
+  // Returns the data of a, b and c.
+  std::vector<void*> RunChain(StepMemoryPlan* plan) {
+    TensorBuffer* a = plan->AllocateBuffer(Kernel(0), 0, 1024, &allocator_);
+    TensorBuffer* b = plan->AllocateBuffer(Kernel(1), 0, 1024, &allocator_);
+    a->Unref();
+    TensorBuffer* c = plan->AllocateBuffer(Kernel(2), 0, 1024, &allocator_);
+    b->Unref();
+    std::vector<void*> data = {a->data(), b->data(), c->data()};
+    c->Unref();
+    return data;
+  }
+
+  void RecordChain(StaticMemoryPlanner* planner, int steps) {
+    for (int i = 0; i < steps; ++i) {
+      StepMemoryPlan* plan = planner->StartStep();
+      ASSERT_NE(nullptr, plan);
+      RunChain(plan);
+      plan->StepDone();
+      plan->Unref();
+    }
+  }
+
+  CountingAllocator allocator_;
+};
+
+TEST_F(StaticMemoryPlannerTest, PlaceTensorsAtFixedOffsets) {
+  StaticMemoryPlanner planner(1, 2);
+  EXPECT_EQ(nullptr, planner.StartStep());
+  RecordChain(&planner, 2);
+  ASSERT_TRUE(planner.Planned());
+  EXPECT_EQ(3, planner.NumPlannedTensors());
+  // a and c share memory.
+  EXPECT_EQ(2048, planner.ArenaSize());
+
+  const int num_allocations = allocator_.num_allocations;
+  std::vector<void*> first;
+  for (int i = 0; i < 3; ++i) {
+    StepMemoryPlan* plan = planner.StartStep();
+    ASSERT_NE(nullptr, plan);
+    std::vector<void*> data = RunChain(plan);
+    plan->StepDone();
+    plan->Unref();
+
+    EXPECT_EQ(data[0], data[2]);
+    EXPECT_NE(data[0], data[1]);
+    // Steps reuse the same arena.
+    if (i == 0) {
+      first = data;
+    } else {
+      EXPECT_EQ(first, data);
+    }
+  }
+  EXPECT_EQ(num_allocations, allocator_.num_allocations);
+}
+
+TEST_F(StaticMemoryPlannerTest, FallbackWhenSharedTensorIsAlive) {
+  StaticMemoryPlanner planner(0, 1);
+  RecordChain(&planner, 1);
+  ASSERT_TRUE(planner.Planned());
+
+  StepMemoryPlan* plan = planner.StartStep();
+  TensorBuffer* a = plan->AllocateBuffer(Kernel(0), 0, 1024, &allocator_);
+  TensorBuffer* b = plan->AllocateBuffer(Kernel(1), 0, 1024, &allocator_);
+  ASSERT_NE(nullptr, a);
+  ASSERT_NE(nullptr, b);
+  // a is still alive, c can't take its memory.
+  EXPECT_EQ(nullptr,
+            plan->AllocateBuffer(Kernel(2), 0, 1024, &allocator_));
+  // Tensors larger than recorded and tensors allocated twice are not placed.
+  a->Unref();
+  EXPECT_EQ(nullptr,
+            plan->AllocateBuffer(Kernel(2), 0, 4096, &allocator_));
+  EXPECT_EQ(nullptr,
+            plan->AllocateBuffer(Kernel(1), 0, 1024, &allocator_));
+  b->Unref();
+  plan->StepDone();
+  plan->Unref();
+}
+
+TEST_F(StaticMemoryPlannerTest, EscapingTensorsAreNotPlanned) {
+  StaticMemoryPlanner planner(0, 1);
+  StepMemoryPlan* plan = planner.StartStep();
+  TensorBuffer* a = plan->AllocateBuffer(Kernel(0), 0, 1024, &allocator_);
+  TensorBuffer* b = plan->AllocateBuffer(Kernel(1), 0, 1024, &allocator_);
+  a->Unref();
+  plan->StepDone();
+  plan->Unref();
+  // b is fetched by the client after the step.
+  b->Unref();
+  ASSERT_TRUE(planner.Planned());
+  EXPECT_EQ(1, planner.NumPlannedTensors());
+
+  plan = planner.StartStep();
+  EXPECT_EQ(nullptr,
+            plan->AllocateBuffer(Kernel(1), 0, 1024, &allocator_));
+  plan->StepDone();
+  plan->Unref();
+}
+
+TEST_F(StaticMemoryPlannerTest, ConcurrentStepsUseDifferentArenas) {
+  StaticMemoryPlanner planner(0, 1);
+  RecordChain(&planner, 1);
+  ASSERT_TRUE(planner.Planned());
+
+  StepMemoryPlan* plan0 = planner.StartStep();
+  StepMemoryPlan* plan1 = planner.StartStep();
+  TensorBuffer* a0 = plan0->AllocateBuffer(Kernel(0), 0, 1024, &allocator_);
+  TensorBuffer* a1 = plan1->AllocateBuffer(Kernel(0), 0, 1024, &allocator_);
+  ASSERT_NE(nullptr, a0);
+  ASSERT_NE(nullptr, a1);
+  EXPECT_NE(a0->data(), a1->data());
+  plan0->StepDone();
+  plan0->Unref();
+  plan1->StepDone();
+  plan1->Unref();
+  // The arenas outlive their steps while tensors are alive.
+  memset(a0->data(), 0, 1024);
+  a0->Unref();
+  a1->Unref();
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -2,6 +2,8 @@
 #include "tensorflow/core/common_runtime/tensorpool_allocator.h"
 #include "tensorflow/core/framework/allocator_registry.h"
 #include "tensorflow/core/platform/mem.h"
+#include "tensorflow/core/platform/numa.h"
+#include "tensorflow/core/util/env_var.h"
 #include <sys/time.h>
 
 #define likely(x) __builtin_expect(!!(x), 1)
@@ -81,6 +83,73 @@ void* SetHeader(void* p, size_t total_bytes, size_t header_size,
   return h->user_ptr;
 }
 
+// Chunks a thread may cache of a bin with `len` chunks.
+size_t ThreadCacheMagazineSize(size_t len) {
+  static bool enable_thread_cache = [] {
+    bool enable = true;
+    Status s = ReadBoolFromEnvVar("TENSORPOOL_ENABLE_THREAD_CACHE", true,
+                                  &enable);
+    if (!s.ok()) {
+      LOG(WARNING) << "Read TENSORPOOL_ENABLE_THREAD_CACHE envrionment error. "
+                   << s.error_message();
+    }
+    return enable;
+  }();
+  if (!enable_thread_cache) {
+    return 0;
+  }
+  // Keep most of the planned chunks shared among threads.
+  return std::min<size_t>(len / 8,
+      TensorPoolAllocator::ThreadLocalCache::kMaxMagazineSize);
+}
+
+// Chunks all the threads may cache of a bin with `len` chunks, the other
+// half is always left in the bin.
+size_t ThreadCacheBudget(size_t len) {
+  return len / 2;
+}
+
+size_t LargeCacheCapacity() {
+  int64 capacity_mb = 512;
+  Status s = ReadInt64FromEnvVar("TENSORPOOL_LARGE_CACHE_MB", 512,
+                                 &capacity_mb);
+  if (!s.ok()) {
+    LOG(WARNING) << "Read TENSORPOOL_LARGE_CACHE_MB envrionment error. "
+                 << s.error_message();
+  }
+  return std::max<int64>(capacity_mb, 0) * 1024 * 1024;
+}
+
+void DeleteThreadLocalCache(void* cache) {
+  delete static_cast<TensorPoolAllocator::ThreadLocalCache*>(cache);
+}
+
+// Size classes of the large size class cache, from 32KB to 1GB with 4
+// classes per power of two.
+constexpr int kLargeClassMinShift = 15;
+constexpr int kLargeClassMaxShift = 30;
+constexpr int kLargeClassesPerShift = 4;
+constexpr int kNumLargeClasses =
+    (kLargeClassMaxShift - kLargeClassMinShift) * kLargeClassesPerShift;
+// Cached blocks are reused for any alignment up to the page size.
+constexpr size_t kLargeClassAlignment = 4096;
+
+int LargeClassIndex(size_t num_bytes) {
+  if (num_bytes <= (1UL << kLargeClassMinShift)) {
+    return 0;
+  }
+  size_t v = num_bytes - 1;
+  int msb = 63 - __builtin_clzll(v);
+  int sub = (v >> (msb - 2)) & (kLargeClassesPerShift - 1);
+  return (msb - kLargeClassMinShift) * kLargeClassesPerShift + sub;
+}
+
+size_t LargeClassSize(int index) {
+  int msb = kLargeClassMinShift + index / kLargeClassesPerShift;
+  int sub = index % kLargeClassesPerShift;
+  return static_cast<size_t>(kLargeClassesPerShift + sub + 1) << (msb - 2);
+}
+
 class DefaultCPUSubAllocator : public SubAllocator {
  public:
   DefaultCPUSubAllocator() : SubAllocator({}, {}) {}
@@ -103,12 +172,39 @@ TensorPoolAllocator::TensorPoolAllocator() :
     sub_allocator_(new DefaultCPUSubAllocator),
     mem_planner_(MemoryPlannerFactory::GetMemoryPlanner()),
     large_bin_index_(0),
+    numa_nodes_(port::NUMAEnabled() ?
+        std::max(port::NUMANumNodes(), 1) : 1),
+    num_bins_(0),
+    large_cache_(new LargeSizeClassCache(LargeCacheCapacity(),
+                                         sub_allocator_.get())),
     null_bin_counter_(0),
     hit_counter_(0),
     missed_counter_(0) {
+  pthread_key_create(&cache_key_, DeleteThreadLocalCache);
   mem_planner_->SetAllocator(this);
 }
 
+TensorPoolAllocator::~TensorPoolAllocator() {
+  // Bins are never released, the caches of the other threads are leaked
+  // rather than returned to bins at thread exit.
+  pthread_key_delete(cache_key_);
+}
+
+TensorPoolAllocator::ThreadLocalCache*
+TensorPoolAllocator::GetThreadLocalCache() {
+  auto cache = static_cast<ThreadLocalCache*>(
+      pthread_getspecific(cache_key_));
+  if (unlikely(cache == nullptr)) {
+    int numa_node = port::NUMAGetThreadNodeAffinity();
+    if (numa_node < 0 || numa_node >= numa_nodes_) {
+      numa_node = 0;
+    }
+    cache = new ThreadLocalCache(numa_node);
+    pthread_setspecific(cache_key_, cache);
+  }
+  return cache;
+}
+
 void TensorPoolAllocator::Init() {
   bool tmp = false;
   if (initing_.compare_exchange_strong(tmp, true)) {
@@ -200,12 +296,23 @@ TensorPoolAllocator::Bin::Bin(size_t len,
     size_t chunk_size, size_t alignment,
     std::vector<VirtualAllocBlock*>& vblocks,
     SubAllocator* sub_allocator, TensorPoolAllocator* tp) :
-  buffer_(len, chunk_size, alignment, sub_allocator),
-  virtual_buffer_(vblocks, tp), sub_allocator_(sub_allocator) {
+  virtual_buffer_(vblocks, tp), sub_allocator_(sub_allocator), tp_(tp),
+  cache_index_(tp->num_bins_++), magazine_size_(ThreadCacheMagazineSize(len)),
+  cache_budget_(ThreadCacheBudget(len)), cached_chunks_(0) {
+  size_t numa_nodes = tp->numa_nodes_;
+  buffers_.resize(numa_nodes);
+  for (size_t node = 0; node < numa_nodes; ++node) {
+    auto node_len = len / numa_nodes + (node < len % numa_nodes ? 1 : 0);
+    if (node_len > 0) {
+      buffers_[node].reset(new Buffer(node_len, chunk_size, alignment,
+          numa_nodes > 1 ? static_cast<int>(node) : port::kNUMANoAffinity, sub_allocator));
+    }
+  }
 }
 
 void* TensorPoolAllocator::Bin::Allocate(size_t total, size_t header_size) {
-  auto ptr = buffer_.Allocate();
+  auto ptr = likely(magazine_size_ > 0)
+      ? tp_->GetThreadLocalCache()->Allocate(this) : AllocateRaw();
   if (ptr != nullptr) {
     return SetHeader(ptr, total, header_size, (void*)this, nullptr);
   } 
@@ -219,7 +326,11 @@ void* TensorPoolAllocator::Bin::Allocate(size_t total, size_t header_size) {
 
 void TensorPoolAllocator::Bin::Deallocate(Header* header) {
   if (header->internal_bin == nullptr) {
-    buffer_.Deallocate(header->raw_ptr);
+    if (likely(magazine_size_ > 0)) {
+      tp_->GetThreadLocalCache()->Deallocate(this, header->raw_ptr);
+    } else {
+      DeallocateRaw(header->raw_ptr);
+    }
   } else {
     virtual_buffer_.Deallocate(header->raw_ptr,
         (TensorPoolAllocator::Bin*)(header->internal_bin));
@@ -227,18 +338,85 @@ void TensorPoolAllocator::Bin::Deallocate(Header* header) {
 }
 
 void* TensorPoolAllocator::Bin::AllocateRaw() {
-  return buffer_.Allocate();
+  for (auto& buffer : buffers_) {
+    if (buffer != nullptr) {
+      auto ptr = buffer->Allocate();
+      if (ptr != nullptr) {
+        return ptr;
+      }
+    }
+  }
+  return nullptr;
 }
 
 void TensorPoolAllocator::Bin::DeallocateRaw(void* p) {
-  buffer_.Deallocate(p);
+  OwnerBuffer(p)->Deallocate(p);
+}
+
+size_t TensorPoolAllocator::Bin::ReserveMagazine() {
+  auto cached = cached_chunks_.load(std::memory_order_relaxed);
+  while (cached < cache_budget_) {
+    auto num = std::min(magazine_size_, cache_budget_ - cached);
+    if (cached_chunks_.compare_exchange_weak(cached, cached + num)) {
+      return num;
+    }
+  }
+  return 0;
+}
+
+void TensorPoolAllocator::Bin::ReleaseMagazine(size_t num) {
+  cached_chunks_.fetch_sub(num);
+}
+
+size_t TensorPoolAllocator::Bin::BatchAllocate(int numa_node, size_t num,
+    void** ret) {
+  size_t allocated = 0;
+  for (size_t i = 0; i < buffers_.size() && allocated < num; ++i) {
+    auto& buffer = buffers_[(numa_node + i) % buffers_.size()];
+    if (buffer != nullptr) {
+      allocated += buffer->BatchAllocate(num - allocated, ret + allocated);
+    }
+  }
+  return allocated;
+}
+
+void TensorPoolAllocator::Bin::BatchDeallocate(size_t num, void** ptrs) {
+  if (likely(buffers_.size() == 1)) {
+    buffers_[0]->BatchDeallocate(num, ptrs);
+    return;
+  }
+  for (size_t i = 0; i < num; ++i) {
+    OwnerBuffer(ptrs[i])->Deallocate(ptrs[i]);
+  }
+}
+
+TensorPoolAllocator::Buffer* TensorPoolAllocator::Bin::OwnerBuffer(void* p) {
+  Buffer* first = nullptr;
+  for (auto& buffer : buffers_) {
+    if (buffer == nullptr) {
+      continue;
+    }
+    if (buffer->Contains(p)) {
+      return buffer.get();
+    }
+    if (first == nullptr) {
+      first = buffer.get();
+    }
+  }
+  // Buffer::Deallocate reports the corruption.
+  return first;
 }
 
 TensorPoolAllocator::Buffer::Buffer(size_t len, size_t chunk_size,
-    size_t alignment, SubAllocator* sub_allocator) {
+    size_t alignment, int numa_node, SubAllocator* sub_allocator) {
   auto rounded_bytes = RoundedBytes(chunk_size, alignment);
   auto buffer_size = rounded_bytes * len;
-  auto p = sub_allocator->Alloc(alignment, buffer_size);
+  void* p = nullptr;
+  if (numa_node != port::kNUMANoAffinity) {
+    p = port::NUMAMalloc(numa_node, buffer_size, alignment);
+  } else {
+    p = sub_allocator->Alloc(alignment, buffer_size);
+  }
   begin_ = p;
   end_ = p + buffer_size;
 
@@ -265,6 +443,165 @@ void TensorPoolAllocator::Buffer::Deallocate(void* p) {
   buffer_.emplace(p);
 }
 
+size_t TensorPoolAllocator::Buffer::BatchAllocate(size_t num, void** ret) {
+  std::lock_guard<spin_lock> l(lock_);
+  size_t allocated = 0;
+  while (allocated < num && !buffer_.empty()) {
+    ret[allocated++] = buffer_.top();
+    buffer_.pop();
+  }
+  return allocated;
+}
+
+void TensorPoolAllocator::Buffer::BatchDeallocate(size_t num, void** ptrs) {
+  for (size_t i = 0; i < num; ++i) {
+    if (unlikely(ptrs[i] < begin_ || ptrs[i] > end_)) {
+      LOG(WARNING) << "probabaly memory corruption!!";
+    }
+  }
+  std::lock_guard<spin_lock> l(lock_);
+  for (size_t i = 0; i < num; ++i) {
+    buffer_.emplace(ptrs[i]);
+  }
+}
+
+constexpr size_t TensorPoolAllocator::ThreadLocalCache::kMaxMagazineSize;
+
+TensorPoolAllocator::ThreadLocalCache::~ThreadLocalCache() {
+  for (auto& m : magazines_) {
+    if (m.bin == nullptr) {
+      continue;
+    }
+    if (m.count > 0) {
+      m.bin->BatchDeallocate(m.count, m.ptrs);
+    }
+    m.bin->ReleaseMagazine(m.capacity);
+  }
+}
+
+TensorPoolAllocator::ThreadLocalCache::Magazine*
+TensorPoolAllocator::ThreadLocalCache::GetMagazine(Bin* bin) {
+  auto index = bin->CacheIndex();
+  if (unlikely(index >= magazines_.size())) {
+    magazines_.resize(index + 1);
+  }
+  auto m = &magazines_[index];
+  if (unlikely(m->bin == nullptr)) {
+    // The budget is reserved once per thread, threads beyond it use the
+    // bin directly.
+    m->bin = bin;
+    m->capacity = bin->ReserveMagazine();
+  }
+  return m;
+}
+
+void* TensorPoolAllocator::ThreadLocalCache::Allocate(Bin* bin) {
+  auto m = GetMagazine(bin);
+  if (unlikely(m->count == 0)) {
+    if (unlikely(m->capacity == 0)) {
+      return bin->AllocateRaw();
+    }
+    // Refill half of the magazine, so that a following deallocation
+    // doesn't return chunks to the bin right away.
+    m->count = bin->BatchAllocate(numa_node_, (m->capacity + 1) / 2,
+                                  m->ptrs);
+    if (m->count == 0) {
+      return nullptr;
+    }
+  }
+  return m->ptrs[--m->count];
+}
+
+void TensorPoolAllocator::ThreadLocalCache::Deallocate(Bin* bin, void* p) {
+  auto m = GetMagazine(bin);
+  if (unlikely(m->capacity == 0)) {
+    bin->DeallocateRaw(p);
+    return;
+  }
+  if (unlikely(m->count >= m->capacity)) {
+    auto num = (m->count + 1) / 2;
+    m->count -= num;
+    bin->BatchDeallocate(num, m->ptrs + m->count);
+  }
+  m->ptrs[m->count++] = p;
+}
+
+class TensorPoolAllocator::LargeSizeClassCache::SizeClass {
+ public:
+  explicit SizeClass(size_t size) : size_(size) {}
+
+  size_t Size() const { return size_; }
+
+  void* Pop() {
+    std::lock_guard<spin_lock> l(lock_);
+    if (blocks_.empty()) {
+      return nullptr;
+    }
+    auto ptr = blocks_.back();
+    blocks_.pop_back();
+    return ptr;
+  }
+
+  void Push(void* p) {
+    std::lock_guard<spin_lock> l(lock_);
+    blocks_.emplace_back(p);
+  }
+
+  void FreeAll(SubAllocator* sub_allocator) {
+    std::lock_guard<spin_lock> l(lock_);
+    for (auto ptr : blocks_) {
+      sub_allocator->Free(ptr, size_);
+    }
+    blocks_.clear();
+  }
+
+ private:
+  mutable spin_lock lock_;
+  std::vector<void*> blocks_;
+  size_t size_;
+};
+
+TensorPoolAllocator::LargeSizeClassCache::LargeSizeClassCache(
+    size_t capacity, SubAllocator* sub_allocator) :
+  cached_bytes_(0), capacity_(capacity), sub_allocator_(sub_allocator) {
+  for (int i = 0; i < kNumLargeClasses; ++i) {
+    size_classes_.emplace_back(new SizeClass(LargeClassSize(i)));
+  }
+}
+
+TensorPoolAllocator::LargeSizeClassCache::~LargeSizeClassCache() {
+  for (auto& sc : size_classes_) {
+    sc->FreeAll(sub_allocator_);
+  }
+}
+
+void* TensorPoolAllocator::LargeSizeClassCache::Allocate(size_t alignment,
+    size_t num_bytes, SizeClass** sc) {
+  auto index = LargeClassIndex(num_bytes);
+  if (capacity_ == 0 || alignment > kLargeClassAlignment ||
+      index >= kNumLargeClasses) {
+    return nullptr;
+  }
+  *sc = size_classes_[index].get();
+  auto ptr = (*sc)->Pop();
+  if (ptr != nullptr) {
+    cached_bytes_ -= (*sc)->Size();
+    return ptr;
+  }
+  return sub_allocator_->Alloc(kLargeClassAlignment, (*sc)->Size());
+}
+
+void TensorPoolAllocator::LargeSizeClassCache::Deallocate(void* p,
+    SizeClass* sc) {
+  auto size = sc->Size();
+  if (cached_bytes_.fetch_add(size) + size > capacity_) {
+    cached_bytes_ -= size;
+    sub_allocator_->Free(p, size);
+    return;
+  }
+  sc->Push(p);
+}
+
 TensorPoolAllocator::VirtualBuffer::VirtualBuffer(
     std::vector<VirtualAllocBlock*>& vblocks,
     TensorPoolAllocator* tp) {
@@ -337,22 +674,19 @@ void* TensorPoolAllocator::BigAllocate(size_t alignment,
 
   auto id = Index(total, alignment_, alignment_offset_);
   if (unlikely(id < 0)) {
-    auto ptr = sub_allocator_->Alloc(alignment, total);
-    return SetDefaultHeader(!inited_.load(), ptr, total, header_size);
+    return LargeAllocate(alignment, total, header_size);
   }
 
   auto b = GetBin(id);
   if (unlikely(b == nullptr)) {
-    auto ptr = sub_allocator_->Alloc(alignment, total);
-    return SetDefaultHeader(!inited_.load(), ptr, total, header_size);
+    return LargeAllocate(alignment, total, header_size);
   }
 
   auto ptr = b->Allocate(total, header_size);
   if (likely(ptr != nullptr)) {
     return ptr;
   }
-  ptr = sub_allocator_->Alloc(alignment, total);
-  return SetDefaultHeader(!inited_.load(), ptr, total, header_size);
+  return LargeAllocate(alignment, total, header_size);
 }
 
 // unlikely execute this path which do some atomic operations
@@ -368,15 +702,13 @@ void* TensorPoolAllocator::BigAllocateStatistic(size_t alignment,
 
   auto id = Index(total, alignment_, alignment_offset_);
   if (unlikely(id < 0)) {
-    auto ptr = sub_allocator_->Alloc(alignment, total);
-    return SetDefaultHeader(!inited_.load(), ptr, total, header_size);
+    return LargeAllocate(alignment, total, header_size);
   }
 
   auto b = GetBin(id);
   if (unlikely(b == nullptr)) {
     ++null_bin_counter_;
-    auto ptr = sub_allocator_->Alloc(alignment, total);
-    return SetDefaultHeader(!inited_.load(), ptr, total, header_size);
+    return LargeAllocate(alignment, total, header_size);
   }
 
   auto ptr = b->Allocate(total, header_size);
@@ -385,8 +717,7 @@ void* TensorPoolAllocator::BigAllocateStatistic(size_t alignment,
     return ptr;
   }
   ++missed_counter_;
-  ptr = sub_allocator_->Alloc(alignment, total);
-  return SetDefaultHeader(!inited_.load(), ptr, total, header_size);
+  return LargeAllocate(alignment, total, header_size);
 }
 
 void TensorPoolAllocator::BigDeallocate(Header* header) {
@@ -399,7 +730,12 @@ void TensorPoolAllocator::BigDeallocate(Header* header) {
   }
   
   if (header->bin == nullptr) {
-    sub_allocator_->Free(ptr, num_bytes);
+    if (header->internal_bin != nullptr) {
+      large_cache_->Deallocate(ptr,
+          (LargeSizeClassCache::SizeClass*)(header->internal_bin));
+    } else {
+      sub_allocator_->Free(ptr, num_bytes);
+    }
     return;
   }
 
@@ -407,6 +743,18 @@ void TensorPoolAllocator::BigDeallocate(Header* header) {
   bin->Deallocate(header);
 }
 
+// Allocations which miss the lifetime bins.
+void* TensorPoolAllocator::LargeAllocate(size_t alignment, size_t total,
+    size_t header_size) {
+  LargeSizeClassCache::SizeClass* sc = nullptr;
+  auto ptr = large_cache_->Allocate(alignment, total, &sc);
+  if (ptr != nullptr) {
+    return SetHeader(ptr, total, header_size, nullptr, sc);
+  }
+  ptr = sub_allocator_->Alloc(alignment, total);
+  return SetDefaultHeader(!inited_.load(), ptr, total, header_size);
+}
+
 class TensorPoolAllocatorFactory : public AllocatorFactory {
  public:
   Allocator* CreateAllocator() override { return new TensorPoolAllocator; }
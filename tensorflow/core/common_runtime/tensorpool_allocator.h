@@ -4,13 +4,18 @@
 #include "tensorflow/core/framework/allocator.h"
 #include "tensorflow/core/lib/core/spin_lock.h"
 
+#include <pthread.h>
 #include <atomic>
 #include <map>
+#include <memory>
 #include <stack>
 #include <vector>
 
 namespace tensorflow {
 // >32KB's allocation header
+// `bin` is the lifetime bin the block comes from, `internal_bin` is the bin
+// of the virtual block if any. Blocks from the large size class cache have
+// no `bin` and `internal_bin` is their size class.
 struct Header {
   double begin;
   double end; 
@@ -43,7 +48,7 @@ class VirtualAllocBlock;
 class TensorPoolAllocator : public Allocator {
  public:
   TensorPoolAllocator();
-  ~TensorPoolAllocator() override {}
+  ~TensorPoolAllocator() override;
 
   TensorPoolAllocator(const TensorPoolAllocator&) = delete;
   TensorPoolAllocator& operator=(const TensorPoolAllocator&) = delete;
@@ -73,14 +78,22 @@ class TensorPoolAllocator : public Allocator {
     std::stack<Bin*> internal_bins_;
   };
 
+  // Slab of `len` chunks allocated on one NUMA node.
   class Buffer {
    public:
-    Buffer(size_t len, size_t chunk_size,
-        size_t alignment, SubAllocator* sub_allocator);
+    Buffer(size_t len, size_t chunk_size, size_t alignment,
+        int numa_node, SubAllocator* sub_allocator);
 
     void* Allocate();
     void Deallocate(void* p);
 
+    // Pops/pushes up to `num` chunks under one lock, returns the number
+    // of allocated chunks.
+    size_t BatchAllocate(size_t num, void** ret);
+    void BatchDeallocate(size_t num, void** ptrs);
+
+    bool Contains(void* p) const { return p >= begin_ && p < end_; }
+
    private:
     mutable spin_lock lock_;
     std::stack<void*> buffer_;
@@ -103,17 +116,99 @@ class TensorPoolAllocator : public Allocator {
 
     void* AllocateRaw();
     void DeallocateRaw(void* p);
+
+    // Used by the thread local caches, chunks of the `numa_node` slab are
+    // preferred.
+    size_t BatchAllocate(int numa_node, size_t num, void** ret);
+    void BatchDeallocate(size_t num, void** ptrs);
+
+    // Index of the bin in the thread local caches.
+    size_t CacheIndex() const { return cache_index_; }
+    // Max number of chunks a thread caches, 0 if caching is disabled.
+    size_t MagazineSize() const { return magazine_size_; }
+
+    // Reserves up to MagazineSize() chunks of the budget shared by the
+    // caches of all the threads, returns the number of chunks the thread
+    // may cache, 0 once the budget is used up.
+    size_t ReserveMagazine();
+    void ReleaseMagazine(size_t num);
+    // Chunks reserved by the thread caches, at most CacheBudget().
+    size_t CachedChunks() const { return cached_chunks_.load(); }
+    size_t CacheBudget() const { return cache_budget_; }
    
    private:
-    Buffer buffer_;
+    Buffer* OwnerBuffer(void* p);
+
+    // One slab per NUMA node, the planned chunks are split among them.
+    std::vector<std::unique_ptr<Buffer>> buffers_;
     VirtualBuffer virtual_buffer_;
     SubAllocator* sub_allocator_;
+    TensorPoolAllocator* tp_;
+    size_t cache_index_;
+    size_t magazine_size_;
+    size_t cache_budget_;
+    std::atomic<size_t> cached_chunks_;
+  };
+
+  // Per thread magazines of chunks in front of the bins, refilled from and
+  // returned to the bins in batches, so that most allocations don't touch
+  // the lock of the bin.
+  class ThreadLocalCache {
+   public:
+    explicit ThreadLocalCache(int numa_node) : numa_node_(numa_node) {}
+    // Returns the cached chunks to their bins.
+    ~ThreadLocalCache();
+
+    void* Allocate(Bin* bin);
+    void Deallocate(Bin* bin, void* p);
+
+    static constexpr size_t kMaxMagazineSize = 32;
+
+   private:
+    struct Magazine {
+      Bin* bin = nullptr;
+      // Chunks reserved from the cache budget of the bin.
+      size_t capacity = 0;
+      size_t count = 0;
+      void* ptrs[kMaxMagazineSize];
+    };
+
+    Magazine* GetMagazine(Bin* bin);
+
+    int numa_node_;
+    std::vector<Magazine> magazines_;
+  };
+
+  // Caches blocks of allocations that miss the lifetime bins, sizes are
+  // rounded up to size classes with 4 classes per power of two, so the
+  // blocks of similar sizes are reused instead of being allocated from the
+  // system each time.
+  class LargeSizeClassCache {
+   public:
+    LargeSizeClassCache(size_t capacity, SubAllocator* sub_allocator);
+    ~LargeSizeClassCache();
+
+    class SizeClass;
+    // Returns a block of at least `num_bytes` aligned to `alignment` and
+    // its size class, nullptr if the size is not cached.
+    void* Allocate(size_t alignment, size_t num_bytes, SizeClass** sc);
+    void Deallocate(void* p, SizeClass* sc);
+
+   private:
+    std::vector<std::unique_ptr<SizeClass>> size_classes_;
+    // Bytes of the free blocks kept in the cache.
+    std::atomic<size_t> cached_bytes_;
+    size_t capacity_;
+    SubAllocator* sub_allocator_;
   };
 
  private:
   void* BigAllocate(size_t alignment, size_t num_bytes);
   void* BigAllocateStatistic(size_t alignment, size_t num_bytes);
   void BigDeallocate(Header* header);
+  void* LargeAllocate(size_t alignment, size_t total, size_t header_size);
+
+  ThreadLocalCache* GetThreadLocalCache();
   
  private:
   bool stats_;
@@ -129,6 +224,11 @@ class TensorPoolAllocator : public Allocator {
 
   size_t alignment_;
   size_t alignment_offset_;
+
+  int numa_nodes_;
+  size_t num_bins_;
+  pthread_key_t cache_key_;
+  std::unique_ptr<LargeSizeClassCache> large_cache_;
  
   // Statistic
   std::atomic<int64_t> null_bin_counter_;
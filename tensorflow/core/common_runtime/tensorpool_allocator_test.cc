@@ -15,10 +15,13 @@ limitations under the License.
 #include <thread>
 #include "tensorflow/core/common_runtime/memory_planner.h"
 #include "tensorflow/core/common_runtime/tensorpool_allocator.h"
+#include "tensorflow/core/lib/core/blocking_counter.h"
+#include "tensorflow/core/lib/core/notification.h"
 #include "tensorflow/core/lib/core/status_test_util.h"
 #include "tensorflow/core/platform/logging.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 #include <unistd.h>
 
 namespace tensorflow {
@@ -275,5 +278,136 @@ TEST(TensorPoolAllocatorTest, HugeMemoryAllocation) {
   sleep(1);
 }
 
+// Runs planned steps until the allocator is initialized with lifetime bins.
+void WarmupTensorPoolAllocator(TensorPoolAllocator* allocator,
+                               const std::vector<int>& sizes) {
+  static thread::ThreadPool* threads =
+      new thread::ThreadPool(Env::Default(), "test", 2);
+  MemoryPlannerFactory::GetMemoryPlanner()->Reset();
+  MemoryPlannerFactory::GetMemoryPlanner()->SetThreadPool(threads);
+  for (int i = 0; i < 2000; ++i) {
+    ScopedMemoryCollector c;
+    std::vector<void*> vec;
+    for (int j = 0; j < 16; ++j) {
+      for (auto size : sizes) {
+        vec.emplace_back(allocator->AllocateRaw(64, size));
+      }
+    }
+    for (auto p : vec) {
+      allocator->DeallocateRaw(p);
+    }
+  }
+  sleep(1);
+}
+
+TEST(TensorPoolAllocatorTest, ThreadLocalCacheCrossThreadDeallocation) {
+  TensorPoolAllocator allocator;
+  std::vector<int> sizes = {64 * 1024, 128 * 1024};
+  WarmupTensorPoolAllocator(&allocator, sizes);
+
+  // Chunks allocated by one thread are freed by another, and sizes not
+  // seen in the warmup go to the large size class cache.
+  sizes.emplace_back(1024 * 1024);
+  const int kRounds = 32;
+  std::vector<void*> ptrs(kRounds * sizes.size());
+  std::thread producer([&] {
+    for (int i = 0; i < kRounds; ++i) {
+      for (size_t j = 0; j < sizes.size(); ++j) {
+        void* p = allocator.AllocateRaw(64, sizes[j]);
+        EXPECT_TRUE(p != nullptr);
+        EXPECT_EQ(0, reinterpret_cast<uintptr_t>(p) % 64);
+        memset(p, i & 0xff, sizes[j]);
+        ptrs[i * sizes.size() + j] = p;
+      }
+    }
+  });
+  producer.join();
+  std::thread consumer([&] {
+    for (int i = 0; i < kRounds; ++i) {
+      for (size_t j = 0; j < sizes.size(); ++j) {
+        auto p = static_cast<unsigned char*>(ptrs[i * sizes.size() + j]);
+        EXPECT_EQ(i & 0xff, p[0]);
+        EXPECT_EQ(i & 0xff, p[sizes[j] - 1]);
+        allocator.DeallocateRaw(p);
+      }
+    }
+  });
+  consumer.join();
+}
+
+TEST(TensorPoolAllocatorTest, ThreadLocalCacheBudget) {
+  TensorPoolAllocator allocator;
+  const int size = 64 * 1024;
+  WarmupTensorPoolAllocator(&allocator, {size});
+  void* p = allocator.AllocateRaw(64, size);
+  auto header = reinterpret_cast<Header*>(
+      static_cast<char*>(p) - sizeof(Header));
+  auto bin = static_cast<TensorPoolAllocator::Bin*>(header->bin);
+  allocator.DeallocateRaw(p);
+  ASSERT_TRUE(bin != nullptr);
+  ASSERT_GT(bin->MagazineSize(), 0);
+
+  // Many more threads than the magazines the budget is split into keep
+  // their caches alive, the bin still keeps the rest of the chunks.
+  const int kThreads = 64;
+  BlockingCounter cached(kThreads);
+  Notification done;
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; ++t) {
+    threads.emplace_back([&] {
+      void* ptrs[4];
+      for (auto& ptr : ptrs) {
+        ptr = allocator.AllocateRaw(64, size);
+        EXPECT_TRUE(ptr != nullptr);
+      }
+      for (auto ptr : ptrs) {
+        allocator.DeallocateRaw(ptr);
+      }
+      cached.DecrementCount();
+      done.WaitForNotification();
+    });
+  }
+  cached.Wait();
+  EXPECT_GT(bin->CachedChunks(), 0);
+  EXPECT_LE(bin->CachedChunks(), bin->CacheBudget());
+  done.Notify();
+  for (auto& th : threads) {
+    th.join();
+  }
+  // The exited threads return their budget.
+  EXPECT_LE(bin->CachedChunks(), bin->MagazineSize());
+}
+
+// Every thread allocates and frees tensors of the warmed up sizes in a
+// loop, the throughput is limited by the contention on the bins.
+static void BM_TensorPoolAllocatorConcurrent(int iters, int num_threads) {
+  testing::StopTiming();
+  TensorPoolAllocator allocator;
+  std::vector<int> sizes = {64 * 1024, 100 * 1024, 256 * 1024};
+  WarmupTensorPoolAllocator(&allocator, sizes);
+
+  testing::StartTiming();
+  std::vector<std::thread> threads;
+  for (int t = 0; t < num_threads; ++t) {
+    threads.emplace_back([&allocator, &sizes, iters] {
+      void* ptrs[8];
+      for (int i = 0; i < iters; ++i) {
+        for (int j = 0; j < 8; ++j) {
+          ptrs[j] = allocator.AllocateRaw(64, sizes[j % sizes.size()]);
+        }
+        for (int j = 0; j < 8; ++j) {
+          allocator.DeallocateRaw(ptrs[j]);
+        }
+      }
+    });
+  }
+  for (auto& th : threads) {
+    th.join();
+  }
+  testing::StopTiming();
+  testing::ItemsProcessed(static_cast<int64>(iters) * num_threads * 8);
+}
+BENCHMARK(BM_TensorPoolAllocatorConcurrent)->Arg(1)->Arg(4)->Arg(16)->Arg(64);
+
 }
 }  // namespace tensorflow
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/distributed_runtime/master_session.h"
 
+#include <algorithm>
+#include <limits>
 #include <memory>
 #include <unordered_map>
 #include <unordered_set>
@@ -62,6 +64,19 @@ limitations under the License.
 
 namespace tensorflow {
 
+struct MasterSession::TensorFuseProfile {
+  struct NodeProfile {
+    // Sum over the steps of the time the node finished, relative to the
+    // first node of its partition.
+    int64 ready_micros = 0;
+    int64 count = 0;
+    // Largest size of each output.
+    std::vector<int64> output_bytes;
+  };
+  std::unordered_map<string, NodeProfile> nodes;
+  int steps = 0;
+};
+
 // MasterSession wraps ClientGraph in a reference counted object.
 // This way, MasterSession can clear up the cache mapping Run requests to
 // compiled graphs while the compiled graph is still being used.
@@ -130,6 +145,40 @@ class MasterSession::ReffedClientGraph : public core::RefCounted {
     return execution_count_.fetch_add(1);
   }
 
+  // Records the tensor fuse profile in the first `steps` steps.
+  void EnableTensorFuseProfile(int steps) {
+    mutex_lock l(tensor_fuse_mu_);
+    tensor_fuse_profile_steps_ = steps;
+    recording_profile_.reset(new TensorFuseProfile);
+  }
+
+  // Fuses the recvs with `profile` when the graph is partitioned.
+  void SetTensorFuseProfile(
+      std::shared_ptr<const TensorFuseProfile> profile) {
+    mutex_lock l(tensor_fuse_mu_);
+    tensor_fuse_profile_ = std::move(profile);
+  }
+
+  bool ShouldRecordTensorFuseProfile() {
+    mutex_lock l(tensor_fuse_mu_);
+    return recording_profile_ != nullptr;
+  }
+
+  // Adds the step stats of one step to the profile being recorded.
+  void RecordTensorFuseProfile(const std::vector<StepStats>& step_stats);
+
+  // Returns the recorded profile once all profiling steps are done, and
+  // nullptr otherwise.
+  std::shared_ptr<const TensorFuseProfile> TakeTensorFuseProfile() {
+    mutex_lock l(tensor_fuse_mu_);
+    if (recording_profile_ == nullptr ||
+        recording_profile_->steps < tensor_fuse_profile_steps_) {
+      return nullptr;
+    }
+    return std::shared_ptr<const TensorFuseProfile>(
+        recording_profile_.release());
+  }
+
   // Turn RPC logging on or off, both at the WorkerCache used by this
   // master process, and at each remote worker in use for the current
   // partitions.
@@ -337,9 +386,56 @@ class MasterSession::ReffedClientGraph : public core::RefCounted {
 
   ExecutorPolicy executor_policy_ = ExecutorPolicy::USE_NORMAL_EXECUTOR;
 
+  mutex tensor_fuse_mu_;
+  int tensor_fuse_profile_steps_ GUARDED_BY(tensor_fuse_mu_) = 0;
+  std::unique_ptr<TensorFuseProfile> recording_profile_
+      GUARDED_BY(tensor_fuse_mu_);
+  std::shared_ptr<const TensorFuseProfile> tensor_fuse_profile_
+      GUARDED_BY(tensor_fuse_mu_);
+
   TF_DISALLOW_COPY_AND_ASSIGN(ReffedClientGraph);
 };
 
+void MasterSession::ReffedClientGraph::RecordTensorFuseProfile(
+    const std::vector<StepStats>& step_stats) {
+  mutex_lock l(tensor_fuse_mu_);
+  if (recording_profile_ == nullptr ||
+      recording_profile_->steps >= tensor_fuse_profile_steps_) {
+    return;
+  }
+  for (const StepStats& ss : step_stats) {
+    // The times are relative to the start of the partition, so that the
+    // clocks of the workers need not agree.
+    int64 base_micros = std::numeric_limits<int64>::max();
+    for (const auto& ds : ss.dev_stats()) {
+      for (const auto& ns : ds.node_stats()) {
+        base_micros = std::min<int64>(base_micros, ns.all_start_micros());
+      }
+    }
+    for (const auto& ds : ss.dev_stats()) {
+      for (const auto& ns : ds.node_stats()) {
+        TensorFuseProfile::NodeProfile& node =
+            recording_profile_->nodes[ns.node_name()];
+        node.ready_micros +=
+            ns.all_start_micros() + ns.all_end_rel_micros() - base_micros;
+        ++node.count;
+        for (const auto& output : ns.output()) {
+          if (output.slot() < 0) continue;
+          if (output.slot() >= static_cast<int>(node.output_bytes.size())) {
+            node.output_bytes.resize(output.slot() + 1, 0);
+          }
+          node.output_bytes[output.slot()] =
+              std::max<int64>(node.output_bytes[output.slot()],
+                              output.tensor_description()
+                                  .allocation_description()
+                                  .requested_bytes());
+        }
+      }
+    }
+  }
+  ++recording_profile_->steps;
+}
+
 Status MasterSession::ReffedClientGraph::RegisterPartitions(
     PartitionOptions popts) {
   {  // Ensure register once.
@@ -443,6 +539,33 @@ Status MasterSession::ReffedClientGraph::DoBuildPartitions(
 
   // Partition the graph.
   if (popts.tensor_fuse) {
+    std::shared_ptr<const TensorFuseProfile> profile;
+    {
+      mutex_lock l(tensor_fuse_mu_);
+      profile = tensor_fuse_profile_;
+    }
+    if (profile != nullptr) {
+      const Graph& graph = client_graph->graph;
+      if (popts.start_times.empty()) {
+        popts.start_times.resize(graph.num_node_ids());
+        for (const Node* n : graph.nodes()) {
+          auto it = profile->nodes.find(n->name());
+          if (it != profile->nodes.end() && it->second.count > 0) {
+            popts.start_times[n->id()] =
+                Microseconds(it->second.ready_micros / it->second.count);
+          }
+        }
+      }
+      popts.edge_bytes = [profile](const Edge* e) -> int64 {
+        auto it = profile->nodes.find(e->src()->name());
+        if (it == profile->nodes.end() ||
+            e->src_output() >=
+                static_cast<int>(it->second.output_bytes.size())) {
+          return -1;
+        }
+        return it->second.output_bytes[e->src_output()];
+      };
+    }
     return PartitionWithTensorFuse(popts, &client_graph->graph, out_partitions);
   }
 
@@ -630,7 +753,7 @@ Status MasterSession::ReffedClientGraph::RunPartitionsHelper(
   if (pss->collect_costs) {
     exec_opts.set_record_costs(true);
   }
-  if (pss->collect_timeline) {
+  if (pss->collect_timeline || pss->collect_tensor_fuse_profile) {
     exec_opts.set_record_timeline(true);
   }
   if (pss->collect_rpcs) {
@@ -639,7 +762,8 @@ Status MasterSession::ReffedClientGraph::RunPartitionsHelper(
   if (pss->collect_partition_graphs) {
     exec_opts.set_record_partition_graphs(true);
   }
-  if (pss->collect_costs || pss->collect_timeline) {
+  if (pss->collect_costs || pss->collect_timeline ||
+      pss->collect_tensor_fuse_profile) {
     pss->step_stats.resize(partitions_.size());
   }
 
@@ -758,7 +882,7 @@ Status MasterSession::ReffedClientGraph::RunPartitionsHelper(
         break;
       }
     }
-    if (pss->collect_timeline) {
+    if (pss->collect_timeline || pss->collect_tensor_fuse_profile) {
       pss->step_stats[i].Swap(run_graph_resp->mutable_step_stats());
     }
     if (pss->collect_costs) {
@@ -918,6 +1042,9 @@ void MasterSession::ReffedClientGraph::ProcessStats(int64 step_id,
                                                     ProfileHandler* ph,
                                                     const RunOptions& options,
                                                     RunMetadata* resp) {
+  if (pss->collect_tensor_fuse_profile) {
+    RecordTensorFuseProfile(pss->step_stats);
+  }
   if (!pss->collect_costs && !pss->collect_timeline) return;
 
   // Out-of-band logging data is collected now, during post-processing.
@@ -1753,6 +1880,15 @@ Status MasterSession::StartStep(const BuildGraphOptions& opts, bool is_partial,
             handle_, opts, std::move(client_graph), session_opts_,
             stats_publisher_factory_, execution_state_.get(), is_partial,
             worker_cache, env_, !should_delete_worker_sessions_);
+        if (!is_partial && env_->tensor_fuse) {
+          auto profile = tensor_fuse_profiles_.find(hash);
+          if (profile != tensor_fuse_profiles_.end()) {
+            entry->SetTensorFuseProfile(profile->second);
+          } else if (session_opts_.config.tensor_fuse_profile_steps() > 0) {
+            entry->EnableTensorFuseProfile(
+                session_opts_.config.tensor_fuse_profile_steps());
+          }
+        }
       }
       iter = m->insert({hash, entry}).first;
       VLOG(1) << "Preparing to execute new graph";
@@ -1882,6 +2018,9 @@ Status MasterSession::BuildAndRegisterPartitions(ReffedClientGraph* rcg) {
   PartitionOptions popts;
   popts.node_to_loc = SplitByWorker;
   popts.tensor_fuse = env_->tensor_fuse;
+  popts.tensor_fuse_max_bytes = session_opts_.config.tensor_fuse_max_bytes();
+  popts.tensor_fuse_max_wait =
+      Microseconds(session_opts_.config.tensor_fuse_max_wait_micros());
   // The closures popts.{new_name,get_incarnation} are called synchronously in
   // RegisterPartitions() below, so do not need a Ref()/Unref() pair to keep
   // "this" alive during the closure.
@@ -2102,6 +2241,7 @@ void MasterSession::FillPerStepState(MasterSession::ReffedClientGraph* rcg,
       build_cost_model_every > 0 &&
       ((count + 1 - build_cost_model_after) % build_cost_model_every == 0);
   out_pss->collect_partition_graphs = run_options.output_partition_graphs();
+  out_pss->collect_tensor_fuse_profile = rcg->ShouldRecordTensorFuseProfile();
 
   *out_ph = rcg->GetProfileHandler(step_id, count, run_options);
   if (*out_ph) {
@@ -2127,6 +2267,9 @@ Status MasterSession::PostRunCleanup(MasterSession::ReffedClientGraph* rcg,
     }
     // Schedule post-processing and cleanup to be done asynchronously.
     rcg->ProcessStats(step_id, pss, ph.get(), run_options, out_run_metadata);
+    if (pss->collect_tensor_fuse_profile) {
+      MaybeRepartitionForTensorFuse(rcg);
+    }
   } else if (errors::IsCancelled(s)) {
     mutex_lock l(mu_);
     if (closed_) {
@@ -2153,6 +2296,26 @@ Status MasterSession::PostRunCleanup(MasterSession::ReffedClientGraph* rcg,
   return s;
 }
 
+void MasterSession::MaybeRepartitionForTensorFuse(ReffedClientGraph* rcg) {
+  std::shared_ptr<const TensorFuseProfile> profile =
+      rcg->TakeTensorFuseProfile();
+  if (profile == nullptr) return;
+  const uint64 hash = HashBuildGraphOptions(rcg->build_graph_options());
+  ReffedClientGraph* to_unref = nullptr;
+  {
+    mutex_lock l(mu_);
+    tensor_fuse_profiles_[hash] = std::move(profile);
+    auto iter = run_graphs_.find(hash);
+    if (iter != run_graphs_.end() && iter->second == rcg) {
+      to_unref = rcg;
+      run_graphs_.erase(iter);
+    }
+  }
+  VLOG(1) << "Recorded the tensor fuse profile of graph " << hash
+          << ", partition it again in the next step.";
+  if (to_unref != nullptr) to_unref->Unref();
+}
+
 Status MasterSession::DoRunWithLocalExecution(
     CallOptions* opts, const RunStepRequestWrapper& req,
     MutableRunStepResponseWrapper* resp) {
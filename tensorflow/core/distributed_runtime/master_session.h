@@ -17,6 +17,7 @@ limitations under the License.
 #define TENSORFLOW_CORE_DISTRIBUTED_RUNTIME_MASTER_SESSION_H_
 
 #include <atomic>
+#include <memory>
 #include <vector>
 
 #include "tensorflow/core/common_runtime/debugger_state_interface.h"
@@ -158,9 +159,17 @@ class MasterSession : public core::RefCounted {
   int64 next_callable_handle_ GUARDED_BY(mu_) = 0;
   RCGMap callables_ GUARDED_BY(mu_);
 
+  // Tensor sizes and ready times recorded in the first steps of a run
+  // graph, used to fuse its recvs when the graph is partitioned again. See
+  // ConfigProto.tensor_fuse_profile_steps.
+  struct TensorFuseProfile;
+  std::unordered_map<uint64, std::shared_ptr<const TensorFuseProfile>>
+      tensor_fuse_profiles_ GUARDED_BY(mu_);
+
   struct PerStepState {
     bool collect_costs = false;
     bool collect_timeline = false;
+    bool collect_tensor_fuse_profile = false;
     bool collect_rpcs = false;
     bool collect_partition_graphs = false;
     bool report_tensor_allocations_upon_oom = false;
@@ -249,6 +258,10 @@ class MasterSession : public core::RefCounted {
 
   Status BuildAndRegisterPartitions(ReffedClientGraph* rcg);
 
+  // Once `rcg` recorded its tensor fuse profile, drops it from the cache so
+  // that the next step partitions the graph again with the profile.
+  void MaybeRepartitionForTensorFuse(ReffedClientGraph* rcg);
+
   Status CreateDebuggerState(
       const DebugOptions& debug_options, const RunStepRequestWrapper& req,
       int64 rcg_execution_count,
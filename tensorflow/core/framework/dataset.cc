@@ -394,9 +394,19 @@ Status DatasetBaseIterator::GetNext(IteratorContext* ctx,
   profiler::TraceMe activity([&] { return BuildTraceMeName(); },
                              profiler::TraceMeLevel::kInfo);
   RecordStart(ctx, /*stop_output=*/true);
+  const bool collect_stats = InputPipelineStats::Global()->enabled();
+  const int64 start_micros = collect_stats ? Env::Default()->NowMicros() : 0;
   Status s = GetNextInternal(ctx, out_tensors, end_of_sequence);
   if (s.ok() && !*end_of_sequence) RecordElement(ctx);
   RecordStop(ctx, /*start_output=*/true);
+  if (collect_stats) {
+    const int64 end_micros = Env::Default()->NowMicros();
+    InputPipelineStats::Stage* stage = stats_stage();
+    stage->RecordCall(start_micros, end_micros);
+    if (s.ok() && !*end_of_sequence) {
+      stage->RecordElement(end_micros - start_micros);
+    }
+  }
   if (TF_PREDICT_FALSE(errors::IsOutOfRange(s))) {
     s = errors::Internal("Iterator \"", params_.prefix,
                          "\" returned `OutOfRange`. This indicates an "
@@ -15,6 +15,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_DATASET_H_
 #define TENSORFLOW_CORE_FRAMEWORK_DATASET_H_
 
+#include <atomic>
 #include <deque>
 #include <memory>
 #include <unordered_map>
@@ -26,6 +27,7 @@ limitations under the License.
 #include "tensorflow/core/framework/dataset_stateful_op_whitelist.h"
 #include "tensorflow/core/framework/function.h"
 #include "tensorflow/core/framework/graph.pb.h"
+#include "tensorflow/core/framework/input_pipeline_stats.h"
 #include "tensorflow/core/framework/model.h"
 #include "tensorflow/core/framework/node_def.pb.h"
 #include "tensorflow/core/framework/op_kernel.h"
@@ -915,7 +917,21 @@ class DatasetBaseIterator : public IteratorBase {
     return model && model->collect_resource_usage() && node_;
   }
 
+  // Returns the input pipeline stats of this iterator, created on the first
+  // call.
+  InputPipelineStats::Stage* stats_stage() {
+    InputPipelineStats::Stage* stage =
+        stats_stage_.load(std::memory_order_acquire);
+    if (TF_PREDICT_FALSE(stage == nullptr)) {
+      stage = InputPipelineStats::Global()->GetStage(
+          params_.prefix, InputPipelineStats::IteratorKind(params_.prefix));
+      stats_stage_.store(stage, std::memory_order_release);
+    }
+    return stage;
+  }
+
   BaseParams params_;
+  std::atomic<InputPipelineStats::Stage*> stats_stage_{nullptr};
 };
 
 // Represents an iterator that is associated with a particular dataset
@@ -3,6 +3,11 @@
 
 //#include "tensorflow/core/framework/embedding/embedding_var.h"
 #include "tensorflow/core/framework/embedding/embedding_config.h"
+#include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/platform/mem.h"
+#include "tensorflow/core/platform/prefetch.h"
+#include "tensorflow/core/util/env_var.h"
 #if GOOGLE_CUDA
 #if !TENSORFLOW_USE_GPU_EV
 #include "tensorflow/core/framework/embedding/batch.h"
@@ -54,8 +59,23 @@ class EmbeddingFilter {
   virtual void CreateGPUBatch(V* val_base, V** default_values, int64 size,
     int64 slice_elems, int64 value_len_, bool* init_flags, V** memcpy_address) = 0;
 
+  virtual ~EmbeddingFilter() {}
+
+  // Looks up or creates the `num` keys as LookupOrCreate does, the value of
+  // keys[i] is written to val + i * value_len.
+  virtual void BatchLookupOrCreate(const K* keys, V* val, int64 value_len,
+                                   const V* const* default_value_ptrs,
+                                   const int32* counts, int64 num,
+                                   ValuePtr<V>** value_ptrs) {
+    for (int64 i = 0; i < num; ++i) {
+      LookupOrCreate(keys[i], val + i * value_len, default_value_ptrs[i],
+                     value_ptrs + i, counts == nullptr ? 1 : counts[i]);
+    }
+  }
+
   virtual int64 GetFreq(K key, ValuePtr<V>* value_ptr) = 0;
   virtual int64 GetFreq(K key) = 0;
+  virtual string DebugString() const { return ""; }
   virtual Status Import(RestoreBuffer& restore_buff,
     int64 key_num,
     int bucket_num,
@@ -71,37 +91,92 @@ class BloomFilter : public EmbeddingFilter<K, V, EV> {
       config_(config), ev_(ev), storage_manager_(storage_manager) {
     switch (config_.counter_type){
       case DT_UINT64:
-        VLOG(2) << "The type of bloom counter is uint64";
-        bloom_counter_ = (void *)calloc(config_.num_counter, sizeof(long));
-        break;
       case DT_UINT32:
-        VLOG(2) << "The type of bloom counter is uint32";
-        bloom_counter_ = (void *)calloc(config_.num_counter, sizeof(int));
-        break;
       case DT_UINT16:
-        VLOG(2) << "The type of bloom counter is uint16";
-        bloom_counter_ = (void *)calloc(config_.num_counter, sizeof(int16));
-        break;
       case DT_UINT8:
-        VLOG(2) << "The type of bloom counter is uint8";
-        bloom_counter_ = (void *)calloc(config_.num_counter, sizeof(bool));
+        counter_type_ = config_.counter_type;
         break;
       default:
         VLOG(2) << "defualt type of counter is uint64";
-        bloom_counter_ = (void *)calloc(config_.num_counter, sizeof(long));
+        counter_type_ = DT_UINT64;
+    }
+    VLOG(2) << "The type of bloom counter is " << DataTypeString(counter_type_);
+    counter_size_ = DataTypeSize(counter_type_);
+    Status s = ReadBoolFromEnvVar("TF_EV_BLOCKED_BLOOM_FILTER", false,
+                                  &blocked_);
+    if (!s.ok()) {
+      LOG(WARNING) << "Invalid TF_EV_BLOCKED_BLOOM_FILTER, use the flat "
+                   << "layout: " << s.error_message();
+      blocked_ = false;
+    }
+    if (blocked_) {
+      // All counters of a key are in one cache line.
+      counters_per_block_ = kBlockBytes / counter_size_;
+      num_blocks_ = std::max<int64>(
+          (config_.num_counter + counters_per_block_ - 1) / counters_per_block_,
+          1);
+      num_counter_ = num_blocks_ * counters_per_block_;
+      bloom_counter_ =
+          port::AlignedMalloc(num_counter_ * counter_size_, kBlockBytes);
+      memset(bloom_counter_, 0, num_counter_ * counter_size_);
+    } else {
+      num_counter_ = config_.num_counter;
+      bloom_counter_ = calloc(num_counter_, counter_size_);
     }
     GenerateSeed(config.kHashFunc);
   }
 
+  ~BloomFilter() override {
+    if (blocked_) {
+      port::AlignedFree(bloom_counter_);
+    } else {
+      free(bloom_counter_);
+    }
+  }
+
   void LookupOrCreate(K key, V* val, const V* default_value_ptr,
                       ValuePtr<V>** value_ptr, int count) override {
-    if (GetBloomFreq(key) >= config_.filter_freq) {
-      TF_CHECK_OK(ev_->LookupOrCreateKey(key, value_ptr));
-      V* mem_val = ev_->LookupOrCreateEmb(*value_ptr, default_value_ptr);
-      memcpy(val, mem_val, sizeof(V) * ev_->ValueLen());
-    } else {
-      AddFreq(key, count);
-      memcpy(val, default_value_ptr, sizeof(V) * ev_->ValueLen());
+    gtl::InlinedVector<int64, kInlinedHashFunc> positions(seeds_.size());
+    GetPositions(key, positions.data());
+    switch (counter_type_) {
+      case DT_UINT32:
+        LookupOrCreate<uint32>(key, positions.data(), val, default_value_ptr,
+                               value_ptr, count);
+        break;
+      case DT_UINT16:
+        LookupOrCreate<uint16>(key, positions.data(), val, default_value_ptr,
+                               value_ptr, count);
+        break;
+      case DT_UINT8:
+        LookupOrCreate<uint8>(key, positions.data(), val, default_value_ptr,
+                              value_ptr, count);
+        break;
+      default:
+        LookupOrCreate<uint64>(key, positions.data(), val, default_value_ptr,
+                               value_ptr, count);
+    }
+  }
+
+  void BatchLookupOrCreate(const K* keys, V* val, int64 value_len,
+                           const V* const* default_value_ptrs,
+                           const int32* counts, int64 num,
+                           ValuePtr<V>** value_ptrs) override {
+    switch (counter_type_) {
+      case DT_UINT32:
+        BatchLookupOrCreate<uint32>(keys, val, value_len, default_value_ptrs,
+                                    counts, num, value_ptrs);
+        break;
+      case DT_UINT16:
+        BatchLookupOrCreate<uint16>(keys, val, value_len, default_value_ptrs,
+                                    counts, num, value_ptrs);
+        break;
+      case DT_UINT8:
+        BatchLookupOrCreate<uint8>(keys, val, value_len, default_value_ptrs,
+                                   counts, num, value_ptrs);
+        break;
+      default:
+        BatchLookupOrCreate<uint64>(keys, val, value_len, default_value_ptrs,
+                                    counts, num, value_ptrs);
     }
   }
 
@@ -130,30 +205,49 @@ class BloomFilter : public EmbeddingFilter<K, V, EV> {
     return bloom_counter_;
   }
 
- private:
-  int64 GetBloomFreq(K key) {
-    std::vector<int64> hash_val;
-    for (int64 i = 0; i < config_.kHashFunc; i++) {
-      hash_val.emplace_back(FastHash64(key, seeds_[i]) % config_.num_counter);
-    }
-    int64 min_freq;
-    switch (config_.counter_type){
-      case DT_UINT64:
-        min_freq = GetMinFreq<uint64>(hash_val);
-        break;
+  string DebugString() const override {
+    int64 nonzero = 0;
+    switch (counter_type_) {
       case DT_UINT32:
-        min_freq = GetMinFreq<uint32>(hash_val);
+        nonzero = CountNonzero<uint32>();
         break;
       case DT_UINT16:
-        min_freq = GetMinFreq<uint16>(hash_val);
+        nonzero = CountNonzero<uint16>();
         break;
       case DT_UINT8:
-        min_freq = GetMinFreq<uint8>(hash_val);
+        nonzero = CountNonzero<uint8>();
         break;
       default:
-        min_freq = GetMinFreq<uint64>(hash_val);
+        nonzero = CountNonzero<uint64>();
+    }
+    // A key not inserted is a false positive if all of its counters are set,
+    // estimated by the ratio of the counters set.
+    const double fill =
+        num_counter_ == 0 ? 0.0 : static_cast<double>(nonzero) / num_counter_;
+    return strings::StrCat(
+        "BloomFilter counter_type: ", DataTypeString(counter_type_),
+        " num_hash_func: ", seeds_.size(),
+        " num_counter: ", num_counter_,
+        " layout: ", blocked_ ? "blocked" : "flat",
+        " memory_bytes: ", num_counter_ * counter_size_,
+        " counter_fill_ratio: ", fill,
+        " estimated_false_positive_rate: ", std::pow(fill, seeds_.size()));
+  }
+
+ private:
+  int64 GetBloomFreq(K key) {
+    gtl::InlinedVector<int64, kInlinedHashFunc> positions(seeds_.size());
+    GetPositions(key, positions.data());
+    switch (counter_type_) {
+      case DT_UINT32:
+        return GetMinFreq<uint32>(positions.data());
+      case DT_UINT16:
+        return GetMinFreq<uint16>(positions.data());
+      case DT_UINT8:
+        return GetMinFreq<uint8>(positions.data());
+      default:
+        return GetMinFreq<uint64>(positions.data());
     }
-    return min_freq;
   }
 
 #define mix(h) ({                                 \
@@ -162,59 +256,127 @@ class BloomFilter : public EmbeddingFilter<K, V, EV> {
                    (h) ^= (h) >> 47;              \
                 })
 
-  uint64_t FastHash64(K key, uint64_t seed) {
-    const uint64_t    m = 0x880355f21e6d1965ULL;
+  // Sets positions[i] to the counter of `key` for seed i. Without the
+  // blocked layout it is FastHash64(key, seed) % num_counter, the mix of
+  // the key is computed once for all seeds.
+  void GetPositions(K key, int64* positions) const {
+    const uint64_t m = 0x880355f21e6d1965ULL;
+    uint64_t v = key;
+    mix(v);
+    const int64 num_hash = seeds_.size();
+    uint64_t* hashes = reinterpret_cast<uint64_t*>(positions);
+    for (int64 i = 0; i < num_hash; i++) {
+      // The second round of FastHash64 mixes a zero, i.e. xors nothing.
+      uint64_t h = ((seeds_[i] ^ (8 * m)) ^ v) * m * m;
+      hashes[i] = mix(h);
+    }
+    if (!blocked_) {
+      for (int64 i = 0; i < num_hash; i++) {
+        positions[i] = hashes[i] % num_counter_;
+      }
+    } else {
+      const int64 base = hashes[0] % num_blocks_ * counters_per_block_;
+      for (int64 i = 0; i < num_hash; i++) {
+        positions[i] = base + (hashes[i] >> 56) % counters_per_block_;
+      }
+    }
+  }
 
-    uint64_t h = seed ^ (8 * m);
-    uint64_t v;
-    v = key;
-    h ^= mix(v);
-    h *= m;
+  template<typename VBloom>
+  int64 GetMinFreq(const int64* positions) const {
+    const VBloom* counter = reinterpret_cast<const VBloom*>(bloom_counter_);
+    VBloom min_freq = counter[positions[0]];
+    for (int64 i = 1; i < seeds_.size(); i++) {
+      min_freq = std::min(counter[positions[i]], min_freq);
+    }
+    return min_freq;
+  }
 
-    v = 0;
-    h ^= mix(v);
-    h *= m;
+  template<typename VBloom>
+  void SetMinFreq(const int64* positions, int64 freq) {
+    VBloom* counter = reinterpret_cast<VBloom*>(bloom_counter_);
+    for (int64 i = 0; i < seeds_.size(); i++) {
+      counter[positions[i]] = freq;
+    }
+  }
 
-    return mix(h);
+  template<typename VBloom>
+  void AddFreq(const int64* positions, int64 count) {
+    VBloom* counter = reinterpret_cast<VBloom*>(bloom_counter_);
+    for (int64 i = 0; i < seeds_.size(); i++) {
+      if (counter[positions[i]] < config_.filter_freq) {
+        __sync_fetch_and_add(counter + positions[i], count);
+      }
+    }
   }
 
   template<typename VBloom>
-  int64 GetMinFreq(std::vector<int64> hash_val) {
-    VBloom min_freq = *((VBloom*)bloom_counter_ + hash_val[0]);
-    for (auto it : hash_val) {
-      min_freq = std::min(*((VBloom*)bloom_counter_ + it), min_freq);
+  int64 CountNonzero() const {
+    const VBloom* counter = reinterpret_cast<const VBloom*>(bloom_counter_);
+    int64 nonzero = 0;
+    for (int64 i = 0; i < num_counter_; i++) {
+      nonzero += counter[i] != 0;
     }
-    return min_freq;
+    return nonzero;
   }
 
   template<typename VBloom>
-  void SetMinFreq(std::vector<int64> hash_val, int64 freq) {
-    for (auto it : hash_val) {
-      *((VBloom*)bloom_counter_ + it) = freq;
+  void LookupOrCreate(K key, const int64* positions, V* val,
+                      const V* default_value_ptr, ValuePtr<V>** value_ptr,
+                      int count) {
+    if (GetMinFreq<VBloom>(positions) >= config_.filter_freq) {
+      TF_CHECK_OK(ev_->LookupOrCreateKey(key, value_ptr));
+      V* mem_val = ev_->LookupOrCreateEmb(*value_ptr, default_value_ptr);
+      memcpy(val, mem_val, sizeof(V) * ev_->ValueLen());
+    } else {
+      AddFreq<VBloom>(positions, count);
+      memcpy(val, default_value_ptr, sizeof(V) * ev_->ValueLen());
     }
   }
 
-  void SetBloomFreq(K key, int64 freq) {
-    std::vector<int64> hash_val;
-    for (int64 i = 0; i < config_.kHashFunc; i++) {
-      hash_val.push_back(FastHash64(key, seeds_[i]) % config_.num_counter);
+  // Hashes a block of keys and prefetches their counters before reading
+  // them.
+  template<typename VBloom>
+  void BatchLookupOrCreate(const K* keys, V* val, int64 value_len,
+                           const V* const* default_value_ptrs,
+                           const int32* counts, int64 num,
+                           ValuePtr<V>** value_ptrs) {
+    const int64 num_hash = seeds_.size();
+    std::vector<int64> positions(std::min(num, kBatchBlockSize) * num_hash);
+    const VBloom* counter = reinterpret_cast<const VBloom*>(bloom_counter_);
+    for (int64 start = 0; start < num; start += kBatchBlockSize) {
+      const int64 limit = std::min(num, start + kBatchBlockSize);
+      for (int64 i = start; i < limit; i++) {
+        int64* key_positions = positions.data() + (i - start) * num_hash;
+        GetPositions(keys[i], key_positions);
+        for (int64 j = 0; j < num_hash; j++) {
+          port::prefetch<port::PREFETCH_HINT_T0>(counter + key_positions[j]);
+        }
+      }
+      for (int64 i = start; i < limit; i++) {
+        LookupOrCreate<VBloom>(
+            keys[i], positions.data() + (i - start) * num_hash,
+            val + i * value_len, default_value_ptrs[i], value_ptrs + i,
+            counts == nullptr ? 1 : counts[i]);
+      }
     }
-   int64 min_freq;
-    switch (config_.counter_type){
-      case DT_UINT64:
-        SetMinFreq<uint64>(hash_val, freq);
-        break;
+  }
+
+  void SetBloomFreq(K key, int64 freq) {
+    gtl::InlinedVector<int64, kInlinedHashFunc> positions(seeds_.size());
+    GetPositions(key, positions.data());
+    switch (counter_type_) {
       case DT_UINT32:
-        SetMinFreq<uint32>(hash_val, freq);
+        SetMinFreq<uint32>(positions.data(), freq);
         break;
       case DT_UINT16:
-        SetMinFreq<uint16>(hash_val, freq);
+        SetMinFreq<uint16>(positions.data(), freq);
         break;
       case DT_UINT8:
-        SetMinFreq<uint8>(hash_val, freq);
+        SetMinFreq<uint8>(positions.data(), freq);
         break;
       default:
-        SetMinFreq<uint64>(hash_val, freq);
+        SetMinFreq<uint64>(positions.data(), freq);
     }
   }
 
@@ -263,68 +425,6 @@ class BloomFilter : public EmbeddingFilter<K, V, EV> {
     return Status::OK();
   }
 
-  void AddFreq(K key) {
-    std::vector<int64> hash_val;
-    for (int64 i = 0; i < config_.kHashFunc; i++) {
-      hash_val.push_back(FastHash64(key, seeds_[i]) % config_.num_counter);
-    }
-
-    for (auto it : hash_val){
-      switch (config_.counter_type){
-        case DT_UINT64:
-          if (*((uint64*)bloom_counter_ + it) < config_.filter_freq)
-            __sync_fetch_and_add((uint64*)bloom_counter_ + it, 1);
-          break;
-        case DT_UINT32:
-          if (*((uint32*)bloom_counter_ +it) < config_.filter_freq)
-            __sync_fetch_and_add((uint32*)bloom_counter_ + it, 1);
-          break;
-        case DT_UINT16:
-          if (*((uint16*)bloom_counter_ +it) < config_.filter_freq)
-            __sync_fetch_and_add((uint16*)bloom_counter_ + it, 1);
-          break;
-        case DT_UINT8:
-          if (*((uint8*)bloom_counter_ + it) < config_.filter_freq)
-            __sync_fetch_and_add((uint8*)bloom_counter_ + it, 1);
-          break;
-        default:
-          if (*((uint64*)bloom_counter_ + it) < config_.filter_freq)
-            __sync_fetch_and_add((uint64*)bloom_counter_ + it, 1);
-      }
-    }
-  }
-
-  void AddFreq(K key, int64 count) {
-    std::vector<int64> hash_val;
-    for (int64 i = 0; i < config_.kHashFunc; i++) {
-      hash_val.push_back(FastHash64(key, seeds_[i]) % config_.num_counter);
-    }
-
-    for (auto it : hash_val){
-      switch (config_.counter_type){
-        case DT_UINT64:
-          if (*((uint64*)bloom_counter_ + it) < config_.filter_freq)
-            __sync_fetch_and_add((uint64*)bloom_counter_ + it, count);
-          break;
-        case DT_UINT32:
-          if (*((uint32*)bloom_counter_ +it) < config_.filter_freq)
-            __sync_fetch_and_add((uint32*)bloom_counter_ + it, count);
-          break;
-        case DT_UINT16:
-          if (*((uint16*)bloom_counter_ +it) < config_.filter_freq)
-            __sync_fetch_and_add((uint16*)bloom_counter_ + it, count);
-          break;
-        case DT_UINT8:
-          if (*((uint8*)bloom_counter_ + it) < config_.filter_freq)
-            __sync_fetch_and_add((uint8*)bloom_counter_ + it, count);
-          break;
-        default:
-          if (*((uint64*)bloom_counter_ + it) < config_.filter_freq)
-            __sync_fetch_and_add((uint64*)bloom_counter_ + it, count);
-      }
-    }
-  }
-
   void GenerateSeed(int64 kHashFunc) {
     if (kHashFunc < default_seeds.size()) {
       for (int64 i = 0; i < kHashFunc; i++) {
@@ -340,7 +440,7 @@ class BloomFilter : public EmbeddingFilter<K, V, EV> {
           if (j % 2 == 0)
             continue;
           bool is_prime = true;
-          for (int64 k = 0; k <= std::sqrt(j) + 1; k++) {
+          for (int64 k = 3; k <= std::sqrt(j) + 1; k += 2) {
             if (j % k == 0)
               is_prime = false;
           }
@@ -355,7 +455,19 @@ class BloomFilter : public EmbeddingFilter<K, V, EV> {
   }
 
  private:
+  static constexpr int64 kBlockBytes = 64;
+  static constexpr int64 kBatchBlockSize = 64;
+  static constexpr int kInlinedHashFunc = 16;
+
   void* bloom_counter_;
+  DataType counter_type_;
+  int64 counter_size_;
+  int64 num_counter_;
+  // Layout of the counters: the counters of a key are anywhere, or in a
+  // block of kBlockBytes with TF_EV_BLOCKED_BLOOM_FILTER=1.
+  bool blocked_;
+  int64 num_blocks_ = 0;
+  int64 counters_per_block_ = 0;
   EmbeddingConfig config_;
   EV* ev_;
   std::vector<int64> seeds_;
@@ -402,6 +514,10 @@ class CounterFilter : public EmbeddingFilter<K, V, EV> {
     return value_ptr->GetFreq();
   }
 
+  string DebugString() const override {
+    return strings::StrCat("CounterFilter filter_freq: ", config_.filter_freq);
+  }
+
   Status Import(RestoreBuffer& restore_buff,
                 int64 key_num,
                 int bucket_num,
@@ -160,6 +160,26 @@ class EmbeddingVar : public ResourceBase {
     add_freq_fn_(value_ptr, count, emb_config_.filter_freq);
   }
 
+  // Looks up or creates the `num` keys as LookupOrCreate does, the value of
+  // keys[i] is written to val + i * ValueLen(). A null default value is the
+  // default value of the variable, counts may be null.
+  void BatchLookupOrCreate(const K* keys, V* val,
+                           const V** default_value_ptrs, const int32* counts,
+                           int64 num) {
+    for (int64 i = 0; i < num; ++i) {
+      if (default_value_ptrs[i] == nullptr) {
+        default_value_ptrs[i] = default_value_;
+      }
+    }
+    std::vector<ValuePtr<V>*> value_ptrs(num, nullptr);
+    filter_->BatchLookupOrCreate(keys, val, ValueLen(), default_value_ptrs,
+                                 counts, num, value_ptrs.data());
+    for (int64 i = 0; i < num; ++i) {
+      add_freq_fn_(value_ptrs[i], counts == nullptr ? 1 : counts[i],
+                   emb_config_.filter_freq);
+    }
+  }
+
   void LookupWithFreqBatch(K* keys, bool *init_flags, bool *copyback_flags, V** memcpy_address, int start, int limit) {
     ValuePtr<V>* value_ptr = nullptr;
     for (int i = start; i < limit; i++) {
@@ -294,7 +314,11 @@ class EmbeddingVar : public ResourceBase {
   }
 
   std::string DebugString() const {
-    return emb_config_.DebugString();
+    if (filter_ == nullptr) {
+      return emb_config_.DebugString();
+    }
+    return strings::StrCat(emb_config_.DebugString(), " ",
+                           filter_->DebugString());
   }
 
   EmbeddingFilter<K, V, EmbeddingVar<K, V>>* GetFilter() const {
@@ -427,7 +451,7 @@ class EmbeddingVar : public ResourceBase {
   Allocator* alloc_;
   embedding::StorageManager<K, V>* storage_manager_;
   EmbeddingConfig emb_config_;
-  EmbeddingFilter<K, V, EmbeddingVar<K, V>>* filter_;
+  EmbeddingFilter<K, V, EmbeddingVar<K, V>>* filter_ = nullptr;
   std::function<void(ValuePtr<V>*, int, int64)> add_freq_fn_;
   std::function<void(ValuePtr<V>*, int64)> update_version_fn_;
 
@@ -15,6 +15,8 @@ limitations under the License.
 
 #include "tensorflow/core/framework/hash_table/bloom_filter_strategy.h"
 
+#include "tensorflow/core/platform/prefetch.h"
+
 namespace tensorflow {
 
 namespace {
@@ -24,6 +26,8 @@ const static std::vector<int64> kHashSeeds = {
   31, 37, 41, 43, 47, 53, 59, 61, 67
 };
 
+constexpr uint64_t kFastHashM = 0x880355f21e6d1965ULL;
+
 #define mix(h) ({                \
   (h) ^= (h) >> 23;              \
   (h) *= 0x2127599bf4325c37ULL;  \
@@ -31,7 +35,7 @@ const static std::vector<int64> kHashSeeds = {
 })
 
 uint64_t FastHash64(const void* buf, size_t len, uint64_t seed) {
-  const uint64_t    m = 0x880355f21e6d1965ULL;
+  const uint64_t    m = kFastHashM;
   const uint64_t *pos = (const uint64_t *)buf;
   const uint64_t *end = pos + (len / 8);
   const unsigned char *pos2;
@@ -129,6 +133,87 @@ bool BloomFilterAdmitStrategy::Admit(int64 key, int64 freq) {
   return AdmitInternal(key, freq);
 }
 
+void BloomFilterAdmitStrategy::AdmitBatch(const int64* keys,
+                                          const int32* freqs, int64 size,
+                                          bool* admitted) {
+  CHECK(seeds_.size() > 0) << "BloomFilter not initialized";
+  const int64 num_hash = seeds_.size();
+  std::vector<int64> indices(std::min(size, kAdmitBlockSize) * num_hash);
+  for (int64 start = 0; start < size; start += kAdmitBlockSize) {
+    const int64 block_size = std::min(kAdmitBlockSize, size - start);
+    for (int64 i = 0; i < block_size; ++i) {
+      const int64 key = keys[start + i];
+      int64 id = (uint64_t)key % max_slice_size_ - slice_offset_;
+      CHECK(id >= 0) << "invalid key slice: key=" << key <<  ",max_slice_size="
+          << max_slice_size_ << ",slice_offset=" << slice_offset_;
+      HashIndices(key, id, indices.data() + i * num_hash);
+    }
+    const int32* block_freqs = freqs == nullptr ? nullptr : freqs + start;
+    switch (dtype_) {
+      case DT_UINT8:
+        UpdateCounters<uint8>(indices.data(), block_freqs, block_size,
+                              admitted + start);
+        break;
+      case DT_UINT16:
+        UpdateCounters<uint16>(indices.data(), block_freqs, block_size,
+                               admitted + start);
+        break;
+      case DT_UINT32:
+        UpdateCounters<uint32>(indices.data(), block_freqs, block_size,
+                               admitted + start);
+        break;
+      default:
+        LOG(FATAL) << "Not support data type " << dtype_;
+        break;
+    }
+  }
+}
+
+void BloomFilterAdmitStrategy::HashIndices(int64 key, int64 id,
+                                           int64* indices) const {
+  // FastHash64 of the 8 bytes of the key, the mix of the key is shared by
+  // all seeds, so that the loop over the seeds is vectorized.
+  uint64_t v = static_cast<uint64_t>(key);
+  mix(v);
+  const uint64_t* seeds = key_seeds_.data();
+  const int64 num_hash = key_seeds_.size();
+  const int64 base = id * segment_size_;
+  for (int64 i = 0; i < num_hash; ++i) {
+    uint64_t h = (seeds[i] ^ v) * kFastHashM;
+    mix(h);
+    indices[i] = base + h % segment_size_;
+  }
+}
+
+template <typename T>
+void BloomFilterAdmitStrategy::UpdateCounters(const int64* indices,
+                                              const int32* freqs, int64 size,
+                                              bool* admitted) {
+  T* bucket = reinterpret_cast<T*>(bucket_);
+  const int64 num_hash = seeds_.size();
+  const int64 num_elements = shape_.num_elements();
+  for (int64 i = 0; i < size * num_hash; ++i) {
+    CHECK(indices[i] < num_elements) << "invalid k=" << indices[i];
+    port::prefetch<port::PREFETCH_HINT_T0>(bucket + indices[i]);
+  }
+  mutex_lock lock(mu_);
+  for (int64 i = 0; i < size; ++i) {
+    const int64 counting = freqs == nullptr ? kDefaultFrequency : freqs[i];
+    CHECK(counting > 0) << "counting should be larger than zero";
+    bool result = true;
+    for (int64 j = 0; j < num_hash; ++j) {
+      T* counter = bucket + indices[i * num_hash + j];
+      const int64 update =
+          std::min(max_freq_, counting + static_cast<int64>(*counter));
+      if (update < minimum_frequency_) {
+        result = false;
+      }
+      *counter = static_cast<T>(update);
+    }
+    admitted[i] = result;
+  }
+}
+
 bool BloomFilterAdmitStrategy::AdmitInternal(int64 key, int64 counting) {
   //auto t = ScopedTimer("AdmitInternal");
   CHECK(seeds_.size() > 0) << "BloomFilter not initialized";
@@ -182,6 +267,11 @@ void BloomFilterAdmitStrategy::GenerateSeeds() {
     }
     seeds_.push_back(next_seed);
   }
+  key_seeds_.clear();
+  for (int64 seed : seeds_) {
+    key_seeds_.push_back(static_cast<uint64_t>(seed) ^
+                         (sizeof(int64) * kFastHashM));
+  }
 }
 
 uint64_t BloomFilterAdmitStrategy::DefaultHashFunc(int64 key, int64 seed) {
@@ -31,6 +31,10 @@ class BloomFilterAdmitStrategy : public HashTableAdmitStrategy {
   virtual ~BloomFilterAdmitStrategy();
   bool Admit(int64 key) override;
   bool Admit(int64 key, int64 freq) override;
+  // Hashes a block of keys with all seeds before updating their counters
+  // under one lock, prefetching the counters.
+  void AdmitBatch(const int64* keys, const int32* freqs, int64 size,
+                  bool* admitted) override;
   std::vector<int8> Snapshot();
   void Restore(int64 src_beg, int64 src_length, int64 dst_beg,
                int64 dst_length, const std::vector<int8>& src);
@@ -38,6 +42,12 @@ class BloomFilterAdmitStrategy : public HashTableAdmitStrategy {
   void GenerateSeeds();
   bool AdmitInternal(int64 key, int64 counting);
   uint64_t DefaultHashFunc(int64 key, int64 seed);
+  // Sets indices[i] to the counter of `key` in slice `id` for seed i, the
+  // same as DefaultHashFunc.
+  void HashIndices(int64 key, int64 id, int64* indices) const;
+  template <typename T>
+  void UpdateCounters(const int64* indices, const int32* freqs, int64 size,
+                      bool* admitted);
   int64 Read(int64 k) {
     int64 val = 0;
     switch (dtype_) {
@@ -81,9 +91,12 @@ class BloomFilterAdmitStrategy : public HashTableAdmitStrategy {
   int8* bucket_;
   int64 segment_size_;
   std::vector<int64> seeds_;
+  // The seeds mixed with the length of a key, as FastHash64 starts.
+  std::vector<uint64_t> key_seeds_;
   int64 max_freq_;
   mutex mu_;
   constexpr static int64 kDefaultFrequency = 1;
+  constexpr static int64 kAdmitBlockSize = 256;
 };
 
 }  // namespace tensorflow
@@ -14,7 +14,9 @@ limitations under the License.
 ==============================================================================*/
 
 #include "tensorflow/core/framework/hash_table/bloom_filter_strategy.h"
+#include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/platform/test.h"
+#include "tensorflow/core/platform/test_benchmark.h"
 
 namespace tensorflow {
 
@@ -56,4 +58,74 @@ TEST(BloomFilterAdmitStrategy, Simple) {
   }
 }
 
+TEST(BloomFilterAdmitStrategy, AdmitBatch) {
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  for (DataType dtype : {DT_UINT8, DT_UINT16, DT_UINT32}) {
+    // more keys than a block, repeated, with and without frequencies
+    std::vector<int64> keys(1000);
+    std::vector<int32> freqs(keys.size());
+    for (size_t i = 0; i < keys.size(); ++i) {
+      keys[i] = static_cast<int64>(rnd.Uniform64(300)) - 150;
+      freqs[i] = rnd.Uniform(3) + 1;
+    }
+    BloomFilterAdmitStrategy bf(4, 5, dtype, {2, 64}, 0, 2);
+    BloomFilterAdmitStrategy batch_bf(4, 5, dtype, {2, 64}, 0, 2);
+    for (int round = 0; round < 2; ++round) {
+      const int32* batch_freqs = round == 0 ? nullptr : freqs.data();
+      std::unique_ptr<bool[]> admitted(new bool[keys.size()]);
+      batch_bf.AdmitBatch(keys.data(), batch_freqs, keys.size(),
+                          admitted.get());
+      for (size_t i = 0; i < keys.size(); ++i) {
+        bool expected = round == 0 ? bf.Admit(keys[i])
+                                   : bf.Admit(keys[i], freqs[i]);
+        EXPECT_EQ(expected, admitted[i]) << "key " << keys[i];
+      }
+      EXPECT_EQ(bf.Snapshot(), batch_bf.Snapshot());
+    }
+  }
+}
+
+namespace {
+
+std::vector<int64> BenchmarkKeys(int size) {
+  random::PhiloxRandom philox(301, 17);
+  random::SimplePhilox rnd(&philox);
+  std::vector<int64> keys(size);
+  for (int i = 0; i < size; ++i) {
+    keys[i] = rnd.Uniform64(size * 4);
+  }
+  return keys;
+}
+
+static void BM_BloomFilterAdmit(int iters, int size) {
+  testing::StopTiming();
+  BloomFilterAdmitStrategy bf(3, 3, DT_UINT8, {1, 1 << 24});
+  std::vector<int64> keys = BenchmarkKeys(size);
+  std::unique_ptr<bool[]> admitted(new bool[size]);
+  testing::ItemsProcessed(static_cast<int64>(iters) * size);
+  testing::StartTiming();
+  while (iters--) {
+    for (int i = 0; i < size; ++i) {
+      admitted[i] = bf.Admit(keys[i], 1);
+    }
+  }
+}
+BENCHMARK(BM_BloomFilterAdmit)->Arg(1 << 20);
+
+static void BM_BloomFilterAdmitBatch(int iters, int size) {
+  testing::StopTiming();
+  BloomFilterAdmitStrategy bf(3, 3, DT_UINT8, {1, 1 << 24});
+  std::vector<int64> keys = BenchmarkKeys(size);
+  std::unique_ptr<bool[]> admitted(new bool[size]);
+  testing::ItemsProcessed(static_cast<int64>(iters) * size);
+  testing::StartTiming();
+  while (iters--) {
+    bf.AdmitBatch(keys.data(), nullptr, size, admitted.get());
+  }
+}
+BENCHMARK(BM_BloomFilterAdmitBatch)->Arg(1 << 20);
+
+}  // namespace
+
 }  //namespace tensorflow
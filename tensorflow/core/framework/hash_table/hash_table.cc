@@ -108,7 +108,8 @@ void HashTable::IdsAllocator::Clear() {
 HashTable::HashTable(int num_worker_threads, bool concurrent_read,
     int slice_size, int id_block_size)
   : slice_size_(slice_size), id_block_size_(id_block_size),
-    size_(slice_size), concurrent_read_(concurrent_read) {
+    size_(slice_size), requested_size_(slice_size),
+    concurrent_read_(concurrent_read) {
   num_tables_ = num_worker_threads;
   LOG(INFO) << "HashTable table splits: " << num_tables_;
   table_locks_.resize(num_tables_);
@@ -304,6 +305,7 @@ void HashTable::GetIdsSimpleForConcurrentRead(
   int64 new_id_size = 0;
   int64 sizex = 0;
   int64 cur_idx;
+  std::vector<int64> missing;
   {
     tf_shared_lock rlock(table_locks_[table_idx]);
     for (int64 i = 0; i < partition_threads; ++i) {
@@ -317,20 +319,22 @@ void HashTable::GetIdsSimpleForConcurrentRead(
           ids[cur_idx] = iter->second;
           sizex = std::max(sizex, ids[cur_idx]);
         } else {
-          // do admit
-          int32_t freq = (freqs == nullptr) ? 1 : freqs[cur_idx];
-          if (admit_strategy == nullptr ||
-              admit_strategy->Admit(keys[cur_idx], freq)) {
-            ids[cur_idx] = new_id_list;
-            new_id_list = cur_idx;
-            ++new_id_size;
-          } else {
-            ids[cur_idx] = kNotAdmitted;
-          }
+          missing.push_back(cur_idx);
         }
       }
     }
   }
+  // do admit
+  std::vector<int64> admitted;
+  AdmitKeys(keys, freqs, missing, admit_strategy, &admitted);
+  for (int64 idx : missing) {
+    ids[idx] = kNotAdmitted;
+  }
+  for (int64 idx : admitted) {
+    ids[idx] = new_id_list;
+    new_id_list = idx;
+    ++new_id_size;
+  }
   // do alloc ids
   if (new_id_list != -1) {
     mutex_lock wlock(table_locks_[table_idx]);
@@ -364,6 +368,7 @@ void HashTable::GetIdsSimpleForExclusiveAccess(
   // do find
   int64 sizex = 0;
   int64 cur_idx;
+  std::vector<int64> missing;
   {
     mutex_lock lock(table_locks_[table_idx]);
     for (int64 i = 0; i < partition_threads; ++i) {
@@ -379,22 +384,30 @@ void HashTable::GetIdsSimpleForExclusiveAccess(
           sizex = std::max(sizex, ids[cur_idx]);
           continue;
         }
-        // do admit
-        int32_t freq = (freqs == nullptr) ? 1 : freqs[cur_idx];
-        if (admit_strategy != nullptr &&
-            !admit_strategy->Admit(keys[cur_idx], freq)) {
-          ids[cur_idx] = kNotAdmitted;
-          continue;
-        }
-        // do alloc ids
-        if (!ids_container_[table_idx].GetNext(&ids[cur_idx])) {
-          mutex_lock lock(update_mu_);
-          ids_allocator_.GetIds(kPreAllocIds, &ids_container_[table_idx]);
-          CHECK(ids_container_[table_idx].GetNext(&ids[cur_idx]));
-        }
-        tables_[table_idx][keys[cur_idx]] = ids[cur_idx];
-        sizex = std::max(sizex, ids[cur_idx]);
+        missing.push_back(cur_idx);
+      }
+    }
+    // do admit
+    std::vector<int64> admitted;
+    AdmitKeys(keys, freqs, missing, admit_strategy, &admitted);
+    for (int64 idx : missing) {
+      ids[idx] = kNotAdmitted;
+    }
+    for (int64 idx : admitted) {
+      // the key may be repeated in the batch
+      auto iter = tables_[table_idx].find(keys[idx]);
+      if (iter != tables_[table_idx].end() && iter->second != kNotAdmitted) {
+        ids[idx] = iter->second;
+        continue;
+      }
+      // do alloc ids
+      if (!ids_container_[table_idx].GetNext(&ids[idx])) {
+        mutex_lock lock(update_mu_);
+        ids_allocator_.GetIds(kPreAllocIds, &ids_container_[table_idx]);
+        CHECK(ids_container_[table_idx].GetNext(&ids[idx]));
       }
+      tables_[table_idx][keys[idx]] = ids[idx];
+      sizex = std::max(sizex, ids[idx]);
     }
   }
 
@@ -407,22 +420,30 @@ void HashTable::Resize(int64 size, std::function<void(Status)> done) {
     done(Status::OK());
     return;
   }
+  // Resizes queued behind a running one are coalesced: each task grows to
+  // the largest size requested so far, the tasks after it find the size
+  // reached and complete at once.
+  int64 requested = requested_size_.load();
+  while (requested < size &&
+         !requested_size_.compare_exchange_weak(requested, size)) {
+  }
   AddTask([size, done, this] {
     if (size_ >= size) {
       done(Status::OK());
       RunNext();
       return;
     } else {
+      const int64 target = std::max(size, requested_size_.load());
       StatusCollector* stc = new StatusCollector(tensors_.size(),
-      [this, size, done] (Status st) {
+      [this, target, done] (Status st) {
         if (st.ok()) {
-          size_ = std::max(size_.load(), size);
+          size_ = std::max(size_.load(), target);
         }
         done(st);
         RunNext();
       });
       for (auto tensor : tensors_) {
-        tensor->Resize(size, [stc] (Status st) {
+        tensor->Resize(target, [stc] (Status st) {
           stc->AddStatus(st);
         });
       }
@@ -431,6 +452,34 @@ void HashTable::Resize(int64 size, std::function<void(Status)> done) {
   });
 }
 
+void HashTable::AdmitKeys(const int64* keys, const int32* freqs,
+                          const std::vector<int64>& indices,
+                          HashTableAdmitStrategy* admit_strategy,
+                          std::vector<int64>* admitted) {
+  if (admit_strategy == nullptr) {
+    admitted->insert(admitted->end(), indices.begin(), indices.end());
+    return;
+  }
+  const int64 size = indices.size();
+  std::vector<int64> batch_keys(size);
+  std::vector<int32> batch_freqs(freqs == nullptr ? 0 : size);
+  for (int64 i = 0; i < size; ++i) {
+    batch_keys[i] = keys[indices[i]];
+    if (freqs != nullptr) {
+      batch_freqs[i] = freqs[indices[i]];
+    }
+  }
+  std::unique_ptr<bool[]> batch_admitted(new bool[size]);
+  admit_strategy->AdmitBatch(batch_keys.data(),
+                             freqs == nullptr ? nullptr : batch_freqs.data(),
+                             size, batch_admitted.get());
+  for (int64 i = 0; i < size; ++i) {
+    if (batch_admitted[i]) {
+      admitted->push_back(indices[i]);
+    }
+  }
+}
+
 void HashTable::AddTask(std::function<void()> task) {
   bool run;
   {
@@ -513,6 +562,7 @@ void HashTable::Clear(const std::function<void(Status)>& done) {
         ids_container_[i].Clear();
       }
       size_ = 0;
+      requested_size_ = 0;
     }
     done(Status::OK());
     ClearAllTask();
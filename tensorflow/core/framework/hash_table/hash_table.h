@@ -37,6 +37,15 @@ class HashTableAdmitStrategy {
   virtual ~HashTableAdmitStrategy() {}
   virtual bool Admit(int64 key) = 0;
   virtual bool Admit(int64 key, int64 freq) { return Admit(key); }
+  // Sets admitted[i] to whether keys[i] is admitted with freqs[i], or 1 if
+  // freqs is null. The keys are counted in order, as by calling Admit for
+  // each of them.
+  virtual void AdmitBatch(const int64* keys, const int32* freqs, int64 size,
+                          bool* admitted) {
+    for (int64 i = 0; i < size; ++i) {
+      admitted[i] = Admit(keys[i], freqs == nullptr ? 1 : freqs[i]);
+    }
+  }
 };
 
 class HashTable {
@@ -90,6 +99,12 @@ class HashTable {
       HashTableAdmitStrategy* admit_strategy,
       std::function<void(Status)> done);
   void Resize(int64 size, std::function<void(Status)> done);
+  // Admits the keys at `indices` with one AdmitBatch, and appends the
+  // admitted indices to `admitted` in order.
+  void AdmitKeys(const int64* keys, const int32* freqs,
+                 const std::vector<int64>& indices,
+                 HashTableAdmitStrategy* admit_strategy,
+                 std::vector<int64>* admitted);
 
   void AddTask(std::function<void()> task);
   void RunNext();
@@ -153,6 +168,8 @@ class HashTable {
   mutex task_mu_;
   std::queue<std::function<void()>> tasks_;
   std::atomic<int64> size_;
+  // The largest size passed to Resize.
+  std::atomic<int64> requested_size_;
 
   std::vector<TensibleVariable*> tensors_;
 
@@ -16,13 +16,54 @@ limitations under the License.
 #include "tensorflow/core/framework/hash_table/tensible_variable.h"
 #include "tensorflow/core/framework/hash_table/status_collector.h"
 
+#include <sys/mman.h>
+
+#include <algorithm>
 #include <future>
 
+#include "tensorflow/core/framework/allocation_description.pb.h"
+
 namespace tensorflow {
 
+namespace {
+
+void* MapZeroed(size_t bytes) {
+  void* ptr = mmap(nullptr, std::max<size_t>(bytes, 1), PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+  return ptr == MAP_FAILED ? nullptr : ptr;
+}
+
+// A segment zero initialized lazily by the kernel, its pages are only backed
+// by memory once written.
+class MappedSegmentBuffer : public TensorBuffer {
+ public:
+  MappedSegmentBuffer(void* data, size_t size)
+      : TensorBuffer(data), size_(size) {}
+  ~MappedSegmentBuffer() override {
+    munmap(data(), std::max<size_t>(size_, 1));
+  }
+
+  size_t size() const override { return size_; }
+  TensorBuffer* root_buffer() override { return this; }
+  void FillAllocationDescription(AllocationDescription* proto) const override {
+    proto->set_requested_bytes(size_);
+    proto->set_allocated_bytes(size_);
+    proto->set_allocator_name("mmap");
+  }
+
+ private:
+  const size_t size_;
+};
+
+}  // namespace
+
+constexpr int64 TensibleVariable::kChunkSegments;
+constexpr int64 TensibleVariable::kMaxChunks;
+
 TensibleVariable::TensibleVariable(
     TensorGenerator* generator, const TensorShape& shape, DataType dtype)
-    : generator_(generator), shape_(shape), dtype_(dtype) {
+    : generator_(generator), shape_(shape), dtype_(dtype),
+      reserved_segments_(0), published_segments_(0) {
   size_.store(0);
   slice_size_ = 1;
   for (int i = 1; i < shape_.dims(); i++) {
@@ -31,87 +72,223 @@ TensibleVariable::TensibleVariable(
   eigen_slice_shape_[0] = slice_size_;
   slice_size_ *= DataTypeSize(dtype);
   segment_size_ = shape_.dim_size(0);
-  all_ptr_vec_.emplace_back();
-  all_ptr_vec_.back().size = kPtrStartSize;
-  all_ptr_vec_.back().ptr.reset(new char*[kPtrStartSize]);
-  ptrs_ = all_ptr_vec_.back().ptr.get();
+  chunks_ = static_cast<std::atomic<Chunk*>*>(
+      MapZeroed(kMaxChunks * sizeof(std::atomic<Chunk*>)));
+  CHECK(chunks_ != nullptr) << "Failed to map the TensibleVariable directory";
   generator_->Ref();
 }
 
 TensibleVariable::~TensibleVariable() {
+  Clear();
+  for (int64 i = 0; i < kMaxChunks; i++) {
+    Chunk* chunk = chunks_[i].load(std::memory_order_relaxed);
+    // Chunks are created by whichever segment lands in them first,
+    // so a null entry doesn't end the mapped ones.
+    if (chunk == nullptr) {
+      continue;
+    }
+    munmap(chunk, sizeof(Chunk));
+  }
+  munmap(chunks_, kMaxChunks * sizeof(std::atomic<Chunk*>));
   generator_->Unref();
 }
 
+Status TensibleVariable::CheckSegment(const Tensor& tensor) const {
+  if (tensor.shape() != shape_) {
+    return errors::InvalidArgument(
+        "Tensor Generator generate shape error ",
+        tensor.shape().DebugString(), " vs ", shape_.DebugString());
+  }
+  if (tensor.dtype() != dtype_) {
+    return errors::InvalidArgument(
+        "Tensor Generator generate dtype error ",
+        tensor.dtype(), " vs ", dtype_);
+  }
+  return Status::OK();
+}
+
+Status TensibleVariable::NewZeroSegment(Tensor** tensor) const {
+  const size_t bytes = segment_size_ * slice_size_;
+  void* data = MapZeroed(bytes);
+  if (data == nullptr) {
+    return errors::ResourceExhausted(
+        "Failed to map a TensibleVariable segment of ", bytes, " bytes");
+  }
+  MappedSegmentBuffer* buf = new MappedSegmentBuffer(data, bytes);
+  *tensor = new Tensor(dtype_, shape_, buf);
+  buf->Unref();
+  return Status::OK();
+}
+
+TensibleVariable::Chunk* TensibleVariable::GetOrCreateChunk(int64 index) {
+  Chunk* chunk = chunks_[index].load(std::memory_order_acquire);
+  if (chunk != nullptr) {
+    return chunk;
+  }
+  Chunk* new_chunk = static_cast<Chunk*>(MapZeroed(sizeof(Chunk)));
+  CHECK(new_chunk != nullptr) << "Failed to map a TensibleVariable chunk";
+  if (chunks_[index].compare_exchange_strong(chunk, new_chunk,
+                                             std::memory_order_acq_rel)) {
+    return new_chunk;
+  }
+  munmap(new_chunk, sizeof(Chunk));
+  return chunk;
+}
+
+void TensibleVariable::SetSegment(int64 segment, Tensor* tensor) {
+  Chunk* chunk = GetOrCreateChunk(segment / kChunkSegments);
+  chunk->tensors[segment % kChunkSegments] = tensor;
+  chunk->data[segment % kChunkSegments].store(
+      const_cast<char*>(tensor->tensor_data().data()),
+      std::memory_order_release);
+}
+
+bool TensibleVariable::SegmentReady(int64 segment) const {
+  const Chunk* chunk =
+      chunks_[segment / kChunkSegments].load(std::memory_order_acquire);
+  return chunk != nullptr &&
+         chunk->data[segment % kChunkSegments].load(
+             std::memory_order_acquire) != nullptr;
+}
+
+void TensibleVariable::PublishSegments(
+    int64 count, Status st, const std::function<void(Status)>& done) {
+  std::vector<std::pair<Status, std::function<void(Status)>>> ready;
+  {
+    mutex_lock lock(publish_mu_);
+    const int64 reserved = reserved_segments_.load();
+    while (published_segments_ < reserved &&
+           SegmentReady(published_segments_)) {
+      ++published_segments_;
+    }
+    size_ = published_segments_ * segment_size_;
+    if (st.ok() && count > published_segments_) {
+      if (failed_segments_.lower_bound(count) == failed_segments_.begin()) {
+        // The earlier segments are still being generated for another
+        // resize, the last of them to finish calls done.
+        waiters_.emplace_back(count, st, done);
+        return;
+      }
+      // One of the segments failed for another resize, which may have
+      // already returned, so nobody would be left to call done.
+      st = errors::Internal("TensibleVariable segment ",
+                            *failed_segments_.begin(),
+                            " failed to generate, resize again to retry");
+    }
+    // A failed resize returns at once, and so do the resizes waiting behind
+    // its failed segments until a later resize generates them again.
+    ready.emplace_back(st, done);
+    const int64 failed = failed_segments_.empty()
+                             ? reserved_segments_.load()
+                             : *failed_segments_.begin();
+    for (auto it = waiters_.begin(); it != waiters_.end();) {
+      if (std::get<0>(*it) <= published_segments_) {
+        ready.emplace_back(std::get<1>(*it), std::get<2>(*it));
+        it = waiters_.erase(it);
+      } else if (!st.ok() && std::get<0>(*it) > failed) {
+        ready.emplace_back(st, std::get<2>(*it));
+        it = waiters_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+  }
+  for (auto& waiter : ready) {
+    waiter.second(waiter.first);
+  }
+}
+
 void TensibleVariable::Resize(
     int64 size, const std::function<void(Status)>& done) {
   if (size <= size_) {
     done(Status::OK());
     return;
   }
-  int64_t segment_count = (size - size_ - 1) / segment_size_ + 1;
-  StatusCollector* stc = new StatusCollector(segment_count, [this, done](Status st) {
-    if (st.ok()) {
-      ptrs_ = all_ptr_vec_.back().ptr.get();
-      size_ = tensors_.size() * segment_size_;
-    }
-    done(st);
+  const int64 count = (size + segment_size_ - 1) / segment_size_;
+  if (count > kMaxChunks * kChunkSegments) {
+    done(errors::ResourceExhausted(
+        "TensibleVariable of ", count, " segments exceeds the max ",
+        kMaxChunks * kChunkSegments, " segments, use a larger segment_size"));
+    return;
+  }
+  int64 first = reserved_segments_.load();
+  while (first < count &&
+         !reserved_segments_.compare_exchange_weak(first, count)) {
+  }
+  std::vector<int64> segments;
+  {
+    // The failed segments of the previous resizes are generated again.
+    mutex_lock lock(publish_mu_);
+    auto end = failed_segments_.lower_bound(count);
+    segments.assign(failed_segments_.begin(), end);
+    failed_segments_.erase(failed_segments_.begin(), end);
+  }
+  for (int64 i = first; i < count; i++) {
+    segments.push_back(i);
+  }
+  if (segments.empty()) {
+    // The segments are reserved by resizes in flight.
+    PublishSegments(count, Status::OK(), done);
+    return;
+  }
+  StatusCollector* stc = new StatusCollector(segments.size(),
+      [this, count, done](Status st) {
+    PublishSegments(count, st, done);
   });
-  for (int i = 0; i < segment_count; i++) {
-    generator_->GetNextTensor([this, stc] (Status st, const Tensor& tensor) {
-      auto fn = [&]() -> Status {
-        mutex_lock lock(structure_update_mu_);
-        if (!st.ok()) {
-          return st;
-        }
-        if (tensor.shape() != shape_) {
-          return errors::InvalidArgument(
-              "Tensor Generator generate shape error ",
-              tensor.shape().DebugString(), " vs ", shape_.DebugString());
-        }
-        if (tensor.dtype() != dtype_) {
-          return errors::InvalidArgument(
-              "Tensor Generator generate dtype error ",
-              tensor.dtype(), " vs ", dtype_);
-        }
-        tensors_.push_back(tensor);
-        if (all_ptr_vec_.back().size < tensors_.size()) {
-          all_ptr_vec_.emplace_back();
-          auto&& old_spec = all_ptr_vec_[all_ptr_vec_.size() - 2];
-          auto&& new_spec = all_ptr_vec_[all_ptr_vec_.size() - 1];
-          new_spec.size = old_spec.size * 2;
-          new_spec.ptr.reset(new char*[new_spec.size]);
-          memcpy(new_spec.ptr.get(), old_spec.ptr.get(),
-              old_spec.size * sizeof(char*));
-        }
-        all_ptr_vec_.back().ptr[tensors_.size() - 1] =
-          const_cast<char*>(tensor.tensor_data().data());
-        return Status::OK();
-      };
-      stc->AddStatus(fn());
+  for (int64 i : segments) {
+    generator_->GetNextTensor([this, stc, i] (Status st, const Tensor& tensor) {
+      if (st.ok()) {
+        st = CheckSegment(tensor);
+      }
+      if (st.ok()) {
+        SetSegment(i, new Tensor(tensor));
+      } else {
+        // A failed segment is never published, neither are the segments
+        // after it until the next resize generates it again.
+        mutex_lock lock(publish_mu_);
+        failed_segments_.insert(i);
+      }
+      stc->AddStatus(st);
     });
   }
   stc->Start();
 }
 
-void TensibleVariable::ZeroCostResize(int64 size) {
-  mutex_lock lock(structure_update_mu_);
-  size_t segment_count = (size + segment_size_ - 1) / segment_size_;
-  while (tensors_.size() < segment_count) {
-    tensors_.emplace_back(dtype_, shape_);
-    if (all_ptr_vec_.back().size < tensors_.size()) {
-      all_ptr_vec_.emplace_back();
-      auto&& old_spec = all_ptr_vec_[all_ptr_vec_.size() - 2];
-      auto&& new_spec = all_ptr_vec_[all_ptr_vec_.size() - 1];
-      new_spec.size = old_spec.size * 2;
-      new_spec.ptr.reset(new char*[new_spec.size]);
-      memcpy(new_spec.ptr.get(), old_spec.ptr.get(),
-          old_spec.size * sizeof(char*));
+Status TensibleVariable::ZeroCostResize(int64 size) {
+  const int64 count = (size + segment_size_ - 1) / segment_size_;
+  if (count > kMaxChunks * kChunkSegments) {
+    return errors::ResourceExhausted(
+        "TensibleVariable of ", count, " segments exceeds the max ",
+        kMaxChunks * kChunkSegments, " segments, use a larger segment_size");
+  }
+  int64 first = reserved_segments_.load();
+  while (first < count &&
+         !reserved_segments_.compare_exchange_weak(first, count)) {
+  }
+  std::vector<int64> segments;
+  {
+    mutex_lock lock(publish_mu_);
+    auto end = failed_segments_.lower_bound(count);
+    segments.assign(failed_segments_.begin(), end);
+    failed_segments_.erase(failed_segments_.begin(), end);
+  }
+  for (int64 i = first; i < count; i++) {
+    segments.push_back(i);
+  }
+  Status st;
+  for (int64 i : segments) {
+    Tensor* tensor = nullptr;
+    Status s = NewZeroSegment(&tensor);
+    if (s.ok()) {
+      SetSegment(i, tensor);
+    } else {
+      mutex_lock lock(publish_mu_);
+      failed_segments_.insert(i);
+      st.Update(s);
     }
-    all_ptr_vec_.back().ptr[tensors_.size() - 1] =
-      const_cast<char*>(tensors_.back().tensor_data().data());
   }
-  size_ = tensors_.size() * segment_size_;
-  ptrs_ = all_ptr_vec_.back().ptr.get();
+  PublishSegments(count, st, [](Status) {});
+  return st;
 }
 
 void TensibleVariable::Pad(
@@ -138,18 +315,29 @@ void TensibleVariable::Pad(
       return;
     }
     int64 pad = size_ - size;
-    memcpy(const_cast<char*>(
-        tensors_.back().tensor_data().data()) +
-          (segment_size_ - pad) * slice_size_,
-        tensor.tensor_data().data(), pad * slice_size_);
+    if (pad > 0) {
+      memcpy(GetSlice<char>(size), tensor.tensor_data().data(),
+             pad * slice_size_);
+    }
     done(Status::OK());
   });
 }
 
 void TensibleVariable::Clear() {
-  mutex_lock lock(structure_update_mu_);
-  tensors_.clear();
+  mutex_lock lock(publish_mu_);
   size_ = 0;
+  const int64 reserved = reserved_segments_.exchange(0);
+  for (int64 i = 0; i < reserved; i++) {
+    Chunk* chunk = chunks_[i / kChunkSegments].load(std::memory_order_relaxed);
+    if (chunk == nullptr) {
+      continue;
+    }
+    chunk->data[i % kChunkSegments].store(nullptr, std::memory_order_relaxed);
+    delete chunk->tensors[i % kChunkSegments];
+    chunk->tensors[i % kChunkSegments] = nullptr;
+  }
+  published_segments_ = 0;
+  failed_segments_.clear();
 }
 
 void TensibleVariable::ClearIds(
@@ -16,16 +16,29 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_FRAMEWORK_HASH_TABLE_TENSIBLE_VARIABLE_H_
 #define TENSORFLOW_CORE_FRAMEWORK_HASH_TABLE_TENSIBLE_VARIABLE_H_
 
+#include <atomic>
 #include <vector>
 #include <deque>
 #include <memory>
+#include <set>
 #include <string>
+#include <tuple>
 
 #include "tensorflow/core/framework/hash_table/tensor_generator.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 
 namespace tensorflow {
 
+// A variable of rows, grown by segments of shape[0] rows initialized by the
+// generator. The segments are indexed through a two level directory of
+// chunks, which never moves, so that growing doesn't block the readers:
+// a row below Size() can always be read without a lock.
+//
+// Resize reserves its segments with a CAS, installs each of them with an
+// atomic store when the generator produces it, and publishes them in order
+// by advancing Size(). Resizes may run concurrently. A segment failed to
+// generate is left out, so Size() stops before it, and is generated again
+// by the next Resize.
 class TensibleVariable : public core::RefCounted {
  public:
   TensibleVariable(
@@ -39,8 +52,12 @@ class TensibleVariable : public core::RefCounted {
   int64 SliceSize() const { return slice_size_; }
   template<typename T = void>
   T* GetSlice(int64_t id) const {
-    return reinterpret_cast<T*>
-      (ptrs_[id / segment_size_] + (id % segment_size_) * slice_size_);
+    const int64 segment = id / segment_size_;
+    const Chunk* chunk =
+        chunks_[segment / kChunkSegments].load(std::memory_order_relaxed);
+    return reinterpret_cast<T*>(
+        chunk->data[segment % kChunkSegments].load(std::memory_order_relaxed) +
+        (id % segment_size_) * slice_size_);
   }
 
   void LockUpdate() {
@@ -54,8 +71,9 @@ class TensibleVariable : public core::RefCounted {
   void Clear();
   void ClearIds(int64* ids, int64 size, const std::function<void(Status)>& done);
 
-  // Only For "Load From Checkpoint"
-  void ZeroCostResize(int64 size);
+  // Only For "Load From Checkpoint", the new segments are zero initialized
+  // lazily by the kernel, instead of by the generator.
+  Status ZeroCostResize(int64 size);
   void Pad(int64 size, const std::function<void(Status)>& done);
 
   mutex* GetRWLock() {
@@ -67,6 +85,26 @@ class TensibleVariable : public core::RefCounted {
   }
   
  private:
+  static constexpr int64 kChunkSegments = 1024;
+  static constexpr int64 kMaxChunks = 65536;
+
+  // The data of the segments and the tensors owning them. Chunks are mapped
+  // anonymously, so that they are zero, i.e. empty, until installed.
+  struct Chunk {
+    std::atomic<char*> data[kChunkSegments];
+    Tensor* tensors[kChunkSegments];
+  };
+
+  Status CheckSegment(const Tensor& tensor) const;
+  Status NewZeroSegment(Tensor** tensor) const;
+  Chunk* GetOrCreateChunk(int64 index);
+  void SetSegment(int64 segment, Tensor* tensor);
+  bool SegmentReady(int64 segment) const;
+  // Publishes the installed segments and calls `done` with `st` once the
+  // first `count` segments are published.
+  void PublishSegments(int64 count, Status st,
+                       const std::function<void(Status)>& done);
+
   TensorGenerator* generator_;
   TensorShape shape_;
   DataType dtype_;
@@ -77,21 +115,18 @@ class TensibleVariable : public core::RefCounted {
   int64 slice_size_;
   std::atomic<int64> size_;
 
-  mutex structure_update_mu_;
+  // kMaxChunks entries, mapped anonymously.
+  std::atomic<Chunk*>* chunks_;
+  std::atomic<int64> reserved_segments_;
 
-  std::vector<Tensor> tensors_;
-
-  struct PtrSpec {
-    std::unique_ptr<char*[]> ptr;
-    size_t size;
-  };
-  std::vector<PtrSpec> all_ptr_vec_;
-
-  char** ptrs_;
+  mutex publish_mu_;
+  int64 published_segments_ GUARDED_BY(publish_mu_);
+  // Reserved segments which failed to generate.
+  std::set<int64> failed_segments_ GUARDED_BY(publish_mu_);
+  std::vector<std::tuple<int64, Status, std::function<void(Status)>>>
+      waiters_ GUARDED_BY(publish_mu_);
 
   mutex update_mu_;
-
-  static constexpr int kPtrStartSize = 4;
 };
 
 class TensibleVariableResource : public ResourceBase {
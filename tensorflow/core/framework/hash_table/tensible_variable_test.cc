@@ -13,6 +13,9 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <atomic>
+#include <memory>
+#include <thread>
 #include <utility>
 
 #include "tensorflow/core/framework/hash_table/tensible_variable.h"
@@ -93,6 +96,185 @@ TEST(TensibleVariable, Simple) {
   tv->Unref();
 }
 
+TEST(TensibleVariable, ZeroCostResize) {
+  TensorGenerator* generator = new TensorGenerator(
+  [](TensorGenerator::Consumer consumer) {
+    consumer(errors::Internal("unused"), Tensor());
+  });
+  TensibleVariable* tv = new TensibleVariable(
+      generator, TensorShape({5, 2}), DT_INT64);
+  generator->Unref();
+
+  TF_EXPECT_OK(tv->ZeroCostResize(12));
+  EXPECT_EQ(15, tv->Size());
+  for (int i = 0; i < 15; i++) {
+    EXPECT_EQ(0, tv->GetSlice<int64>(i)[0]);
+    EXPECT_EQ(0, tv->GetSlice<int64>(i)[1]);
+  }
+  tv->GetSlice<int64>(14)[1] = 3;
+  EXPECT_EQ(3, tv->GetSlice<int64>(14)[1]);
+
+  tv->Clear();
+  EXPECT_EQ(0, tv->Size());
+  TF_EXPECT_OK(tv->ZeroCostResize(3));
+  EXPECT_EQ(5, tv->Size());
+  EXPECT_EQ(0, tv->GetSlice<int64>(4)[1]);
+  tv->Unref();
+}
+
+TEST(TensibleVariable, GeneratorError) {
+  TensorGenerator* generator = new TensorGenerator(
+  [](TensorGenerator::Consumer consumer) {
+    consumer(Status::OK(), Tensor(DT_INT64, TensorShape({4, 2})));
+  });
+  TensibleVariable* tv = new TensibleVariable(
+      generator, TensorShape({5, 2}), DT_INT64);
+  generator->Unref();
+
+  Status rst_status;
+  tv->Resize(4, [&](Status st) { rst_status = st; });
+  EXPECT_EQ(error::INVALID_ARGUMENT, rst_status.code());
+  EXPECT_EQ(0, tv->Size());
+  tv->Unref();
+}
+
+TEST(TensibleVariable, RetryFailedSegment) {
+  int produced = 0;
+  TensorGenerator* generator = new TensorGenerator(
+  [&](TensorGenerator::Consumer consumer) {
+    if (produced++ == 1) {
+      consumer(errors::Internal("Generate failed"), Tensor());
+      return;
+    }
+    Tensor t(DT_INT64, TensorShape({5, 2}));
+    t.flat<int64>().setConstant(7);
+    consumer(Status::OK(), t);
+  });
+  TensibleVariable* tv = new TensibleVariable(
+      generator, TensorShape({5, 2}), DT_INT64);
+  generator->Unref();
+
+  // The second segment fails and is not published.
+  Status rst_status;
+  tv->Resize(15, [&](Status st) { rst_status = st; });
+  EXPECT_EQ(error::INTERNAL, rst_status.code());
+  EXPECT_EQ(5, tv->Size());
+
+  // It is generated again by the next resize.
+  tv->Resize(15, [&](Status st) { rst_status = st; });
+  TF_EXPECT_OK(rst_status);
+  EXPECT_EQ(15, tv->Size());
+  for (int i = 0; i < 15; i++) {
+    EXPECT_EQ(7, tv->GetSlice<int64>(i)[0]);
+    EXPECT_EQ(7, tv->GetSlice<int64>(i)[1]);
+  }
+  tv->Unref();
+}
+
+TEST(TensibleVariable, ConcurrentResize) {
+  TensorGenerator* generator = new TensorGenerator(
+  [&](TensorGenerator::Consumer consumer) {
+    Tensor t(DT_INT64, TensorShape({5, 2}));
+    t.flat<int64>().setConstant(7);
+    consumer(Status::OK(), t);
+  });
+  TensibleVariable* tv = new TensibleVariable(
+      generator, TensorShape({5, 2}), DT_INT64);
+  generator->Unref();
+
+  constexpr int kThreads = 8;
+  constexpr int kSize = 5000;
+  std::atomic<int> failures(0);
+  std::atomic<bool> stop(false);
+  // Rows below Size() are readable while the others grow the variable.
+  std::thread reader([&] {
+    while (!stop) {
+      int64 size = tv->Size();
+      for (int64 i = 0; i < size; i += 13) {
+        if (tv->GetSlice<int64>(i)[1] != 7) {
+          failures++;
+        }
+      }
+    }
+  });
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; t++) {
+    threads.emplace_back([&, t] {
+      for (int64 size = t + 1; size <= kSize; size += kThreads * 7) {
+        std::atomic<bool> called(false);
+        Status st;
+        tv->Resize(size, [&](Status s) {
+          st = s;
+          called = true;
+        });
+        // The resize may complete on another thread.
+        while (!called) {
+          std::this_thread::yield();
+        }
+        if (!st.ok() || tv->Size() < size) {
+          failures++;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  stop = true;
+  reader.join();
+
+  EXPECT_EQ(0, failures);
+  EXPECT_GE(tv->Size(), kSize - kThreads * 7);
+  EXPECT_LE(tv->Size(), kSize);
+  tv->Unref();
+}
+
+TEST(TensibleVariable, ConcurrentResizeWithFailures) {
+  std::atomic<int> produced(0);
+  TensorGenerator* generator = new TensorGenerator(
+  [&](TensorGenerator::Consumer consumer) {
+    if (produced++ % 5 == 3) {
+      consumer(errors::Internal("Generate failed"), Tensor());
+      return;
+    }
+    Tensor t(DT_INT64, TensorShape({5, 2}));
+    t.flat<int64>().setConstant(7);
+    consumer(Status::OK(), t);
+  });
+  TensibleVariable* tv = new TensibleVariable(
+      generator, TensorShape({5, 2}), DT_INT64);
+  generator->Unref();
+
+  constexpr int kThreads = 8;
+  constexpr int kSize = 2000;
+  std::atomic<int> hangs(0);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < kThreads; t++) {
+    threads.emplace_back([&, t] {
+      for (int64 size = t + 1; size <= kSize; size += kThreads * 7) {
+        // Outlives the resize in case done is never called.
+        auto called = std::make_shared<std::atomic<bool>>(false);
+        tv->Resize(size, [called](Status s) { *called = true; });
+        // Every resize returns, successful or not, even when it waits
+        // behind a segment which failed for another one.
+        const uint64 deadline = Env::Default()->NowMicros() + 10000000;
+        while (!*called && Env::Default()->NowMicros() < deadline) {
+          std::this_thread::yield();
+        }
+        if (!*called) {
+          hangs++;
+          return;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(0, hangs);
+  tv->Unref();
+}
+
 }  // namespace
 
 }  // namespace tensorflow
@@ -0,0 +1,269 @@
+/* Copyright 2022 The DeepRec Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/framework/input_pipeline_stats.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "tensorflow/core/lib/strings/str_util.h"
+#include "tensorflow/core/lib/strings/strcat.h"
+#include "tensorflow/core/lib/strings/stringprintf.h"
+#include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/util/env_var.h"
+
+namespace tensorflow {
+
+namespace {
+
+constexpr char kSeparator[] = "::";
+
+bool IsIterator(const InputPipelineStats::StageSummary& s) {
+  return s.kind != InputPipelineStats::kStage;
+}
+
+// The iterators created by the users, e.g. "Iterator::Prefetch", consumed by
+// the graph.
+bool IsRootIterator(const InputPipelineStats::StageSummary& s) {
+  return IsIterator(s) && str_util::StartsWith(s.name, "Iterator::") &&
+         s.name.find(kSeparator, strlen("Iterator::")) == string::npos;
+}
+
+// The iterators producing their elements in background threads, e.g.
+// "Iterator::ParallelMap", their consumers wait for the elements while the
+// next ones are being produced, so the wait is not their own time.
+bool IsAsyncIterator(const InputPipelineStats::StageSummary& s) {
+  if (!IsIterator(s)) return false;
+  const size_t pos = s.name.rfind(kSeparator);
+  const string name = pos == string::npos
+                          ? s.name
+                          : s.name.substr(pos + strlen(kSeparator));
+  return s.kind == "prefetch" || name.find("Parallel") != string::npos ||
+         name.find("MapAndBatch") != string::npos;
+}
+
+bool IsInputIterator(const string& parent, const string& name) {
+  const string prefix = strings::StrCat(parent, kSeparator);
+  return str_util::StartsWith(name, prefix) &&
+         name.find(kSeparator, prefix.size()) == string::npos;
+}
+
+double Millis(double micros) { return micros / 1000.0; }
+
+}  // namespace
+
+constexpr const char* InputPipelineStats::kStage;
+
+InputPipelineStats::InputPipelineStats() : enabled_(false) {
+  bool enabled = false;
+  Status s = ReadBoolFromEnvVar("TF_INPUT_PIPELINE_STATS", false, &enabled);
+  if (!s.ok()) {
+    LOG(WARNING) << "Invalid TF_INPUT_PIPELINE_STATS: " << s.error_message();
+  }
+  enabled_.store(enabled);
+}
+
+InputPipelineStats* InputPipelineStats::Global() {
+  static InputPipelineStats* stats = new InputPipelineStats();
+  return stats;
+}
+
+InputPipelineStats::Stage* InputPipelineStats::GetStage(const string& name,
+                                                        const string& kind) {
+  mutex_lock l(mu_);
+  std::unique_ptr<Stage>& stage = stages_[name];
+  if (stage == nullptr) {
+    stage.reset(new Stage(name, kind));
+  }
+  return stage.get();
+}
+
+std::vector<InputPipelineStats::StageSummary> InputPipelineStats::GetSummary()
+    const {
+  std::vector<StageSummary> summary;
+  {
+    mutex_lock l(mu_);
+    summary.reserve(stages_.size());
+    for (const auto& it : stages_) {
+      const Stage& stage = *it.second;
+      StageSummary s;
+      s.name = stage.name();
+      s.kind = stage.kind();
+      s.elements = stage.elements_.load(std::memory_order_relaxed);
+      if (s.elements > 0) {
+        s.latency_micros =
+            static_cast<double>(
+                stage.latency_micros_.load(std::memory_order_relaxed)) /
+            s.elements;
+      }
+      s.producer_wait_micros =
+          stage.producer_wait_micros_.load(std::memory_order_relaxed);
+      s.consumer_wait_micros =
+          stage.consumer_wait_micros_.load(std::memory_order_relaxed);
+      const int64 samples =
+          stage.occupancy_samples_.load(std::memory_order_relaxed);
+      if (samples > 0) {
+        s.occupancy =
+            static_cast<double>(
+                stage.occupancy_sum_.load(std::memory_order_relaxed)) /
+            samples;
+      }
+      s.capacity = stage.capacity_.load(std::memory_order_relaxed);
+      summary.push_back(std::move(s));
+    }
+  }
+  // The inputs of an iterator have its prefix, and follow it in the order of
+  // the names.
+  for (size_t i = 0; i < summary.size(); ++i) {
+    if (!IsIterator(summary[i]) || IsAsyncIterator(summary[i])) continue;
+    int64 self_micros = summary[i].consumer_wait_micros;
+    for (size_t j = i + 1; j < summary.size() &&
+                           str_util::StartsWith(summary[j].name,
+                                                summary[i].name);
+         ++j) {
+      if (IsIterator(summary[j]) &&
+          IsInputIterator(summary[i].name, summary[j].name)) {
+        self_micros -= summary[j].consumer_wait_micros;
+      }
+    }
+    summary[i].self_micros = std::max<int64>(self_micros, 0);
+  }
+  return summary;
+}
+
+string InputPipelineStats::FindBottleneck(
+    const std::vector<StageSummary>& summary, string* reason) {
+  // The stages consumed by the graph: the TensorBuffers if any, otherwise the
+  // iterators are consumed directly.
+  bool has_buffers = false;
+  for (const StageSummary& s : summary) {
+    has_buffers |= !IsIterator(s) && s.elements > 0;
+  }
+  const StageSummary* boundary = nullptr;
+  int64 producer_wait_micros = 0;
+  int64 consumer_wait_micros = 0;
+  for (const StageSummary& s : summary) {
+    const bool consumed_by_graph =
+        has_buffers ? !IsIterator(s) : IsRootIterator(s);
+    if (s.elements == 0 || !consumed_by_graph) continue;
+    producer_wait_micros += s.producer_wait_micros;
+    consumer_wait_micros += s.consumer_wait_micros;
+    if (boundary == nullptr ||
+        s.consumer_wait_micros > boundary->consumer_wait_micros) {
+      boundary = &s;
+    }
+  }
+  if (boundary == nullptr) {
+    return "";
+  }
+
+  if (consumer_wait_micros <= producer_wait_micros) {
+    *reason = strings::StrCat(
+        "the producers of ", boundary->name, " waited ",
+        Millis(producer_wait_micros), " ms for the graph consuming it and ",
+        "its consumers waited ", Millis(consumer_wait_micros),
+        " ms, the computation after the input pipeline, e.g. the hashing, ",
+        "the embedding lookups and the training, is the bottleneck.");
+    return "compute";
+  }
+
+  // The input pipeline is the bottleneck, blame the iterator which spends
+  // the most time on its own. The time of the asynchronous iterators, e.g.
+  // prefetch and parallel map, overlaps with their inputs and isn't known.
+  const StageSummary* slowest = nullptr;
+  for (const StageSummary& s : summary) {
+    if (!IsIterator(s) || IsAsyncIterator(s)) continue;
+    if (slowest == nullptr || s.self_micros > slowest->self_micros) {
+      slowest = &s;
+    }
+  }
+  if (slowest == nullptr || slowest->self_micros == 0) {
+    *reason = strings::StrCat(
+        "the consumers of ", boundary->name, " waited ",
+        Millis(consumer_wait_micros), " ms for elements and its producers ",
+        "waited ", Millis(producer_wait_micros),
+        " ms, the ops producing its elements are the bottleneck.");
+    return boundary->name;
+  }
+  *reason = strings::StrCat(
+      "the consumers of ", boundary->name, " waited ",
+      Millis(consumer_wait_micros), " ms for elements and its producers ",
+      "waited ", Millis(producer_wait_micros), " ms, ", slowest->name, " (",
+      slowest->kind, ") spent ", Millis(slowest->self_micros),
+      " ms on its own, the most of the input pipeline.");
+  return slowest->name;
+}
+
+string InputPipelineStats::Report() const {
+  const std::vector<StageSummary> summary = GetSummary();
+  string report = strings::Printf(
+      "%-48s %-8s %10s %12s %10s %14s %14s %9s %8s\n", "stage", "kind",
+      "elements", "latency(ms)", "self(ms)", "consumer(ms)", "producer(ms)",
+      "occupancy", "capacity");
+  for (const StageSummary& s : summary) {
+    strings::Appendf(&report,
+                     "%-48s %-8s %10lld %12.3f %10.3f %14.3f %14.3f %9.2f "
+                     "%8lld\n",
+                     s.name.c_str(), s.kind.c_str(),
+                     static_cast<long long>(s.elements),
+                     Millis(s.latency_micros), Millis(s.self_micros),
+                     Millis(s.consumer_wait_micros),
+                     Millis(s.producer_wait_micros), s.occupancy,
+                     static_cast<long long>(s.capacity));
+  }
+  string reason;
+  const string bottleneck = FindBottleneck(summary, &reason);
+  if (bottleneck.empty()) {
+    strings::StrAppend(&report, "Bottleneck: unknown, no elements recorded.");
+  } else {
+    strings::StrAppend(&report, "Bottleneck: ", bottleneck, ", ", reason);
+  }
+  return report;
+}
+
+void InputPipelineStats::Reset() {
+  mutex_lock l(mu_);
+  for (auto& it : stages_) {
+    Stage* stage = it.second.get();
+    stage->elements_ = 0;
+    stage->latency_micros_ = 0;
+    stage->producer_wait_micros_ = 0;
+    stage->consumer_wait_micros_ = 0;
+    stage->occupancy_sum_ = 0;
+    stage->occupancy_samples_ = 0;
+    stage->last_end_micros_ = 0;
+  }
+}
+
+string InputPipelineStats::IteratorKind(const string& prefix) {
+  const size_t pos = prefix.rfind(kSeparator);
+  const string name =
+      pos == string::npos ? prefix : prefix.substr(pos + strlen(kSeparator));
+  auto contains = [&name](const char* s) {
+    return name.find(s) != string::npos;
+  };
+  if (contains("Parse") || contains("Decode")) return "parse";
+  if (contains("Record") || contains("TextLine") || contains("Parquet") ||
+      contains("Kafka") || contains("Csv") || contains("Sql") ||
+      contains("Reader")) {
+    return "read";
+  }
+  if (contains("Map")) return "map";
+  if (contains("Batch")) return "batch";
+  if (contains("Prefetch")) return "prefetch";
+  return "dataset";
+}
+
+}  // namespace tensorflow
@@ -0,0 +1,158 @@
+/* Copyright 2022 The DeepRec Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_FRAMEWORK_INPUT_PIPELINE_STATS_H_
+#define TENSORFLOW_CORE_FRAMEWORK_INPUT_PIPELINE_STATS_H_
+
+#include <atomic>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "tensorflow/core/platform/mutex.h"
+#include "tensorflow/core/platform/thread_annotations.h"
+#include "tensorflow/core/platform/types.h"
+
+namespace tensorflow {
+
+// Timing of the stages of the input pipelines in this process: the tf.data
+// iterators, named by their prefixes, and the TensorBuffers of tf.staged,
+// named by their shared names. The stats are only collected when enabled,
+// with TF_INPUT_PIPELINE_STATS=1 or SetEnabled(true).
+//
+// A stage has a consumer, which waits for its elements, and producers, which
+// wait for the consumer:
+//   - For an iterator, the consumer wait is the time spent in GetNext and the
+//     producer wait is the time between two calls of GetNext.
+//   - For a TensorBuffer, the consumer wait is the time takes are blocked on
+//     an empty buffer and the producer wait is the time puts are blocked on a
+//     full buffer.
+class InputPipelineStats {
+ public:
+  static constexpr const char* kStage = "stage";
+
+  // The counters of a stage, updated without locks.
+  class Stage {
+   public:
+    Stage(const string& name, const string& kind) : name_(name), kind_(kind) {}
+
+    const string& name() const { return name_; }
+    const string& kind() const { return kind_; }
+
+    // An element left the stage `latency_micros` after it was requested, for
+    // an iterator, or put, for a TensorBuffer.
+    void RecordElement(int64 latency_micros) {
+      elements_.fetch_add(1, std::memory_order_relaxed);
+      latency_micros_.fetch_add(latency_micros, std::memory_order_relaxed);
+    }
+
+    void RecordProducerWait(int64 micros) {
+      producer_wait_micros_.fetch_add(micros, std::memory_order_relaxed);
+    }
+
+    void RecordConsumerWait(int64 micros) {
+      consumer_wait_micros_.fetch_add(micros, std::memory_order_relaxed);
+    }
+
+    // A call of GetNext from `start_micros` to `end_micros`.
+    void RecordCall(int64 start_micros, int64 end_micros) {
+      RecordConsumerWait(end_micros - start_micros);
+      const int64 last_end_micros =
+          last_end_micros_.exchange(end_micros, std::memory_order_relaxed);
+      if (last_end_micros > 0 && start_micros > last_end_micros) {
+        RecordProducerWait(start_micros - last_end_micros);
+      }
+    }
+
+    // `size` elements were buffered out of `capacity`.
+    void RecordOccupancy(int64 size, int64 capacity) {
+      occupancy_sum_.fetch_add(size, std::memory_order_relaxed);
+      occupancy_samples_.fetch_add(1, std::memory_order_relaxed);
+      capacity_.store(capacity, std::memory_order_relaxed);
+    }
+
+   private:
+    friend class InputPipelineStats;
+
+    const string name_;
+    const string kind_;
+    std::atomic<int64> elements_{0};
+    std::atomic<int64> latency_micros_{0};
+    std::atomic<int64> producer_wait_micros_{0};
+    std::atomic<int64> consumer_wait_micros_{0};
+    std::atomic<int64> occupancy_sum_{0};
+    std::atomic<int64> occupancy_samples_{0};
+    std::atomic<int64> capacity_{0};
+    std::atomic<int64> last_end_micros_{0};
+  };
+
+  struct StageSummary {
+    string name;
+    string kind;
+    int64 elements = 0;
+    // Mean latency of an element.
+    double latency_micros = 0;
+    // Consumer wait of an iterator not spent in its input iterators, i.e.
+    // the time the iterator itself takes. Zero for TensorBuffers and the
+    // iterators producing elements asynchronously, e.g. ParallelMap.
+    int64 self_micros = 0;
+    int64 producer_wait_micros = 0;
+    int64 consumer_wait_micros = 0;
+    // Mean number of buffered elements, and the last capacity.
+    double occupancy = 0;
+    int64 capacity = 0;
+  };
+
+  static InputPipelineStats* Global();
+
+  bool enabled() const { return enabled_.load(std::memory_order_relaxed); }
+  void SetEnabled(bool enabled) {
+    enabled_.store(enabled, std::memory_order_relaxed);
+  }
+
+  // Returns the stage `name`, created with `kind` on the first call. The
+  // stages are never deleted, callers may keep the pointer.
+  Stage* GetStage(const string& name, const string& kind);
+
+  // Returns the stages in the order of their names, so that an iterator
+  // follows the iterator consuming it.
+  std::vector<StageSummary> GetSummary() const;
+
+  // Returns the stage limiting the throughput in `summary`, and the reason
+  // in `reason`. Returns an empty string if nothing was recorded.
+  static string FindBottleneck(const std::vector<StageSummary>& summary,
+                               string* reason);
+
+  // Returns a table of the stages followed by the bottleneck.
+  string Report() const;
+
+  // Clears the counters of all stages.
+  void Reset();
+
+  // Returns the kind of the iterator with `prefix`, e.g. "read" for
+  // "Iterator::Prefetch::TFRecord".
+  static string IteratorKind(const string& prefix);
+
+ private:
+  InputPipelineStats();
+
+  std::atomic<bool> enabled_;
+  mutable mutex mu_;
+  std::map<string, std::unique_ptr<Stage>> stages_ GUARDED_BY(mu_);
+};
+
+}  // namespace tensorflow
+
+#endif  // TENSORFLOW_CORE_FRAMEWORK_INPUT_PIPELINE_STATS_H_
@@ -0,0 +1,191 @@
+/* Copyright 2022 The DeepRec Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/framework/input_pipeline_stats.h"
+
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+typedef InputPipelineStats::StageSummary StageSummary;
+
+StageSummary Iterator(const string& name, int64 consumer_wait_micros,
+                      int64 self_micros) {
+  StageSummary s;
+  s.name = name;
+  s.kind = InputPipelineStats::IteratorKind(name);
+  s.elements = 100;
+  s.consumer_wait_micros = consumer_wait_micros;
+  s.self_micros = self_micros;
+  return s;
+}
+
+StageSummary Buffer(const string& name, int64 consumer_wait_micros,
+                    int64 producer_wait_micros) {
+  StageSummary s;
+  s.name = name;
+  s.kind = InputPipelineStats::kStage;
+  s.elements = 100;
+  s.consumer_wait_micros = consumer_wait_micros;
+  s.producer_wait_micros = producer_wait_micros;
+  return s;
+}
+
+const StageSummary* Find(const std::vector<StageSummary>& summary,
+                         const string& name) {
+  for (const StageSummary& s : summary) {
+    if (s.name == name) return &s;
+  }
+  return nullptr;
+}
+
+TEST(InputPipelineStatsTest, IteratorKind) {
+  EXPECT_EQ("read", InputPipelineStats::IteratorKind("Iterator::TFRecord"));
+  EXPECT_EQ("read", InputPipelineStats::IteratorKind(
+                        "Iterator::Prefetch::ParquetDataset"));
+  EXPECT_EQ("parse",
+            InputPipelineStats::IteratorKind("Iterator::ParseExample"));
+  EXPECT_EQ("map",
+            InputPipelineStats::IteratorKind("Iterator::ParallelMap"));
+  EXPECT_EQ("batch", InputPipelineStats::IteratorKind("Iterator::Batch"));
+  EXPECT_EQ("prefetch",
+            InputPipelineStats::IteratorKind("Iterator::Prefetch"));
+  EXPECT_EQ("dataset", InputPipelineStats::IteratorKind("Iterator::Shuffle"));
+}
+
+TEST(InputPipelineStatsTest, Summary) {
+  InputPipelineStats* stats = InputPipelineStats::Global();
+  stats->Reset();
+  InputPipelineStats::Stage* map = stats->GetStage(
+      "Iterator::SummaryMap", InputPipelineStats::IteratorKind("Map"));
+  InputPipelineStats::Stage* read =
+      stats->GetStage("Iterator::SummaryMap::TFRecord",
+                      InputPipelineStats::IteratorKind("TFRecord"));
+  InputPipelineStats::Stage* other =
+      stats->GetStage("Iterator::SummaryMapOther", "dataset");
+  EXPECT_EQ(map, stats->GetStage("Iterator::SummaryMap", "map"));
+
+  map->RecordCall(100, 400);
+  map->RecordElement(300);
+  map->RecordCall(500, 800);
+  map->RecordElement(300);
+  read->RecordCall(150, 250);
+  read->RecordElement(100);
+  other->RecordCall(0, 1000);
+  InputPipelineStats::Stage* buffer =
+      stats->GetStage("summary_buffer", InputPipelineStats::kStage);
+  buffer->RecordOccupancy(1, 4);
+  buffer->RecordOccupancy(3, 4);
+
+  const std::vector<StageSummary> summary = stats->GetSummary();
+  const StageSummary* s = Find(summary, "Iterator::SummaryMap");
+  ASSERT_NE(nullptr, s);
+  EXPECT_EQ("map", s->kind);
+  EXPECT_EQ(2, s->elements);
+  EXPECT_DOUBLE_EQ(300, s->latency_micros);
+  EXPECT_EQ(600, s->consumer_wait_micros);
+  EXPECT_EQ(100, s->producer_wait_micros);
+  // Neither the time in its input nor in an iterator with a longer name.
+  EXPECT_EQ(500, s->self_micros);
+  s = Find(summary, "summary_buffer");
+  ASSERT_NE(nullptr, s);
+  EXPECT_DOUBLE_EQ(2, s->occupancy);
+  EXPECT_EQ(4, s->capacity);
+  EXPECT_EQ(0, s->self_micros);
+
+  stats->Reset();
+  const std::vector<StageSummary> reset_summary = stats->GetSummary();
+  s = Find(reset_summary, "Iterator::SummaryMap");
+  ASSERT_NE(nullptr, s);
+  EXPECT_EQ(0, s->elements);
+  EXPECT_EQ(0, s->consumer_wait_micros);
+}
+
+TEST(InputPipelineStatsTest, NoBottleneckWithoutElements) {
+  string reason;
+  EXPECT_EQ("", InputPipelineStats::FindBottleneck({}, &reason));
+}
+
+TEST(InputPipelineStatsTest, InputBound) {
+  string reason;
+  EXPECT_EQ("Iterator::Prefetch::Map",
+            InputPipelineStats::FindBottleneck(
+                {Iterator("Iterator::Prefetch", 9000, 8000),
+                 Iterator("Iterator::Prefetch::Map", 1000, 800),
+                 Iterator("Iterator::Prefetch::Map::TFRecord", 200, 200),
+                 Buffer("prefetch", 5000, 100)},
+                &reason));
+  EXPECT_NE(string::npos, reason.find("Iterator::Prefetch::Map (map)"));
+}
+
+TEST(InputPipelineStatsTest, InputBoundAsyncIterators) {
+  // The consumers of the parallel iterators wait while their inputs produce
+  // the next elements, they are never blamed.
+  string reason;
+  EXPECT_EQ("Iterator::Prefetch::ParallelMap::ParallelInterleave::TFRecord",
+            InputPipelineStats::FindBottleneck(
+                {Iterator("Iterator::Prefetch", 9000, 0),
+                 Iterator("Iterator::Prefetch::ParallelMap", 8000, 6000),
+                 Iterator("Iterator::Prefetch::ParallelMap::"
+                          "ParallelInterleave",
+                          2000, 1500),
+                 Iterator("Iterator::Prefetch::ParallelMap::"
+                          "ParallelInterleave::TFRecord",
+                          500, 500),
+                 Iterator("Iterator::Prefetch::MapAndBatch", 8000, 7000),
+                 Buffer("prefetch", 5000, 100)},
+                &reason));
+
+  InputPipelineStats* stats = InputPipelineStats::Global();
+  stats->Reset();
+  InputPipelineStats::Stage* map =
+      stats->GetStage("Iterator::AsyncParallelMap",
+                      InputPipelineStats::IteratorKind("ParallelMap"));
+  map->RecordCall(0, 1000);
+  map->RecordElement(100);
+  const std::vector<StageSummary> summary = stats->GetSummary();
+  const StageSummary* s = Find(summary, "Iterator::AsyncParallelMap");
+  ASSERT_NE(nullptr, s);
+  EXPECT_EQ(1000, s->consumer_wait_micros);
+  EXPECT_EQ(0, s->self_micros);
+}
+
+TEST(InputPipelineStatsTest, InputBoundWithoutIterators) {
+  string reason;
+  EXPECT_EQ("prefetch_1",
+            InputPipelineStats::FindBottleneck(
+                {Buffer("prefetch", 100, 200), Buffer("prefetch_1", 5000, 0)},
+                &reason));
+}
+
+TEST(InputPipelineStatsTest, ComputeBound) {
+  string reason;
+  EXPECT_EQ("compute", InputPipelineStats::FindBottleneck(
+                           {Iterator("Iterator::Map", 1000, 200),
+                            Iterator("Iterator::Map::TFRecord", 800, 800),
+                            Buffer("prefetch", 100, 5000)},
+                           &reason));
+  // Without buffers the iterators consumed by the graph are the boundary.
+  StageSummary root = Iterator("Iterator::Map", 1000, 200);
+  root.producer_wait_micros = 9000;
+  EXPECT_EQ("compute",
+            InputPipelineStats::FindBottleneck(
+                {root, Iterator("Iterator::Map::TFRecord", 800, 800)},
+                &reason));
+}
+
+}  // namespace
+}  // namespace tensorflow
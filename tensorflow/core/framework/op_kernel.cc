@@ -712,6 +712,24 @@ Status OpKernelContext::allocate_tensor(
     DataType type, const TensorShape& shape, Tensor* out_tensor,
     AllocatorAttributes attr, const AllocationAttributes& allocation_attr) {
   Allocator* a = get_allocator(attr);
+  if (params_->step_memory_plan != nullptr && attr.value == 0 &&
+      attr.scope_id == 0 && !track_allocations() &&
+      DataTypeCanUseMemcpy(type) && shape.num_elements() > 0) {
+    TensorBuffer* buf = params_->step_memory_plan->AllocateBuffer(
+        params_->op_kernel, num_planned_allocations_++,
+        shape.num_elements() * DataTypeSize(type), a);
+    if (buf != nullptr) {
+      Tensor new_tensor(type, shape, buf);
+      buf->Unref();
+      if (params_->log_memory) {
+        LogMemory::RecordTensorAllocation(params_->op_kernel->name(),
+                                          params_->step_id, new_tensor);
+      }
+      record_tensor_reference(new_tensor);
+      *out_tensor = std::move(new_tensor);
+      return Status::OK();
+    }
+  }
   Tensor new_tensor(a, type, shape,
                     AllocationAttributes(allocation_attr.no_retry_on_failure,
                                          /* allocation_will_be_logged= */ true,
@@ -609,6 +609,21 @@ struct GraphCollector {
   }
 };
 
+// Gives the tensors allocated by the kernels of a step fixed locations, e.g.
+// offsets of a per-step arena. A tensor is identified by its kernel and the
+// order of the allocations in the kernel invocation.
+class StepMemoryPlanInterface {
+ public:
+  virtual ~StepMemoryPlanInterface() {}
+
+  // Returns the buffer of the `index`-th tensor of `num_bytes` allocated by
+  // `kernel`, or nullptr to allocate the tensor from `allocator` as usual.
+  // The caller owns a reference on the returned buffer.
+  virtual TensorBuffer* AllocateBuffer(const OpKernel* kernel, int index,
+                                       size_t num_bytes,
+                                       Allocator* allocator) = 0;
+};
+
 class OpKernelContext {
  public:
   // The first element of a WrappedAllocator is a "base" Allocator and
@@ -738,6 +753,9 @@ class OpKernelContext {
     // TensorSliceReaderCache support.
     checkpoint::TensorSliceReaderCacheWrapper* slice_reader_cache = nullptr;
 
+    // Places the tensors allocated with default attributes. Can be nullptr.
+    StepMemoryPlanInterface* step_memory_plan = nullptr;
+
     // Support for forwarding reservations (used by ScopedAllocator).
     static const int kNeverForward = -2;
     static const int kNoReservation = -1;
@@ -1358,6 +1376,9 @@ class OpKernelContext {
 
   bool is_output_dead_ = false;
 
+  // Number of tensors allocated through params_->step_memory_plan.
+  std::atomic<int> num_planned_allocations_{0};
+
   // The following data members are only used when allocation tracking is
   // enabled.
   mutable mutex stats_mu_;
@@ -1940,6 +1940,8 @@ void StageGraph(Graph* dest, Node* stage_node, Node* unstage_node,
     .Attr("shared_capacity", stage_node->def().attr().at("shared_capacity"))
     .Attr("shared_name", stage_node->def().attr().at("shared_name"))
     .Attr("timeout_millis", stage_node->def().attr().at("timeout_millis"))
+    .Attr("shared_max_capacity",
+          stage_node->def().attr().at("shared_max_capacity"))
     .Finalize(&node_def_stage));
   Status s;
   Node* stage_xxx = dest->AddNode(node_def_stage, &s);
@@ -1956,6 +1958,8 @@ void StageGraph(Graph* dest, Node* stage_node, Node* unstage_node,
     .Attr("shared_capacity", unstage_node->def().attr().at("shared_capacity"))
     .Attr("shared_name", unstage_node->def().attr().at("shared_name"))
     .Attr("shared_threads", unstage_node->def().attr().at("shared_threads"))
+    .Attr("shared_max_capacity",
+          unstage_node->def().attr().at("shared_max_capacity"))
     .Finalize(&node_def_unstage));
   Node* unstage_xxx = dest->AddNode(node_def_unstage, &s);
   TF_CHECK_OK(s);
@@ -15,6 +15,7 @@ limitations under the License.
 
 #include "tensorflow/core/graph/graph_partition.h"
 
+#include <algorithm>
 #include <deque>
 #include <queue>
 #include <unordered_map>
@@ -834,6 +835,72 @@ void SplitByGatherInputs(const DupFuseRecvTable& full,
   }
 }
 
+// Splits the recvs of a fused group into buckets of tensors which are ready
+// at about the same time, and whose total size is about
+// opts.tensor_fuse_max_bytes, so that a fused recv neither waits for late
+// tensors nor grows into a single huge message.
+void SplitBySizeAndReadiness(const PartitionOptions& opts,
+                             const DupFuseRecvTable& full,
+                             std::vector<DupFuseRecvTable>* buckets) {
+  if (opts.tensor_fuse_max_bytes <= 0 &&
+      opts.tensor_fuse_max_wait.value() <= 0) {
+    buckets->push_back(full);
+    return;
+  }
+
+  struct Entry {
+    DupFuseRecvTable::const_iterator it;
+    int64 ready;
+    int64 bytes;
+  };
+  std::vector<Entry> entries;
+  entries.reserve(full.size());
+  for (auto it = full.begin(); it != full.end(); ++it) {
+    const Edge* edge = it->second[0].edge;
+    const int src_id = edge->src()->id();
+    Entry entry;
+    entry.it = it;
+    entry.ready = static_cast<size_t>(src_id) < opts.start_times.size()
+                      ? opts.start_times[src_id].value()
+                      : 0;
+    entry.bytes = 0;
+    if (!edge->IsControlEdge() && opts.edge_bytes != nullptr) {
+      entry.bytes = std::max<int64>(opts.edge_bytes(edge), 0);
+    }
+    entries.push_back(entry);
+  }
+  // Sort by the ready time and the node id, so that the partitions don't
+  // depend on the iteration order of the table.
+  std::sort(entries.begin(), entries.end(),
+            [](const Entry& a, const Entry& b) {
+              if (a.ready != b.ready) return a.ready < b.ready;
+              const Edge* ea = a.it->second[0].edge;
+              const Edge* eb = b.it->second[0].edge;
+              if (ea->src()->id() != eb->src()->id()) {
+                return ea->src()->id() < eb->src()->id();
+              }
+              return ea->src_output() < eb->src_output();
+            });
+
+  int64 bucket_bytes = 0;
+  int64 bucket_ready = 0;
+  for (const Entry& entry : entries) {
+    const bool too_large = opts.tensor_fuse_max_bytes > 0 &&
+                           bucket_bytes + entry.bytes >
+                               opts.tensor_fuse_max_bytes;
+    const bool too_late = opts.tensor_fuse_max_wait.value() > 0 &&
+                          entry.ready - bucket_ready >
+                              opts.tensor_fuse_max_wait.value();
+    if (buckets->empty() || too_large || too_late) {
+      buckets->emplace_back();
+      bucket_bytes = 0;
+      bucket_ready = entry.ready;
+    }
+    buckets->back().insert(*entry.it);
+    bucket_bytes += entry.bytes;
+  }
+}
+
 Status DoFuseRecv(const PartitionOptions& opts, const GraphInfo& g_info,
                   const DupFuseRecvTable& recvs, GraphDef* dst_graph,
                   GlobalDupFuseRecvTable* dup_global_fuse_recv) {
@@ -946,15 +1013,15 @@ Status HandleFuseRecvGroup(const PartitionOptions& opts,
   DupFuseRecvTable no_gather_inputs;
   SplitByGatherInputs(group, &gather_inputs, &no_gather_inputs);
 
+  std::vector<DupFuseRecvTable> buckets;
   if (gather_inputs.size() > 0) {
-    status = DoFuseRecv(opts, g_info, gather_inputs, dst_graph, dup_global_fuse_recv);
-    if (!status.ok()) {
-      return status;
-    }
+    SplitBySizeAndReadiness(opts, gather_inputs, &buckets);
   }
-
   if (no_gather_inputs.size() > 0) {
-    status = DoFuseRecv(opts, g_info, no_gather_inputs, dst_graph, dup_global_fuse_recv);
+    SplitBySizeAndReadiness(opts, no_gather_inputs, &buckets);
+  }
+  for (const DupFuseRecvTable& bucket : buckets) {
+    status = DoFuseRecv(opts, g_info, bucket, dst_graph, dup_global_fuse_recv);
     if (!status.ok()) {
       return status;
     }
@@ -81,6 +81,16 @@ struct PartitionOptions {
 
   // Fuse recv ops or not
   bool tensor_fuse = false;
+
+  // With tensor_fuse, the recvs of a fused group are sorted by the start
+  // times of their sources in 'start_times', and split so that a fused recv
+  // carries at most 'tensor_fuse_max_bytes' and waits at most
+  // 'tensor_fuse_max_wait' for its first tensor. 0 means no limit.
+  // 'edge_bytes' returns the bytes sent on an edge, or -1 if unknown.
+  typedef std::function<int64(const Edge*)> EdgeBytesFunc;
+  EdgeBytesFunc edge_bytes = nullptr;
+  int64 tensor_fuse_max_bytes = 0;
+  Microseconds tensor_fuse_max_wait = Microseconds(0);
 };
 
 namespace {
@@ -467,6 +467,91 @@ TEST_F(FuseRecvTest, FuseRecvRefType) {
   }
 }
 
+int CountFuseRecvs(const GraphDef& graph_def) {
+  int fuse_recv_count = 0;
+  for (int i = 0; i < graph_def.node_size(); ++i) {
+    if (graph_def.node(i).op() == "_FuseRecv") {
+      ++fuse_recv_count;
+    }
+  }
+  return fuse_recv_count;
+}
+
+TEST_F(FuseRecvTest, FuseRecvMaxBytes) {
+  string worker_device = "/job:worker/replica:0/task:0/cpu:0";
+  string ps_device = "/job:ps/replica:0/task:0/cpu:0";
+
+  auto w1 = FloatInput(in_.WithOpName("W1"), worker_device);
+  auto w2 = Scatter1to2(in_.WithOpName("W2"), worker_device, w1);
+  auto w3 = Scatter1to2(in_.WithOpName("W3"), worker_device, w1);
+  auto p1 = FakeIdentity(in_.WithOpName("P1"), ps_device, w2[0]);
+  auto p2 = FakeIdentity(in_.WithOpName("P2"), ps_device, w2[1]);
+  auto p3 = FakeIdentity(in_.WithOpName("P3"), ps_device, w3[0]);
+
+  std::shared_ptr<Graph> g = ConstructGraph();
+
+  PartitionOptions popts;
+  popts.node_to_loc = SplitByWorker;
+  popts.new_name = [&g](const string& prefix) { return g->NewName(prefix); };
+  popts.get_incarnation = [](const string& name) {
+    return (name[0] - 'A') + 100;
+  };
+  // Two of the three tensors fit in a fused recv.
+  popts.edge_bytes = [](const Edge* e) { return 100; };
+  popts.tensor_fuse_max_bytes = 200;
+  std::unordered_map<string, GraphDef> partitions;
+  TF_ASSERT_OK(PartitionWithTensorFuse(popts, g.get(), &partitions));
+
+  ASSERT_EQ(partitions.size(), 2);
+  for (auto p : partitions) {
+    if (p.first.find("ps") != std::string::npos) {
+      EXPECT_EQ(CountFuseRecvs(p.second), 2);
+    } else {
+      EXPECT_EQ(CountFuseRecvs(p.second), 0);
+    }
+  }
+}
+
+TEST_F(FuseRecvTest, FuseRecvMaxWait) {
+  string worker_device = "/job:worker/replica:0/task:0/cpu:0";
+  string ps_device = "/job:ps/replica:0/task:0/cpu:0";
+
+  auto w1 = FloatInput(in_.WithOpName("W1"), worker_device);
+  auto w2 = Scatter1to2(in_.WithOpName("W2"), worker_device, w1);
+  auto w3 = Scatter1to2(in_.WithOpName("W3"), worker_device, w1);
+  auto p1 = FakeIdentity(in_.WithOpName("P1"), ps_device, w2[0]);
+  auto p2 = FakeIdentity(in_.WithOpName("P2"), ps_device, w2[1]);
+  auto p3 = FakeIdentity(in_.WithOpName("P3"), ps_device, w3[0]);
+
+  std::shared_ptr<Graph> g = ConstructGraph();
+
+  PartitionOptions popts;
+  popts.node_to_loc = SplitByWorker;
+  popts.new_name = [&g](const string& prefix) { return g->NewName(prefix); };
+  popts.get_incarnation = [](const string& name) {
+    return (name[0] - 'A') + 100;
+  };
+  // W3 is ready long after W2, its tensor is not fused with the ones of W2.
+  popts.start_times.resize(g->num_node_ids());
+  for (Node* n : g->nodes()) {
+    if (n->name() == "W3") {
+      popts.start_times[n->id()] = Microseconds(1000);
+    }
+  }
+  popts.tensor_fuse_max_wait = Microseconds(100);
+  std::unordered_map<string, GraphDef> partitions;
+  TF_ASSERT_OK(PartitionWithTensorFuse(popts, g.get(), &partitions));
+
+  ASSERT_EQ(partitions.size(), 2);
+  for (auto p : partitions) {
+    if (p.first.find("ps") != std::string::npos) {
+      EXPECT_EQ(CountFuseRecvs(p.second), 2);
+    } else {
+      EXPECT_EQ(CountFuseRecvs(p.second), 0);
+    }
+  }
+}
+
 class GraphPartitionTest : public ::testing::Test {
  protected:
   GraphPartitionTest()
@@ -18,6 +18,7 @@ limitations under the License.
 #include "tensorflow/core/graph/optimizer_fusion_engine.h"
 #include "tensorflow/core/graph/optimizer_fusion_engine_impl.h"
 #include "tensorflow/core/graph/template_base.h"
+#include "tensorflow/core/graph/template_kv_hash_unique_gather.h"
 #include "tensorflow/core/graph/template_logicsum_base.h"
 #include "tensorflow/core/graph/template_select_then_scalar.h"
 #include "tensorflow/core/graph/template_select_then_scalar_in_grad.h"
@@ -40,6 +41,8 @@ bool OptimizeFusion(Graph* g) {
   templates.emplace_back(new TemplateSelectElseScalar());
   templates.emplace_back(new TemplateSelectElseScalarInGrad());
   templates.emplace_back(new TemplateSelectThenScalarInGrad());
+  templates.emplace_back(new TemplateKvHashUniqueGather());
+  templates.emplace_back(new TemplateKvHashUniqueWithCountsGather());
 
   for (auto& t : templates) {
     std::unique_ptr<OptimizerFusionImpl> opt(
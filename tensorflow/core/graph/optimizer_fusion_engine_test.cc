@@ -124,6 +124,8 @@ class OptimizerFusionTest : public ::testing::Test {
 
 REGISTER_OP("Input").Output("o: float").SetIsStateful();
 REGISTER_OP("InputInt64").Output("o: int64").SetIsStateful();
+REGISTER_OP("InputString").Output("o: string").SetIsStateful();
+REGISTER_OP("InputResource").Output("o: resource").SetIsStateful();
 REGISTER_OP("Output").Output("o: float");
 
 TEST_F(OptimizerFusionTest, test_input_is_control_dependency_edge) {
@@ -635,6 +637,109 @@ TEST_F(OptimizerFusionTest, SparseInnerFlattenFuse) {
       "A(Const);B(Const);C(Const);D(Const);E(Const);F(Const);G(InputInt64);H(StridedSlice);I(StridedSlice);J(Const);K(Prod);L(Pack);M(ConcatV2);N(Const);O(SparseReshape);P(InputInt64);R(Identity);S(Identity)|A->H:1;B->H:2;C->H:3;D->I:1;E->I:2;F->I:3;G->H;G->I;G->O:1;H->M;I->K;J->K:1;K->L;L->M:1;M->O:2;N->M:2;O->R;O->S;P->O");
 }
 
+TEST_F(OptimizerFusionTest, KvHashUniqueGatherFuse) {
+  InitGraph(
+      "node { name: 'A' op: 'InputResource' }"
+      "node { name: 'B' op: 'InputString' }"
+      "node { name: 'C' op: 'Input' }"
+      "node { name: 'D' op: 'Input' }"
+
+      "node { name: 'E' op: 'StringToHashBucketFast'"
+      " attr { key: 'num_buckets' value { i: 1000 } }"
+      " input: ['B'] }"
+
+      "node { name: 'F' op: 'Unique'"
+      " attr { key: 'T' value { type: DT_INT64 } }"
+      " attr { key: 'out_idx' value { type: DT_INT32 } }"
+      " input: ['E'] }"
+
+      "node { name: 'G' op: 'KvResourceGather'"
+      " attr { key: 'dtype' value { type: DT_FLOAT } }"
+      " attr { key: 'Tkeys' value { type: DT_INT64 } }"
+      " input: ['A', 'F', 'C', '^D'] }"
+
+      "node { name: 'H' op: 'Identity'"
+      " attr { key: 'T' value { type: DT_FLOAT } }"
+      " input: ['G'] }"
+
+      "node { name: 'I' op: 'Identity'"
+      " attr { key: 'T' value { type: DT_INT32 } }"
+      " input: ['F:1'] }"
+
+      "node { name: 'J' op: 'Identity'"
+      " attr { key: 'T' value { type: DT_INT64 } }"
+      " input: ['F'] }");
+
+  EXPECT_EQ(
+      DoFusion(),
+      "A(InputResource);B(InputString);C(Input);D(Input);H(Identity);I(Identity);J(Identity);fused_op_1_kv_hash_unique_gather(_KvResourceHashUniqueGather)|A->fused_op_1_kv_hash_unique_gather;B->fused_op_1_kv_hash_unique_gather:1;C->fused_op_1_kv_hash_unique_gather:2;D:control->fused_op_1_kv_hash_unique_gather:control;fused_op_1_kv_hash_unique_gather->J;fused_op_1_kv_hash_unique_gather:1->I;fused_op_1_kv_hash_unique_gather:3->H");
+}
+
+TEST_F(OptimizerFusionTest, KvHashUniqueWithCountsGatherFuse) {
+  InitGraph(
+      "node { name: 'A' op: 'InputResource' }"
+      "node { name: 'B' op: 'InputString' }"
+      "node { name: 'C' op: 'Input' }"
+
+      "node { name: 'E' op: 'StringToHashBucketFast'"
+      " attr { key: 'num_buckets' value { i: 1000 } }"
+      " input: ['B'] }"
+
+      "node { name: 'F' op: 'UniqueWithCounts'"
+      " attr { key: 'T' value { type: DT_INT64 } }"
+      " attr { key: 'out_idx' value { type: DT_INT64 } }"
+      " input: ['E'] }"
+
+      "node { name: 'G' op: 'KvResourceGatherV1'"
+      " attr { key: 'dtype' value { type: DT_FLOAT } }"
+      " attr { key: 'Tkeys' value { type: DT_INT64 } }"
+      " attr { key: 'counts_type' value { type: DT_INT64 } }"
+      " input: ['A', 'F', 'C', 'F:2'] }"
+
+      "node { name: 'H' op: 'Identity'"
+      " attr { key: 'T' value { type: DT_FLOAT } }"
+      " input: ['G'] }"
+
+      "node { name: 'I' op: 'Identity'"
+      " attr { key: 'T' value { type: DT_INT64 } }"
+      " input: ['F:1'] }");
+
+  EXPECT_EQ(
+      DoFusion(),
+      "A(InputResource);B(InputString);C(Input);H(Identity);I(Identity);fused_op_1_kv_hash_unique_gather(_KvResourceHashUniqueGather)|A->fused_op_1_kv_hash_unique_gather;B->fused_op_1_kv_hash_unique_gather:1;C->fused_op_1_kv_hash_unique_gather:2;fused_op_1_kv_hash_unique_gather:1->I;fused_op_1_kv_hash_unique_gather:3->H");
+}
+
+TEST_F(OptimizerFusionTest, KvHashUniqueGatherNotFuseOnGPU) {
+  InitGraph(
+      "node { name: 'A' op: 'InputResource' }"
+      "node { name: 'B' op: 'InputString' }"
+      "node { name: 'C' op: 'Input' }"
+
+      "node { name: 'E' op: 'StringToHashBucketFast'"
+      " attr { key: 'num_buckets' value { i: 1000 } }"
+      " input: ['B'] device: '/device:GPU:0' }"
+
+      "node { name: 'F' op: 'Unique'"
+      " attr { key: 'T' value { type: DT_INT64 } }"
+      " attr { key: 'out_idx' value { type: DT_INT32 } }"
+      " input: ['E'] device: '/device:GPU:0' }"
+
+      "node { name: 'G' op: 'KvResourceGather'"
+      " attr { key: 'dtype' value { type: DT_FLOAT } }"
+      " attr { key: 'Tkeys' value { type: DT_INT64 } }"
+      " input: ['A', 'F', 'C'] device: '/device:GPU:0' }"
+
+      "node { name: 'H' op: 'Identity'"
+      " attr { key: 'T' value { type: DT_FLOAT } }"
+      " input: ['G'] }"
+
+      "node { name: 'I' op: 'Identity'"
+      " attr { key: 'T' value { type: DT_INT32 } }"
+      " input: ['F:1'] }");
+
+  EXPECT_EQ(DoFusion(), OriginalGraph());
+}
+
 #ifndef GOOGLE_CUDA
 TEST_F(OptimizerFusionTest, MSBatchMatMulFuse2Heads) {
   InitGraph(
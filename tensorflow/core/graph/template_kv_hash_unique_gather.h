@@ -0,0 +1,218 @@
+/* Copyright 2022 The DeepRec Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#ifndef TENSORFLOW_CORE_GRAPH_TEMPLATE_KV_HASH_UNIQUE_GATHER_H_
+#define TENSORFLOW_CORE_GRAPH_TEMPLATE_KV_HASH_UNIQUE_GATHER_H_
+
+#include <set>
+
+#include "tensorflow/core/framework/node_def_util.h"
+#include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/graph/template_base.h"
+#include "tensorflow/core/util/device_name_utils.h"
+
+namespace tensorflow {
+
+// Fuses the hashing of string features, the Unique of the ids and the
+// gather of their embeddings from an EmbeddingVariable on CPU:
+//
+//   StringToHashBucketFast -> Unique(WithCounts) -> KvResourceGather(V1)
+//
+// to _KvResourceHashUniqueGather. The template inputs are the resource, the
+// strings and the default value, the template outputs are the unique ids,
+// idx, the embeddings and, with counts, the counts.
+class TemplateKvHashUniqueGatherBase : public TemplateBase {
+ public:
+  explicit TemplateKvHashUniqueGatherBase(bool with_counts)
+      : with_counts_(with_counts) {
+    const TempNode n0 = {
+      .key = "hash",
+      .op = "StringToHashBucketFast",
+      .inputs = {"1"},
+      .outputs = {{"unique"}}
+    };
+    temp_nodes_.emplace_back(n0);
+
+    TempNode n1 = {
+      .key = "unique",
+      .op = "Unique",
+      .inputs = {"hash"},
+      .outputs = {{"gather", "0"}, {"1"}}
+    };
+    TempNode n2 = {
+      .key = "gather",
+      .op = "KvResourceGather",
+      .inputs = {"0", "unique", "2"},
+      .outputs = {{"2"}}
+    };
+    if (with_counts_) {
+      n1.op = "UniqueWithCounts";
+      n1.outputs.push_back({"gather", "3"});
+      n2.op = "KvResourceGatherV1";
+      n2.inputs.push_back("unique");
+    }
+    temp_nodes_.emplace_back(n1);
+    temp_nodes_.emplace_back(n2);
+
+    first_key_ = "hash";
+    num_inputs_ = 3;
+    num_outputs_ = with_counts_ ? 4 : 3;
+  }
+
+  bool add_subgraph(std::map<std::string, MatchedNode>& nodes,
+      std::string name_prefix, Graph* g,
+      std::vector<const Edge*>& inputs,
+      std::vector<std::vector<const Edge*>>& outputs) override {
+    const Node* hash = nodes["hash"].node;
+    const Node* unique = nodes["unique"].node;
+    const Node* gather = nodes["gather"].node;
+    // The matching doesn't check the source ports, the gather must take the
+    // ids and the counts of the unique.
+    for (const Edge* e : gather->in_edges()) {
+      if ((e->dst_input() == 1 && e->src_output() != 0) ||
+          (e->dst_input() == 3 && e->src_output() != 2)) {
+        return false;
+      }
+    }
+    string device;
+    if (!GetFusedDevice({hash, unique, gather}, &device)) {
+      VLOG(2) << "Skip fusing " << gather->name() << " on " << device;
+      return false;
+    }
+
+    NodeDef fused_def;
+    fused_def.set_op("_KvResourceHashUniqueGather");
+    fused_def.set_name(name_prefix + "_kv_hash_unique_gather");
+    fused_def.set_device(gather->def().device());
+    for (int i = 0; i < num_inputs_; ++i) {
+      add_input(fused_def, inputs[i]);
+    }
+    int64 num_buckets;
+    DataType out_idx;
+    DataType dtype;
+    bool is_use_default_value_tensor;
+    if (!GetNodeAttr(hash->attrs(), "num_buckets", &num_buckets).ok() ||
+        !GetNodeAttr(unique->attrs(), "out_idx", &out_idx).ok() ||
+        !GetNodeAttr(gather->attrs(), "dtype", &dtype).ok() ||
+        !GetNodeAttr(gather->attrs(), "is_use_default_value_tensor",
+                     &is_use_default_value_tensor).ok()) {
+      return false;
+    }
+    AddNodeAttr("num_buckets", num_buckets, &fused_def);
+    AddNodeAttr("with_counts", with_counts_, &fused_def);
+    AddNodeAttr("is_use_default_value_tensor", is_use_default_value_tensor,
+                &fused_def);
+    AddNodeAttr("dtype", dtype, &fused_def);
+    AddNodeAttr("out_idx", out_idx, &fused_def);
+
+    Status status;
+    Node* fused_node = g->AddNode(fused_def, &status);
+    if (status != Status::OK()) {
+      VLOG(1) << status.error_message();
+      return false;
+    }
+    fused_node->set_assigned_device_name(gather->assigned_device_name());
+
+    const std::set<const Node*> matched = {hash, unique, gather};
+    for (int i = 0; i < num_inputs_; ++i) {
+      add_iedge(g, fused_node, i, inputs[i], false);
+    }
+    // The matching ignores the control inputs, keep them on the fused node.
+    for (const Node* n : matched) {
+      for (const Edge* e : n->in_edges()) {
+        if (e->IsControlEdge() && matched.count(e->src()) == 0) {
+          g->AddControlEdge(e->src(), fused_node);
+        }
+      }
+    }
+    // Template output 2 is the embeddings, 3 the counts.
+    const int fused_ports[] = {0, 1, 3, 2};
+    for (int i = 0; i < num_outputs_; ++i) {
+      std::vector<const Edge*> oedges;
+      for (const Edge* e : outputs[i]) {
+        if (matched.count(e->dst()) == 0) {
+          oedges.push_back(e);
+        }
+      }
+      add_oedges(g, fused_node, fused_ports[i], oedges);
+    }
+    // Remove the replaced nodes, otherwise the stateful gather might still
+    // run and create the ids twice.
+    for (const Node* n : matched) {
+      g->RemoveNode(const_cast<Node*>(n));
+    }
+    return true;
+  }
+
+  bool CheckDynamicInputs(
+      const Node* node, const TempNode* temp_node, int dy_mode,
+      std::vector<const Edge*>& fused_op_inputs,
+      std::map<const std::string, TempNode>& temp_node_map,
+      std::map<std::string, MatchedNode>& matched_node_map) override {
+    return false;
+  }
+
+  bool CheckDynamicOutputs(
+      const Node* node, const TempNode* temp_node, int dy_mode,
+      std::vector<std::vector<const Edge*>>& fused_op_outputs,
+      std::map<const std::string, TempNode>& temp_node_map,
+      std::map<std::string, MatchedNode>& matched_node_map) override {
+    return false;
+  }
+
+ private:
+  // The fused kernel is CPU only, fuses the nodes only when they are placed
+  // or requested on the same device which isn't a GPU.
+  static bool GetFusedDevice(const std::vector<const Node*>& nodes,
+                             string* device) {
+    for (const Node* n : nodes) {
+      const string& d = n->assigned_device_name().empty()
+                            ? n->requested_device()
+                            : n->assigned_device_name();
+      if (n != nodes[0] && d != *device) {
+        return false;
+      }
+      *device = d;
+    }
+    DeviceNameUtils::ParsedName parsed;
+    if (!DeviceNameUtils::ParseFullName(*device, &parsed)) {
+      return false;
+    }
+    return !parsed.has_type || parsed.type == DEVICE_CPU;
+  }
+
+  bool with_counts_;
+};
+
+class TemplateKvHashUniqueGather : public TemplateKvHashUniqueGatherBase {
+ public:
+  TemplateKvHashUniqueGather() : TemplateKvHashUniqueGatherBase(false) {}
+
+  const string name() override { return "TemplateKvHashUniqueGather"; }
+};
+
+class TemplateKvHashUniqueWithCountsGather
+    : public TemplateKvHashUniqueGatherBase {
+ public:
+  TemplateKvHashUniqueWithCountsGather()
+      : TemplateKvHashUniqueGatherBase(true) {}
+
+  const string name() override {
+    return "TemplateKvHashUniqueWithCountsGather";
+  }
+};
+
+}  // namespace tensorflow
+#endif  // TENSORFLOW_CORE_GRAPH_TEMPLATE_KV_HASH_UNIQUE_GATHER_H_
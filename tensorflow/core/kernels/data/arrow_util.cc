@@ -123,6 +123,10 @@ class ArrowPrimitiveTensorBuffer : public TensorBuffer {
 ::arrow::Status MakeTensorFromArrowBuffer(
     DataType dtype, const std::shared_ptr<::arrow::Buffer>& arrow_buffer,
     Tensor* tensor) {
+  if (TF_PREDICT_FALSE(!arrow_buffer)) {
+    *tensor = Tensor(dtype, TensorShape({0}));
+    return ::arrow::Status::OK();
+  }
   const TensorShape shape = {arrow_buffer->size() / DataTypeSize(dtype)};
 
 #if DEEPREC_ARROW_ZEROCOPY
@@ -148,6 +152,57 @@ class ArrowPrimitiveTensorBuffer : public TensorBuffer {
 #endif
 }
 
+// Returns `length` elements of `byte_width` bytes from `offset` of
+// `arrow_buffer`, without copying.
+std::shared_ptr<::arrow::Buffer> SliceArrowBuffer(
+    const std::shared_ptr<::arrow::Buffer>& arrow_buffer, int64 offset,
+    int64 length, int64 byte_width) {
+  if (!arrow_buffer ||
+      (offset == 0 && arrow_buffer->size() == length * byte_width)) {
+    return arrow_buffer;
+  }
+  return ::arrow::SliceBuffer(arrow_buffer, offset * byte_width,
+                              length * byte_width);
+}
+
+// Makes the splits of a list or string array from its offsets. The offsets
+// are used as is if they start from 0, which is the case unless the array
+// is a slice, otherwise they are rebased in a single pass.
+::arrow::Status MakeSplitsFromArrowOffsets(
+    const std::shared_ptr<::arrow::Buffer>& offsets_buffer,
+    const int32* offsets, int64 offset, int64 length, Tensor* splits) {
+  const int32 base = offsets[0];
+  if (base == 0) {
+    return MakeTensorFromArrowBuffer(
+        DT_INT32,
+        SliceArrowBuffer(offsets_buffer, offset, length + 1, sizeof(int32)),
+        splits);
+  }
+  *splits = Tensor(DT_INT32, TensorShape({length + 1}));
+  int32* output = splits->flat<int32>().data();
+  for (int64 i = 0; i <= length; ++i) {
+    output[i] = offsets[i] - base;
+  }
+  return ::arrow::Status::OK();
+}
+
+// Makes a uint8 tensor of the bytes of the strings and the splits of each
+// string in it, both without copying.
+::arrow::Status MakeStringViewTensorsFromArrowArray(
+    const ::arrow::StringArray& array, Tensor* values, Tensor* splits) {
+  if (array.null_count() != 0) {
+    return ::arrow::Status::Invalid("Null elements not supported");
+  }
+  const int32* offsets = array.raw_value_offsets();
+  const int64 begin = offsets[0];
+  const int64 end = offsets[array.length()];
+  ARROW_RETURN_NOT_OK(MakeSplitsFromArrowOffsets(
+      array.value_offsets(), offsets, array.offset(), array.length(), splits));
+  return MakeTensorFromArrowBuffer(
+      DT_UINT8, SliceArrowBuffer(array.value_data(), begin, end - begin, 1),
+      values);
+}
+
 ::arrow::Status MakeStringTensorFromArrowArray(
     const ::arrow::StringArray& array, Tensor* tensor) {
   if (array.null_count() != 0) {
@@ -169,39 +224,53 @@ class ArrowPrimitiveTensorBuffer : public TensorBuffer {
 }
 
 // Primitive Arrow arrays have validity and value buffers.
-#define RAGGED_TENSOR_BUILDER_PRIMITIVE_VISIT(ARRAY_CLASS)                    \
-  ::arrow::Status Visit(const ARRAY_CLASS& array) override {                  \
-    if (TF_PREDICT_FALSE(ragged_rank_ != 0)) {                                \
-      return ::arrow::Status::Invalid("Inconsistent ragged rank");            \
-    }                                                                         \
-    Tensor tensor;                                                            \
-    auto st =                                                                 \
-        MakeTensorFromArrowBuffer(dtype_, array.data()->buffers[1], &tensor); \
-    if (!st.ok()) {                                                           \
-      return st;                                                              \
-    }                                                                         \
-    ragged_tensor_.push_front(std::move(tensor));                             \
-    return ::arrow::Status::OK();                                             \
+#define RAGGED_TENSOR_BUILDER_PRIMITIVE_VISIT(ARRAY_CLASS)                   \
+  ::arrow::Status Visit(const ARRAY_CLASS& array) override {                 \
+    if (TF_PREDICT_FALSE(ragged_rank_ != 0)) {                               \
+      return ::arrow::Status::Invalid("Inconsistent ragged rank");           \
+    }                                                                        \
+    Tensor tensor;                                                           \
+    auto st = MakeTensorFromArrowBuffer(                                     \
+        dtype_,                                                              \
+        SliceArrowBuffer(array.data()->buffers[1], array.offset(),           \
+                         array.length(), DataTypeSize(dtype_)),              \
+        &tensor);                                                            \
+    if (!st.ok()) {                                                          \
+      return st;                                                             \
+    }                                                                        \
+    ragged_tensor_.push_front(std::move(tensor));                            \
+    return ::arrow::Status::OK();                                            \
   }
 
-#define RAGGED_TENSOR_BUILDER_STRING_VISIT(ARRAY_CLASS)            \
-  ::arrow::Status Visit(const ARRAY_CLASS& array) override {       \
-    if (TF_PREDICT_FALSE(ragged_rank_ != 0)) {                     \
-      return ::arrow::Status::Invalid("Inconsistent ragged rank"); \
-    }                                                              \
-    Tensor tensor;                                                 \
-    auto st = MakeStringTensorFromArrowArray(array, &tensor);      \
-    if (!st.ok()) {                                                \
-      return st;                                                   \
-    }                                                              \
-    ragged_tensor_.push_front(std::move(tensor));                  \
-    return ::arrow::Status::OK();                                  \
+#define RAGGED_TENSOR_BUILDER_STRING_VISIT(ARRAY_CLASS)                     \
+  ::arrow::Status Visit(const ARRAY_CLASS& array) override {                \
+    if (TF_PREDICT_FALSE(ragged_rank_ != 0)) {                              \
+      return ::arrow::Status::Invalid("Inconsistent ragged rank");          \
+    }                                                                       \
+    if (string_views_) {                                                    \
+      Tensor values;                                                        \
+      Tensor splits;                                                        \
+      auto st = MakeStringViewTensorsFromArrowArray(array, &values, &splits); \
+      if (!st.ok()) {                                                       \
+        return st;                                                          \
+      }                                                                     \
+      ragged_tensor_.push_front(std::move(splits));                         \
+      ragged_tensor_.push_front(std::move(values));                         \
+      return ::arrow::Status::OK();                                         \
+    }                                                                       \
+    Tensor tensor;                                                          \
+    auto st = MakeStringTensorFromArrowArray(array, &tensor);               \
+    if (!st.ok()) {                                                         \
+      return st;                                                            \
+    }                                                                       \
+    ragged_tensor_.push_front(std::move(tensor));                           \
+    return ::arrow::Status::OK();                                           \
   }
 
 class RaggedTensorBuilder : public ::arrow::ArrayVisitor {
  public:
-  RaggedTensorBuilder(DataType dtype, int32 ragged_rank)
-      : dtype_(dtype), ragged_rank_(ragged_rank) {}
+  RaggedTensorBuilder(DataType dtype, int32 ragged_rank, bool string_views)
+      : dtype_(dtype), ragged_rank_(ragged_rank), string_views_(string_views) {}
 
   ::arrow::Status Build(const std::shared_ptr<::arrow::Array>& array,
                         std::vector<Tensor>* output_tensors) {
@@ -217,13 +286,21 @@ class RaggedTensorBuilder : public ::arrow::ArrayVisitor {
   ::arrow::Status Visit(const ::arrow::ListArray& array) override {
     --ragged_rank_;
     Tensor tensor;
-    auto st =
-        MakeTensorFromArrowBuffer(DT_INT32, array.value_offsets(), &tensor);
+    auto st = MakeSplitsFromArrowOffsets(array.value_offsets(),
+                                         array.raw_value_offsets(),
+                                         array.offset(), array.length(),
+                                         &tensor);
     if (!st.ok()) {
       return st;
     }
     ragged_tensor_.push_front(std::move(tensor));
-    return array.values()->Accept(this);
+    // Only the values in the offsets of a sliced list array are visited.
+    const int32 begin = array.value_offset(0);
+    const int32 end = array.value_offset(array.length());
+    if (begin == 0 && end == array.values()->length()) {
+      return array.values()->Accept(this);
+    }
+    return array.values()->Slice(begin, end - begin)->Accept(this);
   }
 
   RAGGED_TENSOR_BUILDER_PRIMITIVE_VISIT(::arrow::Int8Array);
@@ -241,6 +318,7 @@ class RaggedTensorBuilder : public ::arrow::ArrayVisitor {
  private:
   const DataType dtype_;
   int32 ragged_rank_;
+  const bool string_views_;
   std::deque<Tensor> ragged_tensor_;
 };
 
@@ -282,16 +360,12 @@ Status MakeDataTypeAndRaggedRankFromArrowDataType(
 Status MakeTensorsFromArrowArray(
     DataType dtype, int32 ragged_rank,
     const std::shared_ptr<::arrow::Array>& arrow_array,
-    std::vector<Tensor>* output_tensors) {
+    std::vector<Tensor>* output_tensors, bool string_views) {
   if (TF_PREDICT_FALSE(arrow_array->null_count() != 0)) {
     return errors::Internal("Arrow array with null values not supported");
   }
 
-  if (TF_PREDICT_FALSE(arrow_array->data()->offset != 0)) {
-    return errors::Internal("Arrow array has zero non-offset not supported");
-  }
-
-  RaggedTensorBuilder builder(dtype, ragged_rank);
+  RaggedTensorBuilder builder(dtype, ragged_rank, string_views);
   TF_RETURN_IF_ARROW_ERROR(builder.Build(arrow_array, output_tensors));
   return Status::OK();
 }
@@ -343,13 +417,14 @@ int GetArrowFileBufferSizeFromEnv() {
 
 ::arrow::Status OpenParquetReader(
     std::unique_ptr<::parquet::arrow::FileReader>* reader,
-    const std::shared_ptr<::arrow::io::RandomAccessFile>& file) {
+    const std::shared_ptr<::arrow::io::RandomAccessFile>& file,
+    const std::shared_ptr<::parquet::FileMetaData>& metadata) {
   auto config = ::parquet::ReaderProperties();
   config.enable_buffered_stream();
   config.set_buffer_size(GetArrowFileBufferSizeFromEnv());
   ARROW_RETURN_NOT_OK(::parquet::arrow::FileReader::Make(
       ::arrow::default_memory_pool(),
-      ::parquet::ParquetFileReader::Open(file, config), reader));
+      ::parquet::ParquetFileReader::Open(file, config, metadata), reader));
   // If ARROW_NUM_THREADS > 0, specified number of threads will be used.
   // If ARROW_NUM_THREADS = 0, no threads will be used.
   // If ARROW_NUM_THREADS < 0, all threads will be used.
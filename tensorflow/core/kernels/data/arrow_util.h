@@ -60,9 +60,12 @@ int GetArrowFileBufferSizeFromEnv();
     std::shared_ptr<::arrow::io::RandomAccessFile>* file,
     const std::string& filename);
 
+// Opens a parquet reader on `file`. If `metadata` is not null, it is used
+// instead of reading the footer of the file again.
 ::arrow::Status OpenParquetReader(
     std::unique_ptr<::parquet::arrow::FileReader>* reader,
-    const std::shared_ptr<::arrow::io::RandomAccessFile>& file);
+    const std::shared_ptr<::arrow::io::RandomAccessFile>& file,
+    const std::shared_ptr<::parquet::FileMetaData>& metadata = nullptr);
 
 ::arrow::Status GetParquetDataFrameFields(
     std::vector<std::string>* field_names,
@@ -104,10 +107,14 @@ Status MakeDataTypeAndRaggedRankFromArrowDataType(
     const std::shared_ptr<::arrow::DataType>& arrow_dtype, DataType* dtype,
     int32* ragged_rank);
 
+// Appends the values and the splits of `arrow_array` to `output_tensors`,
+// sharing the Arrow buffers when possible. If `string_views` is true, a
+// string array is output as the uint8 bytes of its strings and the int32
+// splits of each string, without materializing the strings.
 Status MakeTensorsFromArrowArray(
     DataType type, int32 ragged_rank,
     const std::shared_ptr<::arrow::Array>& arrow_array,
-    std::vector<Tensor>* output_tensors);
+    std::vector<Tensor>* output_tensors, bool string_views = false);
 
 }  // namespace ArrowUtil
 }  // namespace data
@@ -14,13 +14,19 @@ limitations under the License.
 ==============================================================================*/
 #include "tensorflow/core/kernels/data/parquet_batch_reader.h"
 
+#include <algorithm>
+#include <deque>
 #include <memory>
 #include <numeric>
 #include <string>
 #include <vector>
 
 #include "absl/strings/match.h"
+#include "arrow/array/concatenate.h"
+#include "arrow/io/caching.h"
 #include "tensorflow/core/kernels/data/arrow_util.h"
+#include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/platform/mutex.h"
 
 namespace tensorflow {
 namespace data {
@@ -32,7 +38,8 @@ class ParquetBatchReader::Impl {
        const DataTypeVector& field_dtypes,
        const std::vector<int32>& field_ragged_ranks,
        const int64 partition_count, const int64 partition_index,
-       const bool drop_remainder)
+       const bool drop_remainder, const int64 num_parallel_row_groups,
+       const bool sloppy_row_groups, const bool string_views)
       : filename_(filename),
         batch_size_(batch_size),
         field_names_(field_names),
@@ -40,12 +47,29 @@ class ParquetBatchReader::Impl {
         field_ragged_ranks_(field_ragged_ranks),
         partition_count_(partition_count),
         partition_index_(partition_index),
-        drop_remainder_(drop_remainder) {}
+        drop_remainder_(drop_remainder),
+        num_parallel_row_groups_(num_parallel_row_groups),
+        sloppy_row_groups_(sloppy_row_groups),
+        string_views_(string_views) {}
+
+  ~Impl() {
+    {
+      mutex_lock l(mu_);
+      cancelled_ = true;
+    }
+    // Waits for the scheduled row groups.
+    thread_pool_.reset();
+  }
 
   Status Open() {
-    if (TF_PREDICT_TRUE(batch_reader_)) {
+    if (TF_PREDICT_TRUE(batch_reader_ || thread_pool_)) {
       return Status::OK();
     }
+    if (TF_PREDICT_FALSE(num_parallel_row_groups_ < 1)) {
+      return errors::InvalidArgument("num_parallel_row_groups ",
+                                     num_parallel_row_groups_,
+                                     " must be greater than 0");
+    }
     if (TF_PREDICT_FALSE(partition_index_ >= partition_count_)) {
       return errors::InvalidArgument("Partition index ", partition_index_,
                                      " must be smaller than partition count ",
@@ -99,12 +123,23 @@ class ParquetBatchReader::Impl {
     }
     reader_->set_batch_size(batch_size_);
 
+    if (num_parallel_row_groups_ > 1) {
+      file_ = file;
+      metadata_ = reader_->parquet_reader()->metadata();
+      thread_pool_.reset(new thread::ThreadPool(
+          Env::Default(), ThreadOptions(), "parquet_row_group_reader",
+          num_parallel_row_groups_, false /* low_latency_hint */));
+      return Status::OK();
+    }
     TF_RETURN_IF_ARROW_ERROR(reader_->GetRecordBatchReader(
         row_group_indices_, column_indices_, &batch_reader_));
     return Status::OK();
   }
 
   Status Read(std::vector<Tensor>* output_tensors) {
+    if (thread_pool_) {
+      return ReadParallel(output_tensors);
+    }
     // Read next batch from parquet file.
     std::shared_ptr<::arrow::RecordBatch> batch;
     TF_RETURN_IF_ARROW_ERROR(batch_reader_->ReadNext(&batch));
@@ -120,13 +155,256 @@ class ParquetBatchReader::Impl {
     auto arrays = batch->columns();
     for (size_t i = 0; i < arrays.size(); ++i) {
       TF_RETURN_IF_ERROR(ArrowUtil::MakeTensorsFromArrowArray(
-          field_dtypes_[i], field_ragged_ranks_[i], arrays[i], output_tensors));
+          field_dtypes_[i], field_ragged_ranks_[i], arrays[i], output_tensors,
+          string_views_));
     }
 
     return Status::OK();
   }
 
  private:
+  using RecordBatches = std::vector<std::shared_ptr<::arrow::RecordBatch>>;
+
+  // Batches of a scheduled row group. The first `offset` rows complete the
+  // batch carried over from the previous row groups, the rows after the last
+  // full batch are carried over to the next row groups.
+  struct RowGroup {
+    RowGroup(int index, int64 offset) : index(index), offset(offset) {}
+
+    const int index;
+    const int64 offset;
+    // Reader of the row group, its column chunks are prefetched once it is
+    // opened.
+    std::unique_ptr<::parquet::arrow::FileReader> reader;
+    bool done = false;
+    Status status;
+    RecordBatches head;
+    std::deque<std::vector<Tensor>> batches;
+    RecordBatches tail;
+  };
+
+  // Only the last batch of the file may be partial, so with drop_remainder
+  // the same rows are dropped as reading row groups sequentially.
+  Status ReadParallel(std::vector<Tensor>* output_tensors) {
+    while (ready_batches_.empty()) {
+      std::shared_ptr<RowGroup> row_group;
+      NextRowGroup(&row_group);
+      if (!row_group) {
+        if (pending_rows_ == 0 || drop_remainder_) {
+          return errors::OutOfRange("Reached end of parquet file ", filename_);
+        }
+        TF_RETURN_IF_ERROR(FlushPending());
+        break;
+      }
+      TF_RETURN_IF_ERROR(row_group->status);
+      TF_RETURN_IF_ERROR(AppendPending(row_group->head));
+      for (auto& batch : row_group->batches) {
+        ready_batches_.push_back(std::move(batch));
+      }
+      TF_RETURN_IF_ERROR(AppendPending(row_group->tail));
+    }
+    for (auto& tensor : ready_batches_.front()) {
+      output_tensors->push_back(std::move(tensor));
+    }
+    ready_batches_.pop_front();
+    return Status::OK();
+  }
+
+  // Waits for the next row group to produce, `row_group` is null after the
+  // last one. Row groups are opened outside `mu_`.
+  void NextRowGroup(std::shared_ptr<RowGroup>* row_group) {
+    while (true) {
+      std::vector<std::shared_ptr<RowGroup>> opening;
+      {
+        mutex_lock l(mu_);
+        ScheduleLocked(&opening);
+        if (opening.empty()) {
+          if (scheduled_.empty()) {
+            return;
+          }
+          auto it = scheduled_.begin();
+          if (sloppy_row_groups_) {
+            while (it != scheduled_.end() && !(*it)->done) ++it;
+          }
+          if (it == scheduled_.end() || !(*it)->done) {
+            cond_var_.wait(l);
+            continue;
+          }
+          *row_group = *it;
+          scheduled_.erase(it);
+          ScheduleLocked(&opening);
+        }
+      }
+      for (auto& g : opening) {
+        g->status = OpenRowGroup(g.get());
+        thread_pool_->Schedule([this, g]() { DecodeRowGroup(g); });
+      }
+      if (*row_group) {
+        return;
+      }
+    }
+  }
+
+  // Keeps `num_parallel_row_groups_` row groups decoding and as many row
+  // groups prefetching ahead of them. The new row groups are added to
+  // `opening`.
+  void ScheduleLocked(std::vector<std::shared_ptr<RowGroup>>* opening)
+      EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    while (static_cast<int64>(scheduled_.size()) <
+               2 * num_parallel_row_groups_ &&
+           next_row_group_ < row_group_indices_.size()) {
+      const int index = row_group_indices_[next_row_group_++];
+      // Sloppy row groups are produced in any order, their remainders are
+      // merged as they come.
+      int64 offset = 0;
+      if (!sloppy_row_groups_) {
+        const int64 num_rows = metadata_->RowGroup(index)->num_rows();
+        offset = (batch_size_ - carried_rows_) % batch_size_;
+        carried_rows_ = (carried_rows_ + num_rows) % batch_size_;
+      }
+      auto row_group = std::make_shared<RowGroup>(index, offset);
+      scheduled_.push_back(row_group);
+      opening->push_back(std::move(row_group));
+    }
+  }
+
+  // Opens a reader for the row group and starts to read its column chunks
+  // in the background.
+  Status OpenRowGroup(RowGroup* row_group) {
+    TF_RETURN_IF_ARROW_ERROR(
+        ArrowUtil::OpenParquetReader(&row_group->reader, file_, metadata_));
+    // The row group is decoded at once and then sliced into batches.
+    row_group->reader->set_batch_size(
+        std::max<int64>(metadata_->RowGroup(row_group->index)->num_rows(), 1));
+    row_group->reader->parquet_reader()->PreBuffer(
+        {row_group->index}, column_indices_, ::arrow::io::default_io_context(),
+        ::arrow::io::CacheOptions::Defaults());
+    return Status::OK();
+  }
+
+  void DecodeRowGroup(const std::shared_ptr<RowGroup>& row_group) {
+    RecordBatches head;
+    std::deque<std::vector<Tensor>> batches;
+    RecordBatches tail;
+    Status s;
+    {
+      mutex_lock l(mu_);
+      s = cancelled_ ? errors::Cancelled("Reading ", filename_, " cancelled")
+                     : row_group->status;
+    }
+    if (s.ok()) {
+      s = DecodeBatches(*row_group, &head, &batches, &tail);
+    }
+    row_group->reader.reset();
+    mutex_lock l(mu_);
+    row_group->status = s;
+    row_group->head.swap(head);
+    row_group->batches.swap(batches);
+    row_group->tail.swap(tail);
+    row_group->done = true;
+    cond_var_.notify_all();
+  }
+
+  Status DecodeBatches(const RowGroup& row_group, RecordBatches* head,
+                       std::deque<std::vector<Tensor>>* batches,
+                       RecordBatches* tail) {
+    std::unique_ptr<::arrow::RecordBatchReader> batch_reader;
+    TF_RETURN_IF_ARROW_ERROR(row_group.reader->GetRecordBatchReader(
+        {row_group.index}, column_indices_, &batch_reader));
+    RecordBatches record_batches;
+    int64 num_rows = 0;
+    while (true) {
+      std::shared_ptr<::arrow::RecordBatch> batch;
+      TF_RETURN_IF_ARROW_ERROR(batch_reader->ReadNext(&batch));
+      if (!batch) {
+        break;
+      }
+      num_rows += batch->num_rows();
+      record_batches.push_back(std::move(batch));
+    }
+
+    size_t batch_index = 0;
+    int64 row_offset = 0;
+    const int64 head_rows = std::min(row_group.offset, num_rows);
+    TakeRows(record_batches, head_rows, &batch_index, &row_offset, head);
+    num_rows -= head_rows;
+    for (; num_rows >= batch_size_; num_rows -= batch_size_) {
+      RecordBatches slices;
+      TakeRows(record_batches, batch_size_, &batch_index, &row_offset,
+               &slices);
+      std::vector<Tensor> tensors;
+      TF_RETURN_IF_ERROR(MakeBatchTensors(slices, &tensors));
+      batches->push_back(std::move(tensors));
+    }
+    TakeRows(record_batches, num_rows, &batch_index, &row_offset, tail);
+    return Status::OK();
+  }
+
+  // Appends slices of the next `num_rows` rows of `record_batches` from
+  // (`batch_index`, `row_offset`) to `slices`.
+  static void TakeRows(const RecordBatches& record_batches, int64 num_rows,
+                       size_t* batch_index, int64* row_offset,
+                       RecordBatches* slices) {
+    while (num_rows > 0) {
+      const auto& batch = record_batches[*batch_index];
+      const int64 n = std::min(batch->num_rows() - *row_offset, num_rows);
+      slices->push_back(batch->Slice(*row_offset, n));
+      num_rows -= n;
+      *row_offset += n;
+      if (*row_offset == batch->num_rows()) {
+        ++(*batch_index);
+        *row_offset = 0;
+      }
+    }
+  }
+
+  // Slices of one batch are concatenated only if there are more than one.
+  Status MakeBatchTensors(const RecordBatches& slices,
+                          std::vector<Tensor>* tensors) {
+    for (size_t i = 0; i < column_indices_.size(); ++i) {
+      std::shared_ptr<::arrow::Array> array = slices[0]->column(i);
+      if (slices.size() > 1) {
+        ::arrow::ArrayVector arrays;
+        for (const auto& slice : slices) {
+          arrays.push_back(slice->column(i));
+        }
+        TF_CHECKED_ARROW_ASSIGN(array, ::arrow::Concatenate(arrays));
+      }
+      TF_RETURN_IF_ERROR(ArrowUtil::MakeTensorsFromArrowArray(
+          field_dtypes_[i], field_ragged_ranks_[i], array, tensors,
+          string_views_));
+    }
+    return Status::OK();
+  }
+
+  // Adds rows carried over between row groups, every `batch_size_` rows of
+  // them make a ready batch.
+  Status AppendPending(const RecordBatches& slices) {
+    for (const auto& slice : slices) {
+      int64 offset = 0;
+      while (offset < slice->num_rows()) {
+        const int64 n =
+            std::min(slice->num_rows() - offset, batch_size_ - pending_rows_);
+        pending_.push_back(slice->Slice(offset, n));
+        pending_rows_ += n;
+        offset += n;
+        if (pending_rows_ == batch_size_) {
+          TF_RETURN_IF_ERROR(FlushPending());
+        }
+      }
+    }
+    return Status::OK();
+  }
+
+  Status FlushPending() {
+    std::vector<Tensor> tensors;
+    TF_RETURN_IF_ERROR(MakeBatchTensors(pending_, &tensors));
+    ready_batches_.push_back(std::move(tensors));
+    pending_.clear();
+    pending_rows_ = 0;
+    return Status::OK();
+  }
+
   const string filename_;
   const int64 batch_size_;
   std::vector<string> field_names_;
@@ -139,16 +417,38 @@ class ParquetBatchReader::Impl {
   std::unique_ptr<::arrow::RecordBatchReader> batch_reader_;
   std::vector<int> row_group_indices_;
   std::vector<int> column_indices_;
+
+  const int64 num_parallel_row_groups_;
+  const bool sloppy_row_groups_;
+  const bool string_views_;
+  std::shared_ptr<::arrow::io::RandomAccessFile> file_;
+  std::shared_ptr<::parquet::FileMetaData> metadata_;
+  mutex mu_;
+  condition_variable cond_var_;
+  bool cancelled_ GUARDED_BY(mu_) = false;
+  size_t next_row_group_ GUARDED_BY(mu_) = 0;
+  // Rows of the scheduled row groups after their last full batch.
+  int64 carried_rows_ GUARDED_BY(mu_) = 0;
+  std::deque<std::shared_ptr<RowGroup>> scheduled_ GUARDED_BY(mu_);
+  // Only accessed by the reading thread.
+  std::deque<std::vector<Tensor>> ready_batches_;
+  RecordBatches pending_;
+  int64 pending_rows_ = 0;
+  // Destroyed first to wait for the scheduled row groups.
+  std::unique_ptr<thread::ThreadPool> thread_pool_;
 };
 
 ParquetBatchReader::ParquetBatchReader(
     const string& filename, const int64 batch_size,
     const std::vector<string>& field_names, const DataTypeVector& field_dtypes,
     const std::vector<int32>& field_ragged_ranks, const int64 partition_count,
-    const int64 partition_index, const bool drop_remainder)
+    const int64 partition_index, const bool drop_remainder,
+    const int64 num_parallel_row_groups, const bool sloppy_row_groups,
+    const bool string_views)
     : pimpl_(new ParquetBatchReader::Impl(
           filename, batch_size, field_names, field_dtypes, field_ragged_ranks,
-          partition_count, partition_index, drop_remainder)) {}
+          partition_count, partition_index, drop_remainder,
+          num_parallel_row_groups, sloppy_row_groups, string_views)) {}
 
 Status ParquetBatchReader::Open() { return pimpl_->Open(); }
 
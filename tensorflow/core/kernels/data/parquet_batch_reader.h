@@ -24,6 +24,13 @@ limitations under the License.
 namespace tensorflow {
 namespace data {
 
+// Reads batches from the row groups of a parquet file. If
+// `num_parallel_row_groups` > 1, that many row groups are decoded
+// concurrently and the compressed column chunks of as many next row groups
+// are prefetched. Batches span row groups as reading them sequentially, and
+// the row groups are produced in order unless `sloppy_row_groups` is true. If
+// `string_views` is true, string fields are read as the uint8 bytes of the
+// strings and the splits of each string, see ArrowUtil.
 class ParquetBatchReader {
  public:
   ParquetBatchReader(const string& filename, const int64 batch_size,
@@ -31,7 +38,10 @@ class ParquetBatchReader {
                      const DataTypeVector& field_dtypes,
                      const std::vector<int32>& field_ragged_ranks,
                      const int64 partition_count, const int64 partition_index,
-                     const bool drop_remainder);
+                     const bool drop_remainder,
+                     const int64 num_parallel_row_groups = 1,
+                     const bool sloppy_row_groups = false,
+                     const bool string_views = false);
 
   Status Open();
 
@@ -38,7 +38,8 @@ class ParquetTabularDatasetOp::Dataset : public DatasetBase {
           const DataTypeVector& field_dtypes,
           const std::vector<int32>& field_ragged_ranks,
           const int64 partition_count, const int64 partition_index,
-          const bool drop_remainder)
+          const bool drop_remainder, const int64 num_parallel_row_groups,
+          const bool sloppy_row_groups, const bool string_views)
       : DatasetBase(DatasetContext(ctx)),
         filename_(std::move(filename)),
         batch_size_(batch_size),
@@ -47,14 +48,24 @@ class ParquetTabularDatasetOp::Dataset : public DatasetBase {
         field_ragged_ranks_(std::move(field_ragged_ranks)),
         partition_count_(partition_count),
         partition_index_(partition_index),
-        drop_remainder_(drop_remainder) {
+        drop_remainder_(drop_remainder),
+        num_parallel_row_groups_(num_parallel_row_groups),
+        sloppy_row_groups_(sloppy_row_groups),
+        string_views_(string_views) {
     int64 num_outputs = field_names.size();
     for (int64 i = 0; i < field_names.size(); ++i) {
-      output_dtypes_.push_back(std::move(field_dtypes[i]));
-      for (int64 j = 0; j < field_ragged_ranks_[i]; ++j) {
+      int32 ragged_rank = field_ragged_ranks_[i];
+      // A string field is output as its bytes and the splits of each string.
+      if (string_views_ && field_dtypes[i] == DT_STRING) {
+        output_dtypes_.push_back(DT_UINT8);
+        ++ragged_rank;
+      } else {
+        output_dtypes_.push_back(std::move(field_dtypes[i]));
+      }
+      for (int64 j = 0; j < ragged_rank; ++j) {
         output_dtypes_.push_back(DT_INT32);
       }
-      num_outputs += field_ragged_ranks_[i];
+      num_outputs += ragged_rank;
     }
     int64 actual_batch_size(drop_remainder ? batch_size : -1);
     for (size_t i = 0; i < num_outputs; ++i) {
@@ -64,7 +75,8 @@ class ParquetTabularDatasetOp::Dataset : public DatasetBase {
     reader_ = absl::make_unique<ParquetBatchReader>(
         filename_, batch_size_, field_names_, field_dtypes_,
         field_ragged_ranks_, partition_count_, partition_index_,
-        drop_remainder_);
+        drop_remainder_, num_parallel_row_groups_, sloppy_row_groups_,
+        string_views_);
   }
 
   Status Open() {
@@ -107,6 +119,12 @@ class ParquetTabularDatasetOp::Dataset : public DatasetBase {
     b->BuildAttrValue(partition_index_, &partition_index);
     AttrValue drop_remainder;
     b->BuildAttrValue(drop_remainder_, &drop_remainder);
+    AttrValue num_parallel_row_groups;
+    b->BuildAttrValue(num_parallel_row_groups_, &num_parallel_row_groups);
+    AttrValue sloppy_row_groups;
+    b->BuildAttrValue(sloppy_row_groups_, &sloppy_row_groups);
+    AttrValue string_views;
+    b->BuildAttrValue(string_views_, &string_views);
     TF_RETURN_IF_ERROR(
         b->AddDataset(this, {{0, filename}, {1, batch_size}}, {},
                       {{"field_names", field_names},
@@ -114,7 +132,10 @@ class ParquetTabularDatasetOp::Dataset : public DatasetBase {
                        {"field_ragged_ranks", field_ragged_ranks},
                        {"partition_count", partition_count},
                        {"partition_index", partition_index},
-                       {"drop_remainder", drop_remainder}},
+                       {"drop_remainder", drop_remainder},
+                       {"num_parallel_row_groups", num_parallel_row_groups},
+                       {"sloppy_row_groups", sloppy_row_groups},
+                       {"string_views", string_views}},
                       output));
     return Status::OK();
   }
@@ -129,6 +150,9 @@ class ParquetTabularDatasetOp::Dataset : public DatasetBase {
   const int64 partition_count_;
   const int64 partition_index_;
   const bool drop_remainder_;
+  const int64 num_parallel_row_groups_;
+  const bool sloppy_row_groups_;
+  const bool string_views_;
   DataTypeVector output_dtypes_;
   std::vector<PartialTensorShape> output_shapes_;
   std::unique_ptr<ParquetBatchReader> reader_;
@@ -181,7 +205,10 @@ ParquetTabularDatasetOp::ParquetTabularDatasetOp(OpKernelConstruction* ctx)
     : DatasetOpKernel(ctx),
       partition_count_(1),
       partition_index_(0),
-      drop_remainder_(false) {
+      drop_remainder_(false),
+      num_parallel_row_groups_(1),
+      sloppy_row_groups_(false),
+      string_views_(false) {
   OP_REQUIRES_OK(ctx, ctx->GetAttr("field_names", &field_names_));
   OP_REQUIRES_OK(ctx, ctx->GetAttr("field_dtypes", &field_dtypes_));
   OP_REQUIRES_OK(ctx,
@@ -189,6 +216,11 @@ ParquetTabularDatasetOp::ParquetTabularDatasetOp(OpKernelConstruction* ctx)
   OP_REQUIRES_OK(ctx, ctx->GetAttr("partition_count", &partition_count_));
   OP_REQUIRES_OK(ctx, ctx->GetAttr("partition_index", &partition_index_));
   OP_REQUIRES_OK(ctx, ctx->GetAttr("drop_remainder", &drop_remainder_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr("num_parallel_row_groups",
+                                   &num_parallel_row_groups_));
+  OP_REQUIRES_OK(ctx,
+                 ctx->GetAttr("sloppy_row_groups", &sloppy_row_groups_));
+  OP_REQUIRES_OK(ctx, ctx->GetAttr("string_views", &string_views_));
 }
 
 void ParquetTabularDatasetOp::MakeDataset(OpKernelContext* ctx,
@@ -203,7 +235,8 @@ void ParquetTabularDatasetOp::MakeDataset(OpKernelContext* ctx,
 
   Dataset* ds = new Dataset(
       ctx, filename, batch_size, field_names_, field_dtypes_,
-      field_ragged_ranks_, partition_count_, partition_index_, drop_remainder_);
+      field_ragged_ranks_, partition_count_, partition_index_, drop_remainder_,
+      num_parallel_row_groups_, sloppy_row_groups_, string_views_);
   OP_REQUIRES_OK(ctx, ds->Open());
   *output = ds;
 }
@@ -35,6 +35,9 @@ class ParquetTabularDatasetOp : public DatasetOpKernel {
   int64 partition_count_;
   int64 partition_index_;
   bool drop_remainder_;
+  int64 num_parallel_row_groups_;
+  bool sloppy_row_groups_;
+  bool string_views_;
 };
 
 }  // namespace data
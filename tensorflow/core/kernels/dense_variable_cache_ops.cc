@@ -0,0 +1,175 @@
+/* Copyright 2022 The DeepRec Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/lib/monitoring/counter.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+
+namespace {
+
+// Bytes of the dense variables received from the ps ("refreshed") and read
+// from the caches instead ("cached").
+auto* dense_variable_cache_bytes = monitoring::Counter<1>::New(
+    "/tensorflow/core/dense_variable_cache_bytes",
+    "Bytes of the dense variables refreshed from the ps or read from the "
+    "worker caches.",
+    "type");
+
+// The last value of a dense variable received from the ps. The value is
+// shared with the consumers, holding a reference keeps them from reusing
+// its buffer in place.
+class DenseVariableCache : public ResourceBase {
+ public:
+  string DebugString() const override {
+    tf_shared_lock l(mu_);
+    return strings::StrCat("DenseVariableCache(",
+                           value_.shape().DebugString(), ")");
+  }
+
+  void Set(const Tensor& value) {
+    mutex_lock l(mu_);
+    value_ = value;
+  }
+
+  Tensor Get() const {
+    tf_shared_lock l(mu_);
+    return value_;
+  }
+
+ private:
+  mutable mutex mu_;
+  Tensor value_ GUARDED_BY(mu_);
+};
+
+// Outputs true every `staleness` steps of the graph, starting with the
+// first one.
+class DenseVariableCacheRefreshOp : public OpKernel {
+ public:
+  explicit DenseVariableCacheRefreshOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("staleness", &staleness_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    bool refresh;
+    {
+      mutex_lock l(mu_);
+      refresh = steps_ % staleness_ == 0;
+      ++steps_;
+      if (VLOG_IS_ON(1)) {
+        // The flag is computed before the reads of a step, logs the bytes
+        // of all the caches since the previous step.
+        const int64 refreshed =
+            dense_variable_cache_bytes->GetCell("refreshed")->value();
+        const int64 cached =
+            dense_variable_cache_bytes->GetCell("cached")->value();
+        VLOG(1) << "Dense variable cache " << name() << " step " << steps_
+                << ": refreshed " << refreshed - last_refreshed_bytes_
+                << " bytes, read " << cached - last_cached_bytes_
+                << " cached bytes";
+        last_refreshed_bytes_ = refreshed;
+        last_cached_bytes_ = cached;
+      }
+    }
+    Tensor* output = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({}), &output));
+    output->scalar<bool>()() = refresh;
+  }
+
+ private:
+  int64 staleness_;
+  mutex mu_;
+  int64 steps_ GUARDED_BY(mu_) = 0;
+  int64 last_refreshed_bytes_ GUARDED_BY(mu_) = 0;
+  int64 last_cached_bytes_ GUARDED_BY(mu_) = 0;
+};
+
+class DenseVariableCacheLookupOp : public OpKernel {
+ public:
+  explicit DenseVariableCacheLookupOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("shared_name", &shared_name_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    ResourceMgr* rm = ctx->resource_manager();
+    DenseVariableCache* cache = nullptr;
+    Status s = rm->Lookup<DenseVariableCache>(rm->default_container(),
+                                              shared_name_, &cache);
+    OP_REQUIRES(ctx, s.ok(),
+                errors::FailedPrecondition(
+                    "Dense variable cache of ", shared_name_,
+                    " is read before being refreshed: ", s.error_message()));
+    core::ScopedUnref unref(cache);
+    const Tensor value = cache->Get();
+    OP_REQUIRES(ctx, value.dtype() == ctx->expected_output_dtype(0),
+                errors::InvalidArgument(
+                    "Dense variable cache of ", shared_name_, " has type ",
+                    DataTypeString(value.dtype()), ", expected ",
+                    DataTypeString(ctx->expected_output_dtype(0))));
+    dense_variable_cache_bytes->GetCell("cached")->IncrementBy(
+        value.TotalBytes());
+    ctx->set_output(0, value);
+  }
+
+ private:
+  string shared_name_;
+};
+
+class DenseVariableCacheUpdateOp : public OpKernel {
+ public:
+  explicit DenseVariableCacheUpdateOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("shared_name", &shared_name_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    ResourceMgr* rm = ctx->resource_manager();
+    DenseVariableCache* cache = nullptr;
+    OP_REQUIRES_OK(ctx, rm->LookupOrCreate<DenseVariableCache>(
+                            rm->default_container(), shared_name_, &cache,
+                            [](DenseVariableCache** ret) {
+                              *ret = new DenseVariableCache();
+                              return Status::OK();
+                            }));
+    core::ScopedUnref unref(cache);
+    const Tensor& value = ctx->input(0);
+    cache->Set(value);
+    dense_variable_cache_bytes->GetCell("refreshed")->IncrementBy(
+        value.TotalBytes());
+    VLOG(2) << "Refresh dense variable cache of " << shared_name_ << ", "
+            << value.TotalBytes() << " bytes";
+    ctx->set_output(0, value);
+  }
+
+ private:
+  string shared_name_;
+};
+
+}  // namespace
+
+REGISTER_KERNEL_BUILDER(Name("_DenseVariableCacheRefresh").Device(DEVICE_CPU),
+                        DenseVariableCacheRefreshOp);
+REGISTER_KERNEL_BUILDER(Name("_DenseVariableCacheLookup").Device(DEVICE_CPU),
+                        DenseVariableCacheLookupOp);
+REGISTER_KERNEL_BUILDER(Name("_DenseVariableCacheUpdate").Device(DEVICE_CPU),
+                        DenseVariableCacheUpdateOp);
+
+}  // namespace tensorflow
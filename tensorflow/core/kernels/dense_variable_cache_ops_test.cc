@@ -0,0 +1,120 @@
+/* Copyright 2022 The DeepRec Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/monitoring/collection_registry.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class DenseVariableCacheOpsTest : public OpsTestBase {
+ protected:
+  void MakeLookup() {
+    TF_ASSERT_OK(NodeDefBuilder("lookup", "_DenseVariableCacheLookup")
+                     .Input(FakeInput(DT_BOOL))
+                     .Attr("dtype", DT_FLOAT)
+                     .Attr("shared_name", "var")
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+    inputs_.clear();
+    AddInputFromArray<bool>(TensorShape({}), {false});
+  }
+
+  void MakeUpdate(const std::vector<float>& value) {
+    TF_ASSERT_OK(NodeDefBuilder("update", "_DenseVariableCacheUpdate")
+                     .Input(FakeInput(DT_FLOAT))
+                     .Attr("shared_name", "var")
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+    inputs_.clear();
+    AddInputFromArray<float>(TensorShape({2}), value);
+  }
+};
+
+TEST_F(DenseVariableCacheOpsTest, Refresh) {
+  TF_ASSERT_OK(NodeDefBuilder("refresh", "_DenseVariableCacheRefresh")
+                   .Attr("staleness", 3)
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  std::vector<bool> refreshes;
+  for (int step = 0; step < 7; ++step) {
+    TF_ASSERT_OK(RunOpKernel());
+    refreshes.push_back(GetOutput(0)->scalar<bool>()());
+  }
+  EXPECT_EQ(std::vector<bool>({true, false, false, true, false, false, true}),
+            refreshes);
+}
+
+TEST_F(DenseVariableCacheOpsTest, LookupUpdatedValue) {
+  MakeUpdate({1, 2});
+  TF_ASSERT_OK(RunOpKernel());
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({2}));
+  test::FillValues<float>(&expected, {1, 2});
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+
+  MakeLookup();
+  TF_ASSERT_OK(RunOpKernel());
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+
+  MakeUpdate({3, 4});
+  TF_ASSERT_OK(RunOpKernel());
+  MakeLookup();
+  TF_ASSERT_OK(RunOpKernel());
+  test::FillValues<float>(&expected, {3, 4});
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
+int64 CacheBytes(const string& type) {
+  monitoring::CollectionRegistry::CollectMetricsOptions options;
+  auto metrics =
+      monitoring::CollectionRegistry::Default()->CollectMetrics(options);
+  auto it = metrics->point_set_map.find(
+      "/tensorflow/core/dense_variable_cache_bytes");
+  if (it == metrics->point_set_map.end()) {
+    return 0;
+  }
+  for (const auto& point : it->second->points) {
+    if (point->labels.size() == 1 && point->labels[0].value == type) {
+      return point->int64_value;
+    }
+  }
+  return 0;
+}
+
+TEST_F(DenseVariableCacheOpsTest, CountBytes) {
+  const int64 refreshed = CacheBytes("refreshed");
+  const int64 cached = CacheBytes("cached");
+  MakeUpdate({1, 2});
+  TF_ASSERT_OK(RunOpKernel());
+  MakeLookup();
+  TF_ASSERT_OK(RunOpKernel());
+  TF_ASSERT_OK(RunOpKernel());
+  EXPECT_EQ(refreshed + 2 * sizeof(float), CacheBytes("refreshed"));
+  EXPECT_EQ(cached + 4 * sizeof(float), CacheBytes("cached"));
+}
+
+TEST_F(DenseVariableCacheOpsTest, LookupBeforeUpdate) {
+  MakeLookup();
+  EXPECT_TRUE(errors::IsFailedPrecondition(RunOpKernel()));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -774,6 +774,107 @@ TEST(EmbeddingVariableTest, TestBloomCounterInt8) {
   }
 }
 
+EmbeddingVar<int64, float>* CreateBloomFilterVar(DataType counter_type) {
+  int value_size = 4;
+  Tensor value(DT_FLOAT, TensorShape({value_size}));
+  test::FillValues<float>(&value, std::vector<float>(value_size, 10.0));
+  auto storage_manager = new embedding::StorageManager<int64, float>(
+                 "EmbeddingVar", embedding::StorageConfig());
+  TF_CHECK_OK(storage_manager->Init());
+  EmbeddingVar<int64, float>* var
+    = new EmbeddingVar<int64, float>("EmbeddingVar",
+        storage_manager,
+          EmbeddingConfig(0, 0, 1, 1, "", 5, 3, 99999, -1.0, "normal", 100,
+                          0.01, counter_type));
+  var->Init(value, 1);
+  return var;
+}
+
+TEST(EmbeddingVariableTest, TestBloomFilterBatchLookup) {
+  for (DataType counter_type : {DT_UINT8, DT_UINT16, DT_UINT32, DT_UINT64}) {
+    EmbeddingVar<int64, float>* var = CreateBloomFilterVar(counter_type);
+    EmbeddingVar<int64, float>* batch_var = CreateBloomFilterVar(counter_type);
+    // More ids than a block of the filter, repeated with counts.
+    std::vector<int64> keys;
+    std::vector<int32> counts;
+    for (int64 i = 0; i < 300; ++i) {
+      keys.push_back(i % 120);
+      counts.push_back(i % 3 + 1);
+    }
+    std::vector<float> default_value(var->ValueLen(), 1.0);
+    for (int round = 0; round < 3; ++round) {
+      std::vector<float> val(keys.size() * var->ValueLen());
+      std::vector<float> batch_val(keys.size() * var->ValueLen());
+      std::vector<const float*> default_value_ptrs(keys.size(),
+                                                   default_value.data());
+      for (size_t i = 0; i < keys.size(); ++i) {
+        var->LookupOrCreate(keys[i], val.data() + i * var->ValueLen(),
+                            default_value.data(), counts[i]);
+      }
+      batch_var->BatchLookupOrCreate(keys.data(), batch_val.data(),
+                                     default_value_ptrs.data(), counts.data(),
+                                     keys.size());
+      EXPECT_EQ(val, batch_val);
+      EXPECT_EQ(var->Size(), batch_var->Size());
+    }
+    for (int64 key = 0; key < 120; ++key) {
+      EXPECT_EQ(var->GetFreq(key), batch_var->GetFreq(key));
+    }
+    EXPECT_GT(var->Size(), 0);
+    var->Unref();
+    batch_var->Unref();
+  }
+}
+
+TEST(EmbeddingVariableTest, TestBlockedBloomFilter) {
+  setenv("TF_EV_BLOCKED_BLOOM_FILTER", "1", 1);
+  EmbeddingVar<int64, float>* var = CreateBloomFilterVar(DT_UINT16);
+  unsetenv("TF_EV_BLOCKED_BLOOM_FILTER");
+  std::vector<float> val(var->ValueLen());
+  std::vector<float> default_value(var->ValueLen(), 1.0);
+  for (int64 key = 0; key < 50; ++key) {
+    var->LookupOrCreate(key, val.data(), default_value.data(), 2);
+    EXPECT_EQ(default_value, val);
+  }
+  for (int64 key = 0; key < 50; ++key) {
+    EXPECT_GE(var->GetFreq(key), 2);
+    var->LookupOrCreate(key, val.data(), default_value.data(), 2);
+  }
+  // All ids reached the filter_freq, they are looked up from the variable.
+  for (int64 key = 0; key < 50; ++key) {
+    var->LookupOrCreate(key, val.data(), default_value.data(), 1);
+  }
+  EXPECT_EQ(50, var->Size());
+
+  // 32 uint16 counters in a block of 64 bytes, the counters of a key are in
+  // one block.
+  auto bloom_filter = static_cast<BloomFilter<int64, float,
+      EmbeddingVar<int64, float>>*>(var->GetFilter());
+  const uint16* counter =
+      static_cast<const uint16*>(bloom_filter->GetBloomCounter());
+  EXPECT_EQ(0, reinterpret_cast<uintptr_t>(counter) % 64);
+  const string debug_string = var->DebugString();
+  EXPECT_NE(string::npos, debug_string.find("layout: blocked"));
+  EXPECT_NE(string::npos, debug_string.find("memory_bytes: "));
+  EXPECT_NE(string::npos,
+            debug_string.find("estimated_false_positive_rate: "));
+  var->Unref();
+}
+
+TEST(EmbeddingVariableTest, TestInvalidBlockedBloomFilterEnv) {
+  // A bad value falls back to the flat layout instead of aborting.
+  setenv("TF_EV_BLOCKED_BLOOM_FILTER", "maybe", 1);
+  EmbeddingVar<int64, float>* var = CreateBloomFilterVar(DT_UINT16);
+  unsetenv("TF_EV_BLOCKED_BLOOM_FILTER");
+  std::vector<float> val(var->ValueLen());
+  std::vector<float> default_value(var->ValueLen(), 1.0);
+  var->LookupOrCreate(7, val.data(), default_value.data(), 2);
+  EXPECT_EQ(default_value, val);
+  EXPECT_GE(var->GetFreq(7), 2);
+  EXPECT_NE(string::npos, var->DebugString().find("layout: flat"));
+  var->Unref();
+}
+
 TEST(EmbeddingVariableTest, TestInsertAndLookup) {
   int64 value_size = 128;
   Tensor value(DT_INT64, TensorShape({value_size}));
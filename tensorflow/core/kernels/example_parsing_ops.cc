@@ -26,6 +26,7 @@ limitations under the License.
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/lib/gtl/array_slice.h"
 #include "tensorflow/core/platform/logging.h"
+#include "tensorflow/core/platform/mutex.h"
 #include "tensorflow/core/platform/protobuf.h"
 #include "tensorflow/core/util/example_proto_fast_parsing.h"
 #include "tensorflow/core/util/example_proto_helper.h"
@@ -131,6 +132,7 @@ class ParseExampleOp : public OpKernel {
     for (int d = 0; d < attrs_.num_sparse; ++d) {
       config.sparse.push_back({sparse_keys_t[d], attrs_.sparse_types[d]});
     }
+    OP_REQUIRES_OK(ctx, GetConfigIndex(dense_keys_t, sparse_keys_t, &config));
 
     auto serialized_t = serialized->flat<string>();
     auto names_t = names->flat<string>();
@@ -162,7 +164,30 @@ class ParseExampleOp : public OpKernel {
   }
 
  protected:
+  // The keys are usually constants, compiles the config only when they
+  // change.
+  Status GetConfigIndex(const std::vector<string>& dense_keys,
+                        const std::vector<string>& sparse_keys,
+                        example::FastParseExampleConfig* config) {
+    mutex_lock l(mu_);
+    if (config_index_ == nullptr || dense_keys != index_dense_keys_ ||
+        sparse_keys != index_sparse_keys_) {
+      TF_RETURN_IF_ERROR(example::CompileFastParseExampleConfig(config));
+      config_index_ = config->index;
+      index_dense_keys_ = dense_keys;
+      index_sparse_keys_ = sparse_keys;
+      return Status::OK();
+    }
+    config->index = config_index_;
+    return Status::OK();
+  }
+
   ParseExampleAttrs attrs_;
+  mutex mu_;
+  std::shared_ptr<const example::FastParseExampleConfigIndex> config_index_
+      GUARDED_BY(mu_);
+  std::vector<string> index_dense_keys_ GUARDED_BY(mu_);
+  std::vector<string> index_sparse_keys_ GUARDED_BY(mu_);
 };
 
 REGISTER_KERNEL_BUILDER(Name("ParseExample").Device(DEVICE_CPU),
@@ -172,6 +197,19 @@ class ParseSingleExampleOp : public OpKernel {
  public:
   explicit ParseSingleExampleOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
     OP_REQUIRES_OK(ctx, attrs_.Init(ctx));
+    // The keys are attributes, the index only depends on them.
+    example::FastParseExampleConfig config;
+    for (size_t d = 0; d < attrs_.dense_keys.size(); ++d) {
+      config.dense.push_back({attrs_.dense_keys[d], attrs_.dense_types[d],
+                              attrs_.dense_shapes[d], Tensor(),
+                              attrs_.variable_length[d],
+                              attrs_.elements_per_stride[d]});
+    }
+    for (size_t d = 0; d < attrs_.sparse_keys.size(); ++d) {
+      config.sparse.push_back({attrs_.sparse_keys[d], attrs_.sparse_types[d]});
+    }
+    OP_REQUIRES_OK(ctx, example::CompileFastParseExampleConfig(&config));
+    config_index_ = config.index;
   }
 
   void Compute(OpKernelContext* ctx) override {
@@ -222,7 +260,6 @@ class ParseSingleExampleOp : public OpKernel {
 
     example::Result result;
 
-    // TODO(mrry): Build the configuration once and cache it.
     example::FastParseExampleConfig config;
     for (int d = 0; d < attrs_.dense_keys.size(); ++d) {
       config.dense.push_back({attrs_.dense_keys[d], attrs_.dense_types[d],
@@ -233,6 +270,7 @@ class ParseSingleExampleOp : public OpKernel {
     for (int d = 0; d < attrs_.sparse_keys.size(); ++d) {
       config.sparse.push_back({attrs_.sparse_keys[d], attrs_.sparse_types[d]});
     }
+    config.index = config_index_;
 
     const string& serialized_proto = serialized->scalar<tstring>()();
 
@@ -259,6 +297,7 @@ class ParseSingleExampleOp : public OpKernel {
 
  protected:
   ParseSingleExampleAttrs attrs_;
+  std::shared_ptr<const example::FastParseExampleConfigIndex> config_index_;
 };
 
 REGISTER_KERNEL_BUILDER(Name("ParseSingleExample").Device(DEVICE_CPU),
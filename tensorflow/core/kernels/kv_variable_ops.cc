@@ -30,7 +30,9 @@ limitations under the License.
 #include "tensorflow/core/kernels/gather_functor.h"
 #include "tensorflow/core/kernels/kv_variable_ops.h"
 #include "tensorflow/core/kernels/scatter_functor.h"
+#include "tensorflow/core/kernels/string_to_hash_bucket_ali_op.h"
 #include "tensorflow/core/kernels/training_op_helpers.h"
+#include "tensorflow/core/kernels/unique_ali_op_util.h"
 #include "tensorflow/core/kernels/variable_ops.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/platform/mem.h"
@@ -450,7 +452,20 @@ class KvResourceGatherOp : public OpKernel {
     EmbeddingVar<TKey, TValue>* ev = nullptr;
     OP_REQUIRES_OK(c, LookupResource(c, HandleFromInput(c, 0), &ev));
     core::ScopedUnref unref_me(ev);
-    const Tensor& indices = c->input(1);
+
+    int32* counts = nullptr;
+    if (c->num_inputs() == 4)
+      counts = (int32*)c->input(3).data();
+
+    Gather(c, ev, c->input(1), counts, 0);
+  }
+
+ protected:
+  // Gathers the embeddings of `indices` from `ev` to the output
+  // `output_index`, the default values are taken from input 2 if
+  // is_use_default_value_tensor is set.
+  void Gather(OpKernelContext* c, EmbeddingVar<TKey, TValue>* ev,
+              const Tensor& indices, int32* counts, int output_index) {
     const int64 N = indices.NumElements();
 
     TensorShape result_shape = indices.shape();
@@ -458,11 +473,7 @@ class KvResourceGatherOp : public OpKernel {
     result_shape.AppendShape(value_shape);
 
     Tensor* out = nullptr;
-    OP_REQUIRES_OK(c, c->allocate_output(0, result_shape, &out));
-
-    int32* counts = nullptr;
-    if (c->num_inputs() == 4)
-      counts = (int32*)c->input(3).data();
+    OP_REQUIRES_OK(c, c->allocate_output(output_index, result_shape, &out));
 
     if (N > 0) {
       auto out_flat = out->shaped<TValue, 2>({N, out->NumElements() / N});
@@ -489,14 +500,19 @@ class KvResourceGatherOp : public OpKernel {
       auto do_work = [this, indices_flat,
            out_base, slice_elems, c, default_v, ev, counts] (
                int64 start, int64 limit) {
+        // The ids of a shard are looked up in one batch, so that the
+        // filter handles them together.
+        std::vector<const TValue*> default_v_ptrs(limit - start);
+        std::vector<int32> shard_counts(limit - start);
         for (int64 i = start; i < limit; ++i) {
-          TValue* default_v_ptr = get_default_v_fn_(
+          default_v_ptrs[i - start] = get_default_v_fn_(
               default_v, indices_flat(i), i, ev->GetDefaultValueDim(),
               ev->ValueLen());
-          int32 count = get_count_fn_(counts, i);
-          ev->LookupOrCreate(indices_flat(i),
-              out_base + i * slice_elems, default_v_ptr, count);
+          shard_counts[i - start] = get_count_fn_(counts, i);
         }
+        ev->BatchLookupOrCreate(&indices_flat(start),
+            out_base + start * slice_elems, default_v_ptrs.data(),
+            shard_counts.data(), limit - start);
       };
       auto worker_threads = c->device()->tensorflow_cpu_worker_threads();
       Shard(worker_threads->num_threads,
@@ -511,7 +527,6 @@ class KvResourceGatherOp : public OpKernel {
     }
   }
 
-  private:
     bool is_use_default_value_tensor_;
     std::function<
       TValue*(TValue*, TKey, int64, int64, int64)> get_default_v_fn_;
@@ -537,6 +552,94 @@ TF_CALL_REAL_NUMBER_TYPES(REGISTER_GATHER_ALL_INDICES)
 #undef REGISTER_GATHER_ALL_INDICES
 #undef REGISTER_GATHER_FULL
 
+// Hashes the strings to ids, uniques the ids and gathers their embeddings in
+// one kernel, which saves the intermediate tensors and the scheduling of
+// StringToHashBucketFast -> Unique -> KvResourceGather on the feature path.
+template <typename TValue, typename TIndex>
+class KvResourceHashUniqueGatherOp : public KvResourceGatherOp<int64, TValue> {
+ public:
+  explicit KvResourceHashUniqueGatherOp(OpKernelConstruction* c)
+      : KvResourceGatherOp<int64, TValue>(c) {
+    OP_REQUIRES_OK(c, c->GetAttr("num_buckets", &num_buckets_));
+    OP_REQUIRES_OK(c, c->GetAttr("with_counts", &with_counts_));
+    OP_REQUIRES_OK(c, ReadUniqueAliOptionsFromEnv(&unique_options_));
+    if (with_counts_) {
+      this->get_count_fn_ = [](const int32* count, int64 index) {
+        return count[index];
+      };
+    }
+  }
+
+  void Compute(OpKernelContext* c) override {
+    EmbeddingVar<int64, TValue>* ev = nullptr;
+    OP_REQUIRES_OK(c, LookupResource(c, HandleFromInput(c, 0), &ev));
+    core::ScopedUnref unref_me(ev);
+
+    const Tensor& input = c->input(1);
+    OP_REQUIRES(c, TensorShapeUtils::IsVector(input.shape()),
+                errors::InvalidArgument("input must be a vector, got shape: ",
+                                        input.shape().DebugString()));
+    Tensor ids;
+    OP_REQUIRES_OK(c, c->allocate_temp(DT_INT64, input.shape(), &ids));
+    StringToHashBucketBatch<Fingerprint64>(
+        c, input.flat<string>().data(), input.NumElements(), num_buckets_,
+        ids.flat<int64>().data());
+
+    Tensor idx;
+    Tensor unique_ids;
+    Tensor unique_counts;
+    UniqueWithoutAxis<int64, TIndex>(c, ids, &idx, &unique_ids,
+        &unique_counts, with_counts_ ? 3 : 2,
+        unique_options_.partition_size, unique_options_.serial,
+        unique_options_.unique_ratio_hint, unique_options_.map_flag);
+    if (!c->status().ok()) {
+      return;
+    }
+    c->set_output(0, unique_ids);
+    c->set_output(1, idx);
+
+    int32* counts = nullptr;
+    Tensor counts32;
+    if (with_counts_) {
+      c->set_output(2, unique_counts);
+      if (std::is_same<TIndex, int32>::value) {
+        counts = (int32*)unique_counts.data();
+      } else {
+        OP_REQUIRES_OK(c, c->allocate_temp(DT_INT32, unique_counts.shape(),
+                                           &counts32));
+        counts32.flat<int32>() =
+            unique_counts.flat<TIndex>().template cast<int32>();
+        counts = counts32.flat<int32>().data();
+      }
+    } else {
+      Tensor* empty_counts = nullptr;
+      OP_REQUIRES_OK(c, c->allocate_output(2, TensorShape({0}),
+                                           &empty_counts));
+    }
+    this->Gather(c, ev, unique_ids, counts, 3);
+  }
+
+ private:
+  int64 num_buckets_;
+  bool with_counts_;
+  UniqueAliOptions unique_options_;
+};
+
+#define REGISTER_HASH_UNIQUE_GATHER(vtype, itype)                 \
+  REGISTER_KERNEL_BUILDER(Name("_KvResourceHashUniqueGather")     \
+                              .Device(DEVICE_CPU)                 \
+                              .TypeConstraint<vtype>("dtype")     \
+                              .TypeConstraint<itype>("out_idx"),  \
+                          KvResourceHashUniqueGatherOp<vtype, itype>)
+
+#define REGISTER_HASH_UNIQUE_GATHER_ALL_INDICES(type)             \
+  REGISTER_HASH_UNIQUE_GATHER(type, int32);                       \
+  REGISTER_HASH_UNIQUE_GATHER(type, int64)
+
+TF_CALL_REAL_NUMBER_TYPES(REGISTER_HASH_UNIQUE_GATHER_ALL_INDICES)
+#undef REGISTER_HASH_UNIQUE_GATHER_ALL_INDICES
+#undef REGISTER_HASH_UNIQUE_GATHER
+
 #if GOOGLE_CUDA
 #if !TENSORFLOW_USE_GPU_EV
 template <typename TKey, typename TValue>
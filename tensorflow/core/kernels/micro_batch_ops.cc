@@ -0,0 +1,446 @@
+/* Copyright 2022 The DeepRec Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#define EIGEN_USE_THREADS
+
+#include <unordered_map>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+
+typedef Eigen::ThreadPoolDevice CPUDevice;
+
+namespace {
+
+// Gradient accumulated over the micro-batches of a step.
+struct MicroBatchGradient {
+  // The dense gradient, or the rows of a sparse gradient. For a sparse
+  // gradient, only the first num_rows rows are used.
+  Tensor sum;
+  // Sparse gradient only.
+  int64 num_rows = 0;
+  std::vector<int64> indices;
+  std::unordered_map<int64, int64> row_of_index;
+};
+
+// Accumulates the gradients of the micro-batches of a step in place. The
+// accumulated gradient is taken once every micro-batch added its gradient.
+class MicroBatchAccumulator : public ResourceBase {
+ public:
+  typedef std::function<void(const Status&, MicroBatchGradient*)> TakeCallback;
+
+  explicit MicroBatchAccumulator(int num_micro_batches)
+      : num_micro_batches_(num_micro_batches) {}
+
+  string DebugString() const override {
+    return strings::StrCat("MicroBatchAccumulator(num_micro_batches=",
+                           num_micro_batches_, ")");
+  }
+
+  // Adds the gradient of a micro-batch with `add`.
+  Status Add(const std::function<Status(MicroBatchGradient*)>& add) {
+    TakeCallback waiter;
+    MicroBatchGradient grad;
+    {
+      mutex_lock l(mu_);
+      if (aborted_) {
+        // The step failed, the gradient is dropped.
+        return Status::OK();
+      }
+      TF_RETURN_IF_ERROR(add(&grad_));
+      ++count_;
+      if (count_ < num_micro_batches_ || waiter_ == nullptr) {
+        return Status::OK();
+      }
+      TakeLocked(&grad);
+      std::swap(waiter, waiter_);
+    }
+    waiter(Status::OK(), &grad);
+    return Status::OK();
+  }
+
+  // Calls `done` with the accumulated gradient once all micro-batches added
+  // their gradients.
+  void Take(TakeCallback done) {
+    MicroBatchGradient grad;
+    Status s;
+    {
+      mutex_lock l(mu_);
+      if (aborted_) {
+        s = abort_status_;
+      } else if (waiter_ != nullptr) {
+        s = errors::FailedPrecondition(
+            "Micro-batch gradient is already being taken.");
+      } else if (count_ < num_micro_batches_) {
+        waiter_ = std::move(done);
+        return;
+      } else {
+        TakeLocked(&grad);
+      }
+    }
+    done(s, s.ok() ? &grad : nullptr);
+  }
+
+  // Fails the pending and later takes with `status` and drops the gradients
+  // added later. With `reset`, drops the accumulated gradient and accepts
+  // gradients again.
+  void Abort(const Status& status, bool reset) {
+    TakeCallback waiter;
+    {
+      mutex_lock l(mu_);
+      if (reset) {
+        aborted_ = false;
+        abort_status_ = Status::OK();
+        grad_ = MicroBatchGradient();
+        count_ = 0;
+      } else {
+        aborted_ = true;
+        abort_status_ = status;
+      }
+      std::swap(waiter, waiter_);
+    }
+    if (waiter != nullptr) {
+      waiter(status, nullptr);
+    }
+  }
+
+ private:
+  void TakeLocked(MicroBatchGradient* grad) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    *grad = std::move(grad_);
+    grad_ = MicroBatchGradient();
+    count_ = 0;
+  }
+
+  const int num_micro_batches_;
+  mutex mu_;
+  MicroBatchGradient grad_ GUARDED_BY(mu_);
+  int count_ GUARDED_BY(mu_) = 0;
+  bool aborted_ GUARDED_BY(mu_) = false;
+  Status abort_status_ GUARDED_BY(mu_);
+  TakeCallback waiter_ GUARDED_BY(mu_);
+};
+
+Status LookupOrCreateAccumulator(OpKernelContext* ctx,
+                                 const string& shared_name,
+                                 int num_micro_batches,
+                                 MicroBatchAccumulator** accumulator) {
+  ResourceMgr* rm = ctx->resource_manager();
+  return rm->LookupOrCreate<MicroBatchAccumulator>(
+      rm->default_container(), shared_name, accumulator,
+      [num_micro_batches](MicroBatchAccumulator** ret) {
+        *ret = new MicroBatchAccumulator(num_micro_batches);
+        return Status::OK();
+      });
+}
+
+class MicroBatchAccumulateOpBase : public OpKernel {
+ public:
+  explicit MicroBatchAccumulateOpBase(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("shared_name", &shared_name_));
+    OP_REQUIRES_OK(ctx,
+                   ctx->GetAttr("num_micro_batches", &num_micro_batches_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    MicroBatchAccumulator* accumulator = nullptr;
+    OP_REQUIRES_OK(ctx, LookupOrCreateAccumulator(
+                            ctx, shared_name_, num_micro_batches_,
+                            &accumulator));
+    core::ScopedUnref unref(accumulator);
+    OP_REQUIRES_OK(ctx, accumulator->Add([this, ctx](MicroBatchGradient* g) {
+      return AddGradient(ctx, g);
+    }));
+  }
+
+ protected:
+  virtual Status AddGradient(OpKernelContext* ctx, MicroBatchGradient* g) = 0;
+
+ private:
+  string shared_name_;
+  int num_micro_batches_;
+};
+
+template <typename T>
+class MicroBatchAccumulateOp : public MicroBatchAccumulateOpBase {
+ public:
+  using MicroBatchAccumulateOpBase::MicroBatchAccumulateOpBase;
+
+ protected:
+  Status AddGradient(OpKernelContext* ctx, MicroBatchGradient* g) override {
+    const Tensor& grad = ctx->input(0);
+    const CPUDevice& d = ctx->eigen_device<CPUDevice>();
+    if (!g->sum.IsInitialized()) {
+      // The first micro-batch allocates the sum, the others add to it.
+      TF_RETURN_IF_ERROR(
+          ctx->allocate_temp(DataTypeToEnum<T>::value, grad.shape(), &g->sum));
+      g->sum.flat<T>().device(d) = grad.flat<T>();
+      return Status::OK();
+    }
+    if (!g->sum.IsSameSize(grad)) {
+      return errors::InvalidArgument(
+          "Micro-batch gradients must have the same shape, got ",
+          g->sum.shape().DebugString(), " and ", grad.shape().DebugString());
+    }
+    g->sum.flat<T>().device(d) += grad.flat<T>();
+    return Status::OK();
+  }
+};
+
+template <typename T, typename Tindex>
+class MicroBatchSparseAccumulateOp : public MicroBatchAccumulateOpBase {
+ public:
+  using MicroBatchAccumulateOpBase::MicroBatchAccumulateOpBase;
+
+ protected:
+  // Rows of the same index are summed, so that the optimizer sees unique
+  // indices like with the aggregation of the duplicated graph.
+  Status AddGradient(OpKernelContext* ctx, MicroBatchGradient* g) override {
+    const Tensor& grad = ctx->input(0);
+    const Tensor& indices = ctx->input(1);
+    if (!TensorShapeUtils::IsVector(indices.shape())) {
+      return errors::InvalidArgument("indices must be a vector, got ",
+                                     indices.shape().DebugString());
+    }
+    if (grad.dims() < 1 || grad.dim_size(0) != indices.NumElements()) {
+      return errors::InvalidArgument(
+          "grad must have one row per index, got ",
+          grad.shape().DebugString(), " and ", indices.NumElements(),
+          " indices");
+    }
+    TensorShape row_shape = grad.shape();
+    row_shape.RemoveDim(0);
+    if (!g->sum.IsInitialized()) {
+      TensorShape shape = row_shape;
+      shape.InsertDim(0, std::max<int64>(indices.NumElements(), 1));
+      TF_RETURN_IF_ERROR(
+          ctx->allocate_temp(DataTypeToEnum<T>::value, shape, &g->sum));
+    } else {
+      TensorShape sum_row_shape = g->sum.shape();
+      sum_row_shape.RemoveDim(0);
+      if (sum_row_shape != row_shape) {
+        return errors::InvalidArgument(
+            "Micro-batch gradients must have the same row shape, got ",
+            sum_row_shape.DebugString(), " and ", row_shape.DebugString());
+      }
+    }
+
+    auto indices_flat = indices.flat<Tindex>();
+    auto grad_rows = grad.flat_outer_dims<T>();
+    const int64 row_size = grad_rows.dimension(1);
+    for (int64 i = 0; i < indices_flat.size(); ++i) {
+      const int64 index = indices_flat(i);
+      auto it = g->row_of_index.emplace(index, g->num_rows);
+      if (it.second) {
+        if (g->num_rows == g->sum.dim_size(0)) {
+          TF_RETURN_IF_ERROR(Grow(ctx, g));
+        }
+        g->indices.push_back(index);
+        ++g->num_rows;
+      }
+      T* row = g->sum.flat_outer_dims<T>().data() + it.first->second * row_size;
+      const T* grad_row = grad_rows.data() + i * row_size;
+      if (it.second) {
+        std::copy(grad_row, grad_row + row_size, row);
+      } else {
+        for (int64 j = 0; j < row_size; ++j) {
+          row[j] += grad_row[j];
+        }
+      }
+    }
+    return Status::OK();
+  }
+
+ private:
+  // Doubles the number of rows of the sum.
+  Status Grow(OpKernelContext* ctx, MicroBatchGradient* g) {
+    TensorShape shape = g->sum.shape();
+    shape.set_dim(0, shape.dim_size(0) * 2);
+    Tensor sum;
+    TF_RETURN_IF_ERROR(
+        ctx->allocate_temp(DataTypeToEnum<T>::value, shape, &sum));
+    auto old_flat = g->sum.flat<T>();
+    std::copy(old_flat.data(), old_flat.data() + old_flat.size(),
+              sum.flat<T>().data());
+    g->sum = sum;
+    return Status::OK();
+  }
+};
+
+class MicroBatchTakeOpBase : public AsyncOpKernel {
+ public:
+  explicit MicroBatchTakeOpBase(OpKernelConstruction* ctx)
+      : AsyncOpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("shared_name", &shared_name_));
+    OP_REQUIRES_OK(ctx,
+                   ctx->GetAttr("num_micro_batches", &num_micro_batches_));
+  }
+
+  void ComputeAsync(OpKernelContext* ctx, DoneCallback done) override {
+    MicroBatchAccumulator* accumulator = nullptr;
+    OP_REQUIRES_OK_ASYNC(ctx,
+                         LookupOrCreateAccumulator(ctx, shared_name_,
+                                                   num_micro_batches_,
+                                                   &accumulator),
+                         done);
+
+    CancellationManager* cm = ctx->cancellation_manager();
+    CancellationToken token = CancellationManager::kInvalidToken;
+    if (cm != nullptr) {
+      token = cm->get_cancellation_token();
+      bool already_cancelled = !cm->RegisterCallback(token, [accumulator]() {
+        accumulator->Abort(errors::Cancelled("Step was cancelled."),
+                           false /* reset */);
+      });
+      if (already_cancelled) {
+        accumulator->Unref();
+        ctx->SetStatus(errors::Cancelled("Step was cancelled."));
+        done();
+        return;
+      }
+    }
+
+    accumulator->Take([this, ctx, done, accumulator, cm, token](
+                          const Status& s, MicroBatchGradient* grad) {
+      if (cm != nullptr) {
+        // May run in the cancellation callback, which can't be waited for.
+        cm->TryDeregisterCallback(token);
+      }
+      if (s.ok()) {
+        ctx->SetStatus(SetOutputs(ctx, grad));
+      } else {
+        ctx->SetStatus(s);
+      }
+      accumulator->Unref();
+      done();
+    });
+  }
+
+ protected:
+  virtual Status SetOutputs(OpKernelContext* ctx, MicroBatchGradient* g) = 0;
+
+ private:
+  string shared_name_;
+  int num_micro_batches_;
+};
+
+class MicroBatchTakeOp : public MicroBatchTakeOpBase {
+ public:
+  using MicroBatchTakeOpBase::MicroBatchTakeOpBase;
+
+ protected:
+  Status SetOutputs(OpKernelContext* ctx, MicroBatchGradient* g) override {
+    ctx->set_output(0, g->sum);
+    return Status::OK();
+  }
+};
+
+template <typename Tindex>
+class MicroBatchSparseTakeOp : public MicroBatchTakeOpBase {
+ public:
+  using MicroBatchTakeOpBase::MicroBatchTakeOpBase;
+
+ protected:
+  Status SetOutputs(OpKernelContext* ctx, MicroBatchGradient* g) override {
+    // Slicing from the first row keeps the rows aligned.
+    ctx->set_output(0, g->sum.Slice(0, g->num_rows));
+    Tensor* indices = nullptr;
+    TF_RETURN_IF_ERROR(
+        ctx->allocate_output(1, TensorShape({g->num_rows}), &indices));
+    auto indices_flat = indices->flat<Tindex>();
+    for (int64 i = 0; i < g->num_rows; ++i) {
+      indices_flat(i) = static_cast<Tindex>(g->indices[i]);
+    }
+    return Status::OK();
+  }
+};
+
+class MicroBatchAbortOp : public OpKernel {
+ public:
+  explicit MicroBatchAbortOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("shared_name", &shared_name_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("reset", &reset_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    ResourceMgr* rm = ctx->resource_manager();
+    MicroBatchAccumulator* accumulator = nullptr;
+    Status s = rm->Lookup<MicroBatchAccumulator>(rm->default_container(),
+                                                 shared_name_, &accumulator);
+    if (errors::IsNotFound(s)) {
+      // No micro-batch ran yet.
+      return;
+    }
+    OP_REQUIRES_OK(ctx, s);
+    core::ScopedUnref unref(accumulator);
+    accumulator->Abort(errors::Aborted("A micro-batch of the step failed."),
+                       reset_);
+  }
+
+ private:
+  string shared_name_;
+  bool reset_;
+};
+
+}  // namespace
+
+#define REGISTER_KERNELS(T)                                          \
+  REGISTER_KERNEL_BUILDER(Name("_MicroBatchAccumulate")              \
+                              .Device(DEVICE_CPU)                    \
+                              .TypeConstraint<T>("T"),               \
+                          MicroBatchAccumulateOp<T>);                \
+  REGISTER_KERNEL_BUILDER(                                           \
+      Name("_MicroBatchTake").Device(DEVICE_CPU).TypeConstraint<T>("T"), \
+      MicroBatchTakeOp);
+
+TF_CALL_half(REGISTER_KERNELS);
+TF_CALL_bfloat16(REGISTER_KERNELS);
+TF_CALL_float(REGISTER_KERNELS);
+TF_CALL_double(REGISTER_KERNELS);
+#undef REGISTER_KERNELS
+
+#define REGISTER_KERNELS(T, Tindex)                                 \
+  REGISTER_KERNEL_BUILDER(Name("_MicroBatchSparseAccumulate")       \
+                              .Device(DEVICE_CPU)                   \
+                              .TypeConstraint<T>("T")               \
+                              .TypeConstraint<Tindex>("Tindices"),  \
+                          MicroBatchSparseAccumulateOp<T, Tindex>); \
+  REGISTER_KERNEL_BUILDER(Name("_MicroBatchSparseTake")             \
+                              .Device(DEVICE_CPU)                   \
+                              .TypeConstraint<T>("T")               \
+                              .TypeConstraint<Tindex>("Tindices"),  \
+                          MicroBatchSparseTakeOp<Tindex>);
+#define REGISTER_CPU_KERNELS(T) \
+  REGISTER_KERNELS(T, int32);   \
+  REGISTER_KERNELS(T, int64);
+
+TF_CALL_half(REGISTER_CPU_KERNELS);
+TF_CALL_bfloat16(REGISTER_CPU_KERNELS);
+TF_CALL_float(REGISTER_CPU_KERNELS);
+TF_CALL_double(REGISTER_CPU_KERNELS);
+#undef REGISTER_CPU_KERNELS
+#undef REGISTER_KERNELS
+
+REGISTER_KERNEL_BUILDER(Name("_MicroBatchAbort").Device(DEVICE_CPU),
+                        MicroBatchAbortOp);
+
+}  // namespace tensorflow
@@ -0,0 +1,147 @@
+/* Copyright 2022 The DeepRec Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class MicroBatchOpsTest : public OpsTestBase {
+ protected:
+  void AddDense(const TensorShape& shape, const std::vector<float>& grad) {
+    TF_ASSERT_OK(NodeDefBuilder("accumulate", "_MicroBatchAccumulate")
+                     .Input(FakeInput(DT_FLOAT))
+                     .Attr("shared_name", "accumulator")
+                     .Attr("num_micro_batches", 2)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+    inputs_.clear();
+    AddInputFromArray<float>(shape, grad);
+    TF_ASSERT_OK(RunOpKernel());
+  }
+
+  void AddSparse(const std::vector<int64>& indices,
+                 const std::vector<float>& grad) {
+    TF_ASSERT_OK(NodeDefBuilder("accumulate", "_MicroBatchSparseAccumulate")
+                     .Input(FakeInput(DT_FLOAT))
+                     .Input(FakeInput(DT_INT64))
+                     .Attr("shared_name", "accumulator")
+                     .Attr("num_micro_batches", 2)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+    inputs_.clear();
+    const int64 num_rows = indices.size();
+    AddInputFromArray<float>(TensorShape({num_rows, 2}), grad);
+    AddInputFromArray<int64>(TensorShape({num_rows}), indices);
+    TF_ASSERT_OK(RunOpKernel());
+  }
+
+  Status TakeDense() {
+    TF_CHECK_OK(NodeDefBuilder("take", "_MicroBatchTake")
+                    .Attr("T", DT_FLOAT)
+                    .Attr("shared_name", "accumulator")
+                    .Attr("num_micro_batches", 2)
+                    .Finalize(node_def()));
+    TF_CHECK_OK(InitOp());
+    inputs_.clear();
+    return RunOpKernel();
+  }
+
+  void Abort(bool reset) {
+    TF_ASSERT_OK(NodeDefBuilder("abort", "_MicroBatchAbort")
+                     .Attr("shared_name", "accumulator")
+                     .Attr("reset", reset)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+    inputs_.clear();
+    TF_ASSERT_OK(RunOpKernel());
+  }
+};
+
+TEST_F(MicroBatchOpsTest, SumDenseGradients) {
+  AddDense(TensorShape({2, 2}), {1, 2, 3, 4});
+  AddDense(TensorShape({2, 2}), {10, 20, 30, 40});
+  TF_ASSERT_OK(TakeDense());
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({2, 2}));
+  test::FillValues<float>(&expected, {11, 22, 33, 44});
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+
+  // The next step starts from zero.
+  AddDense(TensorShape({2, 2}), {1, 1, 1, 1});
+  AddDense(TensorShape({2, 2}), {1, 1, 1, 1});
+  TF_ASSERT_OK(TakeDense());
+  test::FillValues<float>(&expected, {2, 2, 2, 2});
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
+TEST_F(MicroBatchOpsTest, MergeSparseGradients) {
+  AddSparse({3, 5}, {1, 2, 3, 4});
+  AddSparse({5, 7, 3}, {10, 20, 30, 40, 50, 60});
+
+  TF_ASSERT_OK(NodeDefBuilder("take", "_MicroBatchSparseTake")
+                   .Attr("T", DT_FLOAT)
+                   .Attr("Tindices", DT_INT64)
+                   .Attr("shared_name", "accumulator")
+                   .Attr("num_micro_batches", 2)
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  inputs_.clear();
+  TF_ASSERT_OK(RunOpKernel());
+
+  Tensor expected_grad(allocator(), DT_FLOAT, TensorShape({3, 2}));
+  test::FillValues<float>(&expected_grad, {51, 62, 13, 24, 30, 40});
+  test::ExpectTensorEqual<float>(expected_grad, *GetOutput(0));
+  Tensor expected_indices(allocator(), DT_INT64, TensorShape({3}));
+  test::FillValues<int64>(&expected_indices, {3, 5, 7});
+  test::ExpectTensorEqual<int64>(expected_indices, *GetOutput(1));
+}
+
+TEST_F(MicroBatchOpsTest, AbortAndReset) {
+  AddDense(TensorShape({2}), {1, 2});
+  Abort(false /* reset */);
+  // Gradients of the failed step are dropped and the take fails.
+  AddDense(TensorShape({2}), {3, 4});
+  EXPECT_TRUE(errors::IsAborted(TakeDense()));
+
+  Abort(true /* reset */);
+  AddDense(TensorShape({2}), {1, 2});
+  AddDense(TensorShape({2}), {3, 4});
+  TF_ASSERT_OK(TakeDense());
+  Tensor expected(allocator(), DT_FLOAT, TensorShape({2}));
+  test::FillValues<float>(&expected, {4, 6});
+  test::ExpectTensorEqual<float>(expected, *GetOutput(0));
+}
+
+TEST_F(MicroBatchOpsTest, MismatchedShapes) {
+  AddDense(TensorShape({2}), {1, 2});
+  TF_ASSERT_OK(NodeDefBuilder("accumulate", "_MicroBatchAccumulate")
+                   .Input(FakeInput(DT_FLOAT))
+                   .Attr("shared_name", "accumulator")
+                   .Attr("num_micro_batches", 2)
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  inputs_.clear();
+  AddInputFromArray<float>(TensorShape({3}), {1, 2, 3});
+  EXPECT_TRUE(errors::IsInvalidArgument(RunOpKernel()));
+}
+
+}  // namespace
+}  // namespace tensorflow
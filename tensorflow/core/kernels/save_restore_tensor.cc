@@ -539,7 +539,7 @@ Status InsertTable(
     int64 size = table->GetIdsWithoutResize(
         &real_key[0], &real_id[0], real_key.size());
     for (size_t j = 0; j < tensibles.size(); j++) {
-      tensibles[j]->ZeroCostResize(size);
+      TF_RETURN_IF_ERROR(tensibles[j]->ZeroCostResize(size));
     }
     real_offset.push_back(-1);
     int64 idx = 0;
@@ -0,0 +1,302 @@
+/* Copyright 2022 The DeepRec Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include <algorithm>
+#include <limits>
+#include <list>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "tensorflow/core/framework/op_kernel.h"
+#include "tensorflow/core/framework/register_types.h"
+#include "tensorflow/core/framework/resource_mgr.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/lib/core/coding.h"
+#include "tensorflow/core/lib/core/errors.h"
+#include "tensorflow/core/platform/mutex.h"
+
+namespace tensorflow {
+
+namespace {
+
+// The encoded indices are the number of unique indices, the zigzag encoded
+// first index and the deltas to the previous index, all as varints. The
+// indices are sorted, so the deltas are non-negative and small for the
+// clustered ids of an embedding.
+inline uint64 ZigZagEncode(int64 v) {
+  return (static_cast<uint64>(v) << 1) ^ static_cast<uint64>(v >> 63);
+}
+
+inline int64 ZigZagDecode(uint64 v) {
+  return static_cast<int64>(v >> 1) ^ -static_cast<int64>(v & 1);
+}
+
+// Quantization error of the rows sent so far, added to the rows of the same
+// index in the next step so that the error does not accumulate in the
+// variable. Only the residuals of the most recently sent indices are kept,
+// the error of an evicted index is dropped.
+class SparseGradientResidual : public ResourceBase {
+ public:
+  string DebugString() const override {
+    tf_shared_lock l(mu_);
+    return strings::StrCat("SparseGradientResidual(size=", residual_.size(),
+                           ")");
+  }
+
+  mutex* mu() { return &mu_; }
+
+  // Returns the residual of `index`, which becomes the most recently used.
+  std::vector<float>* Lookup(int64 index) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    auto it = residual_.find(index);
+    if (it == residual_.end()) {
+      lru_.push_front(index);
+      it = residual_.emplace(index, Entry()).first;
+      it->second.lru_pos = lru_.begin();
+    } else {
+      lru_.splice(lru_.begin(), lru_, it->second.lru_pos);
+    }
+    return &it->second.error;
+  }
+
+  // Evicts the least recently used residuals until at most `capacity` are
+  // left.
+  void Evict(int64 capacity) EXCLUSIVE_LOCKS_REQUIRED(mu_) {
+    while (static_cast<int64>(lru_.size()) > capacity) {
+      residual_.erase(lru_.back());
+      lru_.pop_back();
+    }
+  }
+
+ private:
+  struct Entry {
+    std::vector<float> error;
+    std::list<int64>::iterator lru_pos;
+  };
+
+  mutable mutex mu_;
+  std::unordered_map<int64, Entry> residual_ GUARDED_BY(mu_);
+  std::list<int64> lru_ GUARDED_BY(mu_);
+};
+
+template <typename Tindex, typename Tvalue>
+class SparseGradientEncodeOp : public OpKernel {
+ public:
+  explicit SparseGradientEncodeOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("shared_name", &shared_name_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("error_feedback", &error_feedback_));
+    OP_REQUIRES_OK(ctx,
+                   ctx->GetAttr("max_residual_rows", &max_residual_rows_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& grad = ctx->input(0);
+    const Tensor& indices = ctx->input(1);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsVector(indices.shape()),
+                errors::InvalidArgument("indices must be a vector, got ",
+                                        indices.shape().DebugString()));
+    OP_REQUIRES(ctx,
+                grad.dims() >= 1 && grad.dim_size(0) == indices.NumElements(),
+                errors::InvalidArgument(
+                    "grad must have one row per index, got ",
+                    grad.shape().DebugString(), " and ",
+                    indices.NumElements(), " indices"));
+
+    // Sorts the rows by index, duplicated indices are summed below.
+    auto indices_flat = indices.flat<Tindex>();
+    const int64 n = indices_flat.size();
+    std::vector<std::pair<int64, int64>> order(n);
+    for (int64 i = 0; i < n; ++i) {
+      order[i] = std::make_pair(static_cast<int64>(indices_flat(i)), i);
+    }
+    std::sort(order.begin(), order.end());
+    int64 num_unique = 0;
+    for (int64 i = 0; i < n; ++i) {
+      if (i == 0 || order[i].first != order[i - 1].first) ++num_unique;
+    }
+
+    string encoded;
+    core::PutVarint64(&encoded, num_unique);
+    TensorShape values_shape = grad.shape();
+    values_shape.set_dim(0, num_unique);
+    Tensor* values = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(1, values_shape, &values));
+
+    auto grad_rows = grad.flat_outer_dims<float>();
+    Tvalue* out = values->flat<Tvalue>().data();
+    if (error_feedback_) {
+      ResourceMgr* rm = ctx->resource_manager();
+      SparseGradientResidual* residual = nullptr;
+      OP_REQUIRES_OK(ctx, rm->LookupOrCreate<SparseGradientResidual>(
+                              rm->default_container(), shared_name_,
+                              &residual, [](SparseGradientResidual** ret) {
+                                *ret = new SparseGradientResidual();
+                                return Status::OK();
+                              }));
+      core::ScopedUnref unref(residual);
+      mutex_lock l(*residual->mu());
+      Status s = EncodeRows(grad_rows, order, residual, &encoded, out);
+      residual->Evict(max_residual_rows_);
+      OP_REQUIRES_OK(ctx, s);
+    } else {
+      OP_REQUIRES_OK(ctx,
+                     EncodeRows(grad_rows, order, nullptr, &encoded, out));
+    }
+
+    Tensor* encoded_indices = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(
+                            0, TensorShape({static_cast<int64>(encoded.size())}),
+                            &encoded_indices));
+    std::copy(encoded.begin(), encoded.end(),
+              encoded_indices->flat<uint8>().data());
+  }
+
+ private:
+  // Appends the encoded indices to `encoded` and writes the summed and
+  // quantized rows to `out`, adding and updating `residual` if not null,
+  // whose mutex is held by the caller.
+  Status EncodeRows(
+      typename TTypes<float>::ConstMatrix grad_rows,
+      const std::vector<std::pair<int64, int64>>& order,
+      SparseGradientResidual* residual, string* encoded, Tvalue* out)
+      NO_THREAD_SAFETY_ANALYSIS {
+    const int64 n = order.size();
+    const int64 row_size = grad_rows.dimension(1);
+    std::vector<float> row(row_size);
+    int64 prev = 0;
+    for (int64 i = 0; i < n;) {
+      const int64 index = order[i].first;
+      if (i == 0) {
+        core::PutVarint64(encoded, ZigZagEncode(index));
+      } else {
+        core::PutVarint64(encoded, static_cast<uint64>(index) -
+                                       static_cast<uint64>(prev));
+      }
+      prev = index;
+
+      std::fill(row.begin(), row.end(), 0.0f);
+      for (; i < n && order[i].first == index; ++i) {
+        const float* src = &grad_rows(order[i].second, 0);
+        for (int64 j = 0; j < row_size; ++j) row[j] += src[j];
+      }
+      std::vector<float>* error = nullptr;
+      if (residual != nullptr) {
+        error = residual->Lookup(index);
+        if (error->empty()) {
+          error->resize(row_size, 0.0f);
+        } else if (static_cast<int64>(error->size()) != row_size) {
+          return errors::InvalidArgument(
+              "Row size of the sparse gradient changed from ", error->size(),
+              " to ", row_size, " for ", shared_name_);
+        }
+        for (int64 j = 0; j < row_size; ++j) row[j] += (*error)[j];
+      }
+      for (int64 j = 0; j < row_size; ++j) {
+        out[j] = static_cast<Tvalue>(row[j]);
+      }
+      if (error != nullptr) {
+        for (int64 j = 0; j < row_size; ++j) {
+          (*error)[j] = row[j] - static_cast<float>(out[j]);
+        }
+      }
+      out += row_size;
+    }
+    return Status::OK();
+  }
+
+  string shared_name_;
+  bool error_feedback_;
+  int64 max_residual_rows_;
+};
+
+template <typename Tindex, typename Tvalue>
+class SparseGradientDecodeOp : public OpKernel {
+ public:
+  explicit SparseGradientDecodeOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    const Tensor& encoded = ctx->input(0);
+    const Tensor& values = ctx->input(1);
+    OP_REQUIRES(ctx, TensorShapeUtils::IsVector(encoded.shape()),
+                errors::InvalidArgument("encoded_indices must be a vector, got ",
+                                        encoded.shape().DebugString()));
+    OP_REQUIRES(ctx, values.dims() >= 1,
+                errors::InvalidArgument("values must be at least a vector"));
+
+    const char* p = reinterpret_cast<const char*>(encoded.flat<uint8>().data());
+    const char* limit = p + encoded.NumElements();
+    uint64 num_unique = 0;
+    p = core::GetVarint64Ptr(p, limit, &num_unique);
+    OP_REQUIRES(ctx, p != nullptr,
+                errors::DataLoss("Truncated sparse gradient indices"));
+    OP_REQUIRES(ctx, num_unique == values.dim_size(0),
+                errors::InvalidArgument(
+                    "Sparse gradient has ", num_unique, " indices and ",
+                    values.dim_size(0), " rows"));
+
+    Tensor* indices = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(
+                            1, TensorShape({values.dim_size(0)}), &indices));
+    auto indices_flat = indices->flat<Tindex>();
+    int64 index = 0;
+    for (int64 i = 0; i < indices_flat.size(); ++i) {
+      uint64 v = 0;
+      p = core::GetVarint64Ptr(p, limit, &v);
+      OP_REQUIRES(ctx, p != nullptr,
+                  errors::DataLoss("Truncated sparse gradient indices"));
+      index = i == 0 ? ZigZagDecode(v)
+                     : static_cast<int64>(static_cast<uint64>(index) + v);
+      OP_REQUIRES(ctx,
+                  index >= std::numeric_limits<Tindex>::min() &&
+                      index <= std::numeric_limits<Tindex>::max(),
+                  errors::InvalidArgument("Sparse gradient index ", index,
+                                          " is out of range"));
+      indices_flat(i) = static_cast<Tindex>(index);
+    }
+    OP_REQUIRES(ctx, p == limit,
+                errors::DataLoss("Trailing bytes in sparse gradient indices"));
+
+    Tensor* grad = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, values.shape(), &grad));
+    grad->flat<float>() = values.flat<Tvalue>().template cast<float>();
+  }
+};
+
+}  // namespace
+
+#define REGISTER_KERNELS(Tindex, Tvalue)                                \
+  REGISTER_KERNEL_BUILDER(Name("_SparseGradientEncode")                 \
+                              .Device(DEVICE_CPU)                       \
+                              .TypeConstraint<Tindex>("Tindices")       \
+                              .TypeConstraint<Tvalue>("Tvalues"),       \
+                          SparseGradientEncodeOp<Tindex, Tvalue>);      \
+  REGISTER_KERNEL_BUILDER(Name("_SparseGradientDecode")                 \
+                              .Device(DEVICE_CPU)                       \
+                              .TypeConstraint<Tindex>("Tindices")       \
+                              .TypeConstraint<Tvalue>("Tvalues"),       \
+                          SparseGradientDecodeOp<Tindex, Tvalue>);
+
+#define REGISTER_CPU_KERNELS(Tvalue) \
+  REGISTER_KERNELS(int32, Tvalue);   \
+  REGISTER_KERNELS(int64, Tvalue);
+
+TF_CALL_half(REGISTER_CPU_KERNELS);
+TF_CALL_bfloat16(REGISTER_CPU_KERNELS);
+
+#undef REGISTER_CPU_KERNELS
+#undef REGISTER_KERNELS
+
+}  // namespace tensorflow
@@ -0,0 +1,156 @@
+/* Copyright 2022 The DeepRec Authors. All Rights Reserved.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+==============================================================================*/
+
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
+#include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/kernels/ops_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/platform/test.h"
+
+namespace tensorflow {
+namespace {
+
+class SparseGradientCompressionOpsTest : public OpsTestBase {
+ protected:
+  // Encodes and decodes the sparse gradient, the decoded gradient and
+  // indices are the outputs 0 and 1.
+  Status RoundTrip(DataType values_type, bool error_feedback,
+                   const TensorShape& shape, const std::vector<float>& grad,
+                   const std::vector<int64>& indices,
+                   int64 max_residual_rows = 1 << 20) {
+    TF_CHECK_OK(NodeDefBuilder("encode", "_SparseGradientEncode")
+                    .Input(FakeInput(DT_FLOAT))
+                    .Input(FakeInput(DT_INT64))
+                    .Attr("Tvalues", values_type)
+                    .Attr("shared_name", "grad")
+                    .Attr("error_feedback", error_feedback)
+                    .Attr("max_residual_rows", max_residual_rows)
+                    .Finalize(node_def()));
+    TF_CHECK_OK(InitOp());
+    inputs_.clear();
+    AddInputFromArray<float>(shape, grad);
+    AddInputFromArray<int64>(TensorShape({shape.dim_size(0)}), indices);
+    TF_RETURN_IF_ERROR(RunOpKernel());
+    const Tensor encoded = *GetOutput(0);
+    const Tensor values = *GetOutput(1);
+
+    TF_CHECK_OK(NodeDefBuilder("decode", "_SparseGradientDecode")
+                    .Input(FakeInput(DT_UINT8))
+                    .Input(FakeInput(values_type))
+                    .Attr("Tindices", DT_INT64)
+                    .Finalize(node_def()));
+    TF_CHECK_OK(InitOp());
+    inputs_.clear();
+    AddInputFromArray<uint8>(encoded.shape(), encoded.flat<uint8>());
+    if (values_type == DT_HALF) {
+      AddInputFromArray<Eigen::half>(values.shape(),
+                                     values.flat<Eigen::half>());
+    } else {
+      AddInputFromArray<bfloat16>(values.shape(), values.flat<bfloat16>());
+    }
+    return RunOpKernel();
+  }
+};
+
+TEST_F(SparseGradientCompressionOpsTest, DeduplicateAndSortIndices) {
+  for (DataType values_type : {DT_HALF, DT_BFLOAT16}) {
+    TF_ASSERT_OK(RoundTrip(values_type, false /* error_feedback */,
+                           TensorShape({4, 2}), {1, 2, 3, 4, 5, 6, 7, 8},
+                           {100, -3, 100, 1LL << 40}));
+    Tensor expected_grad(allocator(), DT_FLOAT, TensorShape({3, 2}));
+    test::FillValues<float>(&expected_grad, {3, 4, 6, 8, 7, 8});
+    test::ExpectTensorEqual<float>(expected_grad, *GetOutput(0));
+    Tensor expected_indices(allocator(), DT_INT64, TensorShape({3}));
+    test::FillValues<int64>(&expected_indices, {-3, 100, 1LL << 40});
+    test::ExpectTensorEqual<int64>(expected_indices, *GetOutput(1));
+  }
+}
+
+TEST_F(SparseGradientCompressionOpsTest, EmptyGradient) {
+  TF_ASSERT_OK(RoundTrip(DT_HALF, true /* error_feedback */,
+                         TensorShape({0, 2}), {}, {}));
+  EXPECT_EQ(TensorShape({0, 2}), GetOutput(0)->shape());
+  EXPECT_EQ(TensorShape({0}), GetOutput(1)->shape());
+}
+
+TEST_F(SparseGradientCompressionOpsTest, ErrorFeedback) {
+  // 1 + 2^-9 is not a bfloat16, its rounding error is carried to the next
+  // steps until the sum of the sent values catches up.
+  const float value = 1.0f + 1.0f / 512;
+  float sum = 0;
+  for (int step = 0; step < 4; ++step) {
+    TF_ASSERT_OK(RoundTrip(DT_BFLOAT16, true /* error_feedback */,
+                           TensorShape({1, 1}), {value}, {5}));
+    sum += GetOutput(0)->flat<float>()(0);
+  }
+  EXPECT_EQ(4 * value, sum);
+
+  sum = 0;
+  for (int step = 0; step < 4; ++step) {
+    TF_ASSERT_OK(RoundTrip(DT_BFLOAT16, false /* error_feedback */,
+                           TensorShape({1, 1}), {value}, {5}));
+    sum += GetOutput(0)->flat<float>()(0);
+  }
+  EXPECT_EQ(4.0f, sum);
+}
+
+TEST_F(SparseGradientCompressionOpsTest, EvictResidual) {
+  const float value = 1.0f + 1.0f / 512;
+  // Only the residual of the last sent index is kept, the rounding error of
+  // index 5 is evicted by index 6 before 5 is sent again.
+  float sum = 0;
+  for (int step = 0; step < 4; ++step) {
+    TF_ASSERT_OK(RoundTrip(DT_BFLOAT16, true /* error_feedback */,
+                           TensorShape({1, 1}), {value}, {5},
+                           1 /* max_residual_rows */));
+    sum += GetOutput(0)->flat<float>()(0);
+    TF_ASSERT_OK(RoundTrip(DT_BFLOAT16, true /* error_feedback */,
+                           TensorShape({1, 1}), {value}, {6},
+                           1 /* max_residual_rows */));
+  }
+  EXPECT_EQ(4.0f, sum);
+
+  // Both residuals are kept.
+  sum = 0;
+  for (int step = 0; step < 4; ++step) {
+    TF_ASSERT_OK(RoundTrip(DT_BFLOAT16, true /* error_feedback */,
+                           TensorShape({1, 1}), {value}, {7},
+                           2 /* max_residual_rows */));
+    sum += GetOutput(0)->flat<float>()(0);
+    TF_ASSERT_OK(RoundTrip(DT_BFLOAT16, true /* error_feedback */,
+                           TensorShape({1, 1}), {value}, {8},
+                           2 /* max_residual_rows */));
+  }
+  EXPECT_EQ(4 * value, sum);
+}
+
+TEST_F(SparseGradientCompressionOpsTest, TruncatedIndices) {
+  TF_ASSERT_OK(NodeDefBuilder("decode", "_SparseGradientDecode")
+                   .Input(FakeInput(DT_UINT8))
+                   .Input(FakeInput(DT_HALF))
+                   .Attr("Tindices", DT_INT32)
+                   .Finalize(node_def()));
+  TF_ASSERT_OK(InitOp());
+  // Two indices, only the first one is encoded.
+  AddInputFromArray<uint8>(TensorShape({2}), {2, 4});
+  AddInputFromArray<Eigen::half>(TensorShape({2}),
+                                 {Eigen::half(1.0f), Eigen::half(2.0f)});
+  EXPECT_TRUE(errors::IsDataLoss(RunOpKernel()));
+}
+
+}  // namespace
+}  // namespace tensorflow
@@ -23,6 +23,15 @@ namespace tensorflow {
 REGISTER_KERNEL_BUILDER(Name("StringToHashBucketFast").Device(DEVICE_CPU),
                         StringToHashBucketBatchAliOp<Fingerprint64>);
 
+REGISTER_KERNEL_BUILDER(Name("StringViewToHashBucketFast")
+                            .Device(DEVICE_CPU)
+                            .TypeConstraint<int32>("Tsplits"),
+                        StringViewToHashBucketAliOp<Fingerprint64, int32>);
+REGISTER_KERNEL_BUILDER(Name("StringViewToHashBucketFast")
+                            .Device(DEVICE_CPU)
+                            .TypeConstraint<int64>("Tsplits"),
+                        StringViewToHashBucketAliOp<Fingerprint64, int64>);
+
 REGISTER_KERNEL_BUILDER(Name("StringToHashBucketStrong").Device(DEVICE_CPU),
                         StringToKeyedHashBucketAliOp<StrongKeyedHash>);
 
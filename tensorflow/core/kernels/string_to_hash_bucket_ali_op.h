@@ -20,6 +20,7 @@ limitations under the License.
 
 #include "tensorflow/core/framework/op_kernel.h"
 #include "tensorflow/core/framework/tensor.h"
+#include "tensorflow/core/framework/tensor_shape.h"
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/hash/hash.h"
@@ -73,6 +74,74 @@ class StringToHashBucketAliOp : public OpKernel {
   TF_DISALLOW_COPY_AND_ASSIGN(StringToHashBucketAliOp);
 };
 
+// Hashes `num_strings` strings of `input` to `num_buckets` buckets in
+// `output` with the CPU worker threads of `context`. With AVX512, every 8
+// strings of the same length are hashed at once.
+template <uint64 hash(StringPiece)>
+void StringToHashBucketBatch(OpKernelContext* context, const string* input,
+                             int64 num_strings, int64 num_buckets,
+                             int64* output) {
+  auto RunTask = [input, num_buckets, output](int64 start, int64 end) {
+    int64 batch_end = end - (end - start)%8;
+    int64 i = start;
+#if defined(__AVX512F__)
+    const char* batch_ptr[8]; 
+    uint64_t input_hash[8];
+    bool enable_batch_hash = true;
+    if (batch_end - start >= 8) {
+      for(; i < batch_end; i+=8) {
+        // first unrolling by 8 (for Hash64V3_Batch512)
+        // double check whether all the 8 strings within 
+        // a batch having the same string length.
+        enable_batch_hash = true;
+        int64 size_0 = input[i].size();
+        batch_ptr[0] = input[i].data();
+        for(int j=1; j<8; j++) {
+          if (input[i+j].size() == size_0) {
+            batch_ptr[j] = input[i+j].data();
+          } else {
+            enable_batch_hash = false;
+            break;
+          }
+        }
+        if (enable_batch_hash) {
+          Hash64Farm_Batch512(batch_ptr, &input_hash[0], size_0);
+        } else {
+          // roll back to normal Hash64 function
+          for(int j=0; j<8; j++) {
+              input_hash[j] = (uint64_t)hash(input[i+j]); 
+          }
+        }
+        // feed ids to output tensor
+        for(int j=0; j<8; j++) {
+          output[i+j] = static_cast<int64>(input_hash[j]%num_buckets);
+        }
+      }
+    } 
+#endif
+    // for remained iterations
+    for(; i < end; ++i) {
+      const uint64 input_hash = hash(input[i]);
+      const uint64 bucket_id = input_hash % num_buckets;
+      // The number of buckets is always in the positive range of int64 so is
+      // the resulting bucket_id. Casting the bucket_id from uint64 to int64
+      // is safe.
+      output[i] = static_cast<int64>(bucket_id);
+    }
+  };
+
+  auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
+#if defined (__AVX512F__)
+  const int64 element_cost = 25;  // for AVX512 batch-vectorized impl.
+#else
+  const int64 element_cost = 100;  // Estimated for 32 byte strings.
+#endif
+  // NOTE(zycao): Here we have to use 'num_threads - 1' to make sure no more
+  // task fractions should be created. The cost is also a coarse estimation.
+  Shard(worker_threads->num_threads - 1, worker_threads->workers,
+        num_strings, element_cost, RunTask);
+}
+
 template <uint64 hash(StringPiece)>
 class StringToHashBucketBatchAliOp : public OpKernel {
  public:
@@ -93,72 +162,83 @@ class StringToHashBucketBatchAliOp : public OpKernel {
                                             &output_tensor));
     auto output_flat = output_tensor->flat<int64>();
 
-    auto RunTask = [this, &input_flat, &output_flat](int64 start, int64 end) {
-      typedef decltype(input_flat.size()) Index;
-      Index batch_end = end - (end - start)%8;
-      Index i = start;
-#if defined(__AVX512F__)
-      const char* batch_ptr[8]; 
-      uint64_t input_hash[8];
-      bool enable_batch_hash = true;
-      if (batch_end - start >= 8) {
-        for(; i < batch_end; i+=8) {
-          // first unrolling by 8 (for Hash64V3_Batch512)
-          // double check whether all the 8 strings within 
-          // a batch having the same string length.
-          enable_batch_hash = true;
-          Index size_0 = input_flat(i).size();
-          batch_ptr[0] = input_flat(i).data();
-          for(int j=1; j<8; j++) {
-            if (input_flat(i+j).size() == size_0) {
-              batch_ptr[j] = input_flat(i+j).data();
-            } else {
-              enable_batch_hash = false;
-              break;
-            }
-          }
-          if (enable_batch_hash) {
-            Hash64Farm_Batch512(batch_ptr, &input_hash[0], size_0);
-          } else {
-            // roll back to normal Hash64 function
-            for(int j=0; j<8; j++) {
-                input_hash[j] = (uint64_t)hash(input_flat(i+j)); 
-            }
-          }
-          // feed ids to output tensor
-          for(int j=0; j<8; j++) {
-            output_flat(i+j) = static_cast<int64>(input_hash[j]%num_buckets_);
-          }
-        }
-      } 
-#endif
-      // for remained iterations
-      for(; i < end; ++i) {
-        const uint64 input_hash = hash(input_flat(i));
-        const uint64 bucket_id = input_hash % num_buckets_;
+    StringToHashBucketBatch<hash>(context, input_flat.data(),
+                                  input_flat.size(), num_buckets_,
+                                  output_flat.data());
+  }
+
+ private:
+  int64 num_buckets_;
+
+  TF_DISALLOW_COPY_AND_ASSIGN(StringToHashBucketBatchAliOp);
+};
+
+// Hashes the strings in the bytes `values`, where string i is
+// values[row_splits[i]:row_splits[i+1]], without materializing them.
+template <uint64 hash(StringPiece), typename SPLITS_TYPE>
+class StringViewToHashBucketAliOp : public OpKernel {
+ public:
+  explicit StringViewToHashBucketAliOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("num_buckets", &num_buckets_));
+  }
+
+  void Compute(OpKernelContext* context) override {
+    const Tensor& values = context->input(0);
+    const Tensor& row_splits = context->input(1);
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(values.shape()),
+                errors::InvalidArgument("values must be a vector, got shape ",
+                                        values.shape().DebugString()));
+    OP_REQUIRES(context, TensorShapeUtils::IsVector(row_splits.shape()) &&
+                             row_splits.NumElements() > 0,
+                errors::InvalidArgument(
+                    "row_splits must be a non-empty vector, got shape ",
+                    row_splits.shape().DebugString()));
+    const auto& splits_flat = row_splits.flat<SPLITS_TYPE>();
+    const int64 num_strings = splits_flat.size() - 1;
+    const int64 num_values = values.NumElements();
+    OP_REQUIRES(context, splits_flat(0) == 0,
+                errors::InvalidArgument("row_splits must start with 0, got ",
+                                        splits_flat(0)));
+    for (int64 i = 0; i < num_strings; ++i) {
+      OP_REQUIRES(context,
+                  splits_flat(i) <= splits_flat(i + 1) &&
+                      splits_flat(i + 1) <= num_values,
+                  errors::InvalidArgument(
+                      "row_splits must be sorted and within the ", num_values,
+                      " values, got ", splits_flat(i + 1), " at ", i + 1));
+    }
+    const char* data =
+        reinterpret_cast<const char*>(values.flat<uint8>().data());
+
+    Tensor* output_tensor = nullptr;
+    OP_REQUIRES_OK(context,
+                   context->allocate_output(0, TensorShape({num_strings}),
+                                            &output_tensor));
+    auto output_flat = output_tensor->flat<int64>();
+
+    auto RunTask = [this, data, &splits_flat, &output_flat](int64 start,
+                                                           int64 end) {
+      for (int64 i = start; i < end; ++i) {
+        const uint64 input_hash =
+            hash(StringPiece(data + splits_flat(i),
+                             splits_flat(i + 1) - splits_flat(i)));
         // The number of buckets is always in the positive range of int64 so is
-        // the resulting bucket_id. Casting the bucket_id from uint64 to int64
-        // is safe.
-        output_flat(i) = static_cast<int64>(bucket_id);
+        // the resulting bucket_id.
+        output_flat(i) = static_cast<int64>(input_hash % num_buckets_);
       }
     };
 
     auto worker_threads = context->device()->tensorflow_cpu_worker_threads();
-#if defined (__AVX512F__)
-    const int64 element_cost = 25;  // for AVX512 batch-vectorized impl.
-#else
     const int64 element_cost = 100;  // Estimated for 32 byte strings.
-#endif
-    // NOTE(zycao): Here we have to use 'num_threads - 1' to make sure no more
-    // task fractions should be created. The cost is also a coarse estimation.
     Shard(worker_threads->num_threads - 1, worker_threads->workers,
-          input_flat.size(), element_cost, RunTask);
+          num_strings, element_cost, RunTask);
   }
 
  private:
   int64 num_buckets_;
 
-  TF_DISALLOW_COPY_AND_ASSIGN(StringToHashBucketBatchAliOp);
+  TF_DISALLOW_COPY_AND_ASSIGN(StringViewToHashBucketAliOp);
 };
 
 template <uint64 hash(const uint64 (&)[2], const string&)>
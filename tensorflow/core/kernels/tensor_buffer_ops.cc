@@ -31,11 +31,15 @@ class TensorBufferOp : public OpKernel {
     TensorBuf* buffer = nullptr;
     OP_REQUIRES_OK(ctx, rm->LookupOrCreate<TensorBuf>(
                             cinfo.container(), cinfo.name(), &buffer,
-                            [&ndef](TensorBuf** pbuf) -> Status {
+                            [&ndef, &cinfo](TensorBuf** pbuf) -> Status {
                               int64 capacity;
                               TF_RETURN_IF_ERROR(GetNodeAttr(
                                   ndef, "shared_capacity", &capacity));
-                              *pbuf = new TensorBuf(capacity);
+                              int64 max_capacity;
+                              TF_RETURN_IF_ERROR(GetNodeAttr(
+                                  ndef, "shared_max_capacity", &max_capacity));
+                              *pbuf = new TensorBuf(capacity, max_capacity,
+                                                    cinfo.name());
                               return Status::OK();
                             }));
     core::ScopedUnref scope(buffer);
@@ -63,11 +67,16 @@ class TensorBufferAsyncOp : public AsyncOpKernel {
     TensorBuf* buffer = nullptr;
     OP_REQUIRES_OK_ASYNC(ctx, rm->LookupOrCreate<TensorBuf>(
                                   cinfo.container(), cinfo.name(), &buffer,
-                                  [&ndef](TensorBuf** resource) {
+                                  [&ndef, &cinfo](TensorBuf** resource) {
                                     int64 capacity;
                                     TF_RETURN_IF_ERROR(GetNodeAttr(
                                         ndef, "shared_capacity", &capacity));
-                                    *resource = new TensorBuf(capacity);
+                                    int64 max_capacity;
+                                    TF_RETURN_IF_ERROR(GetNodeAttr(
+                                        ndef, "shared_max_capacity",
+                                        &max_capacity));
+                                    *resource = new TensorBuf(
+                                        capacity, max_capacity, cinfo.name());
                                     return Status::OK();
                                   }),
                          done);
@@ -230,4 +239,85 @@ REGISTER_KERNEL_BUILDER(
     TensorBufferSizeOp);
 #endif  // TENSORFLOW_USE_SYCL
 
+class InputPipelineStatsEnableOp : public OpKernel {
+ public:
+  explicit InputPipelineStatsEnableOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("enabled", &enabled_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    InputPipelineStats::Global()->SetEnabled(enabled_);
+  }
+
+ private:
+  bool enabled_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("InputPipelineStatsEnable").Device(DEVICE_CPU),
+                        InputPipelineStatsEnableOp);
+
+class InputPipelineStatsSummaryOp : public OpKernel {
+ public:
+  explicit InputPipelineStatsSummaryOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("reset", &reset_));
+  }
+
+  void Compute(OpKernelContext* ctx) override {
+    InputPipelineStats* stats = InputPipelineStats::Global();
+    const std::vector<InputPipelineStats::StageSummary> summary =
+        stats->GetSummary();
+    if (reset_) {
+      stats->Reset();
+    }
+    const int64 num_stages = summary.size();
+    Tensor* names = nullptr;
+    OP_REQUIRES_OK(ctx,
+                   ctx->allocate_output(0, TensorShape({num_stages}), &names));
+    Tensor* kinds = nullptr;
+    OP_REQUIRES_OK(ctx,
+                   ctx->allocate_output(1, TensorShape({num_stages}), &kinds));
+    Tensor* values = nullptr;
+    OP_REQUIRES_OK(
+        ctx, ctx->allocate_output(2, TensorShape({num_stages, 7}), &values));
+    auto names_flat = names->flat<string>();
+    auto kinds_flat = kinds->flat<string>();
+    auto values_matrix = values->matrix<double>();
+    for (int64 i = 0; i < num_stages; ++i) {
+      const InputPipelineStats::StageSummary& s = summary[i];
+      names_flat(i) = s.name;
+      kinds_flat(i) = s.kind;
+      values_matrix(i, 0) = s.elements;
+      values_matrix(i, 1) = s.latency_micros;
+      values_matrix(i, 2) = s.self_micros;
+      values_matrix(i, 3) = s.consumer_wait_micros;
+      values_matrix(i, 4) = s.producer_wait_micros;
+      values_matrix(i, 5) = s.occupancy;
+      values_matrix(i, 6) = s.capacity;
+    }
+  }
+
+ private:
+  bool reset_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("InputPipelineStatsSummary").Device(DEVICE_CPU),
+                        InputPipelineStatsSummaryOp);
+
+class InputPipelineStatsReportOp : public OpKernel {
+ public:
+  explicit InputPipelineStatsReportOp(OpKernelConstruction* ctx)
+      : OpKernel(ctx) {}
+
+  void Compute(OpKernelContext* ctx) override {
+    Tensor* report = nullptr;
+    OP_REQUIRES_OK(ctx, ctx->allocate_output(0, TensorShape({}), &report));
+    report->scalar<string>()() = InputPipelineStats::Global()->Report();
+  }
+};
+
+REGISTER_KERNEL_BUILDER(Name("InputPipelineStatsReport").Device(DEVICE_CPU),
+                        InputPipelineStatsReportOp);
+
 }  // namespace tensorflow
@@ -21,6 +21,7 @@ limitations under the License.
 #define EIGEN_USE_GPU
 #endif  // GOOGLE_CUDA
 
+#include "tensorflow/core/framework/input_pipeline_stats.h"
 #include "tensorflow/core/framework/register_types.h"
 #include "tensorflow/core/framework/resource_mgr.h"
 #include "tensorflow/core/framework/tensor.h"
@@ -34,6 +35,7 @@ limitations under the License.
 #include "third_party/eigen3/Eigen/Core"
 #include "third_party/eigen3/unsupported/Eigen/CXX11/Tensor"
 
+#include <algorithm>
 #include <chrono>
 #include <cstddef>
 #include <deque>
@@ -45,17 +47,43 @@ namespace tensorflow {
 
 class TensorBuf : public ResourceBase {
  public:
-  explicit TensorBuf(int64 capacity)
-      : capacity_(capacity), is_cancelled_(false), is_closed_(false) {}
+  // If `max_capacity` is larger than `capacity`, the capacity is doubled up to
+  // `max_capacity` whenever both producers and consumers had to wait within
+  // the last kTuneTakes takes, i.e. the buffer is too shallow to absorb the
+  // jitter between them.
+  //
+  // The waits of the producers and consumers, the time records stay in the
+  // buffer and its occupancy are recorded in the input pipeline stats of
+  // stage `name` when they are enabled.
+  explicit TensorBuf(int64 capacity, int64 max_capacity = 0,
+                     const string& name = "")
+      : capacity_(capacity),
+        max_capacity_(std::max(capacity, max_capacity)),
+        is_cancelled_(false),
+        is_closed_(false),
+        stats_stage_(InputPipelineStats::Global()->GetStage(
+            name, InputPipelineStats::kStage)) {}
 
   ~TensorBuf() { Cancel(); }
 
   Status Put(const std::vector<Tensor>& record, int64 timeout_millis) {
+    const bool collect_stats = InputPipelineStats::Global()->enabled();
     std::unique_lock<std::mutex> lock(mu_);
 
+    int64 wait_start_micros = 0;
+    if (buffer_.size() >= capacity_) {
+      ++num_blocked_puts_;
+      if (collect_stats) {
+        wait_start_micros = Env::Default()->NowMicros();
+      }
+    }
     bool should_retry = !put_cv_.wait_for(
         lock, std::chrono::milliseconds(timeout_millis),
         [this]() { return buffer_.size() < capacity_ || is_cancelled_; });
+    const int64 now_micros = collect_stats ? Env::Default()->NowMicros() : 0;
+    if (wait_start_micros > 0) {
+      stats_stage_->RecordProducerWait(now_micros - wait_start_micros);
+    }
     if (should_retry) {
       lock.unlock();
       LOG(WARNING) << "Prefetching was ignored since timeout.";
@@ -68,6 +96,7 @@ class TensorBuf : public ResourceBase {
     }
 
     buffer_.push_back(std::move(record));
+    put_micros_.push_back(now_micros);
 
     lock.unlock();
     take_cv_.notify_all();
@@ -76,9 +105,24 @@ class TensorBuf : public ResourceBase {
   }
 
   Status Take(std::vector<Tensor>* record) {
+    const bool collect_stats = InputPipelineStats::Global()->enabled();
     std::unique_lock<std::mutex> lock(mu_);
 
+    int64 wait_start_micros = 0;
+    if (buffer_.empty() && !is_cancelled_) {
+      ++num_starved_takes_;
+      if (collect_stats) {
+        wait_start_micros = Env::Default()->NowMicros();
+      }
+    }
+    if (collect_stats) {
+      stats_stage_->RecordOccupancy(buffer_.size(), capacity_);
+    }
     take_cv_.wait(lock, [this]() { return !buffer_.empty() || is_cancelled_; });
+    const int64 now_micros = collect_stats ? Env::Default()->NowMicros() : 0;
+    if (wait_start_micros > 0) {
+      stats_stage_->RecordConsumerWait(now_micros - wait_start_micros);
+    }
 
     if (TF_PREDICT_FALSE(is_closed_ && buffer_.empty())) {
       lock.unlock();
@@ -92,6 +136,14 @@ class TensorBuf : public ResourceBase {
 
     *record = std::move(buffer_.front());
     buffer_.pop_front();
+    // Records put before the stats were enabled have no put time.
+    if (collect_stats && put_micros_.front() > 0) {
+      stats_stage_->RecordElement(now_micros - put_micros_.front());
+    }
+    put_micros_.pop_front();
+    if (++num_takes_ >= kTuneTakes) {
+      MaybeGrowCapacity();
+    }
 
     lock.unlock();
     put_cv_.notify_all();
@@ -128,6 +180,11 @@ class TensorBuf : public ResourceBase {
     return Status::OK();
   }
 
+  int64 GetCapacity() {
+    std::unique_lock<std::mutex> lock(mu_);
+    return capacity_;
+  }
+
   string DebugString() TF_RESOURCE_DEBUG_STRING_CONST override {
     return strings::StrCat("TensorBuf(capacity=", capacity_, ")");
   }
@@ -151,14 +208,36 @@ class TensorBuf : public ResourceBase {
   }
 
  private:
+  static constexpr int64 kTuneTakes = 64;
+
+  void MaybeGrowCapacity() {
+    if (num_blocked_puts_ > 0 && num_starved_takes_ > 0 &&
+        capacity_ < max_capacity_) {
+      capacity_ = std::min(capacity_ * 2, max_capacity_);
+      VLOG(1) << "TensorBuf capacity grows to " << capacity_ << " after "
+              << num_blocked_puts_ << " blocked puts and "
+              << num_starved_takes_ << " starved takes.";
+    }
+    num_takes_ = 0;
+    num_blocked_puts_ = 0;
+    num_starved_takes_ = 0;
+  }
+
   std::deque<std::vector<Tensor> > buffer_;
+  // The times the records in buffer_ were put, 0 if the stats were disabled.
+  std::deque<int64> put_micros_;
   std::size_t capacity_;
+  const std::size_t max_capacity_;
+  int64 num_takes_ = 0;
+  int64 num_blocked_puts_ = 0;
+  int64 num_starved_takes_ = 0;
   bool is_cancelled_;
   bool is_closed_;
   std::mutex mu_;
   std::condition_variable take_cv_;
   std::condition_variable put_cv_;
   std::shared_ptr<thread::ThreadPool> threads_;
+  InputPipelineStats::Stage* stats_stage_;  // Not owned.
 };
 }
 
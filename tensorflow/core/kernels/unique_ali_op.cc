@@ -31,71 +31,11 @@ limitations under the License.
 
 namespace tensorflow {
 
-namespace {
-const char* kUniqueOpSerialEnv = "DEEPREC_UNIQUE_OP_SERIAL";
-const char* kUniqueOpHashMapEnv = "DEEPREC_UNIQUE_OP_HASH_MAP";
-const char* kUniqueOpUniqRatioHint = "DEEPREC_UNIQUE_OP_UNIQ_RATIO_HINT";
-const char* kUniqueOpPartitionSizeEnv = "DEEPREC_UNIQUE_OP_PARTITION_SIZE";
-const char* kMultiMapString = "MULTIMAP";
-const char* kStlHashMapString = "STL";
-const char* kAbslHashMapString = "ABSL";
-const char* kGoogleHashMapString = "GOOGLE";
-const int64 kDefaultUniqueRatioHint = 4;
-}
-
 template <typename T, typename TIndex>
 class UniqueAliOp : public OpKernel {
  public:
   explicit UniqueAliOp(OpKernelConstruction* context) : OpKernel(context) {
-    OP_REQUIRES_OK(context, ReadInt64FromEnvVar(kUniqueOpPartitionSizeEnv,
-                                             kPartitionSize, &partition_size_));
-    OP_REQUIRES(context, partition_size_ > 0,
-                errors::InvalidArgument("Invaild PARTITION_SIZE=",
-                                        partition_size_));
-
-    OP_REQUIRES_OK(context, ReadBoolFromEnvVar(kUniqueOpSerialEnv,
-                                                false, &serial_));
-
-    // NOTE(zycao>: Hash map insertion and lookup performance is dominating in
-    // Unique Op. Based on benchmark results, 'google::dense_hash_map' will be
-    // used as default for most key types except string.
-    //
-    // By setting "DEEPREC_UNIQUE_OP_HASH_MAP" environment variable, a particular
-    // hash map could be seleteed to use. Possible choices are listed below:
-    //     "MULTIMAP" for multimap parrallel process,
-    //     "STL" for std::unordred_map,
-    //     "ABSL" for absl::flat_hash_map,
-    //     "GOOGLE" for google::dense_hash_map.
-    std::string hash_map_str;
-    OP_REQUIRES_OK(context, ReadStringFromEnvVar(kUniqueOpHashMapEnv,
-                                                 kGoogleHashMapString,
-                                                 &hash_map_str));
-    std::transform(hash_map_str.begin(), hash_map_str.end(),
-                   hash_map_str.begin(), ::toupper);
-
-    OP_REQUIRES_OK(context, ReadInt64FromEnvVar(kUniqueOpUniqRatioHint,
-        kDefaultUniqueRatioHint, &unique_ratio_hint_));
-    OP_REQUIRES(context, unique_ratio_hint_ > 0,
-                errors::InvalidArgument("Invaild ", kUniqueOpUniqRatioHint, "=",
-                                        unique_ratio_hint_));
-
-    if (!hash_map_str.compare(kMultiMapString)) {
-      map_flag_ = MULTIMAP;
-      static char print_once = [] {
-        LOG(INFO) << "MultiMapCompute preserved "
-          "dense hash map key: " << kPreseverdEmptyKey;
-        return '\0';
-      }();
-    } else if (!hash_map_str.compare(kStlHashMapString)) {
-      map_flag_ = STL;
-    } else if (!hash_map_str.compare(kAbslHashMapString)) {
-      map_flag_ = ABSL;
-    } else if (!hash_map_str.compare(kGoogleHashMapString)) {
-      map_flag_ = GOOGLE;
-    } else {
-      map_flag_ = GOOGLE;
-    }
-
+    OP_REQUIRES_OK(context, ReadUniqueAliOptionsFromEnv(&options_));
   }
 
   void Compute(OpKernelContext* context) override {
@@ -112,14 +52,14 @@ class UniqueAliOp : public OpKernel {
     if (context->num_inputs() == 1) {
       UniqueWithoutAxis<T, TIndex>(context, input,
           &idx, &output, &output_counter, num_outputs(),
-          partition_size_, serial_, unique_ratio_hint_,
-          map_flag_);
+          options_.partition_size, options_.serial,
+          options_.unique_ratio_hint, options_.map_flag);
     } else {
       const Tensor& axis_tensor = context->input(1);
       UniqueWithAxis<T, TIndex>(context, input,
           axis_tensor, &idx, &output, &output_counter,
-          num_outputs(), partition_size_, serial_,
-          unique_ratio_hint_, map_flag_);
+          num_outputs(), options_.partition_size, options_.serial,
+          options_.unique_ratio_hint, options_.map_flag);
     }
     context->set_output(0, output);
     context->set_output(1, idx);
@@ -128,10 +68,7 @@ class UniqueAliOp : public OpKernel {
     }
   }
 
-  bool serial_ = false;
-  int64 partition_size_ = 0;
-  int64 unique_ratio_hint_;
-  UniqueMaps map_flag_ = GOOGLE;  // "GOOGLE" dense hash map is default
+  UniqueAliOptions options_;
 };
 
 #define REGISTER_UNIQUE(type)                                    \
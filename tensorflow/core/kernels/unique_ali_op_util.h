@@ -17,8 +17,10 @@ limitations under the License.
 #define TENSORFLOW_CORE_KERNELS_UNIQUE_ALI_OP_UTIL_H_
 
 #include <algorithm>
+#include <cmath>
 #include <limits>
 #include <functional>
+#include <type_traits>
 #include <unordered_map>
 #include <utility>
 
@@ -39,6 +41,10 @@ limitations under the License.
 #include "tensorflow/core/util/env_var.h"
 #include "tensorflow/core/util/work_sharder.h"
 
+#if defined(__SSE2__)
+#include <immintrin.h>
+#endif
+
 namespace tensorflow {
 
 #define likely(x) __builtin_expect(!!(x), 1)
@@ -49,15 +55,117 @@ const int64 kPartitionLimit = 14336;
 const int64 kPartitionSize = 8192;
 const int64_t kPreseverdEmptyKey = tensorflow::random::New64Configuable();
 
+const char* kUniqueOpSerialEnv = "DEEPREC_UNIQUE_OP_SERIAL";
+const char* kUniqueOpHashMapEnv = "DEEPREC_UNIQUE_OP_HASH_MAP";
+const char* kUniqueOpUniqRatioHint = "DEEPREC_UNIQUE_OP_UNIQ_RATIO_HINT";
+const char* kUniqueOpPartitionSizeEnv = "DEEPREC_UNIQUE_OP_PARTITION_SIZE";
+const char* kMultiMapString = "MULTIMAP";
+const char* kStlHashMapString = "STL";
+const char* kAbslHashMapString = "ABSL";
+const char* kGoogleHashMapString = "GOOGLE";
+const char* kRadixString = "RADIX";
+const char* kSimdHashString = "SIMD";
+const char* kAutoString = "AUTO";
+const int64 kDefaultUniqueRatioHint = 4;
+
+// Radix sort digits.
+const int kRadixBits = 8;
+const int kRadixBuckets = 1 << kRadixBits;
+// Slots of the SIMD hash table compared at once.
+const int kProbeGroupSize = 4;
+// HyperLogLog sketch of the AUTO backend selection.
+const int kHllPrecision = 12;
+const int kHllRegisters = 1 << kHllPrecision;
+const int64 kCardinalitySamples = 65536;
+// AUTO selects RADIX when at least half of the keys are estimated unique,
+// serially only for inputs of at least kAutoSerialRadixLimit keys.
+const double kAutoRadixUniqueRatio = 0.5;
+const int64 kAutoSerialRadixLimit = 1 << 20;
+
 typedef enum {
   MULTIMAP = 0,
   STL = 1,
   ABSL = 2,
-  GOOGLE = 3
+  GOOGLE = 3,
+  RADIX = 4,
+  SIMD = 5,
+  AUTO = 6
 } UniqueMaps;
 
 }  // namespace
 
+// Options of the Unique computation, shared by the kernels which unique
+// their inputs with UniqueWithoutAxis or UniqueWithAxis.
+struct UniqueAliOptions {
+  int64 partition_size = kPartitionSize;
+  bool serial = false;
+  int64 unique_ratio_hint = kDefaultUniqueRatioHint;
+  UniqueMaps map_flag = GOOGLE;  // "GOOGLE" dense hash map is default
+};
+
+// NOTE(zycao>: Hash map insertion and lookup performance is dominating in
+// Unique Op. Based on benchmark results, 'google::dense_hash_map' will be
+// used as default for most key types except string.
+//
+// By setting "DEEPREC_UNIQUE_OP_HASH_MAP" environment variable, a particular
+// hash map could be seleteed to use. Possible choices are listed below:
+//     "MULTIMAP" for multimap parrallel process,
+//     "STL" for std::unordred_map,
+//     "ABSL" for absl::flat_hash_map,
+//     "GOOGLE" for google::dense_hash_map,
+//     "RADIX" for parallel radix sort of integer keys,
+//     "SIMD" for SIMD probed hash table of integer keys,
+//     "AUTO" to select one of "RADIX", "SIMD" and "GOOGLE" for each input.
+inline Status ReadUniqueAliOptionsFromEnv(UniqueAliOptions* options) {
+  TF_RETURN_IF_ERROR(ReadInt64FromEnvVar(kUniqueOpPartitionSizeEnv,
+                                         kPartitionSize,
+                                         &options->partition_size));
+  if (options->partition_size <= 0) {
+    return errors::InvalidArgument("Invaild PARTITION_SIZE=",
+                                   options->partition_size);
+  }
+
+  TF_RETURN_IF_ERROR(ReadBoolFromEnvVar(kUniqueOpSerialEnv, false,
+                                        &options->serial));
+
+  std::string hash_map_str;
+  TF_RETURN_IF_ERROR(ReadStringFromEnvVar(kUniqueOpHashMapEnv,
+                                          kGoogleHashMapString,
+                                          &hash_map_str));
+  std::transform(hash_map_str.begin(), hash_map_str.end(),
+                 hash_map_str.begin(), ::toupper);
+
+  TF_RETURN_IF_ERROR(ReadInt64FromEnvVar(kUniqueOpUniqRatioHint,
+                                         kDefaultUniqueRatioHint,
+                                         &options->unique_ratio_hint));
+  if (options->unique_ratio_hint <= 0) {
+    return errors::InvalidArgument("Invaild ", kUniqueOpUniqRatioHint, "=",
+                                   options->unique_ratio_hint);
+  }
+
+  if (!hash_map_str.compare(kMultiMapString)) {
+    options->map_flag = MULTIMAP;
+    static char print_once = [] {
+      LOG(INFO) << "MultiMapCompute preserved "
+        "dense hash map key: " << kPreseverdEmptyKey;
+      return '\0';
+    }();
+  } else if (!hash_map_str.compare(kStlHashMapString)) {
+    options->map_flag = STL;
+  } else if (!hash_map_str.compare(kAbslHashMapString)) {
+    options->map_flag = ABSL;
+  } else if (!hash_map_str.compare(kRadixString)) {
+    options->map_flag = RADIX;
+  } else if (!hash_map_str.compare(kSimdHashString)) {
+    options->map_flag = SIMD;
+  } else if (!hash_map_str.compare(kAutoString)) {
+    options->map_flag = AUTO;
+  } else {
+    options->map_flag = GOOGLE;
+  }
+  return Status::OK();
+}
+
 template <typename T>
 const T InvalidHashKey() {
   return std::numeric_limits<T>::max();
@@ -658,6 +766,459 @@ void ComputeInternalWithHashMap(OpKernelContext* context, const Tensor& input,
   }
 }
 
+// NOTE: Backends for integer keys, besides the hash maps.
+//
+// RADIX sorts the keys with their positions by a parallel LSD radix sort,
+// the digits which are the same for all keys are skipped. The runs of equal
+// keys are numbered by their first positions, so the outputs are the same as
+// the ones of the hash maps. It streams over the keys instead of probing at
+// random, which pays off when most of the keys are unique.
+//
+// SIMD probes an open addressing table a group of slots at a time, the keys
+// of a group are compared with one vector instruction. It's serial and suits
+// the inputs whose table fits in cache.
+template <typename U, int kBytes = sizeof(U)>
+struct ProbeGroupMatcher {
+  // Sets the bitmasks of the slots of the group at `keys` which hold `key`
+  // and which are empty.
+  static inline void Match(const U* keys, U key, U empty, uint32* match,
+                           uint32* vacant) {
+    *match = 0;
+    *vacant = 0;
+    for (int i = 0; i < kProbeGroupSize; ++i) {
+      *match |= static_cast<uint32>(keys[i] == key) << i;
+      *vacant |= static_cast<uint32>(keys[i] == empty) << i;
+    }
+  }
+};
+
+#if defined(__AVX2__)
+template <typename U>
+struct ProbeGroupMatcher<U, 8> {
+  static inline void Match(const U* keys, U key, U empty, uint32* match,
+                           uint32* vacant) {
+    const __m256i group =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(keys));
+    *match = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(
+        group, _mm256_set1_epi64x(static_cast<long long>(key)))));
+    *vacant = _mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(
+        group, _mm256_set1_epi64x(static_cast<long long>(empty)))));
+  }
+};
+#endif
+
+#if defined(__SSE2__)
+template <typename U>
+struct ProbeGroupMatcher<U, 4> {
+  static inline void Match(const U* keys, U key, U empty, uint32* match,
+                           uint32* vacant) {
+    const __m128i group =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(keys));
+    *match = _mm_movemask_ps(_mm_castsi128_ps(
+        _mm_cmpeq_epi32(group, _mm_set1_epi32(static_cast<int>(key)))));
+    *vacant = _mm_movemask_ps(_mm_castsi128_ps(
+        _mm_cmpeq_epi32(group, _mm_set1_epi32(static_cast<int>(empty)))));
+  }
+};
+#endif
+
+// Open addressing hash table of integer keys probed by groups of
+// kProbeGroupSize slots. The largest key marks the empty slots, it's kept
+// out of the table.
+template <typename T, typename TIndex>
+class GroupProbeHashMap {
+ public:
+  typedef typename std::make_unsigned<T>::type U;
+
+  explicit GroupProbeHashMap(int64 capacity) {
+    int64 num_slots = kProbeGroupSize;
+    while (num_slots < 2 * capacity) {
+      num_slots <<= 1;
+    }
+    mask_ = num_slots - 1;
+    keys_.reset(new U[num_slots]);
+    std::fill(keys_.get(), keys_.get() + num_slots, kEmpty);
+    values_.reset(new TIndex[num_slots]);
+  }
+
+  // Returns the index of `key`, inserts it with `index` if it's absent.
+  inline TIndex FindOrInsert(const T& key, TIndex index, bool* inserted) {
+    const U k = static_cast<U>(key);
+    if (unlikely(k == kEmpty)) {
+      *inserted = !has_empty_key_;
+      if (*inserted) {
+        has_empty_key_ = true;
+        empty_key_index_ = index;
+      }
+      return empty_key_index_;
+    }
+    int64 slot = static_cast<int64>(hasher_(static_cast<int64>(k))) & mask_ &
+                 ~static_cast<int64>(kProbeGroupSize - 1);
+    while (true) {
+      uint32 match;
+      uint32 vacant;
+      ProbeGroupMatcher<U>::Match(keys_.get() + slot, k, kEmpty, &match,
+                                  &vacant);
+      if (match != 0) {
+        *inserted = false;
+        return values_[slot + __builtin_ctz(match)];
+      }
+      if (vacant != 0) {
+        slot += __builtin_ctz(vacant);
+        keys_[slot] = k;
+        values_[slot] = index;
+        *inserted = true;
+        return index;
+      }
+      slot = (slot + kProbeGroupSize) & mask_;
+    }
+  }
+
+ private:
+  static constexpr U kEmpty = std::numeric_limits<U>::max();
+
+  IdHash hasher_;
+  int64 mask_;
+  std::unique_ptr<U[]> keys_;
+  std::unique_ptr<TIndex[]> values_;
+  bool has_empty_key_ = false;
+  TIndex empty_key_index_ = 0;
+};
+
+template <typename T, typename TIndex>
+constexpr typename GroupProbeHashMap<T, TIndex>::U
+    GroupProbeHashMap<T, TIndex>::kEmpty;
+
+template<typename T, typename TIndex>
+void SimdHashCompute(OpKernelContext* context, const Tensor& input,
+    Tensor* idx, int64 axis, int64* uniq_size, Tensor* output) {
+  auto Tin = input.vec<T>();
+  const int64 N = input.NumElements();
+  auto idx_vec = idx->template vec<TIndex>();
+
+  GroupProbeHashMap<T, TIndex> uniq(N);
+  std::vector<T> uniq_keys;
+  for (int64 i = 0; i < N; ++i) {
+    bool inserted;
+    idx_vec(i) = uniq.FindOrInsert(Tin(i), uniq_keys.size(), &inserted);
+    if (inserted) {
+      uniq_keys.push_back(Tin(i));
+    }
+  }
+
+  *uniq_size = static_cast<int64>(uniq_keys.size());
+  TensorShape output_shape(input.shape());
+  output_shape.set_dim(axis, *uniq_size);
+  AllocatorAttributes attr;
+  attr.set_on_host(true);
+  OP_REQUIRES_OK(context, context->allocate_temp(
+      DataTypeToEnum<T>::v(), output_shape, output, attr));
+  std::copy(uniq_keys.begin(), uniq_keys.end(), output->flat<T>().data());
+}
+
+template<typename T, typename TIndex>
+void RadixSortCompute(OpKernelContext* context, const Tensor& input,
+    Tensor* idx, int64 axis, int64* uniq_size, bool serial, Tensor* output) {
+  typedef typename std::make_unsigned<T>::type U;
+  auto Tin = input.vec<T>();
+  const int64 N = input.NumElements();
+  if (N == 0) {
+    SimdHashCompute<T, TIndex>(context, input, idx, axis, uniq_size, output);
+    return;
+  }
+  auto idx_vec = idx->template vec<TIndex>();
+  int32 max_threads =
+    context->device()->tensorflow_cpu_worker_threads()->num_threads;
+  auto thread_pool =
+    context->device()->tensorflow_cpu_worker_threads()->workers;
+  int32 num_tasks = serial ? 1 : static_cast<int32>(std::max(std::min(
+      static_cast<int64>(max_threads),
+      (N + kPartitionSize - 1) / kPartitionSize), static_cast<int64>(1)));
+  VLOG(1) << "[UniqueRadix] num_tasks: " << num_tasks;
+  Partitioner parter(N, num_tasks);
+
+  // Step 1: Copy the keys with their positions, find the bits which differ
+  //         among the keys.
+  std::unique_ptr<U[]> keys(new U[N]);
+  std::unique_ptr<U[]> keys_buf(new U[N]);
+  std::unique_ptr<int32[]> pos(new int32[N]);
+  std::unique_ptr<int32[]> pos_buf(new int32[N]);
+  std::vector<U> or_bits(num_tasks, 0);
+  std::vector<U> and_bits(num_tasks, std::numeric_limits<U>::max());
+  auto LoadTask = [&Tin, &parter, &keys, &pos, &or_bits, &and_bits]
+    (int32 task_id, int32 num_tasks) {
+      const Range* range = parter.GetRange(task_id);
+      U ors = 0;
+      U ands = std::numeric_limits<U>::max();
+      for (int64 i = range->Start(); i < range->End(); ++i) {
+        const U k = static_cast<U>(Tin(i));
+        keys[i] = k;
+        pos[i] = static_cast<int32>(i);
+        ors |= k;
+        ands &= k;
+      }
+      or_bits[task_id] = ors;
+      and_bits[task_id] = ands;
+    };
+  TaskRunner load_runner(LoadTask, thread_pool, num_tasks);
+  load_runner.Run();
+  U ors = 0;
+  U ands = std::numeric_limits<U>::max();
+  for (int32 i = 0; i < num_tasks; ++i) {
+    ors |= or_bits[i];
+    ands &= and_bits[i];
+  }
+  const U diff_bits = ors ^ ands;
+
+  // Step 2: Sort by each digit which differs among the keys. The offsets of
+  //         a digit are laid out by task so that the sort is stable.
+  U* src_keys = keys.get();
+  U* dst_keys = keys_buf.get();
+  int32* src_pos = pos.get();
+  int32* dst_pos = pos_buf.get();
+  std::vector<int64> offsets(num_tasks * kRadixBuckets);
+  for (int shift = 0; shift < static_cast<int>(8 * sizeof(U));
+       shift += kRadixBits) {
+    if (((diff_bits >> shift) & (kRadixBuckets - 1)) == 0) {
+      continue;
+    }
+    auto CountTask = [&parter, &offsets, src_keys, shift]
+      (int32 task_id, int32 num_tasks) {
+        int64* counts = &offsets[task_id * kRadixBuckets];
+        std::fill(counts, counts + kRadixBuckets, 0);
+        const Range* range = parter.GetRange(task_id);
+        for (int64 i = range->Start(); i < range->End(); ++i) {
+          ++counts[(src_keys[i] >> shift) & (kRadixBuckets - 1)];
+        }
+      };
+    TaskRunner count_runner(CountTask, thread_pool, num_tasks);
+    count_runner.Run();
+
+    int64 offset = 0;
+    for (int d = 0; d < kRadixBuckets; ++d) {
+      for (int32 t = 0; t < num_tasks; ++t) {
+        const int64 count = offsets[t * kRadixBuckets + d];
+        offsets[t * kRadixBuckets + d] = offset;
+        offset += count;
+      }
+    }
+
+    auto ScatterTask = [&parter, &offsets, src_keys, dst_keys, src_pos,
+         dst_pos, shift] (int32 task_id, int32 num_tasks) {
+        int64* next = &offsets[task_id * kRadixBuckets];
+        const Range* range = parter.GetRange(task_id);
+        for (int64 i = range->Start(); i < range->End(); ++i) {
+          const U k = src_keys[i];
+          const int64 p = next[(k >> shift) & (kRadixBuckets - 1)]++;
+          dst_keys[p] = k;
+          dst_pos[p] = src_pos[i];
+        }
+      };
+    TaskRunner scatter_runner(ScatterTask, thread_pool, num_tasks);
+    scatter_runner.Run();
+    std::swap(src_keys, dst_keys);
+    std::swap(src_pos, dst_pos);
+  }
+  const U* sorted_keys = src_keys;
+  const int32* sorted_pos = src_pos;
+
+  // Step 3: Mark the first position of every run of equal keys and count the
+  //         marks of each task.
+  std::unique_ptr<bool[]> first(new bool[N]());
+  auto MarkTask = [&parter, &first, sorted_keys, sorted_pos]
+    (int32 task_id, int32 num_tasks) {
+      const Range* range = parter.GetRange(task_id);
+      for (int64 i = range->Start(); i < range->End(); ++i) {
+        if (i == 0 || sorted_keys[i] != sorted_keys[i - 1]) {
+          first[sorted_pos[i]] = true;
+        }
+      }
+    };
+  TaskRunner mark_runner(MarkTask, thread_pool, num_tasks);
+  mark_runner.Run();
+
+  std::vector<int64> global_offsets(num_tasks + 1, 0);
+  auto CountFirstTask = [&parter, &first, &global_offsets]
+    (int32 task_id, int32 num_tasks) {
+      const Range* range = parter.GetRange(task_id);
+      int64 count = 0;
+      for (int64 i = range->Start(); i < range->End(); ++i) {
+        count += first[i];
+      }
+      global_offsets[task_id + 1] = count;
+    };
+  TaskRunner count_first_runner(CountFirstTask, thread_pool, num_tasks);
+  count_first_runner.Run();
+  for (int32 i = 0; i < num_tasks; ++i) {
+    global_offsets[i + 1] += global_offsets[i];
+  }
+
+  // Step 4: Index the first positions in order and write the output keys.
+  *uniq_size = global_offsets[num_tasks];
+  TensorShape output_shape(input.shape());
+  output_shape.set_dim(axis, *uniq_size);
+  AllocatorAttributes attr;
+  attr.set_on_host(true);
+  OP_REQUIRES_OK(context, context->allocate_temp(
+        DataTypeToEnum<T>::v(), output_shape, output, attr));
+  auto key_output_vec = output->template vec<T>();
+
+  auto IndexFirstTask = [&Tin, &parter, &first, &global_offsets, &idx_vec,
+       &key_output_vec] (int32 task_id, int32 num_tasks) {
+      const Range* range = parter.GetRange(task_id);
+      TIndex cur_id = global_offsets[task_id];
+      for (int64 i = range->Start(); i < range->End(); ++i) {
+        if (first[i]) {
+          idx_vec(i) = cur_id;
+          key_output_vec(cur_id) = Tin(i);
+          ++cur_id;
+        }
+      }
+    };
+  TaskRunner index_first_runner(IndexFirstTask, thread_pool, num_tasks);
+  index_first_runner.Run();
+
+  // Step 5: Every key takes the index of the first position of its run. The
+  //         keys are sorted, a task finds the head of its first run by
+  //         binary search.
+  auto IndexTask = [&parter, &idx_vec, sorted_keys, sorted_pos]
+    (int32 task_id, int32 num_tasks) {
+      const Range* range = parter.GetRange(task_id);
+      if (range->Size() == 0) { return; }
+      int64 head = std::lower_bound(sorted_keys,
+          sorted_keys + range->Start(), sorted_keys[range->Start()]) -
+          sorted_keys;
+      TIndex cur_id = idx_vec(sorted_pos[head]);
+      for (int64 i = range->Start(); i < range->End(); ++i) {
+        if (sorted_keys[i] != sorted_keys[head]) {
+          head = i;
+          cur_id = idx_vec(sorted_pos[i]);
+        } else if (i != head) {
+          idx_vec(sorted_pos[i]) = cur_id;
+        }
+      }
+    };
+  TaskRunner index_runner(IndexTask, thread_pool, num_tasks);
+  index_runner.Run();
+}
+
+// Estimates the number of unique keys with a HyperLogLog sketch of a strided
+// sample. Assuming the sample is drawn uniformly from the unique keys, the
+// estimate of the sample is extrapolated to the whole input.
+template<typename T>
+int64 EstimateUniqueKeys(const Tensor& input) {
+  auto Tin = input.vec<T>();
+  const int64 N = input.NumElements();
+  const int64 num_samples = std::min(N, kCardinalitySamples);
+  if (num_samples == 0) { return 0; }
+  const int64 stride = N / num_samples;
+
+  IdHash hasher;
+  std::vector<uint8> registers(kHllRegisters, 0);
+  for (int64 i = 0; i < num_samples; ++i) {
+    const uint64 h = hasher(static_cast<int64>(Tin(i * stride)));
+    const uint64 reg = h >> (64 - kHllPrecision);
+    const uint64 rest = (h << kHllPrecision) | (1ULL << (kHllPrecision - 1));
+    const uint8 rank = static_cast<uint8>(__builtin_clzll(rest) + 1);
+    registers[reg] = std::max(registers[reg], rank);
+  }
+  double sum = 0;
+  int zeros = 0;
+  for (uint8 r : registers) {
+    sum += std::ldexp(1.0, -r);
+    zeros += (r == 0);
+  }
+  const double m = kHllRegisters;
+  double estimate = 0.7213 / (1 + 1.079 / m) * m * m / sum;
+  if (estimate <= 2.5 * m && zeros > 0) {
+    estimate = m * std::log(m / zeros);
+  }
+  estimate = std::min(estimate, static_cast<double>(num_samples));
+  if (num_samples == N) {
+    return static_cast<int64>(estimate);
+  }
+  // Almost all the samples are unique, no estimate beyond the sample.
+  if (estimate >= 0.98 * num_samples) {
+    return N;
+  }
+  // Solves estimate = U * (1 - exp(-num_samples / U)) for U.
+  double lo = estimate;
+  double hi = N;
+  for (int i = 0; i < 50; ++i) {
+    const double mid = (lo + hi) / 2;
+    if (mid * (1 - std::exp(-num_samples / mid)) < estimate) {
+      lo = mid;
+    } else {
+      hi = mid;
+    }
+  }
+  return static_cast<int64>(hi);
+}
+
+// Selects the backend of AUTO by the size of the input, the estimated ratio
+// of the unique keys and the threads.
+template<typename T>
+UniqueMaps SelectUniqueBackend(const Tensor& input, int32 max_threads,
+                               bool serial) {
+  const int64 N = input.NumElements();
+  if (N < kPartitionLimit) {
+    return SIMD;
+  }
+  const bool parallel = !serial && max_threads > 1;
+  const int64 uniq = EstimateUniqueKeys<T>(input);
+  VLOG(1) << "[UniqueAuto] " << N << " keys, about " << uniq << " unique";
+  if (uniq >= kAutoRadixUniqueRatio * N &&
+      (parallel || N >= kAutoSerialRadixLimit)) {
+    return RADIX;
+  }
+  return parallel ? GOOGLE : SIMD;
+}
+
+template<typename T, typename TIndex>
+typename std::enable_if<!std::is_integral<T>::value>::type
+IntegerKeysCompute(OpKernelContext* context, const Tensor& input,
+    Tensor* idx, int64 axis, int64* uniq_size, bool serial,
+    UniqueMaps map_flag, Tensor* output) {
+  // RADIX and SIMD work on integer keys only.
+  ComputeInternalWithHashMap<T, TIndex, google::dense_hash_map<T, TIndex>>
+      (context, input, idx, axis, uniq_size, input.NumElements(), serial,
+       output);
+}
+
+template<typename T, typename TIndex>
+typename std::enable_if<std::is_integral<T>::value>::type
+IntegerKeysCompute(OpKernelContext* context, const Tensor& input,
+    Tensor* idx, int64 axis, int64* uniq_size, bool serial,
+    UniqueMaps map_flag, Tensor* output) {
+  OP_REQUIRES(context, TensorShapeUtils::IsVector(input.shape()),
+              errors::InvalidArgument("unique expects a 1D vector."));
+  OP_REQUIRES(context,
+              input.NumElements() <= std::numeric_limits<int32>::max(),
+              errors::InvalidArgument(
+                  "unique does not support input tensors larger than ",
+                  std::numeric_limits<int32>::max(), " elements"));
+  if (map_flag == AUTO) {
+    int32 max_threads =
+        context->device()->tensorflow_cpu_worker_threads()->num_threads;
+    map_flag = SelectUniqueBackend<T>(input, max_threads, serial);
+    VLOG(1) << "[UniqueAuto] selected backend: " << map_flag;
+  }
+  switch (map_flag) {
+    case RADIX:
+      RadixSortCompute<T, TIndex>
+          (context, input, idx, axis, uniq_size, serial, output);
+      break;
+    case SIMD:
+      SimdHashCompute<T, TIndex>
+          (context, input, idx, axis, uniq_size, output);
+      break;
+    default:
+      ComputeInternalWithHashMap<T, TIndex, google::dense_hash_map<T, TIndex>>
+          (context, input, idx, axis, uniq_size, input.NumElements(), serial,
+           output);
+  }
+}
+
 template<typename T, typename TIndex>
 void UniqueInternal(OpKernelContext* context, const Tensor& input,
     Tensor* idx, Tensor* output, Tensor* output_counter, int num_outputs,
@@ -705,6 +1266,13 @@ void UniqueInternal(OpKernelContext* context, const Tensor& input,
         ComputeInternalWithHashMap<T, TIndex, DefaultHashMap>
             (context, input, idx, axis, &uniq_size_out, N, serial, output);
         break;
+      case RADIX:
+      case SIMD:
+      case AUTO:
+        IntegerKeysCompute<T, TIndex>
+            (context, input, idx, axis, &uniq_size_out, serial, map_flag,
+             output);
+        break;
       default:
         ComputeInternalWithHashMap<T, TIndex, DefaultHashMap>
             (context, input, idx, axis, &uniq_size_out, N, serial, output);
@@ -13,13 +13,19 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <cstdlib>
 #include <functional>
 #include <memory>
+#include <random>
+#include <unordered_map>
 
 #include "tensorflow/core/common_runtime/kernel_benchmark_testlib.h"
+#include "tensorflow/core/framework/fake_input.h"
+#include "tensorflow/core/framework/node_def_builder.h"
 #include "tensorflow/core/framework/tensor.h"
 #include "tensorflow/core/framework/tensor_shape.pb.h"
 #include "tensorflow/core/framework/types.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
 #include "tensorflow/core/framework/types.pb.h"
 #include "tensorflow/core/graph/node_builder.h"
 #include "tensorflow/core/graph/testlib.h"
@@ -138,6 +144,159 @@ static void BM_Unique_STRING(int iters, int dim) {
   test::Benchmark("cpu", g).Run(iters);
 }
 
+// Keys of which about `unique_percent` percent are unique.
+Tensor GetRandomInt64Tensor(int dim, int unique_percent) {
+  Tensor input(DT_INT64, TensorShape({dim}));
+  const int64 num_unique =
+      std::max(static_cast<int64>(dim) * unique_percent / 100,
+               static_cast<int64>(1));
+  std::mt19937_64 rng(dim);
+  auto input_flat = input.flat<int64>();
+  for (int i = 0; i < dim; ++i) {
+    input_flat(i) = static_cast<int64>(rng() % num_unique) * 7919 - 100;
+  }
+  return input;
+}
+
+class UniqueAliBackendTest : public OpsTestBase {
+ protected:
+  void RunUnique(const string& backend, const Tensor& input) {
+    setenv("DEEPREC_UNIQUE_OP_HASH_MAP", backend.c_str(), 1);
+    TF_ASSERT_OK(NodeDefBuilder("unique", "UniqueWithCounts")
+                     .Input(FakeInput(DT_INT64))
+                     .Attr("T", DT_INT64)
+                     .Attr("out_idx", DT_INT32)
+                     .Finalize(node_def()));
+    TF_ASSERT_OK(InitOp());
+    unsetenv("DEEPREC_UNIQUE_OP_HASH_MAP");
+    inputs_.clear();
+    AddInputFromArray<int64>(
+        input.shape(),
+        gtl::ArraySlice<int64>(input.flat<int64>().data(),
+                               input.NumElements()));
+    TF_ASSERT_OK(RunOpKernel());
+  }
+
+  // Checks the outputs against the keys in the order of their first
+  // occurrences.
+  void ExpectUnique(const Tensor& input) {
+    std::unordered_map<int64, int32> index;
+    std::vector<int64> keys;
+    std::vector<int32> idx;
+    std::vector<int32> counts;
+    auto input_flat = input.flat<int64>();
+    for (int64 i = 0; i < input.NumElements(); ++i) {
+      auto it = index.emplace(input_flat(i), keys.size());
+      if (it.second) {
+        keys.push_back(input_flat(i));
+        counts.push_back(0);
+      }
+      idx.push_back(it.first->second);
+      ++counts[it.first->second];
+    }
+    test::ExpectTensorEqual<int64>(
+        test::AsTensor<int64>(keys, {static_cast<int64>(keys.size())}),
+        *GetOutput(0));
+    test::ExpectTensorEqual<int32>(
+        test::AsTensor<int32>(idx, {static_cast<int64>(idx.size())}),
+        *GetOutput(1));
+    test::ExpectTensorEqual<int32>(
+        test::AsTensor<int32>(counts, {static_cast<int64>(counts.size())}),
+        *GetOutput(2));
+  }
+};
+
+TEST_F(UniqueAliBackendTest, Radix) {
+  for (int unique_percent : {1, 50, 100}) {
+    Tensor input = GetRandomInt64Tensor(100000, unique_percent);
+    RunUnique("RADIX", input);
+    ExpectUnique(input);
+  }
+}
+
+TEST_F(UniqueAliBackendTest, RadixExtremeKeys) {
+  Tensor input = test::AsTensor<int64>(
+      {std::numeric_limits<int64>::max(), -1, 0,
+       std::numeric_limits<int64>::min(), -1, 0,
+       std::numeric_limits<int64>::max()});
+  RunUnique("RADIX", input);
+  ExpectUnique(input);
+}
+
+TEST_F(UniqueAliBackendTest, SimdHash) {
+  for (int unique_percent : {1, 50, 100}) {
+    Tensor input = GetRandomInt64Tensor(10000, unique_percent);
+    RunUnique("SIMD", input);
+    ExpectUnique(input);
+  }
+}
+
+TEST_F(UniqueAliBackendTest, SimdHashEmptyKey) {
+  // The largest key marks the empty slots of the table.
+  Tensor input = test::AsTensor<int64>({-1, 3, -1, 3, 5});
+  RunUnique("SIMD", input);
+  ExpectUnique(input);
+}
+
+TEST_F(UniqueAliBackendTest, Auto) {
+  for (int dim : {0, 100, 100000}) {
+    for (int unique_percent : {1, 100}) {
+      Tensor input = GetRandomInt64Tensor(dim, unique_percent);
+      RunUnique("AUTO", input);
+      ExpectUnique(input);
+    }
+  }
+}
+
+// Sweeps the batch sizes and the ratios of unique keys to find the
+// crossovers of the backends.
+static void BM_UniqueAli_INT64(int iters, int dim, int unique_percent,
+                               const char* backend) {
+  testing::StopTiming();
+  setenv("DEEPREC_UNIQUE_OP_HASH_MAP", backend, 1);
+  Graph* g = new Graph(OpRegistry::Global());
+
+  Tensor input = GetRandomInt64Tensor(dim, unique_percent);
+
+  Node* node;
+  TF_CHECK_OK(NodeBuilder(g->NewName("n"), "Unique")
+                  .Input(test::graph::Constant(g, input))
+                  .Attr("T", DT_INT64)
+                  .Finalize(g, &node));
+
+  testing::BytesProcessed(static_cast<int64>(iters) * dim * sizeof(int64));
+  testing::UseRealTime();
+  testing::StartTiming();
+  test::Benchmark("cpu", g).Run(iters);
+  testing::StopTiming();
+  unsetenv("DEEPREC_UNIQUE_OP_HASH_MAP");
+}
+
+#define BM_UNIQUE_ALI_BACKEND(BACKEND)                                   \
+  static void BM_UniqueAli_##BACKEND(int iters, int dim,                 \
+                                     int unique_percent) {               \
+    BM_UniqueAli_INT64(iters, dim, unique_percent, #BACKEND);            \
+  }                                                                      \
+  BENCHMARK(BM_UniqueAli_##BACKEND)                                      \
+      ->ArgPair(16 * 1024, 1)                                            \
+      ->ArgPair(16 * 1024, 10)                                           \
+      ->ArgPair(16 * 1024, 50)                                           \
+      ->ArgPair(16 * 1024, 100)                                          \
+      ->ArgPair(256 * 1024, 1)                                           \
+      ->ArgPair(256 * 1024, 10)                                          \
+      ->ArgPair(256 * 1024, 50)                                          \
+      ->ArgPair(256 * 1024, 100)                                         \
+      ->ArgPair(4 * 1024 * 1024, 1)                                      \
+      ->ArgPair(4 * 1024 * 1024, 10)                                     \
+      ->ArgPair(4 * 1024 * 1024, 50)                                     \
+      ->ArgPair(4 * 1024 * 1024, 100);
+
+BM_UNIQUE_ALI_BACKEND(GOOGLE);
+BM_UNIQUE_ALI_BACKEND(MULTIMAP);
+BM_UNIQUE_ALI_BACKEND(RADIX);
+BM_UNIQUE_ALI_BACKEND(SIMD);
+BM_UNIQUE_ALI_BACKEND(AUTO);
+
 BENCHMARK(BM_Unique_INT32)
     ->ArgPair(32, 1024 * 1024)
     ->ArgPair(256, 1024 * 1024)
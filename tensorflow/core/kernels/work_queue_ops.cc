@@ -13,6 +13,8 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <cstddef>
 #include <deque>
@@ -44,6 +46,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/error_codes.pb.h"
 #include "tensorflow/core/lib/core/status.h"
 #include "tensorflow/core/lib/core/threadpool.h"
+#include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/lib/strings/numbers.h"
 #include "tensorflow/core/lib/strings/str_util.h"
 #include "tensorflow/core/lib/strings/strcat.h"
@@ -67,9 +70,19 @@ namespace tensorflow {
 
 using shape_inference::InferenceContext;
 
+// Works are distributed to shards by the hash of the work, so that a work is
+// always in the same shard across epochs. A client takes works from its own
+// shard first and steals works from the other shards when its shard is empty,
+// so the clients contend on different locks and keep reading the same works
+// in each epoch while the shards are balanced.
 class WorkQueue : public ResourceBase {
  public:
-  WorkQueue(const string& name) : name_(name), is_closed_(false) {}
+  WorkQueue(const string& name, int64 num_shards)
+      : name_(name), is_closed_(false), size_(0), next_shard_(0) {
+    for (int64 i = 0; i < num_shards; ++i) {
+      shards_.emplace_back(new Shard);
+    }
+  }
 
   ~WorkQueue() { Close(); }
 
@@ -78,75 +91,127 @@ class WorkQueue : public ResourceBase {
   }
 
   int64 MemoryUsed() const override {
-    return static_cast<int64>(queue_.size() * DataTypeSize(DT_STRING));
+    return std::max(size_.load(std::memory_order_relaxed), int64{0}) *
+           DataTypeSize(DT_STRING);
   }
 
   Status Put(const Tensor& inputs) {
     const int64 num_puts = inputs.shape().dim_size(0);
 
-    std::unique_lock<std::mutex> lock(mu_);
-    if (TF_PREDICT_FALSE(is_closed_)) {
-      lock.unlock();
-      take_cv_.notify_all();
-      LOG(WARNING) << "Work queue " << name_ << " reinitialized.";
+    {
+      std::unique_lock<std::mutex> lock(mu_);
+      if (TF_PREDICT_FALSE(is_closed_)) {
+        lock.unlock();
+        take_cv_.notify_all();
+        LOG(WARNING) << "Work queue " << name_ << " reinitialized.";
 
-      return Status::OK();
+        return Status::OK();
+      }
     }
 
+    std::vector<std::vector<string>> works(shards_.size());
     for (int64 i = 0; i < num_puts; ++i) {
-      queue_.push_back(inputs.flat<string>()(i));
+      const string& work = inputs.flat<string>()(i);
+      works[ShardOf(work)].push_back(work);
     }
-
-    lock.unlock();
-    take_cv_.notify_all();
+    for (size_t i = 0; i < shards_.size(); ++i) {
+      if (works[i].empty()) {
+        continue;
+      }
+      std::lock_guard<std::mutex> lock(shards_[i]->mu);
+      for (string& work : works[i]) {
+        shards_[i]->works.push_back(std::move(work));
+      }
+      size_.fetch_add(works[i].size(), std::memory_order_acq_rel);
+    }
+    NotifyAll();
 
     return Status::OK();
   }
 
-  Status Take(Tensor* output) {
-    std::unique_lock<std::mutex> lock(mu_);
-
-    take_cv_.wait(lock, [this]() { return !queue_.empty() || is_closed_; });
-
-    if (TF_PREDICT_FALSE(queue_.empty() && is_closed_)) {
-      return Status(errors::OutOfRange(
-          strings::StrCat("All works in work queue ", name_, " are taken.")));
+  // Takes at most `max_works` works, blocks until there is at least one work
+  // or the queue is closed. `client_index` selects the preferred shard, a
+  // negative `client_index` spreads the takes over the shards.
+  Status Take(int64 client_index, int64 max_works,
+              std::vector<string>* works) {
+    while (true) {
+      TakeFromShards(client_index, max_works, works);
+      if (!works->empty()) {
+        return Status::OK();
+      }
+
+      std::unique_lock<std::mutex> lock(mu_);
+      take_cv_.wait(lock, [this]() {
+        return size_.load(std::memory_order_acquire) > 0 || is_closed_;
+      });
+      if (TF_PREDICT_FALSE(size_.load(std::memory_order_acquire) <= 0 &&
+                           is_closed_)) {
+        return Status(errors::OutOfRange(
+            strings::StrCat("All works in work queue ", name_, " are taken.")));
+      }
     }
+  }
 
-    output->scalar<string>().setConstant(std::move(queue_.front()));
-    queue_.pop_front();
-
-    return Status::OK();
+  // Returns works taken but not handed out to the front of their shards.
+  void PutBack(std::vector<string>* works) {
+    std::vector<std::vector<string>> shard_works(shards_.size());
+    for (string& work : *works) {
+      shard_works[ShardOf(work)].push_back(std::move(work));
+    }
+    works->clear();
+    for (size_t i = 0; i < shards_.size(); ++i) {
+      if (shard_works[i].empty()) {
+        continue;
+      }
+      std::lock_guard<std::mutex> lock(shards_[i]->mu);
+      for (auto it = shard_works[i].rbegin(); it != shard_works[i].rend();
+           ++it) {
+        shards_[i]->works.push_front(std::move(*it));
+      }
+      size_.fetch_add(shard_works[i].size(), std::memory_order_acq_rel);
+    }
+    NotifyAll();
   }
 
   Status GetSize(Tensor* size) {
-    std::unique_lock<std::mutex> lock(mu_);
-    size->scalar<int64>().setConstant(static_cast<int64>(queue_.size()));
+    size->scalar<int64>().setConstant(
+        std::max(size_.load(std::memory_order_acquire), int64{0}));
     return Status::OK();
   }
 
   Status Restore(const Tensor& restorable) {
     const int64 num_works = restorable.shape().dim_size(0);
 
-    std::unique_lock<std::mutex> lock(mu_);
-
-    queue_.clear();
+    std::vector<std::unique_lock<std::mutex>> locks = LockShards();
+    for (auto& shard : shards_) {
+      shard->works.clear();
+    }
     for (int64 i = 0; i < num_works; ++i) {
-      queue_.push_back(restorable.flat<string>()(i));
+      const string& work = restorable.flat<string>()(i);
+      shards_[ShardOf(work)]->works.push_back(work);
     }
+    size_.store(num_works, std::memory_order_release);
+    locks.clear();
 
-    lock.unlock();
-    take_cv_.notify_all();
+    NotifyAll();
     return Status::OK();
   }
 
   Status Save(OpKernelContext* ctx, Tensor** saveable) {
-    std::unique_lock<std::mutex> lock(mu_);
+    // Holds all shards so that each work is either taken or saved.
+    std::vector<std::unique_lock<std::mutex>> locks = LockShards();
 
-    TF_RETURN_IF_ERROR(ctx->allocate_output(
-        0, TensorShape({static_cast<int64>(queue_.size())}), saveable));
-    for (size_t i = 0; i < queue_.size(); ++i) {
-      (*saveable)->flat<string>()(i) = queue_[i];
+    int64 num_works = 0;
+    for (auto& shard : shards_) {
+      num_works += shard->works.size();
+    }
+    TF_RETURN_IF_ERROR(
+        ctx->allocate_output(0, TensorShape({num_works}), saveable));
+    int64 i = 0;
+    for (auto& shard : shards_) {
+      for (const string& work : shard->works) {
+        (*saveable)->flat<string>()(i++) = work;
+      }
     }
 
     return Status::OK();
@@ -184,11 +249,70 @@ class WorkQueue : public ResourceBase {
   }
 
  private:
-  // TODO(yuanman.ym): Use memory efficient data structure, e.g. HAT-trie,
-  // to implement the string queue. (See https://github.com/Tessil/hat-trie)
-  std::deque<string> queue_;
+  struct Shard {
+    std::mutex mu;
+    // TODO(yuanman.ym): Use memory efficient data structure, e.g. HAT-trie,
+    // to implement the string queue. (See https://github.com/Tessil/hat-trie)
+    std::deque<string> works;
+  };
+
+  size_t ShardOf(const string& work) const {
+    if (shards_.size() == 1) {
+      return 0;
+    }
+    return Hash64(work) % shards_.size();
+  }
+
+  std::vector<std::unique_lock<std::mutex>> LockShards() {
+    std::vector<std::unique_lock<std::mutex>> locks;
+    for (auto& shard : shards_) {
+      locks.emplace_back(shard->mu);
+    }
+    return locks;
+  }
+
+  void TakeFromShards(int64 client_index, int64 max_works,
+                      std::vector<string>* works) {
+    const size_t num_shards = shards_.size();
+    const size_t first =
+        client_index >= 0
+            ? client_index % num_shards
+            : next_shard_.fetch_add(1, std::memory_order_relaxed) % num_shards;
+    for (size_t i = 0; i < num_shards; ++i) {
+      if (static_cast<int64>(works->size()) >= max_works ||
+          size_.load(std::memory_order_acquire) <= 0) {
+        return;
+      }
+      Shard* shard = shards_[(first + i) % num_shards].get();
+      int64 num_taken = 0;
+      {
+        std::lock_guard<std::mutex> lock(shard->mu);
+        while (!shard->works.empty() &&
+               static_cast<int64>(works->size()) < max_works) {
+          works->push_back(std::move(shard->works.front()));
+          shard->works.pop_front();
+          ++num_taken;
+        }
+        size_.fetch_sub(num_taken, std::memory_order_acq_rel);
+      }
+    }
+  }
+
+  // The waiters check the size under `mu_`, so a take either sees the new
+  // works or is waiting when notified.
+  void NotifyAll() {
+    std::unique_lock<std::mutex> lock(mu_);
+    lock.unlock();
+    take_cv_.notify_all();
+  }
+
   string name_;
   bool is_closed_;
+  // Number of works in all shards, only updated with the shards locked.
+  // Takes read it to skip locking the shards when the queue is empty.
+  std::atomic<int64> size_;
+  std::atomic<uint64> next_shard_;
+  std::vector<std::unique_ptr<Shard>> shards_;
   std::mutex mu_;
   std::condition_variable take_cv_;
   std::shared_ptr<thread::ThreadPool> threads_;
@@ -202,10 +326,11 @@ class WorkQueueCreateOp : public OpKernel {
  public:
   explicit WorkQueueCreateOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
     OP_REQUIRES_OK(ctx, ctx->GetAttr("shared_name", &shared_name_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("num_shards", &num_shards_));
   }
 
   void Compute(OpKernelContext* ctx) override {
-    WorkQueue* work_queue = new WorkQueue(shared_name_);
+    WorkQueue* work_queue = new WorkQueue(shared_name_, num_shards_);
     Status s = CreateResource(ctx, HandleFromInput(ctx, 0), work_queue);
     if (!s.ok() && s.code() != error::ALREADY_EXISTS) {
       OP_REQUIRES(ctx, false, s);
@@ -214,6 +339,7 @@ class WorkQueueCreateOp : public OpKernel {
 
  private:
   string shared_name_;
+  int64 num_shards_;
 };
 
 REGISTER_KERNEL_BUILDER(Name("WorkQueueCreate").Device(DEVICE_CPU),
@@ -305,6 +431,7 @@ class WorkQueueTakeOp : public AsyncOpKernel {
  public:
   explicit WorkQueueTakeOp(OpKernelConstruction* ctx) : AsyncOpKernel(ctx) {
     OP_REQUIRES_OK(ctx, ctx->GetAttr("num_clients", &num_clients_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("client_index", &client_index_));
   }
 
   void ComputeAsync(OpKernelContext* ctx,
@@ -317,18 +444,66 @@ class WorkQueueTakeOp : public AsyncOpKernel {
       Tensor* work;
       OP_REQUIRES_OK_ASYNC(ctx, ctx->allocate_output(0, TensorShape({}), &work),
                            done);
-      OP_REQUIRES_OK_ASYNC(ctx, work_queue->Take(work), done);
+      std::vector<string> works;
+      OP_REQUIRES_OK_ASYNC(ctx, work_queue->Take(client_index_, 1, &works),
+                           done);
+      work->scalar<string>()() = std::move(works[0]);
       done();
     });
   }
 
  private:
   int64 num_clients_;
+  int64 client_index_;
 };
 
 REGISTER_KERNEL_BUILDER(Name("WorkQueueTake").Device(DEVICE_CPU),
                         WorkQueueTakeOp);
 
+class WorkQueueTakeBatchOp : public AsyncOpKernel {
+ public:
+  explicit WorkQueueTakeBatchOp(OpKernelConstruction* ctx)
+      : AsyncOpKernel(ctx) {
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("num_clients", &num_clients_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("client_index", &client_index_));
+    OP_REQUIRES_OK(ctx, ctx->GetAttr("batch_size", &batch_size_));
+  }
+
+  void ComputeAsync(OpKernelContext* ctx,
+                    AsyncOpKernel::DoneCallback done) override {
+    WorkQueue* work_queue;
+    OP_REQUIRES_OK(ctx,
+                   LookupResource(ctx, HandleFromInput(ctx, 0), &work_queue));
+    core::ScopedUnref scoped_list(work_queue);
+    work_queue->Schedule(num_clients_, [this, ctx, done, work_queue]() {
+      std::vector<string> works;
+      OP_REQUIRES_OK_ASYNC(
+          ctx, work_queue->Take(client_index_, batch_size_, &works), done);
+      // The output size is only known after the take, so the works go
+      // back to the queue if it can't be allocated.
+      Tensor* output;
+      Status s = ctx->allocate_output(
+          0, TensorShape({static_cast<int64>(works.size())}), &output);
+      if (!s.ok()) {
+        work_queue->PutBack(&works);
+      }
+      OP_REQUIRES_OK_ASYNC(ctx, s, done);
+      for (size_t i = 0; i < works.size(); ++i) {
+        output->flat<string>()(i) = std::move(works[i]);
+      }
+      done();
+    });
+  }
+
+ private:
+  int64 num_clients_;
+  int64 client_index_;
+  int64 batch_size_;
+};
+
+REGISTER_KERNEL_BUILDER(Name("WorkQueueTakeBatch").Device(DEVICE_CPU),
+                        WorkQueueTakeBatchOp);
+
 class SaveLocalWorkOp : public OpKernel {
  public:
   explicit SaveLocalWorkOp(OpKernelConstruction* ctx) : OpKernel(ctx) {
@@ -320,6 +320,50 @@ Produces an output tensor with shape `indices.shape + params.shape[1:]` where:
 
 )doc");
 
+REGISTER_OP("_KvResourceHashUniqueGather")
+    .Input("resource: resource")
+    .Input("input: string")
+    .Input("default_value: dtype")
+    .Output("y: int64")
+    .Output("idx: out_idx")
+    .Output("count: out_idx")
+    .Output("output: dtype")
+    .Attr("num_buckets: int >= 1")
+    .Attr("with_counts: bool = false")
+    .Attr("is_use_default_value_tensor: bool = false")
+    .Attr("dtype: type")
+    .Attr("out_idx: {int32, int64} = DT_INT32")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeAndType handle_shape_and_type;
+      TF_RETURN_IF_ERROR(
+          ValidateVariableResourceHandle(c, &handle_shape_and_type));
+
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(
+          c->WithRankAtLeast(handle_shape_and_type.shape, 1, &unused));
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &unused));
+      bool with_counts;
+      TF_RETURN_IF_ERROR(c->GetAttr("with_counts", &with_counts));
+      ShapeHandle uniq_shape = c->Vector(InferenceContext::kUnknownDim);
+      c->set_output(0, uniq_shape);
+      c->set_output(1, c->input(1));
+      c->set_output(2, with_counts ? uniq_shape : c->Vector(0));
+      ShapeHandle out;
+      TF_RETURN_IF_ERROR(
+          c->Concatenate(uniq_shape, handle_shape_and_type.shape, &out));
+      c->set_output(3, out);
+      return Status::OK();
+    })
+    .Doc(R"doc(
+Fuses StringToHashBucketFast, Unique(WithCounts) and KvResourceGather(V1).
+
+`input` is hashed to `num_buckets` buckets, the bucket ids are uniqued to `y`
+with `idx`, and the embeddings of `y` are gathered from `resource` to
+`output`. `count` is the number of occurrences of each id in `y` when
+`with_counts` is true, which are also passed to the gather, and empty
+otherwise. Inserted by the graph fusion on CPU.
+)doc");
+
 REGISTER_OP("KvResourceScatterAdd")
     .Input("resource: resource")
     .Input("indices: Tkeys")
@@ -28,6 +28,9 @@ REGISTER_OP("ParquetTabularDatasetV1")
     .Attr("partition_count: int = 1")
     .Attr("partition_index: int = 0")
     .Attr("drop_remainder: bool = false")
+    .Attr("num_parallel_row_groups: int = 1")
+    .Attr("sloppy_row_groups: bool = false")
+    .Attr("string_views: bool = false")
     .SetIsStateful()  // NOTE: Source dataset ops must be marked stateful to
                       // inhibit constant folding.
     .SetShapeFn([](shape_inference::InferenceContext* c) {
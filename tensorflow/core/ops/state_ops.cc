@@ -296,4 +296,28 @@ REGISTER_OP("ResourceCountUpTo")
       return Status::OK();
     });
 
+// Worker-side cache of a dense variable on the ps, inserted by
+// DenseVariableCachePass.
+REGISTER_OP("_DenseVariableCacheRefresh")
+    .Output("refresh: bool")
+    .Attr("staleness: int >= 1")
+    .SetIsStateful()
+    .SetShapeFn(shape_inference::ScalarShape);
+
+REGISTER_OP("_DenseVariableCacheLookup")
+    .Input("trigger: bool")
+    .Output("value: dtype")
+    .Attr("dtype: type")
+    .Attr("shared_name: string")
+    .SetIsStateful()
+    .SetShapeFn(shape_inference::UnknownShape);
+
+REGISTER_OP("_DenseVariableCacheUpdate")
+    .Input("value: T")
+    .Output("output: T")
+    .Attr("T: type")
+    .Attr("shared_name: string")
+    .SetIsStateful()
+    .SetShapeFn(shape_inference::UnchangedShape);
+
 }  // namespace tensorflow
@@ -80,6 +80,24 @@ REGISTER_OP("StringToHashBucketFast")
     .Attr("num_buckets: int >= 1")
     .SetShapeFn(shape_inference::UnchangedShape);
 
+REGISTER_OP("StringViewToHashBucketFast")
+    .Input("values: uint8")
+    .Input("row_splits: Tsplits")
+    .Output("output: int64")
+    .Attr("num_buckets: int >= 1")
+    .Attr("Tsplits: {int32, int64} = DT_INT32")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 1, &unused));
+      ShapeHandle row_splits;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &row_splits));
+      DimensionHandle num_strings;
+      TF_RETURN_IF_ERROR(
+          c->Subtract(c->Dim(row_splits, 0), 1, &num_strings));
+      c->set_output(0, c->Vector(num_strings));
+      return Status::OK();
+    });
+
 REGISTER_OP("StringToHashBucketStrong")
     .Input("input: string")
     .Output("output: int64")
@@ -32,6 +32,7 @@ REGISTER_OP("TensorBufferPut")
     .Attr("shared_name: string = ''")
     .Attr("shared_capacity: int >= 1 = 1")
     .Attr("timeout_millis: int >= 1 = 1000")
+    .Attr("shared_max_capacity: int >= 0 = 0")
     .SetShapeFn(shape_inference::UnknownShape)
     .SetIsStateful();
 
@@ -42,6 +43,7 @@ REGISTER_OP("TensorBufferTake")
     .Attr("shared_name: string = ''")
     .Attr("shared_capacity: int >= 1 = 1")
     .Attr("shared_threads: int >= 1 = 1")
+    .Attr("shared_max_capacity: int >= 0 = 0")
     .SetShapeFn(shape_inference::UnknownShape)
     .SetIsStateful();
 
@@ -50,6 +52,7 @@ REGISTER_OP("TensorBufferCancel")
     .Attr("is_cancelled: bool = true")
     .Attr("shared_name: string = ''")
     .Attr("shared_capacity: int >= 1 = 1")
+    .Attr("shared_max_capacity: int >= 0 = 0")
     .SetShapeFn(shape_inference::UnknownShape)
     .SetIsStateful();
 
@@ -57,6 +60,7 @@ REGISTER_OP("TensorBufferClose")
     .Attr("container: string = ''")
     .Attr("shared_name: string = ''")
     .Attr("shared_capacity: int >= 1 = 1")
+    .Attr("shared_max_capacity: int >= 0 = 0")
     .SetShapeFn(shape_inference::UnknownShape)
     .SetIsStateful();
 
@@ -65,7 +69,49 @@ REGISTER_OP("TensorBufferSize")
     .Attr("container: string = ''")
     .Attr("shared_name: string = ''")
     .Attr("shared_capacity: int >= 1 = 1")
+    .Attr("shared_max_capacity: int >= 0 = 0")
     .SetShapeFn(shape_inference::ScalarShape)
     .SetIsStateful();
 
+REGISTER_OP("InputPipelineStatsEnable")
+    .Attr("enabled: bool = true")
+    .SetShapeFn(shape_inference::NoOutputs)
+    .SetIsStateful()
+    .Doc(R"doc(
+Enables or disables the stats of the input pipelines in this process.
+)doc");
+
+REGISTER_OP("InputPipelineStatsSummary")
+    .Output("names: string")
+    .Output("kinds: string")
+    .Output("stats: double")
+    .Attr("reset: bool = false")
+    .SetShapeFn([](shape_inference::InferenceContext* c) {
+      shape_inference::DimensionHandle num_stages = c->UnknownDim();
+      c->set_output(0, c->Vector(num_stages));
+      c->set_output(1, c->Vector(num_stages));
+      c->set_output(2, c->Matrix(num_stages, 7));
+      return Status::OK();
+    })
+    .SetIsStateful()
+    .Doc(R"doc(
+Summary of the stages of the input pipelines in this process.
+
+names: Prefixes of the iterators and shared names of the tensor buffers.
+kinds: Kinds of the stages, e.g. read, parse, map or stage.
+stats: For each stage, the number of elements, mean element latency, self
+  time, consumer wait and producer wait in microseconds, mean occupancy and
+  capacity.
+reset: Whether to clear the stats after reading them.
+)doc");
+
+REGISTER_OP("InputPipelineStatsReport")
+    .Output("report: string")
+    .SetShapeFn(shape_inference::ScalarShape)
+    .SetIsStateful()
+    .Doc(R"doc(
+Table of the stages of the input pipelines in this process, followed by the
+stage limiting the throughput.
+)doc");
+
 }
@@ -13,6 +13,7 @@ See the License for the specific language governing permissions and
 limitations under the License.
 ==============================================================================*/
 
+#include "tensorflow/core/framework/common_shape_fns.h"
 #include "tensorflow/core/framework/op.h"
 #include "tensorflow/core/framework/shape_inference.h"
 
@@ -1230,4 +1231,95 @@ REGISTER_OP("ResourceApplyPowerSign")
       return ApplyPowerSignShapeFn(c, /*sparse=*/false);
     });
 
+// Internal ops of the micro-batch pipeline, which accumulate the gradients of
+// the micro-batches of a step before the optimizer applies them once. See
+// GraphExecutionState::MicroBatchPipelineGraph.
+REGISTER_OP("_MicroBatchAccumulate")
+    .Input("grad: T")
+    .Attr("T: numbertype")
+    .Attr("shared_name: string")
+    .Attr("num_micro_batches: int >= 1")
+    .SetIsStateful()
+    .SetShapeFn(shape_inference::NoOutputs);
+
+REGISTER_OP("_MicroBatchSparseAccumulate")
+    .Input("grad: T")
+    .Input("indices: Tindices")
+    .Attr("T: numbertype")
+    .Attr("Tindices: {int32, int64}")
+    .Attr("shared_name: string")
+    .Attr("num_micro_batches: int >= 1")
+    .SetIsStateful()
+    .SetShapeFn(shape_inference::NoOutputs);
+
+REGISTER_OP("_MicroBatchTake")
+    .Output("grad: T")
+    .Attr("T: numbertype")
+    .Attr("shared_name: string")
+    .Attr("num_micro_batches: int >= 1")
+    .SetIsStateful()
+    .SetShapeFn(shape_inference::UnknownShape);
+
+REGISTER_OP("_MicroBatchSparseTake")
+    .Output("grad: T")
+    .Output("indices: Tindices")
+    .Attr("T: numbertype")
+    .Attr("Tindices: {int32, int64}")
+    .Attr("shared_name: string")
+    .Attr("num_micro_batches: int >= 1")
+    .SetIsStateful()
+    .SetShapeFn([](InferenceContext* c) {
+      c->set_output(0, c->UnknownShape());
+      c->set_output(1, c->Vector(InferenceContext::kUnknownDim));
+      return Status::OK();
+    });
+
+REGISTER_OP("_MicroBatchAbort")
+    .Attr("shared_name: string")
+    .Attr("reset: bool = false")
+    .SetIsStateful()
+    .SetShapeFn(shape_inference::NoOutputs);
+
+// Compressed transfer of the sparse gradients to the ps, inserted by
+// SparseGradientCompressionPass.
+REGISTER_OP("_SparseGradientEncode")
+    .Input("grad: float")
+    .Input("indices: Tindices")
+    .Output("encoded_indices: uint8")
+    .Output("values: Tvalues")
+    .Attr("Tindices: {int32, int64}")
+    .Attr("Tvalues: {half, bfloat16}")
+    .Attr("shared_name: string")
+    .Attr("error_feedback: bool = true")
+    .Attr("max_residual_rows: int >= 1 = 1048576")
+    .SetIsStateful()
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle grad;
+      TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(0), 1, &grad));
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(1), 1, &unused));
+      c->set_output(0, c->Vector(InferenceContext::kUnknownDim));
+      ShapeHandle values;
+      TF_RETURN_IF_ERROR(c->ReplaceDim(grad, 0, c->UnknownDim(), &values));
+      c->set_output(1, values);
+      return Status::OK();
+    });
+
+REGISTER_OP("_SparseGradientDecode")
+    .Input("encoded_indices: uint8")
+    .Input("values: Tvalues")
+    .Output("grad: float")
+    .Output("indices: Tindices")
+    .Attr("Tindices: {int32, int64}")
+    .Attr("Tvalues: {half, bfloat16}")
+    .SetShapeFn([](InferenceContext* c) {
+      ShapeHandle unused;
+      TF_RETURN_IF_ERROR(c->WithRank(c->input(0), 1, &unused));
+      ShapeHandle values;
+      TF_RETURN_IF_ERROR(c->WithRankAtLeast(c->input(1), 1, &values));
+      c->set_output(0, values);
+      c->set_output(1, c->Vector(c->Dim(values, 0)));
+      return Status::OK();
+    });
+
 }  // namespace tensorflow
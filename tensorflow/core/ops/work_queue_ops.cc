@@ -39,12 +39,15 @@ handle: Handle of a work queue.
 REGISTER_OP("WorkQueueCreate")
     .Input("handle: resource")
     .Attr("shared_name: string")
+    .Attr("num_shards: int >= 1 = 1")
     .SetShapeFn(tensorflow::shape_inference::NoOutputs)
     .Doc(R"doc(
 Creates a work queue and returns a handle to it.
 
 handle: Handle of a work queue.
 shared_name: Name of the work queue.
+num_shards: Number of shards of the works. A work is always put into the same
+  shard, clients take works from their own shard first.
 )doc");
 
 REGISTER_OP("WorkQueueClose")
@@ -109,6 +112,7 @@ REGISTER_OP("WorkQueueTake")
     .Input("handle: resource")
     .Output("work: string")
     .Attr("num_clients: int >= 1 = 1")
+    .Attr("client_index: int = -1")
     .SetShapeFn(shape_inference::ScalarShape)
     .SetIsStateful()
     .Doc(R"doc(
@@ -117,6 +121,32 @@ Take a work from the work queue.
 handle: Handle of a work queue.
 work: A tensor of taken work.
 num_clients:  Number of threads for taking works.
+client_index: Index of the client, which takes works from shard
+  `client_index % num_shards` first. Negative index takes works from the
+  shards in turn.
+)doc");
+
+REGISTER_OP("WorkQueueTakeBatch")
+    .Input("handle: resource")
+    .Output("works: string")
+    .Attr("num_clients: int >= 1 = 1")
+    .Attr("client_index: int = -1")
+    .Attr("batch_size: int >= 1")
+    .SetShapeFn([](InferenceContext* c) {
+      c->set_output(0, c->Vector(InferenceContext::kUnknownDim));
+      return Status::OK();
+    })
+    .SetIsStateful()
+    .Doc(R"doc(
+Takes at most `batch_size` works from the work queue.
+
+handle: Handle of a work queue.
+works: A vector of taken works, not empty.
+num_clients:  Number of threads for taking works.
+client_index: Index of the client, which takes works from shard
+  `client_index % num_shards` first. Negative index takes works from the
+  shards in turn.
+batch_size: Maximum number of works to take.
 )doc");
 
 REGISTER_OP("SaveLocalWork")
@@ -29,6 +29,7 @@ limitations under the License.
 #include "tensorflow/core/lib/core/errors.h"
 #include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/gtl/inlined_vector.h"
+#include "tensorflow/core/lib/hash/hash.h"
 #include "tensorflow/core/lib/monitoring/counter.h"
 #include "tensorflow/core/platform/byte_order.h"
 #include "tensorflow/core/platform/logging.h"
@@ -335,10 +336,11 @@ bool ParseFeatureMapEntry(protobuf::io::CodedInputStream* stream,
   return true;
 }
 
-bool ParseFeatures(protobuf::io::CodedInputStream* stream,
-                   parsed::Example* example) {
+// Calls `visit` with each entry of the feature map in the wire order. The
+// values are not decoded.
+template <typename Visit>
+bool ScanFeatures(protobuf::io::CodedInputStream* stream, const Visit& visit) {
   DCHECK(stream != nullptr);
-  DCHECK(example != nullptr);
   uint32 length;
   if (!stream->ReadVarint32(&length)) return false;
   auto limit = stream->PushLimit(length);
@@ -346,24 +348,25 @@ bool ParseFeatures(protobuf::io::CodedInputStream* stream,
     parsed::FeatureMapEntry feature_map_entry;
     if (!stream->ExpectTag(kDelimitedTag(1))) return false;
     if (!ParseFeatureMapEntry(stream, &feature_map_entry)) return false;
-    example->push_back(std::move(feature_map_entry));
+    visit(std::move(feature_map_entry));
   }
   stream->PopLimit(limit);
   return true;
 }
 
-bool ParseExample(protobuf::io::CodedInputStream* stream,
-                  parsed::Example* example) {
-  DCHECK(stream != nullptr);
-  DCHECK(example != nullptr);
+template <typename Visit>
+bool ScanExample(StringPiece serialized, const Visit& visit) {
+  protobuf::io::CodedInputStream stream(
+      reinterpret_cast<const uint8*>(serialized.data()), serialized.size());
+  EnableAliasing(&stream);
   // Loop over the input stream which may contain multiple serialized Example
   // protos merged together as strings. This behavior is consistent with Proto's
   // ParseFromString when string representations are concatenated.
-  while (!stream->ExpectAtEnd()) {
-    if (!stream->ExpectTag(kDelimitedTag(1))) {
-      if (!SkipExtraneousTag(stream)) return false;
+  while (!stream.ExpectAtEnd()) {
+    if (!stream.ExpectTag(kDelimitedTag(1))) {
+      if (!SkipExtraneousTag(&stream)) return false;
     } else {
-      if (!ParseFeatures(stream, example)) return false;
+      if (!ScanFeatures(&stream, visit)) return false;
     }
   }
   return true;
@@ -371,10 +374,10 @@ bool ParseExample(protobuf::io::CodedInputStream* stream,
 
 bool ParseExample(StringPiece serialized, parsed::Example* example) {
   DCHECK(example != nullptr);
-  protobuf::io::CodedInputStream stream(
-      reinterpret_cast<const uint8*>(serialized.data()), serialized.size());
-  EnableAliasing(&stream);
-  return ParseExample(&stream, example);
+  return ScanExample(serialized,
+                     [example](parsed::FeatureMapEntry&& feature_map_entry) {
+                       example->push_back(std::move(feature_map_entry));
+                     });
 }
 
 }  // namespace
@@ -482,6 +485,110 @@ struct SeededHasher {
   uint64 seed{0xDECAFCAFFE};
 };
 
+}  // namespace
+
+class FastParseExampleConfigIndex {
+ public:
+  FastParseExampleConfigIndex() : index_(0) {}
+
+  Status Init(const Config& config) {
+    size_t config_size = config.dense.size() + config.sparse.size();
+    index_.Clear(config_size);
+    bool ok = true;
+    for (size_t i = 0; i < 1000; ++i) {
+      for (size_t d = 0; d < config.dense.size(); ++d) {
+        ok &= index_.InsertUnique(hasher_(config.dense[d].feature_name),
+                                  {d, Type::Dense});
+      }
+      for (size_t d = 0; d < config.sparse.size(); ++d) {
+        ok &= index_.InsertUnique(hasher_(config.sparse[d].feature_name),
+                                  {d, Type::Sparse});
+      }
+      if (ok) break;
+      LOG(WARNING) << "Collision found. This should happen only if you have "
+                      "around 2^32 entries in your config.";
+      hasher_.seed++;
+      index_.Clear(config_size);
+      ok = true;
+    }
+    if (!ok) {
+      return errors::Internal(
+          "Could not avoid collision. This should not happen.");
+    }
+    fingerprint_ = Fingerprint(config);
+    return Status::OK();
+  }
+
+  bool Matches(const Config& config) const {
+    return fingerprint_ == Fingerprint(config);
+  }
+
+  // Finds the slot of the feature `feature_name` in `config`, which is the
+  // config of Init.
+  bool Find(const Config& config, StringPiece feature_name,
+            std::pair<size_t, Type>* d_and_type) const {
+    if (!index_.Find(hasher_(feature_name), d_and_type)) return false;
+    // Testing for PresizedCuckooMap collision.
+    const string& config_feature_name =
+        d_and_type->second == Type::Dense
+            ? config.dense[d_and_type->first].feature_name
+            : config.sparse[d_and_type->first].feature_name;
+    return feature_name == config_feature_name;
+  }
+
+ private:
+  // Fingerprint of the dense and the sparse feature names in their order,
+  // the slots of the index refer to them.
+  static uint64 Fingerprint(const Config& config) {
+    uint64 fingerprint =
+        Hash64Combine(config.dense.size(), config.sparse.size());
+    for (const auto& dense : config.dense) {
+      fingerprint = Hash64Combine(fingerprint, Hash64(dense.feature_name));
+    }
+    for (const auto& sparse : config.sparse) {
+      fingerprint = Hash64Combine(fingerprint, Hash64(sparse.feature_name));
+    }
+    return fingerprint;
+  }
+
+  SeededHasher hasher_;
+  PresizedCuckooMap<std::pair<size_t, Type>> index_;
+  uint64 fingerprint_ = 0;
+};
+
+Status CompileFastParseExampleConfig(FastParseExampleConfig* config) {
+  auto index = std::make_shared<FastParseExampleConfigIndex>();
+  TF_RETURN_IF_ERROR(index->Init(*config));
+  config->index = std::move(index);
+  return Status::OK();
+}
+
+namespace {
+
+// Returns the compiled index of `config`, or builds one if there is none.
+Status GetConfigIndex(
+    const Config& config,
+    std::shared_ptr<const FastParseExampleConfigIndex>* index) {
+  if (config.index != nullptr && config.index->Matches(config)) {
+    *index = config.index;
+    return Status::OK();
+  }
+  auto new_index = std::make_shared<FastParseExampleConfigIndex>();
+  TF_RETURN_IF_ERROR(new_index->Init(config));
+  *index = std::move(new_index);
+  return Status::OK();
+}
+
+// Buffers of a minibatch reused by its examples.
+struct ExampleScratch {
+  // The entries of the features in the config and their slots, the entries
+  // of the other features are skipped when scanning the example.
+  std::vector<std::pair<std::pair<size_t, Type>, parsed::FeatureMapEntry>>
+      features;
+  std::vector<int64> sparse_feature_last_example;
+  std::vector<int64> dense_feature_last_example;
+};
+
 template <typename T>
 class LimitedArraySlice {
  public:
@@ -544,23 +651,37 @@ void LogSparseFeatureDataLoss(StringPiece feature_name) {
 Status FastParseSerializedExample(
     const string& serialized_example, const string& example_name,
     const size_t example_index, const Config& config,
-    const PresizedCuckooMap<std::pair<size_t, Type>>& config_index,
-    SeededHasher hasher, std::vector<Tensor>* output_dense,
+    const FastParseExampleConfigIndex& config_index,
+    ExampleScratch* scratch, std::vector<Tensor>* output_dense,
     std::vector<SparseBuffer>* output_varlen_dense,
     std::vector<SparseBuffer>* output_sparse,
     PerExampleFeatureStats* output_stats) {
   DCHECK(output_dense != nullptr);
   DCHECK(output_sparse != nullptr);
-  parsed::Example parsed_example;
-  if (!ParseExample(serialized_example, &parsed_example)) {
+  // Only the features in the config are kept, so that examples with many
+  // other features don't pay for them after the scan.
+  auto& features = scratch->features;
+  features.clear();
+  size_t parsed_example_size = 0;
+  if (!ScanExample(serialized_example,
+                   [&](parsed::FeatureMapEntry&& feature_map_entry) {
+                     ++parsed_example_size;
+                     std::pair<size_t, Type> d_and_type;
+                     if (config_index.Find(config, feature_map_entry.first,
+                                           &d_and_type)) {
+                       features.emplace_back(d_and_type,
+                                             std::move(feature_map_entry));
+                     }
+                   })) {
     return errors::InvalidArgument("Could not parse example input, value: '",
                                    serialized_example, "'");
   }
-  std::vector<int64> sparse_feature_last_example(config.sparse.size(), -1);
-  std::vector<int64> dense_feature_last_example(config.dense.size(), -1);
-
-  // Handle features present in the example.
-  const size_t parsed_example_size = parsed_example.size();
+  // Indexed by the features, the examples of a minibatch have different
+  // indices.
+  std::vector<int64>& sparse_feature_last_example =
+      scratch->sparse_feature_last_example;
+  std::vector<int64>& dense_feature_last_example =
+      scratch->dense_feature_last_example;
 
   if (output_stats) {
     // TODO(b/111553342): This may over-count the number of features if there
@@ -569,30 +690,18 @@ Status FastParseSerializedExample(
     output_stats->features_count = parsed_example_size;
   }
 
-  for (size_t i = 0; i < parsed_example_size; ++i) {
+  // Handle features present in the example.
+  const size_t num_features = features.size();
+  for (size_t i = 0; i < num_features; ++i) {
     // This is a logic that standard protobuf parsing is implementing.
     // I.e. last entry in the map overwrites all the previous ones.
-    parsed::FeatureMapEntry& name_and_feature =
-        parsed_example[parsed_example_size - i - 1];
-
-    const StringPiece feature_name = name_and_feature.first;
-    parsed::Feature& feature = name_and_feature.second;
+    auto& slot_and_feature = features[num_features - i - 1];
 
-    std::pair<size_t, Type> d_and_type;
-    uint64 h = hasher(feature_name);
-    if (!config_index.Find(h, &d_and_type)) continue;
+    const StringPiece feature_name = slot_and_feature.second.first;
+    parsed::Feature& feature = slot_and_feature.second.second;
 
-    size_t d = d_and_type.first;
-    bool is_dense = d_and_type.second == Type::Dense;
-
-    {
-      // Testing for PresizedCuckooMap collision.
-      // TODO(lew): Use dense_hash_map and avoid this and hasher creation.
-      const string& config_feature_name = is_dense
-                                              ? config.dense[d].feature_name
-                                              : config.sparse[d].feature_name;
-      if (feature_name != config_feature_name) continue;
-    }
+    size_t d = slot_and_feature.first.first;
+    bool is_dense = slot_and_feature.first.second == Type::Dense;
 
     auto example_error = [&](StringPiece suffix) {
       return errors::InvalidArgument("Name: ", example_name,
@@ -1018,31 +1127,8 @@ Status FastParseExample(const Config& config,
     result->feature_stats.resize(serialized.size());
   }
 
-  size_t config_size = config.dense.size() + config.sparse.size();
-  SeededHasher hasher;
-  // Build config index.
-  PresizedCuckooMap<std::pair<size_t, Type>> config_index(config_size);
-  bool ok = true;
-  for (size_t i = 0; i < 1000; ++i) {
-    for (size_t d = 0; d < config.dense.size(); ++d) {
-      ok &= config_index.InsertUnique(hasher(config.dense[d].feature_name),
-                                      {d, Type::Dense});
-    }
-    for (size_t d = 0; d < config.sparse.size(); ++d) {
-      ok &= config_index.InsertUnique(hasher(config.sparse[d].feature_name),
-                                      {d, Type::Sparse});
-    }
-    if (ok) break;
-    LOG(WARNING) << "Collision found. This should happen only if you have "
-                    "around 2^32 entries in your config.";
-    hasher.seed++;
-    config_index.Clear(config_size);
-    ok = true;
-  }
-  if (!ok) {
-    return errors::Internal(
-        "Could not avoid collision. This should not happen.");
-  }
+  std::shared_ptr<const FastParseExampleConfigIndex> config_index;
+  TF_RETURN_IF_ERROR(GetConfigIndex(config, &config_index));
 
   // Allocate dense output for fixed length dense values
   // (variable-length dense and sparse have to be buffered).
@@ -1101,6 +1187,9 @@ Status FastParseExample(const Config& config,
   auto ProcessMiniBatch = [&](size_t minibatch) {
     sparse_buffers[minibatch].resize(config.sparse.size());
     varlen_dense_buffers[minibatch].resize(config.dense.size());
+    ExampleScratch scratch;
+    scratch.sparse_feature_last_example.resize(config.sparse.size(), -1);
+    scratch.dense_feature_last_example.resize(config.dense.size(), -1);
     size_t start = first_example_of_minibatch(minibatch);
     size_t end = first_example_of_minibatch(minibatch + 1);
     for (size_t e = start; e < end; ++e) {
@@ -1111,7 +1200,7 @@ Status FastParseExample(const Config& config,
       status_of_minibatch[minibatch] = FastParseSerializedExample(
           serialized[e],
           (!example_names.empty() ? example_names[e] : "<unknown>"), e, config,
-          config_index, hasher, &fixed_dense_values,
+          *config_index, &scratch, &fixed_dense_values,
           &varlen_dense_buffers[minibatch], &sparse_buffers[minibatch], stats);
       if (!status_of_minibatch[minibatch].ok()) break;
     }
@@ -1146,16 +1235,16 @@ Status FastParseExample(const Config& config,
     TensorShape indices_shape;
     indices_shape.AddDim(total_num_features);
     indices_shape.AddDim(2);
-    result->sparse_indices.emplace_back(DT_INT64, indices_shape);
-    Tensor* indices = &result->sparse_indices.back();
+    result->sparse_indices[d] = Tensor(DT_INT64, indices_shape);
+    Tensor* indices = &result->sparse_indices[d];
 
     TensorShape values_shape;
     values_shape.AddDim(total_num_features);
-    result->sparse_values.emplace_back(config.sparse[d].dtype, values_shape);
-    Tensor* values = &result->sparse_values.back();
+    result->sparse_values[d] = Tensor(config.sparse[d].dtype, values_shape);
+    Tensor* values = &result->sparse_values[d];
 
-    result->sparse_shapes.emplace_back(DT_INT64, TensorShape({2}));
-    auto shapes_shape_t = result->sparse_shapes.back().vec<int64>();
+    result->sparse_shapes[d] = Tensor(DT_INT64, TensorShape({2}));
+    auto shapes_shape_t = result->sparse_shapes[d].vec<int64>();
     shapes_shape_t(0) = serialized.size();
     shapes_shape_t(1) = max_num_features;
 
@@ -1262,13 +1351,24 @@ Status FastParseExample(const Config& config,
     }
   };
 
-  for (size_t d = 0; d < config.dense.size(); ++d) {
-    MergeDenseVarLenMinibatches(d);
-  }
-
-  for (size_t d = 0; d < config.sparse.size(); ++d) {
-    MergeSparseMinibatches(d);
-  }
+  // The features are merged independently, which is most of the work with
+  // many sparse features, so the merges are sharded over the threads.
+  result->sparse_indices.resize(config.sparse.size());
+  result->sparse_values.resize(config.sparse.size());
+  result->sparse_shapes.resize(config.sparse.size());
+  const size_t num_merges = config.dense.size() + config.sparse.size();
+  const size_t num_merge_shards =
+      std::min(std::max<size_t>(num_minibatches, 1), num_merges);
+  auto MergeShard = [&](size_t shard) {
+    for (size_t i = shard; i < num_merges; i += num_merge_shards) {
+      if (i < config.dense.size()) {
+        MergeDenseVarLenMinibatches(i);
+      } else {
+        MergeSparseMinibatches(i - config.dense.size());
+      }
+    }
+  };
+  ParallelFor(MergeShard, num_merge_shards, thread_pool);
 
   return Status::OK();
 }
@@ -1290,32 +1390,8 @@ Status FastParseSingleExample(const Config& config,
     stats = &result->feature_stats.back();
   }
 
-  // TODO(mrry): Cache the construction of this map at Op construction time.
-  size_t config_size = config.dense.size() + config.sparse.size();
-  SeededHasher hasher;
-  // Build config index.
-  PresizedCuckooMap<std::pair<size_t, Type>> config_index(config_size);
-  bool ok = true;
-  for (size_t i = 0; i < 1000; ++i) {
-    for (size_t d = 0; d < config.dense.size(); ++d) {
-      ok &= config_index.InsertUnique(hasher(config.dense[d].feature_name),
-                                      {d, Type::Dense});
-    }
-    for (size_t d = 0; d < config.sparse.size(); ++d) {
-      ok &= config_index.InsertUnique(hasher(config.sparse[d].feature_name),
-                                      {d, Type::Sparse});
-    }
-    if (ok) break;
-    LOG(WARNING) << "Collision found. This should happen only if you have "
-                    "around 2^32 entries in your config.";
-    hasher.seed++;
-    config_index.Clear(config_size);
-    ok = true;
-  }
-  if (!ok) {
-    return errors::Internal(
-        "Could not avoid collision. This should not happen.");
-  }
+  std::shared_ptr<const FastParseExampleConfigIndex> config_index;
+  TF_RETURN_IF_ERROR(GetConfigIndex(config, &config_index));
 
   // Allocate dense output tensors.
   for (size_t d = 0; d < config.dense.size(); ++d) {
@@ -1368,21 +1444,11 @@ Status FastParseSingleExample(const Config& config,
     parsed::Feature& feature = name_and_feature.second;
 
     std::pair<size_t, Type> d_and_type;
-    uint64 h = hasher(feature_name);
-    if (!config_index.Find(h, &d_and_type)) continue;
+    if (!config_index->Find(config, feature_name, &d_and_type)) continue;
 
     size_t d = d_and_type.first;
     bool is_dense = d_and_type.second == Type::Dense;
 
-    {
-      // Testing for PresizedCuckooMap collision.
-      // TODO(lew): Use dense_hash_map and avoid this and hasher creation.
-      const string& config_feature_name = is_dense
-                                              ? config.dense[d].feature_name
-                                              : config.sparse[d].feature_name;
-      if (feature_name != config_feature_name) continue;
-    }
-
     auto example_error = [feature_name](StringPiece suffix) {
       return errors::InvalidArgument("Key: ", feature_name, ".  ", suffix);
     };
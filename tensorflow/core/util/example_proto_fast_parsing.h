@@ -16,6 +16,7 @@ limitations under the License.
 #ifndef TENSORFLOW_CORE_UTIL_EXAMPLE_PROTO_FAST_PARSING_H_
 #define TENSORFLOW_CORE_UTIL_EXAMPLE_PROTO_FAST_PARSING_H_
 
+#include <memory>
 #include <string>
 #include <unordered_map>
 #include <vector>
@@ -34,6 +35,8 @@ limitations under the License.
 namespace tensorflow {
 namespace example {
 
+class FastParseExampleConfigIndex;
+
 // FastParseExampleConfig defines how to parse features in Example.
 // Each sub-config is responsible for one feature identified with feautre_name.
 // FastParseExampleConfig can't have two sub-configs with the same feature_name.
@@ -63,8 +66,17 @@ struct FastParseExampleConfig {
   // If `true`, `Result::feature_stats` will contain one
   // `PerExampleFeatureStats` for each serialized example in the input.
   bool collect_feature_stats = false;
+
+  // Index of the feature names built by CompileFastParseExampleConfig. If it
+  // is not set, each parse builds one.
+  std::shared_ptr<const FastParseExampleConfigIndex> index;
 };
 
+// Builds the index of the feature names of `config`, so that the parses with
+// the config don't hash all the feature names again. The config has to be
+// compiled again after its features change.
+Status CompileFastParseExampleConfig(FastParseExampleConfig* config);
+
 // Statistics about the features in each example passed to
 // `FastParse[Single]Example()`.
 //
@@ -103,7 +115,6 @@ Status FastParseExample(const FastParseExampleConfig& config,
                         gtl::ArraySlice<tstring> example_names,
                         thread::ThreadPool* thread_pool, Result* result);
 
-// TODO(mrry): Move the hash table construction into the config object.
 typedef FastParseExampleConfig FastParseSingleExampleConfig;
 
 Status FastParseSingleExample(const FastParseSingleExampleConfig& config,
@@ -19,6 +19,9 @@ limitations under the License.
 
 #include "tensorflow/core/example/example.pb.h"
 #include "tensorflow/core/example/feature.pb.h"
+#include "tensorflow/core/framework/tensor_testutil.h"
+#include "tensorflow/core/lib/core/status_test_util.h"
+#include "tensorflow/core/lib/core/threadpool.h"
 #include "tensorflow/core/lib/random/philox_random.h"
 #include "tensorflow/core/lib/random/simple_philox.h"
 #include "tensorflow/core/platform/protobuf.h"
@@ -321,6 +324,100 @@ TEST(FastParse, StatsCollection) {
   }
 }
 
+void ExpectTensorEqual(const Tensor& x, const Tensor& y) {
+  ASSERT_EQ(x.dtype(), y.dtype());
+  switch (x.dtype()) {
+    case DT_INT64:
+      test::ExpectTensorEqual<int64>(x, y);
+      break;
+    case DT_FLOAT:
+      test::ExpectTensorEqual<float>(x, y);
+      break;
+    case DT_STRING:
+      test::ExpectTensorEqual<tstring>(x, y);
+      break;
+    default:
+      FAIL() << "Unexpected type " << DataTypeString(x.dtype());
+  }
+}
+
+void ExpectResultsEqual(const Result& expected, const Result& result) {
+  ASSERT_EQ(expected.dense_values.size(), result.dense_values.size());
+  for (size_t d = 0; d < expected.dense_values.size(); ++d) {
+    ExpectTensorEqual(expected.dense_values[d], result.dense_values[d]);
+  }
+  ASSERT_EQ(expected.sparse_values.size(), result.sparse_values.size());
+  for (size_t d = 0; d < expected.sparse_values.size(); ++d) {
+    ExpectTensorEqual(expected.sparse_indices[d], result.sparse_indices[d]);
+    ExpectTensorEqual(expected.sparse_values[d], result.sparse_values[d]);
+    ExpectTensorEqual(expected.sparse_shapes[d], result.sparse_shapes[d]);
+  }
+}
+
+TEST(FastParse, CompiledConfig) {
+  const size_t kNumExamples = 100;
+  // Concatenated examples repeat the features, the last ones are kept.
+  std::vector<tstring> serialized(
+      kNumExamples, ExampleWithSomeFeatures() + ExampleWithSomeFeatures());
+
+  FastParseExampleConfig config;
+  AddDenseFeature("bytes_list", DT_STRING, {2}, false, 2, &config);
+  AddDenseFeature("float_list", DT_FLOAT, {-1}, true, 1, &config);
+  AddSparseFeature("int64_list", DT_INT64, &config);
+  AddSparseFeature("empty_int64_list", DT_INT64, &config);
+  AddSparseFeature("missing", DT_STRING, &config);
+  FastParseExampleConfig compiled_config = config;
+  TF_ASSERT_OK(CompileFastParseExampleConfig(&compiled_config));
+
+  Result expected;
+  TF_ASSERT_OK(FastParseExample(config, serialized, {}, nullptr, &expected));
+  EXPECT_EQ(kNumExamples * 3, expected.sparse_values[0].NumElements());
+  EXPECT_EQ(0, expected.sparse_values[2].NumElements());
+  thread::ThreadPool thread_pool(Env::Default(), "fast_parse", 4);
+  for (thread::ThreadPool* pool : {static_cast<thread::ThreadPool*>(nullptr),
+                                   &thread_pool}) {
+    Result result;
+    TF_ASSERT_OK(
+        FastParseExample(compiled_config, serialized, {}, pool, &result));
+    ExpectResultsEqual(expected, result);
+  }
+
+  Result single_expected;
+  TF_ASSERT_OK(FastParseSingleExample(config, serialized[0], &single_expected));
+  Result single_result;
+  TF_ASSERT_OK(
+      FastParseSingleExample(compiled_config, serialized[0], &single_result));
+  ExpectResultsEqual(single_expected, single_result);
+}
+
+TEST(FastParse, StaleCompiledConfig) {
+  std::vector<tstring> serialized(3, ExampleWithSomeFeatures());
+  FastParseExampleConfig config;
+  AddSparseFeature("int64_list", DT_INT64, &config);
+  TF_ASSERT_OK(CompileFastParseExampleConfig(&config));
+  // The index of a config with other features is rebuilt.
+  AddSparseFeature("float_list", DT_FLOAT, &config);
+
+  Result result;
+  TF_ASSERT_OK(FastParseExample(config, serialized, {}, nullptr, &result));
+  ASSERT_EQ(2, result.sparse_values.size());
+  EXPECT_EQ(6, result.sparse_values[1].NumElements());
+
+  // So is the index of a config with the same number of other features.
+  TF_ASSERT_OK(CompileFastParseExampleConfig(&config));
+  config.sparse[0] = config.sparse[1];
+  config.sparse[1].feature_name = "int64_list";
+  config.sparse[1].dtype = DT_INT64;
+  Result swapped_result;
+  TF_ASSERT_OK(
+      FastParseExample(config, serialized, {}, nullptr, &swapped_result));
+  ASSERT_EQ(2, swapped_result.sparse_values.size());
+  EXPECT_EQ(DT_FLOAT, swapped_result.sparse_values[0].dtype());
+  EXPECT_EQ(6, swapped_result.sparse_values[0].NumElements());
+  test::ExpectTensorEqual<int64>(result.sparse_values[0],
+                                 swapped_result.sparse_values[1]);
+}
+
 string RandStr(random::SimplePhilox* rng) {
   static const char key_char_lookup[] =
       "0123456789{}~`!@#$%^&*()"
@@ -192,6 +192,87 @@ class ParquetDatasetTest(test_base.DatasetTestBase):
       with self.assertRaises(tf.errors.OutOfRangeError):
         sess.run(batch)
 
+  def _read_row_groups(self, num_parallel_row_groups, sloppy_row_groups,
+                       drop_remainder=False):
+    filename = os.path.join(self._workspace, 'test_row_groups.parquet')
+    self._df.to_parquet(filename, row_group_size=50)
+    batch_size = 20
+    with tf.Graph().as_default() as graph:
+      ds = parquet_dataset_ops.ParquetDataset(
+        filename,
+        batch_size=batch_size,
+        fields=[parquet_dataset_ops.DataFrame.Field('A', tf.int64)],
+        drop_remainder=drop_remainder,
+        num_parallel_row_groups=num_parallel_row_groups,
+        sloppy_row_groups=sloppy_row_groups)
+      batch = tf.data.make_one_shot_iterator(ds).get_next()
+
+    results = []
+    with tf.Session(graph=graph) as sess:
+      while True:
+        try:
+          results.append(sess.run(batch)['A'])
+        except tf.errors.OutOfRangeError:
+          break
+    return results
+
+  def test_read_parallel_row_groups(self):
+    results = self._read_row_groups(3, False)
+    # Batches cross the row groups of 50 rows.
+    self.assertEqual([20] * 10, [len(r) for r in results])
+    np.testing.assert_equal(
+      np.concatenate(results), self._df['A'].to_numpy())
+
+  def test_read_parallel_row_groups_sloppy(self):
+    results = self._read_row_groups(3, True)
+    np.testing.assert_equal(
+      np.sort(np.concatenate(results)), np.sort(self._df['A'].to_numpy()))
+
+  def test_read_parallel_row_groups_drop_remainder(self):
+    self._df = self._df[:190]
+    results = self._read_row_groups(2, False, drop_remainder=True)
+    # Only the last partial batch of the file is dropped.
+    self.assertEqual([20] * 9, [len(r) for r in results])
+    np.testing.assert_equal(
+      np.concatenate(results), self._df['A'].to_numpy()[:180])
+
+  def test_read_parallel_row_groups_sloppy_drop_remainder(self):
+    self._df = self._df[:190]
+    results = self._read_row_groups(3, True, drop_remainder=True)
+    self.assertEqual([20] * 9, [len(r) for r in results])
+
+  def test_read_string_views(self):
+    filename = os.path.join(self._workspace, 'test_string_views.parquet')
+    strings = pd.DataFrame({'S': [f'str{v}' * (v % 3) for v in self._df['A']]})
+    strings.to_parquet(filename)
+    batch_size = 32
+    with tf.Graph().as_default() as graph:
+      ds = parquet_dataset_ops.ParquetDataset(
+        filename,
+        batch_size=batch_size,
+        fields=[parquet_dataset_ops.DataFrame.Field('S', tf.string)],
+        string_views=True)
+      batch = tf.data.make_one_shot_iterator(ds).get_next()
+      buckets = parquet_dataset_ops.DataFrame.string_view_to_hash_bucket_fast(
+        batch['S'], 1000)
+      actual_strings = tf.placeholder(tf.string, [None])
+      expected_buckets = tf.strings.to_hash_bucket_fast(actual_strings, 1000)
+
+    s = strings['S']
+    with tf.Session(graph=graph) as sess:
+      for i in xrange(len(s) // batch_size):
+        result, result_buckets = sess.run([batch, buckets])
+        start_row = i * batch_size
+        end_row = (i + 1) * batch_size
+        splits = result['S'].nested_row_splits[0]
+        values = result['S'].values.tobytes()
+        actual = [values[splits[j]:splits[j + 1]].decode()
+                  for j in xrange(len(splits) - 1)]
+        self.assertEqual(s[start_row:end_row].tolist(), actual)
+        np.testing.assert_equal(
+          result_buckets,
+          sess.run(expected_buckets, feed_dict={actual_strings: actual}))
+
 
 if __name__ == "__main__":
     test.main()
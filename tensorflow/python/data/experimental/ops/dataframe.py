@@ -33,6 +33,7 @@ from tensorflow.python.framework import tensor_shape
 from tensorflow.python.framework import tensor_spec
 from tensorflow.python.ops import array_ops
 from tensorflow.python.ops import gen_ragged_conversion_ops
+from tensorflow.python.ops import gen_string_ops
 from tensorflow.python.ops import math_ops
 from tensorflow.python.ops import sparse_ops
 from tensorflow.python.ops.ragged import ragged_tensor
@@ -195,6 +196,33 @@ class DataFrame(object):  # pylint: disable=useless-object-inheritance
       return features
     raise ValueError(f'{features} not supported')
 
+  @classmethod
+  def string_view_to_hash_bucket_fast(cls, value, num_buckets, name=None):
+    """Hash the strings read with `string_views` to buckets.
+
+    The buckets are the same as `tf.strings.to_hash_bucket_fast` of the
+    strings, which are not materialized.
+
+    Args:
+      value: A `DataFrame.Value` of the `tf.uint8` bytes of the strings, the
+        first row splits are the offsets of the strings.
+      num_buckets: The number of buckets.
+      name: (Optional.) Name of the op.
+
+    Returns:
+      A `tf.int64` tensor of the buckets if the strings are not ragged,
+      otherwise a `DataFrame.Value` of the buckets and the outer row splits.
+    """
+    if (not isinstance(value, DataFrame.Value)
+        or value.values.dtype != dtypes.uint8
+        or not value.nested_row_splits):
+      raise ValueError(f'{value} is not a string view')
+    buckets = gen_string_ops.string_view_to_hash_bucket_fast(
+      value.values, value.nested_row_splits[0], num_buckets, name=name)
+    if len(value.nested_row_splits) == 1:
+      return buckets
+    return DataFrame.Value(buckets, value.nested_row_splits[1:])
+
   @classmethod
   def unbatch_and_to_sparse(cls, features):
     """Unbatch and convert a row of DataFrame to tensors or sparse tensors."""
@@ -91,7 +91,10 @@ class _ParquetDataset(dataset_ops.DatasetSource):  # pylint: disable=abstract-me
       self, filename, batch_size, fields,
       partition_count=1,
       partition_index=0,
-      drop_remainder=False):
+      drop_remainder=False,
+      num_parallel_row_groups=1,
+      sloppy_row_groups=False,
+      string_views=False):
     """Create a `ParquetDataset`.
 
     Args:
@@ -102,18 +105,21 @@ class _ParquetDataset(dataset_ops.DatasetSource):  # pylint: disable=abstract-me
       partition_index: (Optional.) Index of row group partitions.
       drop_remainder: (Optional.) If True, only keep batches with exactly
         `batch_size` samples.
+      num_parallel_row_groups: (Optional.) Number of row groups to decode in
+        parallel.
+      sloppy_row_groups: (Optional.) If True, produce batches of the parallel
+        row groups in the order they are decoded.
+      string_views: (Optional.) If True, read string fields as `tf.uint8`
+        bytes of the strings and the row splits of each string.
     """
     self._filename = ops.convert_to_tensor(
       filename, dtype=dtypes.string, name='filename')
     self._batch_size = ops.convert_to_tensor(
       batch_size, dtype=dtypes.int64, name='batch_size')
     self._fields = fields
+    self._string_views = string_views
     self._output_specs = {
-      f.name: (
-        DataFrameValueSpec(f)
-        if f.ragged_rank > 0
-        else tensor_spec.TensorSpec(shape=[None], dtype=f.dtype))
-      for f in self._fields}
+      f.name: self._output_spec(f) for f in self._fields}
     self._field_names = nest.flatten({f.name: f.name for f in self._fields})
     self._field_dtypes = nest.flatten({f.name: f.dtype for f in self._fields})
     self._field_ragged_ranks = nest.flatten(
@@ -121,6 +127,8 @@ class _ParquetDataset(dataset_ops.DatasetSource):  # pylint: disable=abstract-me
     self._partition_count = partition_count
     self._partition_index = partition_index
     self._drop_remainder = drop_remainder
+    self._num_parallel_row_groups = num_parallel_row_groups
+    self._sloppy_row_groups = sloppy_row_groups
 
     variant_tensor = gen_parquet_ops.parquet_tabular_dataset_v1(
       self._filename,
@@ -130,9 +138,20 @@ class _ParquetDataset(dataset_ops.DatasetSource):  # pylint: disable=abstract-me
       field_ragged_ranks=self._field_ragged_ranks,
       partition_count=self._partition_count,
       partition_index=self._partition_index,
-      drop_remainder=self._drop_remainder)
+      drop_remainder=self._drop_remainder,
+      num_parallel_row_groups=self._num_parallel_row_groups,
+      sloppy_row_groups=self._sloppy_row_groups,
+      string_views=self._string_views)
     super().__init__(variant_tensor)
 
+  def _output_spec(self, field):
+    if self._string_views and field.dtype == dtypes.string:
+      return DataFrameValueSpec(
+        DataFrame.Field(field.name, dtypes.uint8, field.ragged_rank + 1))
+    if field.ragged_rank > 0:
+      return DataFrameValueSpec(field)
+    return tensor_spec.TensorSpec(shape=[None], dtype=field.dtype)
+
   @property
   def element_spec(self):
     return self._output_specs
@@ -165,7 +184,10 @@ class ParquetDataset(dataset_ops.DatasetV2):  # pylint: disable=abstract-method
       partition_index=0,
       drop_remainder=False,
       num_parallel_reads=None,
-      num_sequential_reads=1):
+      num_sequential_reads=1,
+      num_parallel_row_groups=1,
+      sloppy_row_groups=False,
+      string_views=False):
     """Create a `ParquetDataset`.
 
     Args:
@@ -182,11 +204,24 @@ class ParquetDataset(dataset_ops.DatasetV2):  # pylint: disable=abstract-method
         sequentially.
       num_sequential_reads: (Optional.) A `tf.int64` scalar representing the
         number of batches to read in sequential. Defaults to 1.
+      num_parallel_row_groups: (Optional.) Number of row groups of a file to
+        decode in parallel, the compressed column chunks of as many next row
+        groups are prefetched. Defaults to decoding row groups sequentially.
+      sloppy_row_groups: (Optional.) If True, produce batches of the parallel
+        row groups in the order they are decoded instead of the order in the
+        file.
+      string_views: (Optional.) If True, read string fields as `tf.uint8`
+        bytes of the strings and the row splits of each string without
+        materializing the strings, see
+        `DataFrame.string_view_to_hash_bucket_fast`.
     """
     filenames, self._fields = parquet_filenames_and_fields(filenames, fields)
     self._partition_count = partition_count
     self._partition_index = partition_index
     self._drop_remainder = drop_remainder
+    self._num_parallel_row_groups = num_parallel_row_groups
+    self._sloppy_row_groups = sloppy_row_groups
+    self._string_views = string_views
 
     def _create_dataset(f):
       f = ops.convert_to_tensor(f, dtypes.string, name='filename')
@@ -195,7 +230,10 @@ class ParquetDataset(dataset_ops.DatasetV2):  # pylint: disable=abstract-method
         fields=self._fields,
         partition_count=self._partition_count,
         partition_index=self._partition_index,
-        drop_remainder=self._drop_remainder)
+        drop_remainder=self._drop_remainder,
+        num_parallel_row_groups=self._num_parallel_row_groups,
+        sloppy_row_groups=self._sloppy_row_groups,
+        string_views=self._string_views)
     self._impl = self._build_dataset(
       _create_dataset, filenames,
       num_parallel_reads=num_parallel_reads,
@@ -218,6 +256,18 @@ class ParquetDataset(dataset_ops.DatasetV2):  # pylint: disable=abstract-method
   def drop_remainder(self):
     return self._drop_remainder
 
+  @property
+  def num_parallel_row_groups(self):
+    return self._num_parallel_row_groups
+
+  @property
+  def sloppy_row_groups(self):
+    return self._sloppy_row_groups
+
+  @property
+  def string_views(self):
+    return self._string_views
+
   def _inputs(self):
     return self._impl._inputs()  # pylint: disable=protected-access
 
@@ -251,7 +301,10 @@ def read_parquet(
     partition_index=0,
     drop_remainder=False,
     num_parallel_reads=None,
-    num_sequential_reads=1):
+    num_sequential_reads=1,
+    num_parallel_row_groups=1,
+    sloppy_row_groups=False,
+    string_views=False):
   """Create a `ParquetDataset` from filenames dataset.
 
     Args:
@@ -266,6 +319,12 @@ def read_parquet(
         sequentially.
       num_sequential_reads: (Optional.) A `tf.int64` scalar representing the
         number of batches to read in sequential. Defaults to 1.
+      num_parallel_row_groups: (Optional.) Number of row groups of a file to
+        decode in parallel. Defaults to decoding row groups sequentially.
+      sloppy_row_groups: (Optional.) If True, produce batches of the parallel
+        row groups in the order they are decoded.
+      string_views: (Optional.) If True, read string fields as `tf.uint8`
+        bytes of the strings and the row splits of each string.
     """
   def _apply_fn(filenames):
     return ParquetDataset(
@@ -276,6 +335,9 @@ def read_parquet(
       partition_index=partition_index,
       drop_remainder=drop_remainder,
       num_parallel_reads=num_parallel_reads,
-      num_sequential_reads=num_sequential_reads)
+      num_sequential_reads=num_sequential_reads,
+      num_parallel_row_groups=num_parallel_row_groups,
+      sloppy_row_groups=sloppy_row_groups,
+      string_views=string_views)
 
   return _apply_fn
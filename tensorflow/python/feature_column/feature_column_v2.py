@@ -131,6 +131,7 @@ import abc
 import collections
 import contextlib
 import math
+import os
 
 import numpy as np
 import six
@@ -4159,6 +4160,27 @@ class CutoffCategoricalColumn(
     return cls(**kwargs)
 
 
+def _hashed_embedding_input(categorical_column, sparse_ids, sparse_weights):
+  """Returns the strings and the number of buckets hashed to `sparse_ids`.
+
+  Only the ids of a string `EmbeddingCategoricalColumn` without weights are
+  looked up from the strings, so the hashing can be fused with the lookup,
+  returns None for the others. The empty rows then look up hash("") instead
+  of id 0, so it is only done when TF_HASH_UNIQUE_GATHER_FUSION=1.
+  """
+  if os.environ.get("TF_HASH_UNIQUE_GATHER_FUSION", "0") != "1":
+    return None
+  if (not isinstance(categorical_column, EmbeddingCategoricalColumn) or
+      categorical_column.dtype != dtypes.string or sparse_weights is not None):
+    return None
+  hash_op = sparse_ids.values.op
+  if hash_op.type != 'StringToHashBucketFast':
+    return None
+  sparse_strings = sparse_tensor_lib.SparseTensor(
+      sparse_ids.indices, hash_op.inputs[0], sparse_ids.dense_shape)
+  return sparse_strings, hash_op.get_attr('num_buckets')
+
+
 class EmbeddingColumn(
     DenseColumn,
     SequenceDenseColumn,
@@ -4278,6 +4300,17 @@ class EmbeddingColumn(
             combiner=self.combiner,
             name='%s_weights' % self.name,
             max_norm=self.max_norm)
+    hashed = _hashed_embedding_input(self.categorical_column, sparse_ids,
+                                     sparse_weights)
+    if hashed is not None:
+      sparse_strings, num_buckets = hashed
+      return embedding_ops.hashed_safe_embedding_lookup_sparse(
+          embedding_weights,
+          sparse_strings,
+          num_buckets,
+          combiner=self.combiner,
+          name='%s_weights' % self.name,
+          max_norm=self.max_norm)
     else:
       return embedding_ops.safe_embedding_lookup_sparse(
           embedding_weights=embedding_weights,
@@ -4663,6 +4696,17 @@ class SharedEmbeddingColumnV2(
           combiner=self.combiner,
           name='%s_weights' % self.name,
           max_norm=self.max_norm)
+    hashed = _hashed_embedding_input(self.categorical_column, sparse_ids,
+                                     sparse_weights)
+    if hashed is not None:
+      sparse_strings, num_buckets = hashed
+      return embedding_ops.hashed_safe_embedding_lookup_sparse(
+          embedding_weights,
+          sparse_strings,
+          num_buckets,
+          combiner=self.combiner,
+          name='%s_weights' % self.name,
+          max_norm=self.max_norm)
     else:
       return embedding_ops.safe_embedding_lookup_sparse(
           embedding_weights=embedding_weights,
@@ -21,6 +21,7 @@ from tensorflow.python.framework import constant_op
 from tensorflow.python.framework import dtypes
 from tensorflow.python.framework import test_util
 from tensorflow.python.ops import array_ops
+from tensorflow.python.ops import gen_string_ops
 from tensorflow.python.ops import string_ops
 from tensorflow.python.platform import test
 
@@ -49,6 +50,27 @@ class StringToHashBucketOpTest(test.TestCase):
       # Fingerprint64('d') -> 4470636696479570465 -> mod 10 -> 5
       self.assertAllEqual([9, 2, 2, 5] * 65536, result)
 
+  def testStringViewToHashBucketsFast(self):
+    with self.cached_session():
+      strings = ['a', 'bc', '', 'd'] * 1024
+      values = constant_op.constant(
+          list(bytearray(''.join(strings).encode())), dtype=dtypes.uint8)
+      splits = [0]
+      for s in strings:
+        splits.append(splits[-1] + len(s))
+      for splits_dtype in (dtypes.int32, dtypes.int64):
+        output = gen_string_ops.string_view_to_hash_bucket_fast(
+            values, constant_op.constant(splits, dtype=splits_dtype), 10)
+        expected = string_ops.string_to_hash_bucket_fast(strings, 10)
+        self.assertAllEqual(self.evaluate(expected), self.evaluate(output))
+
+  def testStringViewToHashBucketsFastInvalidSplits(self):
+    with self.cached_session():
+      values = constant_op.constant([97, 98], dtype=dtypes.uint8)
+      with self.assertRaisesOpError('row_splits must be sorted'):
+        self.evaluate(gen_string_ops.string_view_to_hash_bucket_fast(
+            values, constant_op.constant([0, 3]), 10))
+
   @test_util.run_deprecated_v1
   def testStringToOneHashBucketLegacyHash(self):
     with self.cached_session():
@@ -35,6 +35,7 @@ from tensorflow.python.ops import math_ops
 from tensorflow.python.ops import resource_variable_ops
 from tensorflow.python.ops import sparse_ops
 from tensorflow.python.ops import variables
+from tensorflow.python.ops import string_ops
 from tensorflow.python.ops import fused_embedding_ops
 from tensorflow.python.platform import tf_logging as logging
 from tensorflow.python.util.tf_export import tf_export
@@ -1422,6 +1423,85 @@ def fused_safe_embedding_lookup_sparse(embedding_weights,
                 result.get_shape()[1:]))
     return final_result
 
+def hashed_safe_embedding_lookup_sparse(embedding_weights,
+                                        sparse_strings,
+                                        num_buckets,
+                                        combiner="mean",
+                                        name=None,
+                                        partition_strategy="div",
+                                        max_norm=None):
+  """Functionally the same as safe_embedding_lookup_sparse with the ids
+  `string_to_hash_bucket_fast(sparse_strings.values, num_buckets)`.
+
+  The empty rows are filled before the strings are hashed, so the hash directly
+  feeds the Unique and the gather of the lookup, which the op fusion can
+  replace by _KvResourceHashUniqueGather. The hashed ids are never negative,
+  nothing is pruned. The embeddings of the empty rows are zeros.
+  """
+  if embedding_weights is None:
+    raise ValueError("Missing embedding_weights %s." % embedding_weights)
+  if isinstance(embedding_weights, variables.PartitionedVariable):
+    embedding_weights = list(embedding_weights)  # get underlying Variables.
+  if not isinstance(embedding_weights, list):
+    embedding_weights = [embedding_weights]
+  if len(embedding_weights) < 1:
+    raise ValueError("Missing embedding_weights %s." % embedding_weights)
+
+  with ops.name_scope(name, "embedding_lookup", embedding_weights +
+                      [sparse_strings]) as scope:
+    # Reshape higher-rank sparse strings to linear segment ids.
+    original_shape = sparse_strings.dense_shape
+    original_rank_dim = tensor_shape.dimension_value(
+        sparse_strings.dense_shape.get_shape()[0])
+    original_rank = (
+        array_ops.size(original_shape)
+        if original_rank_dim is None else original_rank_dim)
+    sparse_strings = sparse_ops.sparse_reshape(sparse_strings, [
+        math_ops.reduce_prod(
+            array_ops.slice(original_shape, [0], [original_rank - 1])),
+        array_ops.gather(original_shape, original_rank - 1)
+    ])
+
+    # Fill in dummy values for empty features, their embeddings are masked.
+    sparse_strings, is_row_empty = sparse_ops.sparse_fill_empty_rows(
+        sparse_strings, "")
+    sparse_ids = sparse_tensor.SparseTensor(
+        sparse_strings.indices,
+        string_ops.string_to_hash_bucket_fast(sparse_strings.values,
+                                              num_buckets),
+        sparse_strings.dense_shape)
+
+    result = embedding_lookup_sparse(
+        embedding_weights,
+        sparse_ids,
+        None,
+        combiner=combiner,
+        partition_strategy=partition_strategy,
+        max_norm=max_norm)
+
+    # Broadcast is_row_empty to the same shape as embedding_lookup_result,
+    # for use in Select.
+    is_row_empty = array_ops.tile(
+        array_ops.reshape(is_row_empty, [-1, 1]),
+        array_ops.stack([1, array_ops.shape(result)[1]]))
+    result = array_ops.where(
+        is_row_empty, array_ops.zeros_like(result), result, name=scope)
+
+    # Reshape back from linear ids back into higher-dimensional dense result.
+    final_result = array_ops.reshape(
+        result,
+        array_ops.concat([
+            array_ops.slice(
+                math_ops.cast(original_shape, dtypes.int32), [0],
+                [original_rank - 1]),
+            array_ops.slice(array_ops.shape(result), [1], [-1])
+        ], 0))
+    final_result.set_shape(
+        tensor_shape.unknown_shape(
+            (tensor_shape.Dimension(original_rank_dim) - 1).value).concatenate(
+                result.get_shape()[1:]))
+    return final_result
+
 @tf_export("nn.safe_embedding_lookup_multi_dim")
 def safe_embedding_lookup_multi_dim(embedding_weights,
                                     sparse_ids,
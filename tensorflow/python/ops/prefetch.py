@@ -24,6 +24,8 @@ from tensorflow.python.framework import sparse_tensor
 from tensorflow.python.framework import ops
 from tensorflow.python.ops import array_ops
 from tensorflow.python.ops import control_flow_ops
+from tensorflow.python.platform import tf_logging as logging
+from tensorflow.python.training import session_run_hook
 from tensorflow.python.util import nest
 from tensorflow.python.util.tf_export import tf_export
 
@@ -34,6 +36,8 @@ from tensorflow.python.ops.prefetch_runner import PrefetchRunner
 ops.NotDifferentiable('TensorBufferPut')
 ops.NotDifferentiable('TensorBufferTake')
 ops.NotDifferentiable('TensorBufferCancel')
+ops.NotDifferentiable('InputPipelineStatsSummary')
+ops.NotDifferentiable('InputPipelineStatsReport')
 
 PREFETCH = "prefetch"
 
@@ -316,3 +320,85 @@ def prefetch_join(
       ignored_exception_types=ignored_exception_types)
   ops.add_to_collection(PREFETCH, runner)
   return prefetched
+
+@tf_export(v1=["input_pipeline_stats_summary"])
+def input_pipeline_stats_summary(reset=False, name=None):
+  """Summary of the stages of the input pipelines in this process.
+
+  The stages are the tf.data iterators, named by their prefixes, and the
+  buffers of `tf.staged`, named by their shared names. The stats are only
+  collected when enabled by `TF_INPUT_PIPELINE_STATS=1` or
+  `make_input_pipeline_stats_hook`.
+
+  Args:
+    reset: (Optional.) Whether to clear the stats after reading them.
+    name: (Optional.) Name of the operation.
+
+  Returns:
+    A tuple of the names and kinds of the stages, and a float64 matrix of
+    their stats. The columns are the number of elements, mean element
+    latency, self time, consumer wait and producer wait in microseconds,
+    mean occupancy and capacity.
+  """
+  return gen_tensor_buffer_ops.input_pipeline_stats_summary(
+      reset=reset, name=name)
+
+@tf_export(v1=["input_pipeline_stats_report"])
+def input_pipeline_stats_report(name=None):
+  """Report of the input pipelines in this process.
+
+  Args:
+    name: (Optional.) Name of the operation.
+
+  Returns:
+    A string tensor with a table of the stages, followed by the stage
+    limiting the throughput.
+  """
+  return gen_tensor_buffer_ops.input_pipeline_stats_report(name=name)
+
+class InputPipelineStatsHook(session_run_hook.SessionRunHook):
+  """SessionRunHook that collects and logs the input pipeline stats."""
+  def __init__(self, every_n_steps=1000):
+    """Build InputPipelineStatsHook.
+
+    Args:
+      every_n_steps: Number of steps between two reports, the last report is
+        logged at the end of the session anyway.
+    """
+    super(InputPipelineStatsHook, self).__init__()
+    if every_n_steps < 1:
+      raise ValueError('every_n_steps must >= 1')
+    self._every_n_steps = every_n_steps
+    self._steps = 0
+
+  def begin(self):
+    with ops.name_scope('input_pipeline_stats'):
+      self._enable_op = gen_tensor_buffer_ops.input_pipeline_stats_enable()
+      self._report = input_pipeline_stats_report()
+
+  def after_create_session(self, session, coord):
+    session.run(self._enable_op)
+
+  def after_run(self, run_context, run_values):
+    self._steps += 1
+    if self._steps % self._every_n_steps == 0:
+      self._log(run_context.session)
+
+  def end(self, session):
+    self._log(session)
+
+  def _log(self, session):
+    logging.info('Input pipeline stats after %d steps:\n%s', self._steps,
+                 session.run(self._report).decode())
+
+@tf_export(v1=["make_input_pipeline_stats_hook"])
+def make_input_pipeline_stats_hook(every_n_steps=1000):
+  """Create InputPipelineStatsHook for finding input pipeline bottlenecks.
+
+  Args:
+    every_n_steps: (Optional.) Number of steps between two reports.
+
+  Returns:
+    An InputPipelineStatsHook which enables the stats and logs the report.
+  """
+  return InputPipelineStatsHook(every_n_steps=every_n_steps)
@@ -20,6 +20,7 @@ from __future__ import print_function
 
 from six.moves import xrange # pylint: disable=redefined-builtin
 
+from tensorflow.python.data.ops import dataset_ops
 from tensorflow.python.framework import dtypes
 from tensorflow.python.framework import errors
 from tensorflow.python.framework import ops
@@ -309,6 +310,42 @@ class PrefetchTest(test.TestCase):
       sess.run(y)
       sess.close()
 
+  def test_input_pipeline_stats(self):
+    with ops.Graph().as_default() as graph:
+      with ops.device('/cpu:0'):
+        dataset = dataset_ops.Dataset.range(100).map(lambda x: x * 2).batch(4)
+        x = dataset_ops.make_one_shot_iterator(dataset).get_next()
+        y = prefetch.staged(
+            x, capacity=2, timeout_millis=1000, name='stats_prefetch')
+      hook = prefetch.make_input_pipeline_stats_hook(every_n_steps=5)
+      hook.begin()
+      names, kinds, stats = prefetch.input_pipeline_stats_summary()
+      report = prefetch.input_pipeline_stats_report()
+
+    graph.finalize()
+
+    with self.test_session(graph=graph) as sess:
+      hook.after_create_session(sess, None)
+      coord = coordinator.Coordinator()
+      prefetch.make_prefetch_hook().create_threads(sess, coord)
+      for i in xrange(10):
+        self.assertAllEqual([8 * i, 8 * i + 2, 8 * i + 4, 8 * i + 6],
+                            sess.run(y))
+      names_data, kinds_data, stats_data = sess.run([names, kinds, stats])
+      stages = {}
+      for i, name in enumerate(names_data):
+        stages[name.decode()] = (kinds_data[i].decode(), stats_data[i])
+      self.assertIn('stats_prefetch', stages)
+      kind, buffer_stats = stages['stats_prefetch']
+      self.assertEqual('stage', kind)
+      self.assertGreaterEqual(buffer_stats[0], 10)
+      self.assertEqual(2, buffer_stats[6])
+      iterators = [s for s in stages if s.startswith('Iterator::')]
+      self.assertTrue(iterators)
+      self.assertIn('map', [stages[s][0] for s in iterators])
+      self.assertIn('Bottleneck: ', sess.run(report).decode())
+      coord.request_stop()
+
 # pylint: enable=missing-docstring
 
 if __name__ == '__main__':
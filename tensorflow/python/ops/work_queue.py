@@ -25,6 +25,7 @@ from six.moves import xrange
 
 from tensorflow.python.eager import context
 from tensorflow.python.framework import constant_op
+from tensorflow.python.framework import device as pydev
 from tensorflow.python.data.ops import dataset_ops
 from tensorflow.python.framework import dtypes
 from tensorflow.python.framework import ops
@@ -154,7 +155,8 @@ class WorkQueue(saver.BaseSaverBuilder.SaveableObject):
       num_slices=None,
       num_clients=1,
       name=None,
-      local_work_mgr=None):
+      local_work_mgr=None,
+      num_shards=1):
     """Constructs a work queue.
 
     Args:
@@ -169,6 +171,11 @@ class WorkQueue(saver.BaseSaverBuilder.SaveableObject):
       num_slices: (Optional.) Total number of slices on all workers.
       num_clients: (Optional.) Number of threads for taking works.
       name: (Optional.) Name of the work queue.
+      local_work_mgr: (Optional.) A `LocalWorkMgr` to save the taken works.
+      num_shards: (Optional.) Number of shards of the works. Each work is
+        always in the same shard, a worker takes works from the shard of its
+        task index first and from the other shards when it is empty. 1 by
+        default, which takes the works in order.
 
     Raises:
       ValueError: If one of the arguments is invalid.
@@ -201,6 +208,8 @@ class WorkQueue(saver.BaseSaverBuilder.SaveableObject):
 
     if num_epochs <= 0:
       raise ValueError("num_epochs must be > 0 not {}.".format(num_epochs))
+    if num_shards <= 0:
+      raise ValueError("num_shards must be > 0 not {}.".format(num_shards))
 
     with ops.name_scope(name):
       self._remote_device = vs.variable(
@@ -210,6 +219,8 @@ class WorkQueue(saver.BaseSaverBuilder.SaveableObject):
           validate_shape=False,
           collections=[ops.GraphKeys.LOCAL_VARIABLES]).device
       self._local_device = control_flow_ops.no_op().device
+      local_task = pydev.DeviceSpec.from_string(self._local_device).task
+      self._client_index = -1 if local_task is None else int(local_task)
       with ops.device(self._remote_device):
         self._handle = gen_work_queue_ops.work_queue_handle_op(shared_name=name)
         self._digest_op = ops.convert_to_tensor(
@@ -250,7 +261,7 @@ class WorkQueue(saver.BaseSaverBuilder.SaveableObject):
         works_tensor = ops.convert_to_tensor(
             slices or self._works, dtype=dtypes.string)
         self._create = gen_work_queue_ops.work_queue_create(
-            self._handle, shared_name=name)
+            self._handle, shared_name=name, num_shards=num_shards)
         for epoch_index in xrange(num_epochs):
           with ops.control_dependencies([self._create]):
             with ops.name_scope('epochs/{}'.format(epoch_index)):
@@ -365,7 +376,8 @@ class WorkQueue(saver.BaseSaverBuilder.SaveableObject):
         with ops.device(self._remote_device):
           taken = gen_work_queue_ops.work_queue_take(
               self._handle,
-              num_clients=self.num_clients)
+              num_clients=self.num_clients,
+              client_index=self._client_index)
 
           work_bak = control_flow_ops.no_op()
           if self._local_work_mgr:
@@ -398,6 +410,30 @@ class WorkQueue(saver.BaseSaverBuilder.SaveableObject):
       return local_work
     return string_ops.string_join([self._prefix, local_work])
 
+  def take_batch(self, batch_size):
+    """Take at most `batch_size` works from the work queue.
+
+    Args:
+      batch_size: Maximum number of works to take.
+
+    Returns:
+      A vector of taken works, which is not empty.
+    """
+    if self._local_work_mgr:
+      raise ValueError("take_batch is not supported with local_work_mgr.")
+    with ops.name_scope(self.name):
+      with ops.device(self._remote_device):
+        taken = gen_work_queue_ops.work_queue_take_batch(
+            self._handle,
+            num_clients=self.num_clients,
+            client_index=self._client_index,
+            batch_size=batch_size)
+      with ops.device(self._local_device):
+        local_works = array_ops.identity(taken)
+    if self._prefix is None:
+      return local_works
+    return string_ops.string_join([self._prefix, local_works])
+
   def input_producer(self):
     """Returns a FIFOQueue as input producer.
 
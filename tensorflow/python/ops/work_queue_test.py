@@ -25,10 +25,12 @@ from six import string_types
 import portpicker
 
 from tensorflow.core.protobuf import config_pb2
+from tensorflow.python.framework import dtypes
 from tensorflow.python.framework import errors_impl
 from tensorflow.python.framework import ops
 from tensorflow.python.framework import test_util
 from tensorflow.python.ops import array_ops
+from tensorflow.python.ops import gen_work_queue_ops
 from tensorflow.python.ops import resources
 from tensorflow.python.ops import variables
 from tensorflow.python.ops import variable_scope as vs
@@ -140,6 +142,82 @@ class WorkQueueTest(test_lib.TestCase):
       for thread in threads:
         thread.join()
 
+  def _take_all(self, sess, take):
+    taken = []
+    while True:
+      try:
+        taken.append(sess.run(take))
+      except errors_impl.OutOfRangeError:
+        return taken
+
+  def test_sharded_take_batch(self):
+    with self.test_session() as sess:
+      works = [b"to", b"be", b"or", b"not", b"to", b"be"]
+      num_epochs = 2
+      work_queue = WorkQueue(
+          works, num_epochs=num_epochs, shuffle=False, num_shards=3)
+      take = work_queue.take_batch(4)
+
+      resources.initialize_resources(resources.shared_resources()).run()
+      variables.local_variables_initializer().run()
+
+      batches = [batch.tolist() for batch in self._take_all(sess, take)]
+      for batch in batches:
+        self.assertTrue(0 < len(batch) <= 4)
+      self.assertEqual(
+          sorted(works * num_epochs),
+          sorted([work for batch in batches for work in batch]))
+
+  def test_sharded_save_restore(self):
+    with self.test_session() as sess:
+      works = [b"work_%d" % i for i in range(20)]
+      work_queue = WorkQueue(works, shuffle=False, num_shards=4)
+      take = work_queue.take()
+      handle = work_queue._handle  # pylint: disable=protected-access
+      save = gen_work_queue_ops.work_queue_save(handle)
+      saved_works = array_ops.placeholder(dtype=dtypes.string)
+      restore = gen_work_queue_ops.work_queue_restore(handle, saved_works)
+      size = gen_work_queue_ops.work_queue_size(handle)
+
+      resources.initialize_resources(resources.shared_resources()).run()
+      variables.local_variables_initializer().run()
+
+      taken = [sess.run(take) for _ in range(5)]
+      saved = sess.run(save).tolist()
+      # Each work is either taken or saved.
+      self.assertEqual(sorted(works), sorted(taken + saved))
+
+      self._take_all(sess, take)
+      sess.run(restore, feed_dict={saved_works: saved})
+      self.assertEqual(15, sess.run(size))
+      self.assertEqual(sorted(saved), sorted(self._take_all(sess, take)))
+
+  def test_sharded_concurrent_take(self):
+    with self.test_session() as sess:
+      works = [b"work_%d" % i for i in range(200)]
+      num_threads = 8
+      work_queue = WorkQueue(
+          works, shuffle=False, num_shards=num_threads,
+          num_clients=num_threads)
+      take = work_queue.take_batch(3)
+
+      resources.initialize_resources(resources.shared_resources()).run()
+      variables.local_variables_initializer().run()
+
+      results = [[] for _ in range(num_threads)]
+      def _run(result):
+        result.extend(
+            work for batch in self._take_all(sess, take) for work in batch)
+      threads = [
+          self.checkedThread(target=_run, args=(results[i],))
+          for i in range(num_threads)]
+      for thread in threads:
+        thread.start()
+      for thread in threads:
+        thread.join()
+      self.assertEqual(
+          sorted(works), sorted([w for result in results for w in result]))
+
   def test_monitored_session(self):
     ps_hosts = ["localhost:{}".format(portpicker.pick_unused_port())]
     worker_hosts = ["localhost:{}".format(portpicker.pick_unused_port())]